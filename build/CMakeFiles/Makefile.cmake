@@ -0,0 +1,106 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/root/repo/src/benchmarks/CMakeLists.txt"
+  "/root/repo/src/tests/CMakeLists.txt"
+  "/usr/share/cmake-3.25/Modules/CMakeCInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CTest.cmake"
+  "/usr/share/cmake-3.25/Modules/CTestTargets.cmake"
+  "/usr/share/cmake-3.25/Modules/CTestUseLaunchers.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/DartConfiguration.tcl.in"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-C.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "DartConfiguration.tcl"
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/tests/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/benchmarks/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "CMakeFiles/Experimental.dir/DependInfo.cmake"
+  "CMakeFiles/Nightly.dir/DependInfo.cmake"
+  "CMakeFiles/Continuous.dir/DependInfo.cmake"
+  "CMakeFiles/NightlyMemoryCheck.dir/DependInfo.cmake"
+  "CMakeFiles/NightlyStart.dir/DependInfo.cmake"
+  "CMakeFiles/NightlyUpdate.dir/DependInfo.cmake"
+  "CMakeFiles/NightlyConfigure.dir/DependInfo.cmake"
+  "CMakeFiles/NightlyBuild.dir/DependInfo.cmake"
+  "CMakeFiles/NightlyTest.dir/DependInfo.cmake"
+  "CMakeFiles/NightlyCoverage.dir/DependInfo.cmake"
+  "CMakeFiles/NightlyMemCheck.dir/DependInfo.cmake"
+  "CMakeFiles/NightlySubmit.dir/DependInfo.cmake"
+  "CMakeFiles/ExperimentalStart.dir/DependInfo.cmake"
+  "CMakeFiles/ExperimentalUpdate.dir/DependInfo.cmake"
+  "CMakeFiles/ExperimentalConfigure.dir/DependInfo.cmake"
+  "CMakeFiles/ExperimentalBuild.dir/DependInfo.cmake"
+  "CMakeFiles/ExperimentalTest.dir/DependInfo.cmake"
+  "CMakeFiles/ExperimentalCoverage.dir/DependInfo.cmake"
+  "CMakeFiles/ExperimentalMemCheck.dir/DependInfo.cmake"
+  "CMakeFiles/ExperimentalSubmit.dir/DependInfo.cmake"
+  "CMakeFiles/ContinuousStart.dir/DependInfo.cmake"
+  "CMakeFiles/ContinuousUpdate.dir/DependInfo.cmake"
+  "CMakeFiles/ContinuousConfigure.dir/DependInfo.cmake"
+  "CMakeFiles/ContinuousBuild.dir/DependInfo.cmake"
+  "CMakeFiles/ContinuousTest.dir/DependInfo.cmake"
+  "CMakeFiles/ContinuousCoverage.dir/DependInfo.cmake"
+  "CMakeFiles/ContinuousMemCheck.dir/DependInfo.cmake"
+  "CMakeFiles/ContinuousSubmit.dir/DependInfo.cmake"
+  "CMakeFiles/utilities.dir/DependInfo.cmake"
+  "CMakeFiles/queue.dir/DependInfo.cmake"
+  "CMakeFiles/logger.dir/DependInfo.cmake"
+  "CMakeFiles/cpu_diagnostics.dir/DependInfo.cmake"
+  "CMakeFiles/threads.dir/DependInfo.cmake"
+  "CMakeFiles/main.dir/DependInfo.cmake"
+  "src/tests/CMakeFiles/utilities_time_test.dir/DependInfo.cmake"
+  "src/tests/CMakeFiles/queue_test.dir/DependInfo.cmake"
+  "src/tests/CMakeFiles/message_queue_test.dir/DependInfo.cmake"
+  "src/tests/CMakeFiles/message_queue_stats_test.dir/DependInfo.cmake"
+  "src/tests/CMakeFiles/value_queue_test.dir/DependInfo.cmake"
+  "src/tests/CMakeFiles/spsc_ring_test.dir/DependInfo.cmake"
+  "src/tests/CMakeFiles/broadcast_test.dir/DependInfo.cmake"
+  "src/tests/CMakeFiles/mpsc_queue_test.dir/DependInfo.cmake"
+  "src/tests/CMakeFiles/cpu_diagnostics_linux_test.dir/DependInfo.cmake"
+  "src/tests/CMakeFiles/cpu_diagnostics_kernels_test.dir/DependInfo.cmake"
+  "src/tests/CMakeFiles/cpu_diagnostics_process_test.dir/DependInfo.cmake"
+  "src/tests/CMakeFiles/cpu_diagnostics_cgroup_test.dir/DependInfo.cmake"
+  "src/tests/CMakeFiles/cpu_diagnostics_stat_pool_test.dir/DependInfo.cmake"
+  "src/benchmarks/CMakeFiles/stat_read_bench.dir/DependInfo.cmake"
+  "src/benchmarks/CMakeFiles/stat_layout_bench.dir/DependInfo.cmake"
+  "src/benchmarks/CMakeFiles/stat_kernels_bench.dir/DependInfo.cmake"
+  "src/benchmarks/CMakeFiles/proc_collector_bench.dir/DependInfo.cmake"
+  "src/benchmarks/CMakeFiles/cgroup_collector_bench.dir/DependInfo.cmake"
+  "src/benchmarks/CMakeFiles/spsc_ring_bench.dir/DependInfo.cmake"
+  "src/benchmarks/CMakeFiles/queue_bench.dir/DependInfo.cmake"
+  "src/benchmarks/CMakeFiles/wait_latency_bench.dir/DependInfo.cmake"
+  )
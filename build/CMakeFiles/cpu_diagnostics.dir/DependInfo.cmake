@@ -0,0 +1,28 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/cpu_diagnostics/cgroup.c" "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/cgroup.c.o" "gcc" "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/cgroup.c.o.d"
+  "/root/repo/src/cpu_diagnostics/kernels.c" "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/kernels.c.o" "gcc" "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/kernels.c.o.d"
+  "/root/repo/src/cpu_diagnostics/kernels_avx2.c" "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/kernels_avx2.c.o" "gcc" "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/kernels_avx2.c.o.d"
+  "/root/repo/src/cpu_diagnostics/kernels_sse2.c" "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/kernels_sse2.c.o" "gcc" "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/kernels_sse2.c.o.d"
+  "/root/repo/src/cpu_diagnostics/linux.c" "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/linux.c.o" "gcc" "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/linux.c.o.d"
+  "/root/repo/src/cpu_diagnostics/message.c" "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/message.c.o" "gcc" "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/message.c.o.d"
+  "/root/repo/src/cpu_diagnostics/process.c" "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/process.c.o" "gcc" "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/process.c.o.d"
+  "/root/repo/src/cpu_diagnostics/stat_pool.c" "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/stat_pool.c.o" "gcc" "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/stat_pool.c.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/build/CMakeFiles/queue.dir/DependInfo.cmake"
+  "/root/repo/build/CMakeFiles/utilities.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,25 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/cgroup.c.o"
+  "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/cgroup.c.o.d"
+  "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/kernels.c.o"
+  "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/kernels.c.o.d"
+  "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/kernels_avx2.c.o"
+  "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/kernels_avx2.c.o.d"
+  "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/kernels_sse2.c.o"
+  "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/kernels_sse2.c.o.d"
+  "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/linux.c.o"
+  "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/linux.c.o.d"
+  "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/message.c.o"
+  "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/message.c.o.d"
+  "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/process.c.o"
+  "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/process.c.o.d"
+  "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/stat_pool.c.o"
+  "CMakeFiles/cpu_diagnostics.dir/src/cpu_diagnostics/stat_pool.c.o.d"
+  "libcpu_diagnostics.a"
+  "libcpu_diagnostics.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/cpu_diagnostics.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
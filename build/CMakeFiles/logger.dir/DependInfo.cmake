@@ -0,0 +1,24 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/logger/log_record.c" "CMakeFiles/logger.dir/src/logger/log_record.c.o" "gcc" "CMakeFiles/logger.dir/src/logger/log_record.c.o.d"
+  "/root/repo/src/logger/logger.c" "CMakeFiles/logger.dir/src/logger/logger.c.o" "gcc" "CMakeFiles/logger.dir/src/logger/logger.c.o.d"
+  "/root/repo/src/logger/output_sinks.c" "CMakeFiles/logger.dir/src/logger/output_sinks.c.o" "gcc" "CMakeFiles/logger.dir/src/logger/output_sinks.c.o.d"
+  "/root/repo/src/logger/severity.c" "CMakeFiles/logger.dir/src/logger/severity.c.o" "gcc" "CMakeFiles/logger.dir/src/logger/severity.c.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/build/CMakeFiles/queue.dir/DependInfo.cmake"
+  "/root/repo/build/CMakeFiles/utilities.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,17 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/logger.dir/src/logger/log_record.c.o"
+  "CMakeFiles/logger.dir/src/logger/log_record.c.o.d"
+  "CMakeFiles/logger.dir/src/logger/logger.c.o"
+  "CMakeFiles/logger.dir/src/logger/logger.c.o.d"
+  "CMakeFiles/logger.dir/src/logger/output_sinks.c.o"
+  "CMakeFiles/logger.dir/src/logger/output_sinks.c.o.d"
+  "CMakeFiles/logger.dir/src/logger/severity.c.o"
+  "CMakeFiles/logger.dir/src/logger/severity.c.o.d"
+  "liblogger.a"
+  "liblogger.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/logger.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,27 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/data_structures/broadcast.c" "CMakeFiles/queue.dir/src/data_structures/broadcast.c.o" "gcc" "CMakeFiles/queue.dir/src/data_structures/broadcast.c.o.d"
+  "/root/repo/src/data_structures/byte_ring.c" "CMakeFiles/queue.dir/src/data_structures/byte_ring.c.o" "gcc" "CMakeFiles/queue.dir/src/data_structures/byte_ring.c.o.d"
+  "/root/repo/src/data_structures/channel.c" "CMakeFiles/queue.dir/src/data_structures/channel.c.o" "gcc" "CMakeFiles/queue.dir/src/data_structures/channel.c.o.d"
+  "/root/repo/src/data_structures/message_queue.c" "CMakeFiles/queue.dir/src/data_structures/message_queue.c.o" "gcc" "CMakeFiles/queue.dir/src/data_structures/message_queue.c.o.d"
+  "/root/repo/src/data_structures/message_value_queue.c" "CMakeFiles/queue.dir/src/data_structures/message_value_queue.c.o" "gcc" "CMakeFiles/queue.dir/src/data_structures/message_value_queue.c.o.d"
+  "/root/repo/src/data_structures/mpsc_queue.c" "CMakeFiles/queue.dir/src/data_structures/mpsc_queue.c.o" "gcc" "CMakeFiles/queue.dir/src/data_structures/mpsc_queue.c.o.d"
+  "/root/repo/src/data_structures/queue.c" "CMakeFiles/queue.dir/src/data_structures/queue.c.o" "gcc" "CMakeFiles/queue.dir/src/data_structures/queue.c.o.d"
+  "/root/repo/src/data_structures/spsc_ring.c" "CMakeFiles/queue.dir/src/data_structures/spsc_ring.c.o" "gcc" "CMakeFiles/queue.dir/src/data_structures/spsc_ring.c.o.d"
+  "/root/repo/src/data_structures/value_queue.c" "CMakeFiles/queue.dir/src/data_structures/value_queue.c.o" "gcc" "CMakeFiles/queue.dir/src/data_structures/value_queue.c.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,27 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/queue.dir/src/data_structures/broadcast.c.o"
+  "CMakeFiles/queue.dir/src/data_structures/broadcast.c.o.d"
+  "CMakeFiles/queue.dir/src/data_structures/byte_ring.c.o"
+  "CMakeFiles/queue.dir/src/data_structures/byte_ring.c.o.d"
+  "CMakeFiles/queue.dir/src/data_structures/channel.c.o"
+  "CMakeFiles/queue.dir/src/data_structures/channel.c.o.d"
+  "CMakeFiles/queue.dir/src/data_structures/message_queue.c.o"
+  "CMakeFiles/queue.dir/src/data_structures/message_queue.c.o.d"
+  "CMakeFiles/queue.dir/src/data_structures/message_value_queue.c.o"
+  "CMakeFiles/queue.dir/src/data_structures/message_value_queue.c.o.d"
+  "CMakeFiles/queue.dir/src/data_structures/mpsc_queue.c.o"
+  "CMakeFiles/queue.dir/src/data_structures/mpsc_queue.c.o.d"
+  "CMakeFiles/queue.dir/src/data_structures/queue.c.o"
+  "CMakeFiles/queue.dir/src/data_structures/queue.c.o.d"
+  "CMakeFiles/queue.dir/src/data_structures/spsc_ring.c.o"
+  "CMakeFiles/queue.dir/src/data_structures/spsc_ring.c.o.d"
+  "CMakeFiles/queue.dir/src/data_structures/value_queue.c.o"
+  "CMakeFiles/queue.dir/src/data_structures/value_queue.c.o.d"
+  "libqueue.a"
+  "libqueue.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/queue.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
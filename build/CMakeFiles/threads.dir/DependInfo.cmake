@@ -0,0 +1,30 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/threads/execution_frame.c" "CMakeFiles/threads.dir/src/threads/execution_frame.c.o" "gcc" "CMakeFiles/threads.dir/src/threads/execution_frame.c.o.d"
+  "/root/repo/src/threads/frames/analyzer.c" "CMakeFiles/threads.dir/src/threads/frames/analyzer.c.o" "gcc" "CMakeFiles/threads.dir/src/threads/frames/analyzer.c.o.d"
+  "/root/repo/src/threads/frames/cgroup_reader.c" "CMakeFiles/threads.dir/src/threads/frames/cgroup_reader.c.o" "gcc" "CMakeFiles/threads.dir/src/threads/frames/cgroup_reader.c.o.d"
+  "/root/repo/src/threads/frames/logger.c" "CMakeFiles/threads.dir/src/threads/frames/logger.c.o" "gcc" "CMakeFiles/threads.dir/src/threads/frames/logger.c.o.d"
+  "/root/repo/src/threads/frames/printer.c" "CMakeFiles/threads.dir/src/threads/frames/printer.c.o" "gcc" "CMakeFiles/threads.dir/src/threads/frames/printer.c.o.d"
+  "/root/repo/src/threads/frames/process_reader.c" "CMakeFiles/threads.dir/src/threads/frames/process_reader.c.o" "gcc" "CMakeFiles/threads.dir/src/threads/frames/process_reader.c.o.d"
+  "/root/repo/src/threads/frames/reader.c" "CMakeFiles/threads.dir/src/threads/frames/reader.c.o" "gcc" "CMakeFiles/threads.dir/src/threads/frames/reader.c.o.d"
+  "/root/repo/src/threads/thread_context.c" "CMakeFiles/threads.dir/src/threads/thread_context.c.o" "gcc" "CMakeFiles/threads.dir/src/threads/thread_context.c.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/build/CMakeFiles/logger.dir/DependInfo.cmake"
+  "/root/repo/build/CMakeFiles/utilities.dir/DependInfo.cmake"
+  "/root/repo/build/CMakeFiles/cpu_diagnostics.dir/DependInfo.cmake"
+  "/root/repo/build/CMakeFiles/queue.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,25 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/threads.dir/src/threads/execution_frame.c.o"
+  "CMakeFiles/threads.dir/src/threads/execution_frame.c.o.d"
+  "CMakeFiles/threads.dir/src/threads/frames/analyzer.c.o"
+  "CMakeFiles/threads.dir/src/threads/frames/analyzer.c.o.d"
+  "CMakeFiles/threads.dir/src/threads/frames/cgroup_reader.c.o"
+  "CMakeFiles/threads.dir/src/threads/frames/cgroup_reader.c.o.d"
+  "CMakeFiles/threads.dir/src/threads/frames/logger.c.o"
+  "CMakeFiles/threads.dir/src/threads/frames/logger.c.o.d"
+  "CMakeFiles/threads.dir/src/threads/frames/printer.c.o"
+  "CMakeFiles/threads.dir/src/threads/frames/printer.c.o.d"
+  "CMakeFiles/threads.dir/src/threads/frames/process_reader.c.o"
+  "CMakeFiles/threads.dir/src/threads/frames/process_reader.c.o.d"
+  "CMakeFiles/threads.dir/src/threads/frames/reader.c.o"
+  "CMakeFiles/threads.dir/src/threads/frames/reader.c.o.d"
+  "CMakeFiles/threads.dir/src/threads/thread_context.c.o"
+  "CMakeFiles/threads.dir/src/threads/thread_context.c.o.d"
+  "libthreads.a"
+  "libthreads.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/threads.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
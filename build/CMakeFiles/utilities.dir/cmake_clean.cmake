@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/utilities.dir/src/utilities/string.c.o"
+  "CMakeFiles/utilities.dir/src/utilities/string.c.o.d"
+  "CMakeFiles/utilities.dir/src/utilities/time.c.o"
+  "CMakeFiles/utilities.dir/src/utilities/time.c.o.d"
+  "libutilities.a"
+  "libutilities.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/utilities.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,23 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/utilities/time.c" "src/benchmarks/CMakeFiles/cgroup_collector_bench.dir/__/utilities/time.c.o" "gcc" "src/benchmarks/CMakeFiles/cgroup_collector_bench.dir/__/utilities/time.c.o.d"
+  "/root/repo/src/benchmarks/cpu_diagnostics/cgroup_collector_bench.c" "src/benchmarks/CMakeFiles/cgroup_collector_bench.dir/cpu_diagnostics/cgroup_collector_bench.c.o" "gcc" "src/benchmarks/CMakeFiles/cgroup_collector_bench.dir/cpu_diagnostics/cgroup_collector_bench.c.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/build/CMakeFiles/cpu_diagnostics.dir/DependInfo.cmake"
+  "/root/repo/build/CMakeFiles/queue.dir/DependInfo.cmake"
+  "/root/repo/build/CMakeFiles/utilities.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
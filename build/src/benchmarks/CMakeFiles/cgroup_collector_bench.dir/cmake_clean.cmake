@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "../../cgroup_collector_bench"
+  "../../cgroup_collector_bench.pdb"
+  "CMakeFiles/cgroup_collector_bench.dir/__/utilities/time.c.o"
+  "CMakeFiles/cgroup_collector_bench.dir/__/utilities/time.c.o.d"
+  "CMakeFiles/cgroup_collector_bench.dir/cpu_diagnostics/cgroup_collector_bench.c.o"
+  "CMakeFiles/cgroup_collector_bench.dir/cpu_diagnostics/cgroup_collector_bench.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/cgroup_collector_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
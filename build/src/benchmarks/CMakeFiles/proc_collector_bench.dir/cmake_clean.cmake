@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "../../proc_collector_bench"
+  "../../proc_collector_bench.pdb"
+  "CMakeFiles/proc_collector_bench.dir/__/utilities/time.c.o"
+  "CMakeFiles/proc_collector_bench.dir/__/utilities/time.c.o.d"
+  "CMakeFiles/proc_collector_bench.dir/cpu_diagnostics/proc_collector_bench.c.o"
+  "CMakeFiles/proc_collector_bench.dir/cpu_diagnostics/proc_collector_bench.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/proc_collector_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
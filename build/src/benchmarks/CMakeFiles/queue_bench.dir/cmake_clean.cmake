@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "../../queue_bench"
+  "../../queue_bench.pdb"
+  "CMakeFiles/queue_bench.dir/__/utilities/time.c.o"
+  "CMakeFiles/queue_bench.dir/__/utilities/time.c.o.d"
+  "CMakeFiles/queue_bench.dir/data_structures/queue_bench.c.o"
+  "CMakeFiles/queue_bench.dir/data_structures/queue_bench.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/queue_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
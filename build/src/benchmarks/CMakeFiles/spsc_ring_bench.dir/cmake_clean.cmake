@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "../../spsc_ring_bench"
+  "../../spsc_ring_bench.pdb"
+  "CMakeFiles/spsc_ring_bench.dir/__/utilities/time.c.o"
+  "CMakeFiles/spsc_ring_bench.dir/__/utilities/time.c.o.d"
+  "CMakeFiles/spsc_ring_bench.dir/data_structures/spsc_ring_bench.c.o"
+  "CMakeFiles/spsc_ring_bench.dir/data_structures/spsc_ring_bench.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/spsc_ring_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "../../stat_kernels_bench"
+  "../../stat_kernels_bench.pdb"
+  "CMakeFiles/stat_kernels_bench.dir/__/utilities/time.c.o"
+  "CMakeFiles/stat_kernels_bench.dir/__/utilities/time.c.o.d"
+  "CMakeFiles/stat_kernels_bench.dir/cpu_diagnostics/kernels_bench.c.o"
+  "CMakeFiles/stat_kernels_bench.dir/cpu_diagnostics/kernels_bench.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/stat_kernels_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "../../stat_layout_bench"
+  "../../stat_layout_bench.pdb"
+  "CMakeFiles/stat_layout_bench.dir/__/utilities/time.c.o"
+  "CMakeFiles/stat_layout_bench.dir/__/utilities/time.c.o.d"
+  "CMakeFiles/stat_layout_bench.dir/cpu_diagnostics/stat_layout_bench.c.o"
+  "CMakeFiles/stat_layout_bench.dir/cpu_diagnostics/stat_layout_bench.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/stat_layout_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
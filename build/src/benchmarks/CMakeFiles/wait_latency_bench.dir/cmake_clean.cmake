@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "../../wait_latency_bench"
+  "../../wait_latency_bench.pdb"
+  "CMakeFiles/wait_latency_bench.dir/__/utilities/time.c.o"
+  "CMakeFiles/wait_latency_bench.dir/__/utilities/time.c.o.d"
+  "CMakeFiles/wait_latency_bench.dir/data_structures/wait_latency_bench.c.o"
+  "CMakeFiles/wait_latency_bench.dir/data_structures/wait_latency_bench.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/wait_latency_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "../../broadcast_test"
+  "../../broadcast_test.pdb"
+  "CMakeFiles/broadcast_test.dir/__/data_structures/broadcast.c.o"
+  "CMakeFiles/broadcast_test.dir/__/data_structures/broadcast.c.o.d"
+  "CMakeFiles/broadcast_test.dir/__/utilities/time.c.o"
+  "CMakeFiles/broadcast_test.dir/__/utilities/time.c.o.d"
+  "CMakeFiles/broadcast_test.dir/data_structures/broadcast_test.c.o"
+  "CMakeFiles/broadcast_test.dir/data_structures/broadcast_test.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/broadcast_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
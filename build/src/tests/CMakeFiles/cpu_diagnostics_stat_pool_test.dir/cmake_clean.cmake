@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../cpu_diagnostics_stat_pool_test"
+  "../../cpu_diagnostics_stat_pool_test.pdb"
+  "CMakeFiles/cpu_diagnostics_stat_pool_test.dir/cpu_diagnostics/stat_pool_test.c.o"
+  "CMakeFiles/cpu_diagnostics_stat_pool_test.dir/cpu_diagnostics/stat_pool_test.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/cpu_diagnostics_stat_pool_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
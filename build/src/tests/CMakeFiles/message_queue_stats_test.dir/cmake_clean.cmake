@@ -0,0 +1,17 @@
+file(REMOVE_RECURSE
+  "../../message_queue_stats_test"
+  "../../message_queue_stats_test.pdb"
+  "CMakeFiles/message_queue_stats_test.dir/__/data_structures/message_queue.c.o"
+  "CMakeFiles/message_queue_stats_test.dir/__/data_structures/message_queue.c.o.d"
+  "CMakeFiles/message_queue_stats_test.dir/__/data_structures/queue.c.o"
+  "CMakeFiles/message_queue_stats_test.dir/__/data_structures/queue.c.o.d"
+  "CMakeFiles/message_queue_stats_test.dir/__/utilities/time.c.o"
+  "CMakeFiles/message_queue_stats_test.dir/__/utilities/time.c.o.d"
+  "CMakeFiles/message_queue_stats_test.dir/data_structures/message_queue_stats_test.c.o"
+  "CMakeFiles/message_queue_stats_test.dir/data_structures/message_queue_stats_test.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/message_queue_stats_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,22 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/data_structures/message_queue.c" "src/tests/CMakeFiles/message_queue_test.dir/__/data_structures/message_queue.c.o" "gcc" "src/tests/CMakeFiles/message_queue_test.dir/__/data_structures/message_queue.c.o.d"
+  "/root/repo/src/data_structures/queue.c" "src/tests/CMakeFiles/message_queue_test.dir/__/data_structures/queue.c.o" "gcc" "src/tests/CMakeFiles/message_queue_test.dir/__/data_structures/queue.c.o.d"
+  "/root/repo/src/utilities/time.c" "src/tests/CMakeFiles/message_queue_test.dir/__/utilities/time.c.o" "gcc" "src/tests/CMakeFiles/message_queue_test.dir/__/utilities/time.c.o.d"
+  "/root/repo/src/tests/data_structures/message_queue_test.c" "src/tests/CMakeFiles/message_queue_test.dir/data_structures/message_queue_test.c.o" "gcc" "src/tests/CMakeFiles/message_queue_test.dir/data_structures/message_queue_test.c.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "../../mpsc_queue_test"
+  "../../mpsc_queue_test.pdb"
+  "CMakeFiles/mpsc_queue_test.dir/__/data_structures/mpsc_queue.c.o"
+  "CMakeFiles/mpsc_queue_test.dir/__/data_structures/mpsc_queue.c.o.d"
+  "CMakeFiles/mpsc_queue_test.dir/__/utilities/time.c.o"
+  "CMakeFiles/mpsc_queue_test.dir/__/utilities/time.c.o.d"
+  "CMakeFiles/mpsc_queue_test.dir/data_structures/mpsc_queue_test.c.o"
+  "CMakeFiles/mpsc_queue_test.dir/data_structures/mpsc_queue_test.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/mpsc_queue_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
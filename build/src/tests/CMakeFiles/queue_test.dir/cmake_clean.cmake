@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "../../queue_test"
+  "../../queue_test.pdb"
+  "CMakeFiles/queue_test.dir/__/data_structures/queue.c.o"
+  "CMakeFiles/queue_test.dir/__/data_structures/queue.c.o.d"
+  "CMakeFiles/queue_test.dir/data_structures/queue_test.c.o"
+  "CMakeFiles/queue_test.dir/data_structures/queue_test.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/queue_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
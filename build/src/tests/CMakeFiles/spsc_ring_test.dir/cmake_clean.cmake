@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "../../spsc_ring_test"
+  "../../spsc_ring_test.pdb"
+  "CMakeFiles/spsc_ring_test.dir/__/data_structures/spsc_ring.c.o"
+  "CMakeFiles/spsc_ring_test.dir/__/data_structures/spsc_ring.c.o.d"
+  "CMakeFiles/spsc_ring_test.dir/__/utilities/time.c.o"
+  "CMakeFiles/spsc_ring_test.dir/__/utilities/time.c.o.d"
+  "CMakeFiles/spsc_ring_test.dir/data_structures/spsc_ring_test.c.o"
+  "CMakeFiles/spsc_ring_test.dir/data_structures/spsc_ring_test.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/spsc_ring_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "../../utilities_time_test"
+  "../../utilities_time_test.pdb"
+  "CMakeFiles/utilities_time_test.dir/__/utilities/time.c.o"
+  "CMakeFiles/utilities_time_test.dir/__/utilities/time.c.o.d"
+  "CMakeFiles/utilities_time_test.dir/utilities/time_test.c.o"
+  "CMakeFiles/utilities_time_test.dir/utilities/time_test.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/utilities_time_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,17 @@
+file(REMOVE_RECURSE
+  "../../value_queue_test"
+  "../../value_queue_test.pdb"
+  "CMakeFiles/value_queue_test.dir/__/data_structures/message_value_queue.c.o"
+  "CMakeFiles/value_queue_test.dir/__/data_structures/message_value_queue.c.o.d"
+  "CMakeFiles/value_queue_test.dir/__/data_structures/value_queue.c.o"
+  "CMakeFiles/value_queue_test.dir/__/data_structures/value_queue.c.o.d"
+  "CMakeFiles/value_queue_test.dir/__/utilities/time.c.o"
+  "CMakeFiles/value_queue_test.dir/__/utilities/time.c.o.d"
+  "CMakeFiles/value_queue_test.dir/data_structures/value_queue_test.c.o"
+  "CMakeFiles/value_queue_test.dir/data_structures/value_queue_test.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/value_queue_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
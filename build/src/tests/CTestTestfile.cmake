@@ -0,0 +1,32 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/src/tests
+# Build directory: /root/repo/build/src/tests
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test([=[Time-Test]=] "/root/repo/build/utilities_time_test")
+set_tests_properties([=[Time-Test]=] PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/src/tests/CMakeLists.txt;7;add_test;/root/repo/src/tests/CMakeLists.txt;0;")
+add_test([=[Queue-Test]=] "/root/repo/build/queue_test")
+set_tests_properties([=[Queue-Test]=] PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/src/tests/CMakeLists.txt;18;add_test;/root/repo/src/tests/CMakeLists.txt;0;")
+add_test([=[Message-Queue-Test]=] "/root/repo/build/message_queue_test")
+set_tests_properties([=[Message-Queue-Test]=] PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/src/tests/CMakeLists.txt;33;add_test;/root/repo/src/tests/CMakeLists.txt;0;")
+add_test([=[Message-Queue-Stats-Test]=] "/root/repo/build/message_queue_stats_test")
+set_tests_properties([=[Message-Queue-Stats-Test]=] PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/src/tests/CMakeLists.txt;51;add_test;/root/repo/src/tests/CMakeLists.txt;0;")
+add_test([=[Value-Queue-Test]=] "/root/repo/build/value_queue_test")
+set_tests_properties([=[Value-Queue-Test]=] PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/src/tests/CMakeLists.txt;66;add_test;/root/repo/src/tests/CMakeLists.txt;0;")
+add_test([=[Spsc-Ring-Test]=] "/root/repo/build/spsc_ring_test")
+set_tests_properties([=[Spsc-Ring-Test]=] PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/src/tests/CMakeLists.txt;80;add_test;/root/repo/src/tests/CMakeLists.txt;0;")
+add_test([=[Broadcast-Test]=] "/root/repo/build/broadcast_test")
+set_tests_properties([=[Broadcast-Test]=] PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/src/tests/CMakeLists.txt;94;add_test;/root/repo/src/tests/CMakeLists.txt;0;")
+add_test([=[Mpsc-Queue-Test]=] "/root/repo/build/mpsc_queue_test")
+set_tests_properties([=[Mpsc-Queue-Test]=] PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/src/tests/CMakeLists.txt;108;add_test;/root/repo/src/tests/CMakeLists.txt;0;")
+add_test([=[Linux-Stat-Test]=] "/root/repo/build/cpu_diagnostics_linux_test")
+set_tests_properties([=[Linux-Stat-Test]=] PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/src/tests/CMakeLists.txt;121;add_test;/root/repo/src/tests/CMakeLists.txt;0;")
+add_test([=[Stat-Kernels-Test]=] "/root/repo/build/cpu_diagnostics_kernels_test")
+set_tests_properties([=[Stat-Kernels-Test]=] PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/src/tests/CMakeLists.txt;133;add_test;/root/repo/src/tests/CMakeLists.txt;0;")
+add_test([=[Process-Collector-Test]=] "/root/repo/build/cpu_diagnostics_process_test")
+set_tests_properties([=[Process-Collector-Test]=] PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/src/tests/CMakeLists.txt;145;add_test;/root/repo/src/tests/CMakeLists.txt;0;")
+add_test([=[Cgroup-Collector-Test]=] "/root/repo/build/cpu_diagnostics_cgroup_test")
+set_tests_properties([=[Cgroup-Collector-Test]=] PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/src/tests/CMakeLists.txt;157;add_test;/root/repo/src/tests/CMakeLists.txt;0;")
+add_test([=[Stat-Pool-Test]=] "/root/repo/build/cpu_diagnostics_stat_pool_test")
+set_tests_properties([=[Stat-Pool-Test]=] PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/src/tests/CMakeLists.txt;169;add_test;/root/repo/src/tests/CMakeLists.txt;0;")
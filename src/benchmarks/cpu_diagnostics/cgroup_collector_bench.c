@@ -0,0 +1,132 @@
+//for mkdtemp and setrlimit
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cpu_diagnostics/cgroup.h"
+#include "utilities/time.h"
+
+/**
+ * @file Measures a scan of the per-cgroup collector on a synthetic cgroup v2
+ * like tree of the requested size made in /tmp, and the cpu share it takes
+ * when scanning once a second.
+ * 
+ * The tree has 50 parents with the rest of the cgroups spread under them.
+ * 
+ * Usage: cgroup_collector_bench [cgroup count] [scans]
+ */
+
+static void cgroup_path(
+  const char* root,
+  long id,
+  const char* file,
+  char path[static 512]
+) {
+  if (id < 50) {
+    snprintf(path, 512, "%s/p%ld%s", root, id, file);
+  } else {
+    snprintf(path, 512, "%s/p%ld/c%ld%s", root, id % 50, id, file);
+  }
+}
+
+static void write_stat(const char* root, long id) {
+  char path[512];
+  cgroup_path(root, id, "/cpu.stat", path);
+  FILE* file = fopen(path, "w");
+  if (file == NULL) {
+    return;
+  }
+  fprintf(
+    file,
+    "usage_usec %ld\nuser_usec %ld\nsystem_usec 0\nnr_periods 0\n"
+    "nr_throttled 0\nthrottled_usec 0\nnr_bursts 0\nburst_usec 0\n",
+    id,
+    id
+  );
+  fclose(file);
+}
+
+int main(int argc, char* argv[]) {
+  long cgroup_count = (argc > 1) ? strtol(argv[1], NULL, 10) : 5000;
+  long scans = (argc > 2) ? strtol(argv[2], NULL, 10) : 50;
+  if (cgroup_count <= 0 || scans <= 0) {
+    fputs("Cgroup and scan counts have to be positive.\n", stderr);
+    return EXIT_FAILURE;
+  }
+
+  //cached descriptors need two per cgroup
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+
+  char root[] = "/tmp/cgroup_collector_bench_XXXXXX";
+  if (mkdtemp(root) == NULL) {
+    fputs("Failed to create the synthetic tree.\n", stderr);
+    return EXIT_FAILURE;
+  }
+  for (long id = 0; id < cgroup_count; ++id) {
+    char path[512];
+    cgroup_path(root, id, "", path);
+    mkdir(path, 0700);
+    write_stat(root, id);
+  }
+
+  cgroup_collector_t collector;
+  if (cgroup_collector_open(&collector, root)) {
+    fputs("Failed to open the synthetic tree.\n", stderr);
+    return EXIT_FAILURE;
+  }
+  cgroup_sample_t sample = NULL;
+  //first scan walks the tree and opens every file, it's measured separately
+  timepoint_t start = timepoint_now();
+  int failures = (cgroup_collector_sample(&collector, &sample) != 0);
+  double first_ns = timespan_elapsed_ns(start, timepoint_now());
+  size_t tracked = (failures == 0) ? sample->cgroup_count : 0;
+  if (failures == 0) {
+    cgroup_sample_free(sample);
+  }
+  start = timepoint_now();
+  for (long i = 0; i < scans; ++i) {
+    if (cgroup_collector_sample(&collector, &sample)) {
+      failures += 1;
+    } else {
+      cgroup_sample_free(sample);
+    }
+  }
+  double scan_ns = timespan_elapsed_ns(start, timepoint_now()) / (double)scans;
+  unsigned long long walk_count = collector.walk_count;
+  cgroup_collector_close(&collector);
+
+  for (long id = cgroup_count - 1; id >= 0; --id) {
+    char path[512];
+    cgroup_path(root, id, "/cpu.stat", path);
+    remove(path);
+    cgroup_path(root, id, "", path);
+    rmdir(path);
+  }
+  rmdir(root);
+
+  printf(
+    "%ld cgroups(%zu tracked), %ld scans, %llu walks\n",
+    cgroup_count,
+    tracked,
+    scans,
+    walk_count
+  );
+  printf("1st scan:            %14.1f us\n", first_ns / 1000);
+  printf("scan:                %14.1f us\n", scan_ns / 1000);
+  printf("cpu at 1 scan/s:     %14.3f%%\n", scan_ns / 1e7);
+
+  if (failures) {
+    fprintf(stderr, "%i scans failed.\n", failures);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cpu_diagnostics/linux.h"
+#include "cpu_diagnostics/kernels.h"
+#include "utilities/time.h"
+
+/**
+ * @file Throughput of every kernel available on the machine, on synthetic
+ * samples of a 2048 cpu partition(2049 rows with the summary one).
+ * 
+ * Usage: stat_kernels_bench [rounds] [cpu_count]
+ */
+
+/**
+ * @brief Keeps the compiler from discarding the computed values.
+ */
+static volatile stat_cpu_percentage_t sink;
+
+int main(int argc, char* argv[]) {
+  long rounds_arg = (argc > 1) ? strtol(argv[1], NULL, 10) : 2000;
+  long cpus_arg = (argc > 2) ? strtol(argv[2], NULL, 10) : 2048;
+  if (rounds_arg <= 0 || cpus_arg <= 0) {
+    fputs("Round and cpu counts have to be positive.\n", stderr);
+    return EXIT_FAILURE;
+  }
+  size_t rounds = (size_t)rounds_arg;
+  stat_layout_t layout = {
+    .cpu_count = (size_t)cpus_arg + 1,
+    .cpu_column_count = 10
+  };
+
+  stat_cpu_array_t old = stat_cpu_array_create_l(&layout);
+  stat_cpu_array_t curr = stat_cpu_array_create_l(&layout);
+  stat_cpu_array_t delta = stat_cpu_array_create_l(&layout);
+  stat_cpu_percentage_array_t result =
+    stat_cpu_percentage_array_create_l(&layout);
+  for (size_t i = 0; i < layout.cpu_count; ++i) {
+    stat_cpu_row_t old_row = stat_cpu_array_row(old, i);
+    stat_cpu_row_t curr_row = stat_cpu_array_row(curr, i);
+    for (size_t j = 0; j < layout.cpu_column_count; ++j) {
+      old_row[j] = 1000000 + i * 31 + j * 7;
+      curr_row[j] = old_row[j] + (i + j) % 97;
+    }
+  }
+  size_t field_count = layout.cpu_count * old->stride;
+  double bytes_per_round =
+    (double)(field_count * sizeof(stat_cpu_field_t) * 3);
+
+  printf(
+    "%zu rows, active kernels: %s\n",
+    layout.cpu_count,
+    stat_kernels_active()->name
+  );
+  printf(
+    "%10s %14s %14s %12s %12s\n",
+    "kernels",
+    "delta ns",
+    "percentage ns",
+    "fused ns",
+    "delta GB/s"
+  );
+  for (int isa = 0; isa < stat_kernel_isa_count; ++isa) {
+    const stat_kernels_t* kernels =
+      stat_kernels_get((enum stat_kernel_isa)isa);
+    if (kernels == NULL) {
+      continue;
+    }
+    timepoint_t start = timepoint_now();
+    size_t resets = 0;
+    for (size_t round = 0; round < rounds; ++round) {
+      resets += kernels->delta(
+        old->fields,
+        curr->fields,
+        delta->fields,
+        field_count
+      );
+    }
+    double delta_ns =
+      timespan_elapsed_ns(start, timepoint_now()) / (double)rounds;
+
+    start = timepoint_now();
+    for (size_t round = 0; round < rounds; ++round) {
+      kernels->percentage(
+        result->values,
+        delta->fields,
+        layout.cpu_count,
+        delta->stride
+      );
+      sink = result->values[round % layout.cpu_count];
+    }
+    double percentage_ns =
+      timespan_elapsed_ns(start, timepoint_now()) / (double)rounds;
+
+    start = timepoint_now();
+    for (size_t round = 0; round < rounds; ++round) {
+      resets += kernels->fused(
+        result->values,
+        old->fields,
+        curr->fields,
+        layout.cpu_count,
+        old->stride
+      );
+      sink = result->values[round % layout.cpu_count];
+    }
+    double fused_ns =
+      timespan_elapsed_ns(start, timepoint_now()) / (double)rounds;
+    sink = (stat_cpu_percentage_t)resets;
+
+    printf(
+      "%10s %14.1f %14.1f %12.1f %12.2f\n",
+      kernels->name,
+      delta_ns,
+      percentage_ns,
+      fused_ns,
+      bytes_per_round / delta_ns
+    );
+  }
+
+  stat_cpu_array_free(old);
+  stat_cpu_array_free(curr);
+  stat_cpu_array_free(delta);
+  stat_cpu_percentage_array_free(result);
+  return EXIT_SUCCESS;
+}
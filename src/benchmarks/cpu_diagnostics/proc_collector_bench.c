@@ -0,0 +1,167 @@
+//for mkdtemp, opendir and setrlimit
+#define _POSIX_C_SOURCE 200809L
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cpu_diagnostics/process.h"
+#include "utilities/time.h"
+
+/**
+ * @file Compares a tick of the per-process collector against the naive way of
+ * doing the same(readdir, then fopen and fscanf of every stat file), on
+ * a synthetic /proc-like tree of the requested size made in /tmp.
+ * 
+ * Usage: proc_collector_bench [process count] [ticks]
+ */
+
+static void write_stat(const char* root, long pid, unsigned long long ticks) {
+  char path[256];
+  snprintf(path, sizeof(path), "%s/%ld/stat", root, pid);
+  FILE* file = fopen(path, "w");
+  if (file == NULL) {
+    return;
+  }
+  fprintf(
+    file,
+    "%ld (bench worker) S 1 %ld %ld 0 -1 4194560 120 0 0 0 %llu %llu 0 0 20 0 "
+    "1 0 %ld 1000 100 18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 0 17 0 0 0 "
+    "0 0 0\n",
+    pid,
+    pid,
+    pid,
+    ticks,
+    ticks / 2,
+    pid
+  );
+  fclose(file);
+}
+
+/**
+ * @brief Reads the whole tree the way a stdio based tool would.
+ */
+static size_t naive_tick(const char* root) {
+  DIR* dir = opendir(root);
+  if (dir == NULL) {
+    return 0;
+  }
+  size_t active = 0;
+  struct dirent* dirent;
+  while ((dirent = readdir(dir)) != NULL) {
+    if (dirent->d_name[0] < '0' || dirent->d_name[0] > '9') {
+      continue;
+    }
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s/stat", root, dirent->d_name);
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+      continue;
+    }
+    unsigned long long utime = 0;
+    unsigned long long stime = 0;
+    if (
+      fscanf(
+        file,
+        "%*d (%*[^)]) %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu",
+        &utime,
+        &stime
+      ) == 2
+    ) {
+      active += (utime + stime != 0);
+    }
+    fclose(file);
+  }
+  closedir(dir);
+  return active;
+}
+
+int main(int argc, char* argv[]) {
+  long process_count = (argc > 1) ? strtol(argv[1], NULL, 10) : 20000;
+  long ticks = (argc > 2) ? strtol(argv[2], NULL, 10) : 20;
+  if (process_count <= 0 || ticks <= 0) {
+    fputs("Process and tick counts have to be positive.\n", stderr);
+    return EXIT_FAILURE;
+  }
+
+  //cached descriptors need one per process
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+
+  char root[] = "/tmp/proc_collector_bench_XXXXXX";
+  if (mkdtemp(root) == NULL) {
+    fputs("Failed to create the synthetic tree.\n", stderr);
+    return EXIT_FAILURE;
+  }
+  for (long pid = 1; pid <= process_count; ++pid) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%ld", root, pid);
+    mkdir(path, 0700);
+    write_stat(root, pid, (unsigned long long)pid);
+  }
+
+  timepoint_t start = timepoint_now();
+  size_t naive_active = 0;
+  for (long i = 0; i < ticks; ++i) {
+    naive_active += naive_tick(root);
+  }
+  double naive_ns = timespan_elapsed_ns(start, timepoint_now()) / (double)ticks;
+
+  proc_collector_t collector;
+  if (proc_collector_open(&collector, root, proc_collect_processes)) {
+    fputs("Failed to open the synthetic tree.\n", stderr);
+    return EXIT_FAILURE;
+  }
+  proc_sample_t sample = NULL;
+  //first tick opens every stat file, it's measured separately
+  start = timepoint_now();
+  int failures = (proc_collector_sample(&collector, &sample) != 0);
+  double first_ns = timespan_elapsed_ns(start, timepoint_now());
+  proc_sample_free(sample);
+  start = timepoint_now();
+  for (long i = 0; i < ticks; ++i) {
+    if (proc_collector_sample(&collector, &sample)) {
+      failures += 1;
+    } else {
+      proc_sample_free(sample);
+    }
+  }
+  double collector_ns =
+    timespan_elapsed_ns(start, timepoint_now()) / (double)ticks;
+  size_t task_count = proc_collector_task_count(&collector);
+  proc_collector_close(&collector);
+
+  for (long pid = 1; pid <= process_count; ++pid) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%ld/stat", root, pid);
+    remove(path);
+    snprintf(path, sizeof(path), "%s/%ld", root, pid);
+    rmdir(path);
+  }
+  rmdir(root);
+
+  printf(
+    "%ld processes(%zu tracked), %ld ticks, %zu active per naive tick\n",
+    process_count,
+    task_count,
+    ticks,
+    naive_active / (size_t)ticks
+  );
+  printf("readdir+fscanf:      %14.1f us/tick\n", naive_ns / 1000);
+  printf("collector, 1st tick: %14.1f us\n", first_ns / 1000);
+  printf("collector:           %14.1f us/tick\n", collector_ns / 1000);
+  printf("speedup:             %14.2fx\n", naive_ns / collector_ns);
+
+  if (failures) {
+    fprintf(stderr, "%i ticks failed.\n", failures);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cpu_diagnostics/linux.h"
+#include "utilities/time.h"
+
+/**
+ * @file Compares the contiguous stat_cpu_array_t against the pointer table
+ * layout it replaced, on synthetic samples of 8, 64, 512 and 4096 cpus.
+ * 
+ * Each round creates a sample, fills it, computes the delta against the
+ * previous sample and percentages from the delta, then frees the previous
+ * sample, which is what one reader and analyzer iteration amounts to.
+ * 
+ * Usage: stat_layout_bench [rounds_per_size]
+ */
+
+/**
+ * @brief Previous layout, one allocation for the row table plus one per row.
+ */
+typedef stat_cpu_row_t* legacy_array_t;
+
+static legacy_array_t legacy_create(stat_layout_t layout[static 1]) {
+  legacy_array_t array = malloc(sizeof(stat_cpu_row_t) * layout->cpu_count);
+  for (size_t i = 0; i < layout->cpu_count; ++i) {
+    array[i] = malloc(sizeof(stat_cpu_field_t) * layout->cpu_column_count);
+  }
+  return array;
+}
+
+static void legacy_free(
+  legacy_array_t array,
+  stat_layout_t layout[static 1]
+) {
+  for (size_t i = 0; i < layout->cpu_count; ++i) {
+    free(array[i]);
+  }
+  free(array);
+}
+
+static void legacy_fill(
+  legacy_array_t array,
+  stat_layout_t layout[static 1],
+  size_t round
+) {
+  for (size_t i = 0; i < layout->cpu_count; ++i) {
+    for (size_t j = 0; j < layout->cpu_column_count; ++j) {
+      array[i][j] = (stat_cpu_field_t)(round * (i + j + 1));
+    }
+  }
+}
+
+static void legacy_analyze(
+  legacy_array_t old,
+  legacy_array_t curr,
+  legacy_array_t delta,
+  stat_cpu_percentage_array_t result,
+  stat_layout_t layout[static 1]
+) {
+  for (size_t i = 0; i < layout->cpu_count; ++i) {
+    stat_cpu_row_delta_l(old[i], curr[i], delta[i], layout);
+  }
+  for (size_t i = 0; i < layout->cpu_count; ++i) {
+    result->values[i] = stat_cpu_row_percentage_8(delta[i]);
+  }
+}
+
+static void contiguous_fill(
+  stat_cpu_array_t array,
+  stat_layout_t layout[static 1],
+  size_t round
+) {
+  for (size_t i = 0; i < layout->cpu_count; ++i) {
+    stat_cpu_row_t row = stat_cpu_array_row(array, i);
+    for (size_t j = 0; j < layout->cpu_column_count; ++j) {
+      row[j] = (stat_cpu_field_t)(round * (i + j + 1));
+    }
+  }
+}
+
+/**
+ * @brief Keeps the compiler from discarding the computed percentages.
+ */
+static volatile stat_cpu_percentage_t sink;
+
+int main(int argc, char* argv[]) {
+  long rounds_arg = (argc > 1) ? strtol(argv[1], NULL, 10) : 2000;
+  if (rounds_arg <= 0) {
+    fputs("Round count has to be positive.\n", stderr);
+    return EXIT_FAILURE;
+  }
+  size_t rounds = (size_t)rounds_arg;
+  static const size_t cpu_counts[] = {8, 64, 512, 4096};
+
+  printf(
+    "%8s %16s %16s %10s\n",
+    "cpus",
+    "pointers ns",
+    "contiguous ns",
+    "speedup"
+  );
+  for (size_t k = 0; k < sizeof(cpu_counts) / sizeof(cpu_counts[0]); ++k) {
+    stat_layout_t layout = {
+      .cpu_count = cpu_counts[k] + 1,
+      .cpu_column_count = 10
+    };
+    stat_cpu_percentage_array_t result =
+      stat_cpu_percentage_array_create_l(&layout);
+
+    legacy_array_t legacy_delta = legacy_create(&layout);
+    legacy_array_t legacy_prev = legacy_create(&layout);
+    legacy_fill(legacy_prev, &layout, 0);
+    timepoint_t start = timepoint_now();
+    for (size_t round = 1; round <= rounds; ++round) {
+      legacy_array_t curr = legacy_create(&layout);
+      legacy_fill(curr, &layout, round);
+      legacy_analyze(legacy_prev, curr, legacy_delta, result, &layout);
+      sink = result->values[0];
+      legacy_free(legacy_prev, &layout);
+      legacy_prev = curr;
+    }
+    double legacy_ns =
+      timespan_elapsed_ns(start, timepoint_now()) / (double)rounds;
+    legacy_free(legacy_prev, &layout);
+    legacy_free(legacy_delta, &layout);
+
+    stat_cpu_array_t delta = stat_cpu_array_create_l(&layout);
+    stat_cpu_array_t prev = stat_cpu_array_create_l(&layout);
+    contiguous_fill(prev, &layout, 0);
+    start = timepoint_now();
+    for (size_t round = 1; round <= rounds; ++round) {
+      stat_cpu_array_t curr = stat_cpu_array_create_l(&layout);
+      contiguous_fill(curr, &layout, round);
+      stat_cpu_array_delta_l(prev, curr, delta, &layout);
+      stat_cpu_percentage_array_calculate_l(result, delta, &layout);
+      sink = result->values[0];
+      stat_cpu_array_free(prev);
+      prev = curr;
+    }
+    double contiguous_ns =
+      timespan_elapsed_ns(start, timepoint_now()) / (double)rounds;
+    stat_cpu_array_free(prev);
+    stat_cpu_array_free(delta);
+
+    stat_cpu_percentage_array_free(result);
+    printf(
+      "%8zu %16.1f %16.1f %9.2fx\n",
+      cpu_counts[k],
+      legacy_ns,
+      contiguous_ns,
+      legacy_ns / contiguous_ns
+    );
+  }
+  return EXIT_SUCCESS;
+}
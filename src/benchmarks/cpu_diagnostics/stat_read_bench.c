@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cpu_diagnostics/linux.h"
+#include "utilities/time.h"
+
+/**
+ * @file Compares the cost of taking a single /proc/stat sample the way the
+ * reader used to(fopen, allocation, fscanf, fclose) against the persistent
+ * stat_sampler_t.
+ * 
+ * Usage: stat_read_bench [path] [iterations]
+ */
+
+int main(int argc, char* argv[]) {
+  const char* path = (argc > 1) ? argv[1] : "/proc/stat";
+  long iterations = (argc > 2) ? strtol(argv[2], NULL, 10) : 20000;
+  if (iterations <= 0) {
+    fputs("Iteration count has to be positive.\n", stderr);
+    return EXIT_FAILURE;
+  }
+
+  FILE* source = fopen(path, "r");
+  if (source == NULL) {
+    fprintf(stderr, "Failed to open %s.\n", path);
+    return EXIT_FAILURE;
+  }
+  stat_layout_t layout;
+  stat_layout_set_lf(&layout, source);
+  fclose(source);
+
+  int failures = 0;
+
+  timepoint_t start = timepoint_now();
+  for (long i = 0; i < iterations; ++i) {
+    FILE* stat = fopen(path, "r");
+    stat_cpu_array_t array = stat_cpu_array_create_l(&layout);
+    failures += (stat_cpu_array_read_fl(array, stat, &layout) != 0);
+    fclose(stat);
+    stat_cpu_array_free(array);
+  }
+  double fscanf_ns =
+    timespan_elapsed_ns(start, timepoint_now()) / (double)iterations;
+
+  stat_sampler_t sampler;
+  if (stat_sampler_open(&sampler, path)) {
+    fprintf(stderr, "Failed to open %s.\n", path);
+    return EXIT_FAILURE;
+  }
+  stat_cpu_array_t array = stat_cpu_array_create_l(&layout);
+  start = timepoint_now();
+  for (long i = 0; i < iterations; ++i) {
+    failures += (stat_sampler_read_l(&sampler, array, &layout) != 0);
+  }
+  double sampler_ns =
+    timespan_elapsed_ns(start, timepoint_now()) / (double)iterations;
+  stat_cpu_array_free(array);
+  stat_sampler_close(&sampler);
+
+  printf(
+    "%s: %zu cpu lines x %zu columns, %ld iterations\n",
+    path,
+    layout.cpu_count,
+    layout.cpu_column_count,
+    iterations
+  );
+  printf("fopen+fscanf: %12.1f ns/sample\n", fscanf_ns);
+  printf("stat_sampler: %12.1f ns/sample\n", sampler_ns);
+  printf("speedup:      %12.2fx\n", fscanf_ns / sampler_ns);
+
+  if (failures) {
+    fprintf(stderr, "%i reads failed.\n", failures);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
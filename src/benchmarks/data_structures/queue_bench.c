@@ -0,0 +1,175 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "data_structures/message_queue.h"
+#include "data_structures/message_value_queue.h"
+#include "data_structures/queue.h"
+#include "utilities/time.h"
+
+/**
+ * @file Compares plain and pooled queues on bursts of pushes followed by pops,
+ * both the bare queue and the message queue around it, then passing small
+ * payloads boxed on the heap against copying them by value.
+ * 
+ * Usage: queue_bench [burst size] [bursts]
+ */
+
+/**
+ * @return Nanoseconds per push and pop pair, negative if elements got lost.
+ */
+static double bench_queue(queue_t queue[static 1], long burst, long bursts) {
+  static int element;
+  long popped = 0;
+  timepoint_t start = timepoint_now();
+  for (long i = 0; i < bursts; ++i) {
+    for (long j = 0; j < burst; ++j) {
+      queue_push(queue, &element);
+    }
+    for (long j = 0; j < burst; ++j) {
+      popped += (queue_pop(queue) != NULL);
+    }
+  }
+  double total_ns = timespan_elapsed_ns(start, timepoint_now());
+  return (popped == burst * bursts) ? total_ns / (double)popped : -1;
+}
+
+/**
+ * @return Nanoseconds per push and pop pair, negative if elements got lost.
+ */
+static double bench_message_queue(
+  message_queue_t queue[static 1],
+  long burst,
+  long bursts
+) {
+  static int element;
+  long popped = 0;
+  timepoint_t start = timepoint_now();
+  for (long i = 0; i < bursts; ++i) {
+    for (long j = 0; j < burst; ++j) {
+      message_queue_push(queue, &element);
+    }
+    for (long j = 0; j < burst; ++j) {
+      popped += (message_queue_pop(queue) != NULL);
+    }
+  }
+  double total_ns = timespan_elapsed_ns(start, timepoint_now());
+  return (popped == burst * bursts) ? total_ns / (double)popped : -1;
+}
+
+/**
+ * @brief Small message, the size of a timestamp and a few counters.
+ */
+typedef struct payload {
+  struct timespec timestamp;
+  unsigned long long counters[2];
+} payload_t;
+
+/**
+ * @return Nanoseconds per push and pop pair of heap allocated payloads,
+ * negative if elements got lost.
+ */
+static double bench_boxed(
+  message_queue_t queue[static 1],
+  long burst,
+  long bursts
+) {
+  long popped = 0;
+  timepoint_t start = timepoint_now();
+  for (long i = 0; i < bursts; ++i) {
+    for (long j = 0; j < burst; ++j) {
+      payload_t* payload = malloc(sizeof(payload_t));
+      if (payload == NULL) {
+        return -1;
+      }
+      *payload = (payload_t){.counters = {(unsigned long long)j, 0}};
+      message_queue_push(queue, payload);
+    }
+    for (long j = 0; j < burst; ++j) {
+      payload_t* payload = message_queue_pop(queue);
+      popped += (payload != NULL);
+      free(payload);
+    }
+  }
+  double total_ns = timespan_elapsed_ns(start, timepoint_now());
+  return (popped == burst * bursts) ? total_ns / (double)popped : -1;
+}
+
+/**
+ * @return Nanoseconds per push and pop pair of payloads copied by value,
+ * negative if elements got lost.
+ */
+static double bench_by_value(
+  message_value_queue_t queue[static 1],
+  long burst,
+  long bursts
+) {
+  long popped = 0;
+  timepoint_t start = timepoint_now();
+  for (long i = 0; i < bursts; ++i) {
+    for (long j = 0; j < burst; ++j) {
+      payload_t payload = {.counters = {(unsigned long long)j, 0}};
+      message_value_queue_push(queue, &payload);
+    }
+    for (long j = 0; j < burst; ++j) {
+      payload_t payload;
+      popped += (message_value_queue_pop(queue, &payload) == 0);
+    }
+  }
+  double total_ns = timespan_elapsed_ns(start, timepoint_now());
+  return (popped == burst * bursts) ? total_ns / (double)popped : -1;
+}
+
+int main(int argc, char* argv[]) {
+  long burst = (argc > 1) ? strtol(argv[1], NULL, 10) : 64;
+  long bursts = (argc > 2) ? strtol(argv[2], NULL, 10) : 100000;
+  if (burst <= 0 || bursts <= 0) {
+    fputs("Burst size and count have to be positive.\n", stderr);
+    return EXIT_FAILURE;
+  }
+
+  queue_t plain;
+  queue_init(&plain, NULL);
+  queue_t pooled;
+  message_queue_t plain_message;
+  message_queue_t pooled_message;
+  message_value_queue_t value_message;
+  if (
+    queue_init_pooled(&pooled, NULL, (size_t)burst) ||
+    message_queue_init(&plain_message, NULL) ||
+    message_queue_init_pooled(&pooled_message, NULL, (size_t)burst) ||
+    message_value_queue_init(&value_message, sizeof(payload_t), 0)
+  ) {
+    fputs("Failed to create the queues.\n", stderr);
+    return EXIT_FAILURE;
+  }
+
+  double results[6] = {
+    bench_queue(&plain, burst, bursts),
+    bench_queue(&pooled, burst, bursts),
+    bench_message_queue(&plain_message, burst, bursts),
+    bench_message_queue(&pooled_message, burst, bursts),
+    bench_boxed(&pooled_message, burst, bursts),
+    bench_by_value(&value_message, burst, bursts)
+  };
+  queue_destroy(&plain);
+  queue_destroy(&pooled);
+  message_queue_destroy(&plain_message);
+  message_queue_destroy(&pooled_message);
+  message_value_queue_destroy(&value_message);
+
+  printf("bursts of %ld, %ld bursts, ns per push and pop\n", burst, bursts);
+  printf("queue:                %10.1f\n", results[0]);
+  printf("queue, pooled:        %10.1f\n", results[1]);
+  printf("message_queue:        %10.1f\n", results[2]);
+  printf("message_queue pooled: %10.1f\n", results[3]);
+  printf("%zu byte payloads:\n", sizeof(payload_t));
+  printf("boxed, pooled queue:  %10.1f\n", results[4]);
+  printf("by value:             %10.1f\n", results[5]);
+  for (size_t i = 0; i < 6; ++i) {
+    if (results[i] < 0) {
+      fputs("Elements got lost.\n", stderr);
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
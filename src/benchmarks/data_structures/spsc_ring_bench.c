@@ -0,0 +1,169 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#include "data_structures/channel.h"
+#include "data_structures/message_queue.h"
+#include "data_structures/spsc_ring.h"
+#include "utilities/time.h"
+
+/**
+ * @file Compares the mutex queue against the lock-free ring on a single
+ * producer and single consumer, both through channels as the pipeline uses
+ * them.
+ * 
+ * Throughput streams pointers from one thread to the other, latency bounces
+ * a single pointer between two threads over a pair of channels and reports
+ * half of the round trip.
+ * 
+ * Usage: spsc_ring_bench [message count] [round trips]
+ */
+
+typedef struct bench_pair {
+  channel_t* forth;
+  channel_t* back;
+  long count;
+} bench_pair_t;
+
+static timepoint_t deadline(void) {
+  return timepoint_after(timepoint_now(), timespan_s_ns(5, 0));
+}
+
+static void push_retry(channel_t channel[static 1], void* message) {
+  //only the ring declines, when the consumer is behind
+  while (channel_push(channel, message)) {
+    thrd_yield();
+  }
+}
+
+static int stream_producer(void* argument) {
+  bench_pair_t* pair = argument;
+  for (uintptr_t i = 1; i <= (uintptr_t)pair->count; ++i) {
+    push_retry(pair->forth, (void*)i);
+  }
+  return 0;
+}
+
+static int echo(void* argument) {
+  bench_pair_t* pair = argument;
+  for (long i = 0; i < pair->count; ++i) {
+    void* message = channel_pop_wait_t(pair->forth, deadline());
+    if (message == NULL) {
+      return -1;
+    }
+    push_retry(pair->back, message);
+  }
+  return 0;
+}
+
+/**
+ * @return Nanoseconds per message, negative if messages got lost.
+ */
+static double bench_throughput(channel_t channel[static 1], long count) {
+  bench_pair_t pair = {.forth = channel, .count = count};
+  timepoint_t start = timepoint_now();
+  thrd_t thread;
+  if (thrd_create(&thread, stream_producer, &pair) != thrd_success) {
+    return -1;
+  }
+  long received = 0;
+  for (long i = 0; i < count; ++i) {
+    received += (channel_pop_wait_t(channel, deadline()) != NULL);
+  }
+  double total_ns = timespan_elapsed_ns(start, timepoint_now());
+  thrd_join(thread, NULL);
+  return (received == count) ? total_ns / (double)count : -1;
+}
+
+/**
+ * @return Nanoseconds of a single hop, negative if messages got lost.
+ */
+static double bench_latency(
+  channel_t forth[static 1],
+  channel_t back[static 1],
+  long count
+) {
+  bench_pair_t pair = {.forth = forth, .back = back, .count = count};
+  thrd_t thread;
+  if (thrd_create(&thread, echo, &pair) != thrd_success) {
+    return -1;
+  }
+  long received = 0;
+  timepoint_t start = timepoint_now();
+  for (long i = 0; i < count; ++i) {
+    push_retry(forth, &pair);
+    received += (channel_pop_wait_t(back, deadline()) != NULL);
+  }
+  double total_ns = timespan_elapsed_ns(start, timepoint_now());
+  thrd_join(thread, NULL);
+  return (received == count) ? total_ns / (double)count / 2 : -1;
+}
+
+int main(int argc, char* argv[]) {
+  long message_count = (argc > 1) ? strtol(argv[1], NULL, 10) : 2000000;
+  long round_trips = (argc > 2) ? strtol(argv[2], NULL, 10) : 20000;
+  if (message_count <= 0 || round_trips <= 0) {
+    fputs("Message and round trip counts have to be positive.\n", stderr);
+    return EXIT_FAILURE;
+  }
+
+  message_queue_t queues[2];
+  spsc_ring_t rings[2];
+  for (size_t i = 0; i < 2; ++i) {
+    if (
+      message_queue_init(&(queues[i]), NULL) ||
+      spsc_ring_init(&(rings[i]), 1024, NULL)
+    ) {
+      fputs("Failed to create the queues.\n", stderr);
+      return EXIT_FAILURE;
+    }
+  }
+  channel_t queue_channels[2] = {
+    channel_from_queue(&(queues[0])),
+    channel_from_queue(&(queues[1]))
+  };
+  channel_t ring_channels[2] = {
+    channel_from_ring(&(rings[0])),
+    channel_from_ring(&(rings[1]))
+  };
+
+  double queue_throughput =
+    bench_throughput(&(queue_channels[0]), message_count);
+  double ring_throughput = bench_throughput(&(ring_channels[0]), message_count);
+  double queue_latency =
+    bench_latency(&(queue_channels[0]), &(queue_channels[1]), round_trips);
+  double ring_latency =
+    bench_latency(&(ring_channels[0]), &(ring_channels[1]), round_trips);
+
+  for (size_t i = 0; i < 2; ++i) {
+    message_queue_destroy(&(queues[i]));
+    spsc_ring_destroy(&(rings[i]));
+  }
+
+  printf(
+    "%ld messages, %ld round trips, %zu slots per ring\n",
+    message_count,
+    round_trips,
+    (size_t)1024
+  );
+  printf("                  throughput(ns/msg)   latency(ns/hop)\n");
+  printf(
+    "message_queue:    %18.1f %17.1f\n",
+    queue_throughput,
+    queue_latency
+  );
+  printf(
+    "spsc_ring:        %18.1f %17.1f\n",
+    ring_throughput,
+    ring_latency
+  );
+  if (
+    queue_throughput < 0 || ring_throughput < 0 ||
+    queue_latency < 0 || ring_latency < 0
+  ) {
+    fputs("Messages got lost.\n", stderr);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
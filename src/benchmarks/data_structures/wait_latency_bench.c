@@ -0,0 +1,164 @@
+//for clock_gettime and CLOCK_MONOTONIC
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#include "data_structures/message_queue.h"
+#include "utilities/time.h"
+
+/**
+ * @file Measures how long it takes a waiting consumer of message_queue to get
+ * a message, from the push to the return of the pop, for each wait strategy.
+ * 
+ * The producer pauses between pushes so the consumer is already waiting,
+ * spinning or parked, when each message comes, every message carries the
+ * monotonic time of its push.
+ * 
+ * Usage: wait_latency_bench [message count] [pause in microseconds]
+ */
+
+typedef struct stamped {
+  struct timespec pushed;
+} stamped_t;
+
+typedef struct bench_run {
+  message_queue_t* queue;
+  stamped_t* messages;
+  long count;
+  long pause_us;
+} bench_run_t;
+
+static int compare_double(const void* left, const void* right) {
+  double l = *(const double*)left;
+  double r = *(const double*)right;
+  return (l > r) - (l < r);
+}
+
+static int producer(void* argument) {
+  bench_run_t* run = argument;
+  struct timespec pause = {
+    .tv_sec = run->pause_us / 1000000,
+    .tv_nsec = (run->pause_us % 1000000) * 1000
+  };
+  for (long i = 0; i < run->count; ++i) {
+    thrd_sleep(&pause, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &(run->messages[i].pushed));
+    if (message_queue_push(run->queue, &(run->messages[i]))) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Runs the producer against a waiting consumer and prints the
+ * percentiles of the wake-up latency.
+ * 
+ * @return 0 on success, -1 if messages got lost.
+ */
+static int bench_strategy(
+  const char* name,
+  message_queue_t queue[static 1],
+  long count,
+  long pause_us
+) {
+  stamped_t* messages = malloc(sizeof(stamped_t) * (size_t)count);
+  double* latencies = malloc(sizeof(double) * (size_t)count);
+  if (messages == NULL || latencies == NULL) {
+    free(messages);
+    free(latencies);
+    return -1;
+  }
+  bench_run_t run = {
+    .queue = queue,
+    .messages = messages,
+    .count = count,
+    .pause_us = pause_us
+  };
+  thrd_t thread;
+  if (thrd_create(&thread, producer, &run) != thrd_success) {
+    free(messages);
+    free(latencies);
+    return -1;
+  }
+  long received = 0;
+  for (long i = 0; i < count; ++i) {
+    timepoint_t deadline =
+      timepoint_after(timepoint_now(), timespan_s_ns(5, 0));
+    stamped_t* message = message_queue_pop_wait_t(queue, deadline);
+    struct timespec popped;
+    clock_gettime(CLOCK_MONOTONIC, &popped);
+    if (message == NULL) {
+      break;
+    }
+    latencies[received] = timespan_elapsed_ns(message->pushed, popped);
+    ++received;
+  }
+  thrd_join(thread, NULL);
+  if (received != count) {
+    free(messages);
+    free(latencies);
+    return -1;
+  }
+  qsort(latencies, (size_t)count, sizeof(double), compare_double);
+  printf(
+    "%-22s %12.1f %12.1f %12.1f\n",
+    name,
+    latencies[count / 2],
+    latencies[count * 9 / 10],
+    latencies[count * 99 / 100]
+  );
+  free(messages);
+  free(latencies);
+  return 0;
+}
+
+int main(int argc, char* argv[]) {
+  long message_count = (argc > 1) ? strtol(argv[1], NULL, 10) : 2000;
+  long pause_us = (argc > 2) ? strtol(argv[2], NULL, 10) : 200;
+  if (message_count <= 0 || pause_us < 0) {
+    fputs(
+      "Message count has to be positive and pause non-negative.\n",
+      stderr
+    );
+    return EXIT_FAILURE;
+  }
+
+  message_queue_t condition;
+  message_queue_t parked;
+  message_queue_t spinning;
+  if (
+    message_queue_init(&condition, NULL) ||
+    message_queue_init(&parked, NULL) ||
+    message_queue_init(&spinning, NULL) ||
+    message_queue_use_eventfd(&parked, 0) ||
+    message_queue_use_eventfd(&spinning, 100000)
+  ) {
+    fputs("Failed to create the queues.\n", stderr);
+    return EXIT_FAILURE;
+  }
+
+  printf(
+    "%ld messages, %ld us apart, push to pop latency in ns\n",
+    message_count,
+    pause_us
+  );
+  printf("                          median          p90          p99\n");
+  int bench_flag =
+    bench_strategy("condition variable:", &condition, message_count, pause_us);
+  bench_flag |=
+    bench_strategy("eventfd:", &parked, message_count, pause_us);
+  bench_flag |=
+    bench_strategy("spin, then eventfd:", &spinning, message_count, pause_us);
+
+  message_queue_destroy(&condition);
+  message_queue_destroy(&parked);
+  message_queue_destroy(&spinning);
+  if (bench_flag) {
+    fputs("Messages got lost.\n", stderr);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
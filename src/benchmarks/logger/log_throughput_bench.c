@@ -0,0 +1,243 @@
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#include "logger/log_args.h"
+#include "logger/logger.h"
+#include "utilities/time.h"
+
+/**
+ * @file Measures how many records per second get from producer threads
+ * through their rings to a sink, with 1, 4 and 16 producers and a single
+ * logger thread draining them.
+ * 
+ * The count sink only counts the records, so its numbers show the cost of
+ * logging itself rather than of the output. The text and binary sinks write
+ * to /dev/null, showing the cost of formatting the text against that of
+ * encoding the raw arguments. Calls per second is the rate at which the
+ * producers got through their log calls, delivered per second the rate of
+ * records reaching the sink. Records finding the ring of their thread full
+ * are dropped, as they would be in the pipeline.
+ * 
+ * Last, the logger thread's cost per record of each sink is measured apart
+ * from the rings, formatting the arguments to text for the text sink.
+ * 
+ * Usage: log_throughput_bench [records per producer]
+ */
+
+/**
+ * @brief Sinks the records are delivered to.
+ */
+typedef enum bench_sink {
+  bench_count_sink,
+  bench_text_sink,
+  bench_binary_sink
+} bench_sink_t;
+
+static const char* bench_sink_names[] = {
+  [bench_count_sink] = "count",
+  [bench_text_sink] = "text",
+  [bench_binary_sink] = "binary"
+};
+
+static size_t printed_count;
+
+static atomic_bool producing;
+
+static int counting_printer(
+  char* buffer,
+  size_t size,
+  log_record_t record[static 1]
+) {
+  (void)record;
+  //nothing gets written, only counted
+  if (size != 0) {
+    buffer[0] = '\0';
+  }
+  printed_count += 1;
+  return 0;
+}
+
+/**
+ * @brief Captures the arguments the way log_printf does.
+ * 
+ * @return Size of the captured arguments.
+ */
+static size_t capture_arguments(
+  unsigned char* buffer,
+  const char* format,
+  ...
+) {
+  va_list arguments;
+  va_start(arguments, format);
+  size_t size = log_args_capture(format, &arguments, buffer);
+  va_end(arguments);
+  return size;
+}
+
+static int producer(void* argument) {
+  long count = *(long*)argument;
+  for (long i = 0; i < count; ++i) {
+    log_printf(log_trace, "<Bench> Record %ld of the producer.", i);
+  }
+  return 0;
+}
+
+static int consumer(void* argument) {
+  (void)argument;
+  while (atomic_load(&producing)) {
+    log_process_some_dur(timespan_s_ns(0, NS_PER_MS));
+  }
+  log_process_all();
+  return 0;
+}
+
+static double elapsed_s(timepoint_t start, timepoint_t end) {
+  timespan_t span = timespan_dur(start, end);
+  return (double)span.tv_sec + (double)span.tv_nsec / NS_PER_SEC;
+}
+
+/**
+ * @brief Runs the producers against the logger thread and prints the rates of
+ * the calls and of the delivered records.
+ * 
+ * @return 0 on success, -1 if the threads couldn't be started.
+ */
+static int bench_producers(
+  size_t producer_count,
+  long count,
+  bench_sink_t sink
+) {
+  if (log_init()) {
+    return -1;
+  }
+  FILE* null_stream = NULL;
+  if (sink == bench_count_sink) {
+    log_add_sink_f(stdout, false, counting_printer, NULL);
+  } else {
+    null_stream = fopen("/dev/null", "w");
+    if (null_stream == NULL) {
+      log_destroy();
+      return -1;
+    }
+    if (sink == bench_text_sink) {
+      log_add_sink_f(null_stream, true, NULL, NULL);
+    } else {
+      log_add_sink_binary(null_stream, true, NULL);
+    }
+  }
+  printed_count = 0;
+  atomic_store(&producing, true);
+  thrd_t threads[16];
+  thrd_t logger;
+  if (thrd_create(&logger, consumer, NULL) != thrd_success) {
+    log_destroy();
+    return -1;
+  }
+  timepoint_t start = timepoint_now();
+  size_t started = 0;
+  for (; started < producer_count; ++started) {
+    if (thrd_create(&(threads[started]), producer, &count) != thrd_success) {
+      break;
+    }
+  }
+  for (size_t i = 0; i < started; ++i) {
+    thrd_join(threads[i], NULL);
+  }
+  timepoint_t produced = timepoint_now();
+  atomic_store(&producing, false);
+  thrd_join(logger, NULL);
+  timepoint_t end = timepoint_now();
+  if (sink != bench_count_sink) {
+    printed_count = (size_t)count * started - log_dropped();
+  }
+  printf(
+    "%-6s %9zu %12.0f %12.0f %12zu %12zu\n",
+    bench_sink_names[sink],
+    producer_count,
+    (double)count * (double)producer_count / elapsed_s(start, produced),
+    (double)printed_count / elapsed_s(start, end),
+    printed_count,
+    log_dropped()
+  );
+  log_destroy();
+  return (started == producer_count) ? 0 : -1;
+}
+
+/**
+ * @brief Prints a record to the sink the number of times and prints the cost
+ * of a single one.
+ * 
+ * @return 0 on success, -1 if the sink couldn't be created.
+ */
+static int bench_sink_cost(bench_sink_t sink_kind, long count) {
+  FILE* null_stream = fopen("/dev/null", "w");
+  if (null_stream == NULL) {
+    return -1;
+  }
+  output_sink_t* sink = (sink_kind == bench_text_sink) ?
+    output_sink_new(null_stream, true, NULL, NULL) :
+    output_sink_new_binary(null_stream, true, NULL);
+  if (sink == NULL) {
+    fclose(null_stream);
+    return -1;
+  }
+  const char* format = "<Bench> Record %ld of %s took %zu ns.";
+  unsigned char arguments[64];
+  char text[128];
+  log_record_t record = {
+    .thread_id = thrd_current(),
+    .severity = log_trace,
+    .format = format,
+    .arguments = arguments
+  };
+  timepoint_t start = timepoint_now();
+  for (long i = 0; i < count; ++i) {
+    record.arguments_size =
+      capture_arguments(arguments, format, i, "the bench", (size_t)i * 3);
+    record.timestamp = timepoint_now();
+    if (sink_kind == bench_text_sink) {
+      log_args_format(text, sizeof(text), format, arguments);
+      record.message = text;
+    }
+    output_sink_print(sink, &record);
+  }
+  timepoint_t end = timepoint_now();
+  printf(
+    "%-6s %9.1f ns/record\n",
+    bench_sink_names[sink_kind],
+    elapsed_s(start, end) * NS_PER_SEC / (double)count
+  );
+  output_sink_free(sink);
+  return 0;
+}
+
+int main(int argc, char* argv[]) {
+  long count = (argc > 1) ? strtol(argv[1], NULL, 10) : 100000;
+  if (count <= 0) {
+    fputs("Record count has to be positive.\n", stderr);
+    return EXIT_FAILURE;
+  }
+  printf("%ld records per producer\n", count);
+  printf(
+    "sink   producers      calls/s  delivered/s    delivered      dropped\n"
+  );
+  const size_t producer_counts[] = {1, 4, 16};
+  for (int sink = bench_count_sink; sink <= bench_binary_sink; ++sink) {
+    for (size_t i = 0; i < 3; ++i) {
+      if (bench_producers(producer_counts[i], count, (bench_sink_t)sink)) {
+        fputs("Failed to start the threads.\n", stderr);
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  for (int sink = bench_text_sink; sink <= bench_binary_sink; ++sink) {
+    if (bench_sink_cost((bench_sink_t)sink, count * 10)) {
+      fputs("Failed to open /dev/null.\n", stderr);
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
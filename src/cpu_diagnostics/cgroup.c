@@ -0,0 +1,546 @@
+//for getdents64
+#define _GNU_SOURCE
+
+#include "cgroup.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Buffer sizes, cpu.stat is a handful of short lines and a single
+ * inotify event takes at most NAME_MAX bytes past its header.
+ */
+enum {
+  CGROUP_STAT_BUFFER_SIZE = 1024,
+  CGROUP_DIRENT_BUFFER_SIZE = 32768,
+  CGROUP_EVENT_BUFFER_SIZE = 4096
+};
+
+/**
+ * @brief Events of a watched directory that change the hierarchy.
+ */
+#define CGROUP_WATCH_MASK \
+  (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR)
+
+/**
+ * @brief Lines of cpu.stat, with the counter each one fills.
+ */
+static const struct {
+  const char* label;
+  size_t label_size;
+  size_t offset;
+} cgroup_stat_lines[] = {
+  {"usage_usec ", 11, offsetof(cgroup_counters_t, usage_usec)},
+  {"user_usec ", 10, offsetof(cgroup_counters_t, user_usec)},
+  {"system_usec ", 12, offsetof(cgroup_counters_t, system_usec)},
+  {"nr_throttled ", 13, offsetof(cgroup_counters_t, nr_throttled)},
+  {"throttled_usec ", 15, offsetof(cgroup_counters_t, throttled_usec)}
+};
+
+void cgroup_stat_parse(
+  const char* begin,
+  const char* end,
+  cgroup_counters_t counters[static 1]
+) {
+  *counters = (cgroup_counters_t){0};
+  size_t line_count = sizeof(cgroup_stat_lines) / sizeof(cgroup_stat_lines[0]);
+  const char* cursor = begin;
+  while (cursor != end) {
+    for (size_t i = 0; i < line_count; ++i) {
+      size_t label_size = cgroup_stat_lines[i].label_size;
+      if (
+        (size_t)(end - cursor) > label_size &&
+        memcmp(cursor, cgroup_stat_lines[i].label, label_size) == 0
+      ) {
+        cursor += label_size;
+        uint64_t value = 0;
+        while (cursor != end && *cursor >= '0' && *cursor <= '9') {
+          value = value * 10 + (uint64_t)(*cursor - '0');
+          ++cursor;
+        }
+        unsigned char* base = (unsigned char*)counters;
+        memcpy(base + cgroup_stat_lines[i].offset, &value, sizeof(value));
+        break;
+      }
+    }
+    //nr_periods and the burst counters are skipped
+    const char* line_end = memchr(cursor, '\n', (size_t)(end - cursor));
+    cursor = (line_end == NULL) ? end : line_end + 1;
+  }
+}
+
+int cgroup_collector_open(
+  cgroup_collector_t collector[static 1],
+  const char root[static 1]
+) {
+  collector->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (collector->inotify_fd == -1) {
+    return -1;
+  }
+  collector->root = strdup(root);
+  collector->dirent_buffer = malloc(CGROUP_DIRENT_BUFFER_SIZE);
+  if (collector->root == NULL || collector->dirent_buffer == NULL) {
+    free(collector->root);
+    free(collector->dirent_buffer);
+    close(collector->inotify_fd);
+    return -1;
+  }
+  collector->changed = true;
+  collector->walk_count = 0;
+  collector->nodes = NULL;
+  collector->count = 0;
+  collector->scratch = NULL;
+  collector->scratch_size = 0;
+  collector->timestamp = (struct timespec){0};
+  return 0;
+}
+
+/**
+ * @brief Closes the node's descriptors and frees its path.
+ */
+static void cgroup_node_release(cgroup_node_t node[static 1]) {
+  if (node->stat_fd != -1) {
+    close(node->stat_fd);
+  }
+  if (node->dir_fd != -1) {
+    close(node->dir_fd);
+  }
+  free(node->path);
+  *node = (cgroup_node_t){.dir_fd = -1, .stat_fd = -1};
+}
+
+void cgroup_collector_close(cgroup_collector_t collector[static 1]) {
+  for (size_t i = 0; i < collector->count; ++i) {
+    cgroup_node_release(&(collector->nodes[i]));
+  }
+  free(collector->nodes);
+  free(collector->scratch);
+  free(collector->dirent_buffer);
+  free(collector->root);
+  close(collector->inotify_fd);
+  collector->nodes = NULL;
+  collector->count = 0;
+  collector->inotify_fd = -1;
+}
+
+/**
+ * @brief Orders the nodes by path, so a walk can find the previous ones.
+ */
+static int cgroup_node_compare(const void* lhs, const void* rhs) {
+  const cgroup_node_t* left = lhs;
+  const cgroup_node_t* right = rhs;
+  return strcmp(left->path, right->path);
+}
+
+/**
+ * @brief Nodes found by the walk in progress, in the order of a breadth first
+ * traversal.
+ */
+typedef struct cgroup_walk {
+  cgroup_node_t* nodes;
+  size_t count;
+  size_t capacity;
+  cgroup_node_t* old_nodes;     /**<Sorted, taken ones lose their descriptors*/
+  size_t old_count;
+} cgroup_walk_t;
+
+/**
+ * @brief Records the directory, carrying over the descriptors and counters of
+ * the previous walk if it's still the same cgroup.
+ * 
+ * @param parent_fd Directory containing the cgroup, or AT_FDCWD for the root
+ * @param name Name of the cgroup in its parent
+ * @param path Owned path relative to the root, freed if the node isn't added
+ * @return 0 on success, also when the directory disappeared in the meantime,
+ * -1 on allocation failure.
+ */
+static int cgroup_walk_add(
+  cgroup_collector_t collector[static 1],
+  cgroup_walk_t walk[static 1],
+  int parent_fd,
+  const char name[static 1],
+  char* path
+) {
+  struct stat status;
+  if (
+    fstatat(parent_fd, name, &status, AT_SYMLINK_NOFOLLOW) == -1 ||
+    !S_ISDIR(status.st_mode)
+  ) {
+    free(path);
+    return 0;
+  }
+  if (walk->count == walk->capacity) {
+    size_t capacity = (walk->capacity == 0) ? 64 : walk->capacity * 2;
+    cgroup_node_t* nodes =
+      realloc(walk->nodes, sizeof(cgroup_node_t) * capacity);
+    if (nodes == NULL) {
+      free(path);
+      return -1;
+    }
+    walk->nodes = nodes;
+    walk->capacity = capacity;
+  }
+
+  cgroup_node_t key = {.path = path};
+  //the first walk has no array to search
+  cgroup_node_t* old = (walk->old_count == 0) ? NULL : bsearch(
+    &key,
+    walk->old_nodes,
+    walk->old_count,
+    sizeof(cgroup_node_t),
+    cgroup_node_compare
+  );
+  cgroup_node_t* node = &(walk->nodes[walk->count]);
+  //same path with a different inode is a cgroup recreated since the last walk
+  if (old != NULL && old->dir_fd != -1 && old->inode == status.st_ino) {
+    *node = *old;
+    node->path = path;
+    old->dir_fd = -1;
+    old->stat_fd = -1;
+    walk->count += 1;
+    return 0;
+  }
+  int dir_fd = openat(parent_fd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (dir_fd == -1) {
+    //removed after being listed, or out of descriptors
+    free(path);
+    return 0;
+  }
+  *node = (cgroup_node_t){
+    .path = path,
+    .dir_fd = dir_fd,
+    .stat_fd = openat(dir_fd, "cpu.stat", O_RDONLY | O_CLOEXEC),
+    .inode = status.st_ino,
+    .fresh = true
+  };
+  walk->count += 1;
+
+  //watched before being listed, so no child created in between goes unnoticed
+  char full_path[PATH_MAX];
+  int full_size =
+    snprintf(full_path, sizeof(full_path), "%s/%s", collector->root, path);
+  if (full_size > 0 && (size_t)full_size < sizeof(full_path)) {
+    //without a watch the cgroup is still read, only its children are missed
+    inotify_add_watch(collector->inotify_fd, full_path, CGROUP_WATCH_MASK);
+  }
+  return 0;
+}
+
+/**
+ * @brief Lists the directory of a walked node, adding its subdirectories.
+ */
+static int cgroup_walk_list(
+  cgroup_collector_t collector[static 1],
+  cgroup_walk_t walk[static 1],
+  size_t index
+) {
+  int dir_fd = walk->nodes[index].dir_fd;
+  if (lseek(dir_fd, 0, SEEK_SET) == -1) {
+    return 0;
+  }
+  char* buffer = collector->dirent_buffer;
+  while (true) {
+    //a directory removed in the meantime simply lists as empty
+    ssize_t read_size = getdents64(dir_fd, buffer, CGROUP_DIRENT_BUFFER_SIZE);
+    if (read_size <= 0) {
+      return 0;
+    }
+    for (ssize_t offset = 0; offset < read_size;) {
+      struct dirent64* dirent = (struct dirent64*)(void*)(buffer + offset);
+      offset += dirent->d_reclen;
+      const char* name = dirent->d_name;
+      if (
+        (dirent->d_type != DT_DIR && dirent->d_type != DT_UNKNOWN) ||
+        strcmp(name, ".") == 0 ||
+        strcmp(name, "..") == 0
+      ) {
+        continue;
+      }
+      //nodes may move while adding, the parent is looked up every time
+      const char* parent = walk->nodes[index].path;
+      size_t parent_size = strlen(parent);
+      size_t name_size = strlen(name);
+      char* path = malloc(parent_size + name_size + 2);
+      if (path == NULL) {
+        return -1;
+      }
+      if (parent_size == 0) {
+        memcpy(path, name, name_size + 1);
+      } else {
+        memcpy(path, parent, parent_size);
+        path[parent_size] = '/';
+        memcpy(path + parent_size + 1, name, name_size + 1);
+      }
+      if (cgroup_walk_add(collector, walk, dir_fd, name, path)) {
+        return -1;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Walks the whole hierarchy breadth first, replacing the nodes.
+ * 
+ * Nodes of cgroups that are still there keep their descriptors and counters.
+ * A failed walk still leaves the nodes it managed to find.
+ */
+static int cgroup_collector_walk(cgroup_collector_t collector[static 1]) {
+  cgroup_walk_t walk = {
+    .old_nodes = collector->nodes,
+    .old_count = collector->count
+  };
+  int walk_flag = -1;
+  char* root_path = malloc(1);
+  if (root_path != NULL) {
+    root_path[0] = '\0';
+    walk_flag =
+      cgroup_walk_add(collector, &walk, AT_FDCWD, collector->root, root_path);
+  }
+  if (walk_flag == 0 && walk.count == 0) {
+    walk_flag = EOF;
+  }
+  for (size_t i = 0; walk_flag == 0 && i < walk.count; ++i) {
+    walk_flag = cgroup_walk_list(collector, &walk, i);
+  }
+
+  for (size_t i = 0; i < walk.old_count; ++i) {
+    cgroup_node_release(&(walk.old_nodes[i]));
+  }
+  free(walk.old_nodes);
+  qsort(walk.nodes, walk.count, sizeof(cgroup_node_t), cgroup_node_compare);
+  collector->nodes = walk.nodes;
+  collector->count = walk.count;
+  collector->walk_count += 1;
+  return walk_flag;
+}
+
+/**
+ * @brief Drains the inotify queue, marking the hierarchy as changed if any
+ * directory came or went.
+ */
+static void cgroup_collector_poll(cgroup_collector_t collector[static 1]) {
+  _Alignas(struct inotify_event) char buffer[CGROUP_EVENT_BUFFER_SIZE];
+  while (true) {
+    ssize_t read_size = read(collector->inotify_fd, buffer, sizeof(buffer));
+    if (read_size <= 0) {
+      return;
+    }
+    for (ssize_t offset = 0; offset < read_size;) {
+      const struct inotify_event* event =
+        (const struct inotify_event*)(void*)(buffer + offset);
+      offset += (ssize_t)(sizeof(struct inotify_event) + event->len);
+      //an overflowed queue may have lost some of the directory events
+      if (event->mask & (IN_ISDIR | IN_Q_OVERFLOW)) {
+        collector->changed = true;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Makes sure the scratch buffer can hold a delta of every cgroup.
+ */
+static int cgroup_collector_reserve(cgroup_collector_t collector[static 1]) {
+  if (collector->scratch_size >= collector->count) {
+    return 0;
+  }
+  size_t scratch_size = collector->count * 2;
+  cgroup_delta_t* scratch =
+    realloc(collector->scratch, sizeof(cgroup_delta_t) * scratch_size);
+  if (scratch == NULL) {
+    return -1;
+  }
+  collector->scratch = scratch;
+  collector->scratch_size = scratch_size;
+  return 0;
+}
+
+/**
+ * @brief Takes the differences of the counters.
+ * 
+ * @return Whether the counters are comparable and any of them moved, counters
+ * going backwards can only come from a cgroup that was recreated.
+ */
+static bool cgroup_counters_delta(
+  const cgroup_counters_t old[static 1],
+  const cgroup_counters_t curr[static 1],
+  cgroup_counters_t delta[static 1]
+) {
+  if (
+    curr->usage_usec < old->usage_usec ||
+    curr->user_usec < old->user_usec ||
+    curr->system_usec < old->system_usec ||
+    curr->nr_throttled < old->nr_throttled ||
+    curr->throttled_usec < old->throttled_usec
+  ) {
+    return false;
+  }
+  *delta = (cgroup_counters_t){
+    .usage_usec = curr->usage_usec - old->usage_usec,
+    .user_usec = curr->user_usec - old->user_usec,
+    .system_usec = curr->system_usec - old->system_usec,
+    .nr_throttled = curr->nr_throttled - old->nr_throttled,
+    .throttled_usec = curr->throttled_usec - old->throttled_usec
+  };
+  return (
+    delta->usage_usec != 0 ||
+    delta->user_usec != 0 ||
+    delta->system_usec != 0 ||
+    delta->nr_throttled != 0 ||
+    delta->throttled_usec != 0
+  );
+}
+
+int cgroup_collector_sample(
+  cgroup_collector_t collector[static 1],
+  cgroup_sample_t sample[static 1]
+) {
+  cgroup_collector_poll(collector);
+  if (collector->changed) {
+    collector->changed = false;
+    int walk_flag = cgroup_collector_walk(collector);
+    if (walk_flag) {
+      collector->changed = true;
+      return walk_flag;
+    }
+  }
+  if (cgroup_collector_reserve(collector)) {
+    return -1;
+  }
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  double elapsed = 0;
+  if (collector->timestamp.tv_sec != 0 || collector->timestamp.tv_nsec != 0) {
+    elapsed =
+      (double)(now.tv_sec - collector->timestamp.tv_sec) +
+      (double)(now.tv_nsec - collector->timestamp.tv_nsec) / 1e9;
+  }
+  collector->timestamp = now;
+
+  size_t count = 0;
+  size_t path_size = 0;
+  for (size_t i = 0; i < collector->count; ++i) {
+    cgroup_node_t* node = &(collector->nodes[i]);
+    if (node->stat_fd == -1) {
+      continue;
+    }
+    char text[CGROUP_STAT_BUFFER_SIZE];
+    ssize_t read_size = pread(node->stat_fd, text, sizeof(text), 0);
+    if (read_size <= 0) {
+      continue;
+    }
+    cgroup_counters_t reading;
+    cgroup_stat_parse(text, text + read_size, &reading);
+    cgroup_delta_t* delta = &(collector->scratch[count]);
+    if (
+      !node->fresh &&
+      cgroup_counters_delta(&(node->counters), &reading, &(delta->counters))
+    ) {
+      delta->path = node->path;
+      path_size += strlen(node->path) + 1;
+      count += 1;
+    }
+    node->fresh = false;
+    node->counters = reading;
+  }
+
+  //entries follow the header and paths follow the entries
+  cgroup_sample_t new_sample = malloc(
+    sizeof(cgroup_sample_block_t) + sizeof(cgroup_delta_t) * count + path_size
+  );
+  if (new_sample == NULL) {
+    return -1;
+  }
+  new_sample->kind = diagnostics_cgroup_sample;
+  new_sample->count = count;
+  new_sample->cgroup_count = collector->count;
+  new_sample->elapsed = elapsed;
+  new_sample->entries = (cgroup_delta_t*)(void*)(new_sample + 1);
+  char* paths = (char*)(new_sample->entries + count);
+  for (size_t i = 0; i < count; ++i) {
+    size_t size = strlen(collector->scratch[i].path) + 1;
+    memcpy(paths, collector->scratch[i].path, size);
+    new_sample->entries[i] = collector->scratch[i];
+    new_sample->entries[i].path = paths;
+    paths += size;
+  }
+  *sample = new_sample;
+  return 0;
+}
+
+void cgroup_sample_free(cgroup_sample_t sample) {
+  free(sample);
+}
+
+/**
+ * @brief Orders the deltas from the highest total usage.
+ */
+static int cgroup_delta_compare(const void* lhs, const void* rhs) {
+  const cgroup_delta_t* left = lhs;
+  const cgroup_delta_t* right = rhs;
+  uint64_t left_usage = left->counters.usage_usec;
+  uint64_t right_usage = right->counters.usage_usec;
+  return (left_usage < right_usage) - (left_usage > right_usage);
+}
+
+cgroup_report_t cgroup_report_create(cgroup_sample_t sample, size_t top_count) {
+  size_t count = (sample->count < top_count) ? sample->count : top_count;
+  qsort(
+    sample->entries,
+    sample->count,
+    sizeof(cgroup_delta_t),
+    cgroup_delta_compare
+  );
+  size_t throttled_count = 0;
+  for (size_t i = 0; i < sample->count; ++i) {
+    throttled_count += (sample->entries[i].counters.nr_throttled != 0);
+  }
+  size_t path_size = 0;
+  for (size_t i = 0; i < count; ++i) {
+    path_size += strlen(sample->entries[i].path) + 1;
+  }
+
+  cgroup_report_t report = malloc(
+    sizeof(cgroup_report_block_t) + sizeof(cgroup_usage_t) * count + path_size
+  );
+  if (report == NULL) {
+    return NULL;
+  }
+  report->kind = diagnostics_cgroup_report;
+  report->count = count;
+  report->cgroup_count = sample->cgroup_count;
+  report->active_count = sample->count;
+  report->throttled_count = throttled_count;
+  report->entries = (cgroup_usage_t*)(void*)(report + 1);
+
+  double scale = (sample->elapsed > 0) ? 100.0 / (sample->elapsed * 1e6) : 0;
+  char* paths = (char*)(report->entries + count);
+  for (size_t i = 0; i < count; ++i) {
+    const cgroup_delta_t* delta = &(sample->entries[i]);
+    size_t size = strlen(delta->path) + 1;
+    memcpy(paths, delta->path, size);
+    report->entries[i] = (cgroup_usage_t){
+      .path = paths,
+      .usage = (double)delta->counters.usage_usec * scale,
+      .user = (double)delta->counters.user_usec * scale,
+      .system = (double)delta->counters.system_usec * scale,
+      .nr_throttled = delta->counters.nr_throttled,
+      .throttled = (double)delta->counters.throttled_usec * scale
+    };
+    paths += size;
+  }
+  return report;
+}
+
+void cgroup_report_free(cgroup_report_t report) {
+  free(report);
+}
@@ -0,0 +1,192 @@
+#ifndef SKAI_CPU_DIAGNOSTICS_CGROUP_H
+#define SKAI_CPU_DIAGNOSTICS_CGROUP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <time.h>
+
+#include "message.h"
+
+/**
+ * @file Per-cgroup cpu accounting over the cpu.stat files of a cgroup v2
+ * hierarchy.
+ * 
+ * Directories and cpu.stat files stay open between scans and the hierarchy is
+ * watched with inotify, so it's walked again only when cgroups get created or
+ * removed, otherwise a scan is a pread of every cpu.stat file.
+ */
+
+/**
+ * @brief Counters of a single cpu.stat file, the ones missing from it are
+ * left at 0.
+ */
+typedef struct cgroup_counters {
+  uint64_t usage_usec;      /**<Total cpu time*/
+  uint64_t user_usec;       /**<Cpu time in user mode*/
+  uint64_t system_usec;     /**<Cpu time in kernel mode*/
+  uint64_t nr_throttled;    /**<Periods in which the cgroup was throttled*/
+  uint64_t throttled_usec;  /**<Time spent throttled*/
+} cgroup_counters_t;
+
+/**
+ * @brief State of a single cgroup kept between scans.
+ * 
+ * Accessing struct fields directly is not recommended.
+ */
+typedef struct cgroup_node {
+  char* path;                   /**<Owned, relative to the root, empty for
+                                    the root itself*/
+  int dir_fd;                   /**<Descriptor of the cgroup directory*/
+  int stat_fd;                  /**<Descriptor of its cpu.stat, -1 if it has
+                                    none*/
+  ino_t inode;                  /**<Tells a recreated cgroup from the old
+                                    one with the same path*/
+  bool fresh;                   /**<No reading to compare against yet*/
+  cgroup_counters_t counters;   /**<Last reading*/
+} cgroup_node_t;
+
+/**
+ * @brief Usage of a single cgroup between two scans.
+ */
+typedef struct cgroup_delta {
+  const char* path;             /**<Points into the message*/
+  cgroup_counters_t counters;   /**<Differences of the counters*/
+} cgroup_delta_t;
+
+/**
+ * @brief Message with the cgroups whose counters changed between two scans,
+ * header, entries and paths in a single allocation.
+ */
+typedef struct cgroup_sample_block {
+  diagnostics_message_kind_t kind;  /**<Always diagnostics_cgroup_sample*/
+  size_t count;                 /**<Number of entries*/
+  size_t cgroup_count;          /**<Number of cgroups in the hierarchy*/
+  double elapsed;               /**<Seconds between the two scans*/
+  cgroup_delta_t* entries;      /**<Only the cgroups that changed*/
+} cgroup_sample_block_t;
+
+/**
+ * @brief Handle to the cgroups' usage, should be handled with associated
+ * functions.
+ */
+typedef cgroup_sample_block_t* cgroup_sample_t;
+
+/**
+ * @brief Usage of a single cgroup as percentage of one core.
+ */
+typedef struct cgroup_usage {
+  const char* path;             /**<Points into the message*/
+  double usage;                 /**<Total percentage*/
+  double user;                  /**<Percentage spent in user mode*/
+  double system;                /**<Percentage spent in kernel mode*/
+  uint64_t nr_throttled;        /**<Periods throttled during the interval*/
+  double throttled;             /**<Percentage of the interval throttled*/
+} cgroup_usage_t;
+
+/**
+ * @brief Message with the cgroups using the most cpu, sorted from the top
+ * one, header, entries and paths in a single allocation.
+ */
+typedef struct cgroup_report_block {
+  diagnostics_message_kind_t kind;  /**<Always diagnostics_cgroup_report*/
+  size_t count;                 /**<Number of entries*/
+  size_t cgroup_count;          /**<Number of cgroups in the hierarchy*/
+  size_t active_count;          /**<Number of cgroups that changed*/
+  size_t throttled_count;       /**<Number of cgroups throttled during the
+                                    interval, listed or not*/
+  cgroup_usage_t* entries;      /**<Sorted by total usage, descending*/
+} cgroup_report_block_t;
+
+/**
+ * @brief Handle to the report, should be handled with associated functions.
+ */
+typedef cgroup_report_block_t* cgroup_report_t;
+
+/**
+ * @brief Collector of per-cgroup usage under a cgroup v2 mount point.
+ * 
+ * Accessing struct fields directly is not recommended.
+ */
+typedef struct cgroup_collector {
+  char* root;                   /**<Owned copy of the root path*/
+  int inotify_fd;               /**<Watches every directory of the tree*/
+  bool changed;                 /**<Hierarchy has to be walked again*/
+  unsigned long long walk_count;  /**<Number of walks done so far*/
+  cgroup_node_t* nodes;         /**<Owned, sorted by path*/
+  size_t count;                 /**<Number of nodes*/
+  cgroup_delta_t* scratch;      /**<Owned buffer deltas are gathered in*/
+  size_t scratch_size;          /**<Capacity of the scratch buffer*/
+  char* dirent_buffer;          /**<Owned buffer for getdents64*/
+  struct timespec timestamp;    /**<CLOCK_MONOTONIC time of the last scan*/
+} cgroup_collector_t;
+
+/**
+ * @brief Parses the contents of a cpu.stat file.
+ * 
+ * @param begin First character of the text
+ * @param end One past the last character of the text
+ * @param counters Set to the parsed counters
+ */
+void cgroup_stat_parse(
+  const char* begin,
+  const char* end,
+  cgroup_counters_t counters[static 1]
+);
+
+/**
+ * @brief Opens the hierarchy for collecting.
+ * 
+ * The hierarchy is walked on the first scan.
+ * 
+ * @param collector Collector to initialize
+ * @param root Path to the cgroup v2 mount point or a directory laid out the
+ * same way
+ * @return 0 on success, non-0 value if either opening inotify or an
+ * allocation failed, in which case nothing has to be cleaned up.
+ */
+int cgroup_collector_open(
+  cgroup_collector_t collector[static 1],
+  const char root[static 1]
+);
+
+/**
+ * @brief Closes all the descriptors and frees everything owned by the
+ * collector.
+ * 
+ * @param collector 
+ */
+void cgroup_collector_close(cgroup_collector_t collector[static 1]);
+
+/**
+ * @brief Rereads every cpu.stat file and returns the changes since the
+ * previous scan, walking the hierarchy first if it changed.
+ * 
+ * Cgroups found by a walk are only recorded, so they show up starting with
+ * the next scan.
+ * 
+ * @param collector 
+ * @param sample Set to the new sample on success, owned by the caller
+ * @return 0 on success, EOF if the root couldn't be walked, -1 on allocation
+ * failure.
+ */
+int cgroup_collector_sample(
+  cgroup_collector_t collector[static 1],
+  cgroup_sample_t sample[static 1]
+);
+
+void cgroup_sample_free(cgroup_sample_t sample);
+
+/**
+ * @brief Turns the sample into percentages and keeps the top users.
+ * 
+ * @param sample Its entries get sorted in the process
+ * @param top_count Maximum number of entries in the report
+ * @return New report, NULL on allocation failure.
+ */
+cgroup_report_t cgroup_report_create(cgroup_sample_t sample, size_t top_count);
+
+void cgroup_report_free(cgroup_report_t report);
+
+#endif
@@ -0,0 +1,140 @@
+#include "kernels.h"
+
+#include <stdbool.h>
+#include <threads.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+static size_t portable_delta(
+  const stat_cpu_field_t* old,
+  const stat_cpu_field_t* curr,
+  stat_cpu_field_t* result,
+  size_t field_count
+) {
+  size_t reset_count = 0;
+  for (size_t i = 0; i < field_count; ++i) {
+    result[i] = stat_cpu_field_delta(old[i], curr[i], &reset_count);
+  }
+  return reset_count;
+}
+
+static void portable_percentage(
+  stat_cpu_percentage_t* percentages,
+  const stat_cpu_field_t* delta,
+  size_t row_count,
+  size_t stride
+) {
+  for (size_t i = 0; i < row_count; ++i) {
+    percentages[i] = stat_cpu_row_percentage_8(delta);
+    delta += stride;
+  }
+}
+
+static size_t portable_fused(
+  stat_cpu_percentage_t* percentages,
+  const stat_cpu_field_t* old,
+  const stat_cpu_field_t* curr,
+  size_t row_count,
+  size_t stride
+) {
+  size_t reset_count = 0;
+  for (size_t i = 0; i < row_count; ++i) {
+    //only the fields used by the percentage, kept in registers
+    stat_cpu_field_t delta[8];
+    for (size_t j = 0; j < 8; ++j) {
+      delta[j] = stat_cpu_field_delta(old[j], curr[j], &reset_count);
+    }
+    percentages[i] = stat_cpu_row_percentage_8(delta);
+    old += stride;
+    curr += stride;
+  }
+  return reset_count;
+}
+
+static const stat_kernels_t portable_kernels = {
+  .name = "portable",
+  .delta = portable_delta,
+  .percentage = portable_percentage,
+  .fused = portable_fused
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+/**
+ * @brief Checks whether the operating system saves the SSE and AVX register
+ * state on context switches, which AVX2 instructions require on top of the
+ * processor support.
+ */
+static bool os_saves_ymm_state(void) {
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_OSXSAVE)) {
+    return false;
+  }
+  unsigned int xcr0_low, xcr0_high;
+  __asm__ ("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+  (void)xcr0_high;
+  //bit 1 is the SSE state, bit 2 the upper halves of YMM registers
+  return (xcr0_low & 0x6) == 0x6;
+}
+
+static bool cpu_supports(enum stat_kernel_isa isa) {
+  unsigned int eax, ebx, ecx, edx;
+  switch (isa) {
+    case stat_kernel_portable:
+      return true;
+    case stat_kernel_sse2:
+      return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (edx & bit_SSE2);
+    case stat_kernel_avx2:
+      return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) &&
+             (ebx & bit_AVX2) &&
+             os_saves_ymm_state();
+    case stat_kernel_isa_count:
+      break;
+  }
+  return false;
+}
+#else
+static bool cpu_supports(enum stat_kernel_isa isa) {
+  return isa == stat_kernel_portable;
+}
+#endif
+
+const stat_kernels_t* stat_kernels_get(enum stat_kernel_isa isa) {
+  const stat_kernels_t* kernels = NULL;
+  switch (isa) {
+    case stat_kernel_portable:
+      kernels = &portable_kernels;
+      break;
+    case stat_kernel_sse2:
+      kernels = stat_kernels_sse2();
+      break;
+    case stat_kernel_avx2:
+      kernels = stat_kernels_avx2();
+      break;
+    case stat_kernel_isa_count:
+      break;
+  }
+  if (kernels == NULL || !cpu_supports(isa)) {
+    return NULL;
+  }
+  return kernels;
+}
+
+static const stat_kernels_t* active_kernels = &portable_kernels;
+static once_flag active_kernels_flag = ONCE_FLAG_INIT;
+
+static void select_active_kernels(void) {
+  for (int isa = stat_kernel_isa_count - 1; isa >= 0; --isa) {
+    const stat_kernels_t* kernels = stat_kernels_get((enum stat_kernel_isa)isa);
+    if (kernels != NULL) {
+      active_kernels = kernels;
+      return;
+    }
+  }
+}
+
+const stat_kernels_t* stat_kernels_active(void) {
+  call_once(&active_kernels_flag, select_active_kernels);
+  return active_kernels;
+}
@@ -0,0 +1,123 @@
+#ifndef SKAI_CPU_DIAGNOSTICS_KERNELS_H
+#define SKAI_CPU_DIAGNOSTICS_KERNELS_H
+
+#include <stddef.h>
+
+#include "linux.h"
+
+/**
+ * @file Whole-array kernels behind stat_cpu_array_delta_l,
+ * stat_cpu_percentage_array_calculate_l and
+ * stat_cpu_percentage_array_calculate_delta_l, in a portable version and
+ * vectorized versions for x86, with the best one supported by the processor
+ * picked once at startup.
+ * 
+ * All versions give results identical to stat_cpu_field_delta and
+ * stat_cpu_row_percentage_8 applied field by field and row by row.
+ */
+
+/**
+ * @brief Signature of the delta kernel.
+ * 
+ * @param old Fields that will be subtracted
+ * @param curr Fields to subtract from
+ * @param result Fields to which the difference will be saved
+ * @param field_count Number of fields in each of the buffers
+ * @return Number of fields that were found reset
+ */
+typedef size_t (*stat_delta_kernel)(
+  const stat_cpu_field_t* old,
+  const stat_cpu_field_t* curr,
+  stat_cpu_field_t* result,
+  size_t field_count
+);
+
+/**
+ * @brief Signature of the percentage kernel.
+ * 
+ * @param percentages One value per row will be saved here
+ * @param delta Rows of deltas, each with at least 8 fields
+ * @param row_count Number of rows
+ * @param stride Distance in fields between starts of consecutive rows
+ */
+typedef void (*stat_percentage_kernel)(
+  stat_cpu_percentage_t* percentages,
+  const stat_cpu_field_t* delta,
+  size_t row_count,
+  size_t stride
+);
+
+/**
+ * @brief Signature of the fused kernel, calculating percentages straight from
+ * two samples without storing the delta.
+ * 
+ * @param percentages One value per row will be saved here
+ * @param old Rows of the earlier sample, each with at least 8 fields
+ * @param curr Rows of the later sample, same dimensions as old
+ * @param row_count Number of rows
+ * @param stride Distance in fields between starts of consecutive rows
+ * @return Number of fields among the first 8 of each row found reset
+ */
+typedef size_t (*stat_fused_kernel)(
+  stat_cpu_percentage_t* percentages,
+  const stat_cpu_field_t* old,
+  const stat_cpu_field_t* curr,
+  size_t row_count,
+  size_t stride
+);
+
+/**
+ * @brief Set of kernels written for one instruction set.
+ */
+typedef struct stat_kernels {
+  const char* name;                     /**<Human readable name*/
+  stat_delta_kernel delta;              /**<Whole-array delta*/
+  stat_percentage_kernel percentage;    /**<Row-wise usage percentage*/
+  stat_fused_kernel fused;              /**<Delta and percentage in one pass*/
+} stat_kernels_t;
+
+/**
+ * @brief Instruction sets kernels are provided for, in order of preference
+ * from the least to the most preferred.
+ */
+enum stat_kernel_isa {
+  stat_kernel_portable,
+  stat_kernel_sse2,
+  stat_kernel_avx2,
+  stat_kernel_isa_count
+};
+
+/**
+ * @brief Returns kernels for the instruction set, if they can run here.
+ * 
+ * @param isa
+ * @return Pointer to static kernels, NULL if they weren't compiled in or the
+ * processor doesn't support them.
+ */
+const stat_kernels_t* stat_kernels_get(enum stat_kernel_isa isa);
+
+/**
+ * @brief Returns the most preferred kernels supported by the processor.
+ * 
+ * Selection is done with cpuid on the first call, which is thread safe, later
+ * calls only return the stored pointer.
+ * 
+ * @return Pointer to static kernels, never NULL.
+ */
+const stat_kernels_t* stat_kernels_active(void);
+
+/**
+ * @brief SSE2 kernels, defined in kernels_sse2.c.
+ * 
+ * @return Pointer to static kernels, NULL if they weren't compiled in.
+ */
+const stat_kernels_t* stat_kernels_sse2(void);
+
+/**
+ * @brief AVX2 kernels, defined in kernels_avx2.c.
+ * 
+ * @return Pointer to static kernels, NULL if they weren't compiled in.
+ */
+const stat_kernels_t* stat_kernels_avx2(void);
+
+#endif
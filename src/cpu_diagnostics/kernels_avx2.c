@@ -0,0 +1,248 @@
+#include "kernels.h"
+
+#ifdef __AVX2__
+
+#include <immintrin.h>
+#include <stdbool.h>
+
+/**
+ * @file AVX2 kernels, four fields per instruction.
+ * 
+ * Compiled with AVX2 enabled for this file only, the dispatcher makes sure
+ * they're never called on processors without it.
+ */
+
+/**
+ * @brief Vector version of stat_cpu_field_delta.
+ */
+static __m256i avx2_delta_vec(
+  __m256i old_vec,
+  __m256i curr_vec,
+  __m256i resets[static 1]
+) {
+  __m256i difference = _mm256_sub_epi64(curr_vec, old_vec);
+  //all ones in lanes where the difference has its top bit set, i.e. resets
+  __m256i reset_mask = _mm256_cmpgt_epi64(_mm256_setzero_si256(), difference);
+  //mask lanes are -1 where reset happened
+  *resets = _mm256_sub_epi64(*resets, reset_mask);
+  return _mm256_andnot_si256(reset_mask, difference);
+}
+
+static size_t avx2_sum_lanes(__m256i values) {
+  stat_cpu_field_t lanes[4];
+  _mm256_storeu_si256((__m256i*)(void*)lanes, values);
+  return (size_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+}
+
+static __m256i avx2_load(const stat_cpu_field_t* fields) {
+  return _mm256_loadu_si256((const __m256i*)(const void*)fields);
+}
+
+static size_t avx2_delta(
+  const stat_cpu_field_t* old,
+  const stat_cpu_field_t* curr,
+  stat_cpu_field_t* result,
+  size_t field_count
+) {
+  __m256i resets = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 4 <= field_count; i += 4) {
+    __m256i delta = avx2_delta_vec(
+      avx2_load(old + i),
+      avx2_load(curr + i),
+      &resets
+    );
+    _mm256_storeu_si256((__m256i*)(void*)(result + i), delta);
+  }
+  size_t reset_count = avx2_sum_lanes(resets);
+  for (; i < field_count; ++i) {
+    result[i] = stat_cpu_field_delta(old[i], curr[i], &reset_count);
+  }
+  return reset_count;
+}
+
+/**
+ * @brief Partial sums of the first 8 fields of a row given as two halves,
+ * four lanes each, left for the caller to reduce together with three other
+ * rows.
+ */
+static void avx2_row_sums(
+  __m256i fields_0123,
+  __m256i fields_4567,
+  __m256i total[static 1],
+  __m256i work[static 1]
+) {
+  //idle is the last field of the first half, iowait the first of the second
+  const __m256i keep_first = _mm256_set_epi64x(0, -1, -1, -1);
+  const __m256i keep_second = _mm256_set_epi64x(-1, -1, -1, 0);
+  *total = _mm256_add_epi64(fields_0123, fields_4567);
+  *work = _mm256_add_epi64(
+    _mm256_and_si256(fields_0123, keep_first),
+    _mm256_and_si256(fields_4567, keep_second)
+  );
+}
+
+/**
+ * @brief Reduces partial sums of four rows into one lane per row.
+ */
+static __m256i avx2_reduce_4(__m256i a, __m256i b, __m256i c, __m256i d) {
+  __m256i ab = _mm256_add_epi64(
+    _mm256_unpacklo_epi64(a, b),
+    _mm256_unpackhi_epi64(a, b)
+  );
+  __m256i cd = _mm256_add_epi64(
+    _mm256_unpacklo_epi64(c, d),
+    _mm256_unpackhi_epi64(c, d)
+  );
+  return _mm256_add_epi64(
+    _mm256_permute2x128_si256(ab, cd, 0x20),
+    _mm256_permute2x128_si256(ab, cd, 0x31)
+  );
+}
+
+/**
+ * @brief Converts unsigned 64-bit lanes smaller than 2^52 to doubles exactly.
+ * 
+ * The value is placed in the mantissa of 2^52, which is subtracted afterwards.
+ */
+static __m256d avx2_small_to_double(__m256i values) {
+  const __m256i magic_bits = _mm256_set1_epi64x(0x4330000000000000LL);
+  const __m256d magic = _mm256_set1_pd(4503599627370496.0);
+  return _mm256_sub_pd(
+    _mm256_castsi256_pd(_mm256_or_si256(values, magic_bits)),
+    magic
+  );
+}
+
+static bool avx2_all_small(__m256i values) {
+  return _mm256_testz_si256(
+    values,
+    _mm256_set1_epi64x((long long)0xFFF0000000000000ULL)
+  );
+}
+
+/**
+ * @brief Percentages of four rows from their partial sums, falls back to the
+ * scalar version when the sums are too large for exact conversion.
+ */
+static void avx2_percentage_4(
+  stat_cpu_percentage_t percentages[static 4],
+  const __m256i total[static 4],
+  const __m256i work[static 4],
+  const stat_cpu_field_t* delta[static 4]
+) {
+  __m256i totals = avx2_reduce_4(total[0], total[1], total[2], total[3]);
+  __m256i works = avx2_reduce_4(work[0], work[1], work[2], work[3]);
+  //real counters never move that much, exact conversion needs scalar
+  if (!avx2_all_small(_mm256_or_si256(totals, works))) {
+    for (size_t j = 0; j < 4; ++j) {
+      percentages[j] = stat_cpu_row_percentage_8(delta[j]);
+    }
+    return;
+  }
+  __m256d total_d = avx2_small_to_double(totals);
+  __m256d work_d = avx2_small_to_double(works);
+  __m256d result = _mm256_div_pd(
+    _mm256_mul_pd(work_d, _mm256_set1_pd(100.00)),
+    total_d
+  );
+  //idle rows give 0/0, scalar version returns 0 for them
+  result = _mm256_andnot_pd(
+    _mm256_cmp_pd(total_d, _mm256_setzero_pd(), _CMP_EQ_OQ),
+    result
+  );
+  _mm256_storeu_pd(percentages, result);
+}
+
+static void avx2_percentage(
+  stat_cpu_percentage_t* percentages,
+  const stat_cpu_field_t* delta,
+  size_t row_count,
+  size_t stride
+) {
+  size_t i = 0;
+  for (; i + 4 <= row_count; i += 4) {
+    __m256i total[4], work[4];
+    const stat_cpu_field_t* rows[4];
+    for (size_t j = 0; j < 4; ++j) {
+      rows[j] = delta + (i + j) * stride;
+      avx2_row_sums(
+        avx2_load(rows[j]),
+        avx2_load(rows[j] + 4),
+        &(total[j]),
+        &(work[j])
+      );
+    }
+    avx2_percentage_4(percentages + i, total, work, rows);
+  }
+  for (; i < row_count; ++i) {
+    percentages[i] = stat_cpu_row_percentage_8(delta + i * stride);
+  }
+}
+
+static size_t avx2_fused(
+  stat_cpu_percentage_t* percentages,
+  const stat_cpu_field_t* old,
+  const stat_cpu_field_t* curr,
+  size_t row_count,
+  size_t stride
+) {
+  __m256i resets = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 4 <= row_count; i += 4) {
+    __m256i total[4], work[4];
+    //kept only for the rare scalar fallback
+    _Alignas(32) stat_cpu_field_t deltas[4][8];
+    const stat_cpu_field_t* rows[4];
+    for (size_t j = 0; j < 4; ++j) {
+      size_t offset = (i + j) * stride;
+      __m256i first = avx2_delta_vec(
+        avx2_load(old + offset),
+        avx2_load(curr + offset),
+        &resets
+      );
+      __m256i second = avx2_delta_vec(
+        avx2_load(old + offset + 4),
+        avx2_load(curr + offset + 4),
+        &resets
+      );
+      _mm256_store_si256((__m256i*)(void*)deltas[j], first);
+      _mm256_store_si256((__m256i*)(void*)(deltas[j] + 4), second);
+      rows[j] = deltas[j];
+      avx2_row_sums(first, second, &(total[j]), &(work[j]));
+    }
+    avx2_percentage_4(percentages + i, total, work, rows);
+  }
+  size_t reset_count = avx2_sum_lanes(resets);
+  for (; i < row_count; ++i) {
+    stat_cpu_field_t delta[8];
+    for (size_t j = 0; j < 8; ++j) {
+      delta[j] = stat_cpu_field_delta(
+        old[i * stride + j],
+        curr[i * stride + j],
+        &reset_count
+      );
+    }
+    percentages[i] = stat_cpu_row_percentage_8(delta);
+  }
+  return reset_count;
+}
+
+static const stat_kernels_t avx2_kernels = {
+  .name = "avx2",
+  .delta = avx2_delta,
+  .percentage = avx2_percentage,
+  .fused = avx2_fused
+};
+
+const stat_kernels_t* stat_kernels_avx2(void) {
+  return &avx2_kernels;
+}
+
+#else
+
+const stat_kernels_t* stat_kernels_avx2(void) {
+  return NULL;
+}
+
+#endif
@@ -0,0 +1,230 @@
+#include "kernels.h"
+
+#ifdef __SSE2__
+
+#include <emmintrin.h>
+#include <stdbool.h>
+
+/**
+ * @file SSE2 kernels, two fields per instruction.
+ * 
+ * There are no 64-bit compares in SSE2, so sign masks of 64-bit lanes are
+ * taken from arithmetic shifts of their upper halves.
+ */
+
+/**
+ * @brief Vector version of stat_cpu_field_delta.
+ */
+static __m128i sse2_delta_vec(
+  __m128i old_vec,
+  __m128i curr_vec,
+  __m128i resets[static 1]
+) {
+  __m128i difference = _mm_sub_epi64(curr_vec, old_vec);
+  //all ones in lanes where the difference has its top bit set, i.e. resets
+  __m128i reset_mask = _mm_shuffle_epi32(
+    _mm_srai_epi32(difference, 31),
+    _MM_SHUFFLE(3, 3, 1, 1)
+  );
+  //mask lanes are -1 where reset happened
+  *resets = _mm_sub_epi64(*resets, reset_mask);
+  return _mm_andnot_si128(reset_mask, difference);
+}
+
+static size_t sse2_sum_lanes(__m128i values) {
+  stat_cpu_field_t lanes[2];
+  _mm_storeu_si128((__m128i*)(void*)lanes, values);
+  return (size_t)(lanes[0] + lanes[1]);
+}
+
+static __m128i sse2_load(const stat_cpu_field_t* fields) {
+  return _mm_loadu_si128((const __m128i*)(const void*)fields);
+}
+
+static size_t sse2_delta(
+  const stat_cpu_field_t* old,
+  const stat_cpu_field_t* curr,
+  stat_cpu_field_t* result,
+  size_t field_count
+) {
+  __m128i resets = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 2 <= field_count; i += 2) {
+    __m128i delta = sse2_delta_vec(
+      sse2_load(old + i),
+      sse2_load(curr + i),
+      &resets
+    );
+    _mm_storeu_si128((__m128i*)(void*)(result + i), delta);
+  }
+  size_t reset_count = sse2_sum_lanes(resets);
+  for (; i < field_count; ++i) {
+    result[i] = stat_cpu_field_delta(old[i], curr[i], &reset_count);
+  }
+  return reset_count;
+}
+
+/**
+ * @brief Sums of the first 8 fields of a row given as four pairs, both halved
+ * into two partial lanes and left for the caller to combine with a second row.
+ */
+static void sse2_row_sums(
+  const __m128i fields[static 4],
+  __m128i total[static 1],
+  __m128i work[static 1]
+) {
+  //idle is the second field of the 2-3 pair, iowait the first of the 4-5 one
+  const __m128i keep_low = _mm_set_epi32(0, 0, -1, -1);
+  const __m128i keep_high = _mm_set_epi32(-1, -1, 0, 0);
+  *total = _mm_add_epi64(
+    _mm_add_epi64(fields[0], fields[1]),
+    _mm_add_epi64(fields[2], fields[3])
+  );
+  *work = _mm_add_epi64(
+    _mm_add_epi64(fields[0], _mm_and_si128(fields[1], keep_low)),
+    _mm_add_epi64(_mm_and_si128(fields[2], keep_high), fields[3])
+  );
+}
+
+/**
+ * @brief Converts unsigned 64-bit lanes smaller than 2^52 to doubles exactly.
+ * 
+ * The value is placed in the mantissa of 2^52, which is subtracted afterwards.
+ */
+static __m128d sse2_small_to_double(__m128i values) {
+  const __m128i magic_bits = _mm_set1_epi64x(0x4330000000000000LL);
+  const __m128d magic = _mm_set1_pd(4503599627370496.0);
+  return _mm_sub_pd(
+    _mm_castsi128_pd(_mm_or_si128(values, magic_bits)),
+    magic
+  );
+}
+
+static bool sse2_all_small(__m128i values) {
+  __m128i high_bits = _mm_srli_epi64(values, 52);
+  __m128i zero_halves = _mm_cmpeq_epi32(high_bits, _mm_setzero_si128());
+  return _mm_movemask_epi8(zero_halves) == 0xFFFF;
+}
+
+/**
+ * @brief Percentages of two rows from their partial sums, falls back to the
+ * scalar version when the sums are too large for exact conversion.
+ */
+static void sse2_percentage_2(
+  stat_cpu_percentage_t percentages[static 2],
+  const __m128i total[static 2],
+  const __m128i work[static 2],
+  const stat_cpu_field_t* delta[static 2]
+) {
+  __m128i totals = _mm_add_epi64(
+    _mm_unpacklo_epi64(total[0], total[1]),
+    _mm_unpackhi_epi64(total[0], total[1])
+  );
+  __m128i works = _mm_add_epi64(
+    _mm_unpacklo_epi64(work[0], work[1]),
+    _mm_unpackhi_epi64(work[0], work[1])
+  );
+  //real counters never move that much, exact conversion needs scalar
+  if (!sse2_all_small(_mm_or_si128(totals, works))) {
+    percentages[0] = stat_cpu_row_percentage_8(delta[0]);
+    percentages[1] = stat_cpu_row_percentage_8(delta[1]);
+    return;
+  }
+  __m128d total_d = sse2_small_to_double(totals);
+  __m128d work_d = sse2_small_to_double(works);
+  __m128d result = _mm_div_pd(
+    _mm_mul_pd(work_d, _mm_set1_pd(100.00)),
+    total_d
+  );
+  //idle rows give 0/0, scalar version returns 0 for them
+  result = _mm_andnot_pd(_mm_cmpeq_pd(total_d, _mm_setzero_pd()), result);
+  _mm_storeu_pd(percentages, result);
+}
+
+static void sse2_percentage(
+  stat_cpu_percentage_t* percentages,
+  const stat_cpu_field_t* delta,
+  size_t row_count,
+  size_t stride
+) {
+  size_t i = 0;
+  for (; i + 2 <= row_count; i += 2) {
+    __m128i total[2], work[2];
+    const stat_cpu_field_t* rows[2];
+    for (size_t j = 0; j < 2; ++j) {
+      rows[j] = delta + (i + j) * stride;
+      __m128i fields[4];
+      for (size_t k = 0; k < 4; ++k) {
+        fields[k] = sse2_load(rows[j] + k * 2);
+      }
+      sse2_row_sums(fields, &(total[j]), &(work[j]));
+    }
+    sse2_percentage_2(percentages + i, total, work, rows);
+  }
+  for (; i < row_count; ++i) {
+    percentages[i] = stat_cpu_row_percentage_8(delta + i * stride);
+  }
+}
+
+static size_t sse2_fused(
+  stat_cpu_percentage_t* percentages,
+  const stat_cpu_field_t* old,
+  const stat_cpu_field_t* curr,
+  size_t row_count,
+  size_t stride
+) {
+  __m128i resets = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 2 <= row_count; i += 2) {
+    __m128i total[2], work[2];
+    //kept only for the rare scalar fallback
+    _Alignas(16) stat_cpu_field_t deltas[2][8];
+    const stat_cpu_field_t* rows[2] = {deltas[0], deltas[1]};
+    for (size_t j = 0; j < 2; ++j) {
+      size_t offset = (i + j) * stride;
+      __m128i fields[4];
+      for (size_t k = 0; k < 4; ++k) {
+        fields[k] = sse2_delta_vec(
+          sse2_load(old + offset + k * 2),
+          sse2_load(curr + offset + k * 2),
+          &resets
+        );
+        _mm_store_si128((__m128i*)(void*)(deltas[j] + k * 2), fields[k]);
+      }
+      sse2_row_sums(fields, &(total[j]), &(work[j]));
+    }
+    sse2_percentage_2(percentages + i, total, work, rows);
+  }
+  size_t reset_count = sse2_sum_lanes(resets);
+  for (; i < row_count; ++i) {
+    stat_cpu_field_t delta[8];
+    for (size_t j = 0; j < 8; ++j) {
+      delta[j] = stat_cpu_field_delta(
+        old[i * stride + j],
+        curr[i * stride + j],
+        &reset_count
+      );
+    }
+    percentages[i] = stat_cpu_row_percentage_8(delta);
+  }
+  return reset_count;
+}
+
+static const stat_kernels_t sse2_kernels = {
+  .name = "sse2",
+  .delta = sse2_delta,
+  .percentage = sse2_percentage,
+  .fused = sse2_fused
+};
+
+const stat_kernels_t* stat_kernels_sse2(void) {
+  return &sse2_kernels;
+}
+
+#else
+
+const stat_kernels_t* stat_kernels_sse2(void) {
+  return NULL;
+}
+
+#endif
@@ -1,9 +1,16 @@
+//for pread, sysconf and clock_gettime
+#define _POSIX_C_SOURCE 200809L
+
 #include "linux.h"
+#include "kernels.h"
+#include "stat_pool.h"
 
-/**
- * @brief File scope variable storing layout for use globally by implementation.
- */
-static stat_layout_t global_layout;
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
 
 int stat_layout_set_lf(
   stat_layout_t layout[static 1],
@@ -51,49 +58,92 @@ int stat_layout_set_lf(
   return 0;
 }
 
-int stat_layout_set_f(
-  FILE source[static 1]
-) {
-  return stat_layout_set_lf(&global_layout, source);
+/**
+ * @brief Returns the dimensions an array was created with.
+ */
+static stat_layout_t stat_array_layout(stat_cpu_array_t array) {
+  return (stat_layout_t){
+    .cpu_count = array->cpu_count,
+    .cpu_column_count = array->cpu_column_count
+  };
 }
 
-stat_layout_t stat_layout_get(void) {
-  return global_layout;
+/**
+ * @brief Rounds value up to the nearest multiple of alignment.
+ */
+static size_t stat_align_up(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
 }
 
-
 stat_cpu_array_t stat_cpu_array_create_l(stat_layout_t layout[static 1]) {
-  stat_cpu_array_t new_array = malloc(
-    sizeof(stat_cpu_row_t) * layout->cpu_count
+  size_t stride = stat_align_up(
+    layout->cpu_column_count,
+    STAT_ROW_ALIGNMENT / sizeof(stat_cpu_field_t)
   );
-  for (size_t i = 0; i < layout->cpu_count; ++i) {
-    new_array[i] = malloc(sizeof(stat_cpu_field_t) * layout->cpu_column_count);
+  //header takes the first cache line, fields start right after it
+  size_t header_size = stat_align_up(
+    sizeof(stat_cpu_block_t),
+    STAT_CACHE_LINE_SIZE
+  );
+  size_t fields_size = sizeof(stat_cpu_field_t) * stride * layout->cpu_count;
+  //aligned_alloc requires the size to be a multiple of the alignment
+  unsigned char* storage = aligned_alloc(
+    STAT_CACHE_LINE_SIZE,
+    stat_align_up(header_size + fields_size, STAT_CACHE_LINE_SIZE)
+  );
+  if (storage == NULL) {
+    return NULL;
   }
+  stat_cpu_array_t new_array = (stat_cpu_array_t)(void*)storage;
+  new_array->kind = diagnostics_cpu_sample;
+  new_array->cpu_count = layout->cpu_count;
+  new_array->cpu_column_count = layout->cpu_column_count;
+  new_array->stride = stride;
+  new_array->layout = NULL;
+  new_array->source = NULL;
+  new_array->pool = NULL;
+  new_array->timestamp = (struct timespec){0};
+  new_array->system = (stat_system_t){0};
+  new_array->fields = (stat_cpu_field_t*)(void*)(storage + header_size);
+  //padding has to stay zeroed for kernels walking the whole block
+  memset(new_array->fields, 0, fields_size);
   return new_array;
 }
 
-stat_cpu_array_t stat_cpu_array_create(void) {
-  return stat_cpu_array_create_l(&global_layout);
-}
-
-void stat_cpu_array_free_l(
-  stat_cpu_array_t array,
-  stat_layout_t layout[static 1]
+stat_cpu_array_t stat_cpu_array_create_v(
+  stat_layout_version_t* layout
 ) {
-  for (size_t i = 0; i < layout->cpu_count; ++i) {
-    free(array[i]);
+  stat_cpu_array_t new_array = stat_cpu_array_create_l(&(layout->layout));
+  if (new_array != NULL) {
+    new_array->layout = stat_layout_version_acquire(layout);
   }
-  free(array);
+  return new_array;
 }
 
 void stat_cpu_array_free(stat_cpu_array_t array) {
-  stat_cpu_array_free_l(array, &global_layout);
+  if (array == NULL) {
+    return;
+  }
+  stat_layout_version_release(array->layout);
+  array->layout = NULL;
+  if (array->pool != NULL) {
+    stat_pool_give_back(array->pool, &(array->link));
+    return;
+  }
+  free(array);
 }
 
 void stat_cpu_array_deleter(void *array_ptr) {
   stat_cpu_array_free((stat_cpu_array_t)array_ptr);
 }
 
+stat_cpu_row_t stat_cpu_array_row(
+  stat_cpu_array_t array,
+  size_t index
+) {
+  return array->fields + index * array->stride;
+}
+
 int stat_cpu_array_read_fl(
   stat_cpu_array_t array,
   FILE source[static 1],
@@ -107,10 +157,11 @@ int stat_cpu_array_read_fl(
   int read_total = 0; //for counting how many numbers were successfully read
 
   for (size_t i = 0; i < layout->cpu_count && err_flag == 1; ++i) {
+    stat_cpu_row_t row = stat_cpu_array_row(array, i);
     //even if it's an unnecessary data, failure here means something's wrong
     err_flag = fscanf(source, "%s", dummy);
     for (size_t j = 0; j < layout->cpu_column_count && err_flag == 1; ++j) {
-      err_flag = fscanf(source, "%lf", &(array[i][j]));
+      err_flag = fscanf(source, "%" SCNu64, &(row[j]));
       //necessary because fscanf can also return EOF
       read_total += (err_flag == 1);
     }
@@ -131,51 +182,528 @@ int stat_cpu_array_read_f(
   stat_cpu_array_t array,
   FILE source[static 1]
 ) {
-  return stat_cpu_array_read_fl(array, source, &global_layout);
+  stat_layout_t layout = stat_array_layout(array);
+  return stat_cpu_array_read_fl(array, source, &layout);
+}
+
+/**
+ * @brief Moves the cursor past spaces and parses the following unsigned number.
+ * 
+ * @return 0 on success, EOF if the text ended, 1 if there was no number
+ */
+static int stat_scan_number(
+  const char* cursor[static 1],
+  const char* end,
+  stat_cpu_field_t value[static 1]
+) {
+  const char* iter = *cursor;
+  while (iter != end && *iter == ' ') {
+    ++iter;
+  }
+  if (iter == end) {
+    return EOF;
+  }
+  if (*iter < '0' || *iter > '9') {
+    return 1;
+  }
+  stat_cpu_field_t number = 0;
+  while (iter != end && *iter >= '0' && *iter <= '9') {
+    number = number * 10 + (stat_cpu_field_t)(*iter - '0');
+    ++iter;
+  }
+  *cursor = iter;
+  *value = number;
+  return 0;
+}
+
+/**
+ * @brief Moves the cursor past the end of the current line.
+ */
+static void stat_skip_line(const char* cursor[static 1], const char* end) {
+  const char* iter = *cursor;
+  while (iter != end && *iter != '\n') {
+    ++iter;
+  }
+  *cursor = (iter == end) ? end : iter + 1;
+}
+
+/**
+ * @brief Parses the 'cpu' or 'cpuN' label at the cursor.
+ * 
+ * @param id Set to N, or STAT_CPU_TOTAL_ID for the plain 'cpu' label
+ * @return 0 if there was a cpu label, 1 otherwise, in which case the cursor
+ * is left where it was.
+ */
+static int stat_scan_label(
+  const char* cursor[static 1],
+  const char* end,
+  int id[static 1]
+) {
+  const char* iter = *cursor;
+  if (end - iter < 3 || memcmp(iter, "cpu", 3) != 0) {
+    return 1;
+  }
+  iter += 3;
+  if (iter != end && *iter == ' ') {
+    *id = STAT_CPU_TOTAL_ID;
+    *cursor = iter;
+    return 0;
+  }
+  int number = 0;
+  const char* digits = iter;
+  while (iter != end && *iter >= '0' && *iter <= '9') {
+    number = number * 10 + (*iter - '0');
+    ++iter;
+  }
+  if (iter == digits || iter == end || *iter != ' ') {
+    return 1;
+  }
+  *id = number;
+  *cursor = iter;
+  return 0;
+}
+
+/**
+ * @brief Moves the cursor past spaces and tells whether a number follows.
+ */
+static bool stat_number_follows(const char* cursor[static 1], const char* end) {
+  while (*cursor != end && **cursor == ' ') {
+    ++(*cursor);
+  }
+  return *cursor != end && **cursor >= '0' && **cursor <= '9';
+}
+
+/**
+ * @brief Lines after the cpu section, with the counter each one fills.
+ * 
+ * Lines carrying more than one number contribute only the first one, which is
+ * the total.
+ */
+static const struct {
+  const char* label;
+  size_t label_size;
+  size_t offset;
+} stat_system_lines[] = {
+  {"intr ", 5, offsetof(stat_system_t, interrupts)},
+  {"ctxt ", 5, offsetof(stat_system_t, context_switches)},
+  {"processes ", 10, offsetof(stat_system_t, forks)},
+  {"procs_running ", 14, offsetof(stat_system_t, procs_running)},
+  {"procs_blocked ", 14, offsetof(stat_system_t, procs_blocked)},
+  {"softirq ", 8, offsetof(stat_system_t, softirqs)}
+};
+
+/**
+ * @brief Fills the system counters from the lines following the cpu section.
+ */
+static void stat_parse_system(
+  stat_system_t system[static 1],
+  const char* cursor,
+  const char* end
+) {
+  *system = (stat_system_t){0};
+  size_t line_count = sizeof(stat_system_lines) / sizeof(stat_system_lines[0]);
+  while (cursor != end) {
+    for (size_t i = 0; i < line_count; ++i) {
+      size_t label_size = stat_system_lines[i].label_size;
+      if (
+        (size_t)(end - cursor) > label_size &&
+        memcmp(cursor, stat_system_lines[i].label, label_size) == 0
+      ) {
+        cursor += label_size;
+        stat_cpu_field_t value;
+        if (stat_scan_number(&cursor, end, &value) == 0) {
+          unsigned char* base = (unsigned char*)system;
+          memcpy(base + stat_system_lines[i].offset, &value, sizeof(value));
+        }
+        break;
+      }
+    }
+    //the rest of 'intr' and 'softirq' lines are skipped without parsing
+    const char* line_end = memchr(cursor, '\n', (size_t)(end - cursor));
+    cursor = (line_end == NULL) ? end : line_end + 1;
+  }
+}
+
+/**
+ * @brief Common implementation of sample parsing.
+ * 
+ * Without cpu_ids labels are skipped and surplus columns ignored, with them
+ * every deviation from the layout makes it return STAT_LAYOUT_CHANGED.
+ */
+static int stat_parse_cpu_rows(
+  stat_cpu_array_t array,
+  const char* begin,
+  const char* end,
+  stat_layout_t layout[static 1],
+  const int* cpu_ids
+) {
+  const char* cursor = begin;
+  int read_total = 0;
+  for (size_t i = 0; i < layout->cpu_count; ++i) {
+    stat_cpu_row_t row = stat_cpu_array_row(array, i);
+    if (cpu_ids != NULL) {
+      int id;
+      if (stat_scan_label(&cursor, end, &id) || id != cpu_ids[i]) {
+        return STAT_LAYOUT_CHANGED;
+      }
+    } else {
+      //skip whatever is left of the previous line and the 'cpuN' label
+      while (cursor != end && *cursor == '\n') {
+        ++cursor;
+      }
+      while (cursor != end && *cursor != ' ' && *cursor != '\n') {
+        ++cursor;
+      }
+    }
+    for (size_t j = 0; j < layout->cpu_column_count; ++j) {
+      stat_cpu_field_t value;
+      int scan_flag = stat_scan_number(&cursor, end, &value);
+      if (scan_flag == EOF) {
+        return EOF;
+      }
+      if (scan_flag) {
+        //line ending early means the kernel reports fewer columns now
+        if (cpu_ids != NULL && *cursor == '\n') {
+          return STAT_LAYOUT_CHANGED;
+        }
+        return read_total + 1;
+      }
+      row[j] = value;
+      read_total += 1;
+    }
+    if (cpu_ids != NULL && stat_number_follows(&cursor, end)) {
+      return STAT_LAYOUT_CHANGED;
+    }
+    //columns past the layout are ignored, same as the line terminator
+    stat_skip_line(&cursor, end);
+  }
+  int id;
+  if (cpu_ids != NULL && stat_scan_label(&cursor, end, &id) == 0) {
+    return STAT_LAYOUT_CHANGED;
+  }
+  stat_parse_system(&(array->system), cursor, end);
+  return 0;
+}
+
+int stat_cpu_array_parse_l(
+  stat_cpu_array_t array,
+  const char* begin,
+  const char* end,
+  stat_layout_t layout[static 1]
+) {
+  return stat_parse_cpu_rows(array, begin, end, layout, NULL);
 }
 
-void stat_cpu_array_delta_l(
+stat_layout_version_t* stat_layout_version_scan(
+  const char* begin,
+  const char* end,
+  unsigned long long version
+) {
+  stat_layout_t layout = {
+    .cpu_count = 0,
+    .cpu_column_count = 0
+  };
+  const char* cursor = begin;
+  int id;
+  while (stat_scan_label(&cursor, end, &id) == 0) {
+    if (layout.cpu_count == 0) {
+      stat_cpu_field_t value;
+      while (stat_scan_number(&cursor, end, &value) == 0) {
+        layout.cpu_column_count += 1;
+      }
+    }
+    layout.cpu_count += 1;
+    stat_skip_line(&cursor, end);
+  }
+  if (layout.cpu_count == 0) {
+    return NULL;
+  }
+
+  stat_layout_version_t* snapshot = malloc(
+    sizeof(stat_layout_version_t) + sizeof(int) * layout.cpu_count
+  );
+  if (snapshot == NULL) {
+    return NULL;
+  }
+  atomic_init(&(snapshot->ref_count), 1);
+  snapshot->version = version;
+  snapshot->layout = layout;
+  cursor = begin;
+  for (size_t i = 0; i < layout.cpu_count; ++i) {
+    stat_scan_label(&cursor, end, &(snapshot->cpu_ids[i]));
+    stat_skip_line(&cursor, end);
+  }
+  return snapshot;
+}
+
+stat_layout_version_t* stat_layout_version_acquire(
+  stat_layout_version_t* layout
+) {
+  atomic_fetch_add_explicit(&(layout->ref_count), 1, memory_order_relaxed);
+  return layout;
+}
+
+void stat_layout_version_release(stat_layout_version_t* layout) {
+  if (layout == NULL) {
+    return;
+  }
+  //release-acquire pair makes all the uses happen before the free
+  if (
+    atomic_fetch_sub_explicit(&(layout->ref_count), 1, memory_order_acq_rel)
+    == 1
+  ) {
+    free(layout);
+  }
+}
+
+int stat_sampler_open(
+  stat_sampler_t sampler[static 1],
+  const char path[static 1]
+) {
+  long page_size = sysconf(_SC_PAGESIZE);
+  sampler->buffer_size = (page_size > 0) ? (size_t)page_size : 4096;
+  sampler->data_size = 0;
+  sampler->timestamp = (struct timespec){0};
+  sampler->layout = NULL;
+  sampler->pool = NULL;
+  sampler->buffer = malloc(sampler->buffer_size);
+  if (sampler->buffer == NULL) {
+    return -1;
+  }
+  sampler->fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (sampler->fd < 0) {
+    free(sampler->buffer);
+    sampler->buffer = NULL;
+    return -1;
+  }
+  return 0;
+}
+
+void stat_sampler_close(stat_sampler_t sampler[static 1]) {
+  close(sampler->fd);
+  free(sampler->buffer);
+  stat_layout_version_release(sampler->layout);
+  sampler->layout = NULL;
+  sampler->fd = -1;
+  sampler->buffer = NULL;
+  sampler->buffer_size = 0;
+  sampler->data_size = 0;
+}
+
+int stat_sampler_refresh(stat_sampler_t sampler[static 1]) {
+  while (true) {
+    ssize_t read_size = pread(
+      sampler->fd,
+      sampler->buffer,
+      sampler->buffer_size,
+      0
+    );
+    if (read_size < 0) {
+      return EOF;
+    }
+    //a read filling the whole buffer might have been truncated, the file has
+    //to be read again as a whole, as its contents can change between reads
+    if ((size_t)read_size < sampler->buffer_size) {
+      sampler->data_size = (size_t)read_size;
+      clock_gettime(CLOCK_MONOTONIC, &(sampler->timestamp));
+      return 0;
+    }
+    char* new_buffer = realloc(sampler->buffer, sampler->buffer_size * 2);
+    if (new_buffer == NULL) {
+      return EOF;
+    }
+    sampler->buffer = new_buffer;
+    sampler->buffer_size *= 2;
+  }
+}
+
+int stat_sampler_read_l(
+  stat_sampler_t sampler[static 1],
+  stat_cpu_array_t array,
+  stat_layout_t layout[static 1]
+) {
+  if (stat_sampler_refresh(sampler)) {
+    return EOF;
+  }
+  array->timestamp = sampler->timestamp;
+  return stat_cpu_array_parse_l(
+    array,
+    sampler->buffer,
+    sampler->buffer + sampler->data_size,
+    layout
+  );
+}
+
+int stat_sampler_read(
+  stat_sampler_t sampler[static 1],
+  stat_cpu_array_t array
+) {
+  stat_layout_t layout = stat_array_layout(array);
+  return stat_sampler_read_l(sampler, array, &layout);
+}
+
+/**
+ * @brief Replaces the sampler's layout with one scanned from its buffer.
+ * 
+ * @return 0 on success, 1 if the buffer has no cpu lines, STAT_OUT_OF_MEMORY
+ * on allocation failure.
+ */
+static int stat_sampler_rescan(stat_sampler_t sampler[static 1]) {
+  const char* begin = sampler->buffer;
+  const char* end = begin + sampler->data_size;
+  const char* cursor = begin;
+  int id;
+  //first number is missing, same as the parse would report
+  if (stat_scan_label(&cursor, end, &id)) {
+    return 1;
+  }
+  unsigned long long version =
+    (sampler->layout != NULL) ? sampler->layout->version + 1 : 1;
+  stat_layout_version_t* layout =
+    stat_layout_version_scan(begin, end, version);
+  if (layout == NULL) {
+    return STAT_OUT_OF_MEMORY;
+  }
+  stat_layout_version_release(sampler->layout);
+  sampler->layout = layout;
+  return 0;
+}
+
+/**
+ * @brief Parses the buffer into a new sample of the sampler's layout.
+ */
+static int stat_sampler_parse(
+  stat_sampler_t sampler[static 1],
+  stat_cpu_array_t sample[static 1]
+) {
+  stat_cpu_array_t array = (sampler->pool != NULL) ?
+    stat_pool_take_sample(sampler->pool, sampler->layout) :
+    stat_cpu_array_create_v(sampler->layout);
+  if (array == NULL) {
+    return STAT_OUT_OF_MEMORY;
+  }
+  int parse_flag = stat_parse_cpu_rows(
+    array,
+    sampler->buffer,
+    sampler->buffer + sampler->data_size,
+    &(sampler->layout->layout),
+    sampler->layout->cpu_ids
+  );
+  if (parse_flag) {
+    stat_cpu_array_free(array);
+    return parse_flag;
+  }
+  array->timestamp = sampler->timestamp;
+  *sample = array;
+  return 0;
+}
+
+int stat_sampler_sample(
+  stat_sampler_t sampler[static 1],
+  stat_cpu_array_t sample[static 1]
+) {
+  if (stat_sampler_refresh(sampler)) {
+    return EOF;
+  }
+  if (sampler->layout == NULL) {
+    int rescan_flag = stat_sampler_rescan(sampler);
+    if (rescan_flag) {
+      return rescan_flag;
+    }
+  }
+  int parse_flag = stat_sampler_parse(sampler, sample);
+  if (parse_flag != STAT_LAYOUT_CHANGED) {
+    return parse_flag;
+  }
+  int rescan_flag = stat_sampler_rescan(sampler);
+  if (rescan_flag) {
+    return rescan_flag;
+  }
+  //columns are counted on the first line only, so lines that disagree with
+  //each other fail again instead of being rescanned over and over
+  return stat_sampler_parse(sampler, sample);
+}
+
+int stat_source_open(
+  stat_source_t source[static 1],
+  size_t id,
+  const char name[static 1],
+  const char path[static 1]
+) {
+  source->id = id;
+  source->name = name;
+  return stat_sampler_open(&(source->sampler), path);
+}
+
+void stat_source_close(stat_source_t source[static 1]) {
+  stat_sampler_close(&(source->sampler));
+}
+
+int stat_source_sample(
+  stat_source_t source[static 1],
+  stat_cpu_array_t sample[static 1]
+) {
+  int sample_flag = stat_sampler_sample(&(source->sampler), sample);
+  if (sample_flag == 0) {
+    (*sample)->source = source;
+  }
+  return sample_flag;
+}
+
+stat_cpu_field_t stat_cpu_field_delta(
+  stat_cpu_field_t old,
+  stat_cpu_field_t curr,
+  size_t reset_count[static 1]
+) {
+  //unsigned subtraction already gives the right answer for wrapped counters
+  stat_cpu_field_t difference = curr - old;
+  //written without branches, so loops calling it can still be vectorized
+  bool reset = difference > (stat_cpu_field_t)INT64_MAX;
+  *reset_count += (size_t)reset;
+  return reset ? 0 : difference;
+}
+
+size_t stat_cpu_array_delta_l(
   stat_cpu_array_t old,
   stat_cpu_array_t curr,
   stat_cpu_array_t result,
   stat_layout_t layout[static 1]
 ) {
-  for (size_t i = 0; i < layout->cpu_count; ++i) {
-    stat_cpu_row_delta_l(old[i], curr[i], result[i], layout);
-  }
+  //rows are contiguous, so the whole block is one linear pass
+  return stat_kernels_active()->delta(
+    old->fields,
+    curr->fields,
+    result->fields,
+    layout->cpu_count * result->stride
+  );
 }
 
-void stat_cpu_array_delta(
+size_t stat_cpu_array_delta(
   stat_cpu_array_t old,
   stat_cpu_array_t curr,
   stat_cpu_array_t result
 ) {
-  stat_cpu_array_delta_l(old, curr, result, &global_layout);
+  stat_layout_t layout = stat_array_layout(result);
+  return stat_cpu_array_delta_l(old, curr, result, &layout);
 }
 
-void stat_cpu_row_delta_l(
+size_t stat_cpu_row_delta_l(
   stat_cpu_row_t old,
   stat_cpu_row_t curr,
   stat_cpu_row_t result,
   stat_layout_t layout[static 1]
 ) {
+  size_t reset_count = 0;
   for (size_t i = 0; i < layout->cpu_column_count; ++i) {
-    result[i] = curr[i] - old[i];
+    result[i] = stat_cpu_field_delta(old[i], curr[i], &reset_count);
   }
-}
-
-void stat_cpu_row_delta(
-  stat_cpu_row_t old,
-  stat_cpu_row_t curr,
-  stat_cpu_row_t result
-){
-  stat_cpu_row_delta_l(old, curr, result, &global_layout);
+  return reset_count;
 }
 
 stat_cpu_percentage_t stat_cpu_row_percentage_8(
-  stat_cpu_row_t delta
+  const stat_cpu_field_t* delta
 ) {
-  stat_cpu_percentage_t total_work = (
+  stat_cpu_field_t total_work = (
     delta[user_proc_col] +
     delta[nice_proc_col] +
     delta[system_proc_col] +
@@ -183,26 +711,58 @@ stat_cpu_percentage_t stat_cpu_row_percentage_8(
     delta[softirq_col] +
     delta[steal_col]
   );
-  stat_cpu_percentage_t total = total_work + delta[idle_col] + delta[iowait_col];
-  if (total == 0.0) {
+  stat_cpu_field_t total = total_work + delta[idle_col] + delta[iowait_col];
+  if (total == 0) {
     return 0;
   }
-  return total_work * 100.00 / total;
+  return (stat_cpu_percentage_t)total_work * 100.00 /
+         (stat_cpu_percentage_t)total;
 }
 
 stat_cpu_percentage_array_t stat_cpu_percentage_array_create_l(
   stat_layout_t layout[static 1]
 ) {
-  return malloc(sizeof(stat_cpu_percentage_t) * layout->cpu_count);
+  //values follow the header, which keeps them aligned for doubles
+  stat_cpu_percentage_array_t new_array = malloc(
+    sizeof(stat_cpu_percentage_block_t) +
+    sizeof(stat_cpu_percentage_t) * layout->cpu_count
+  );
+  if (new_array == NULL) {
+    return NULL;
+  }
+  new_array->kind = diagnostics_cpu_usage;
+  new_array->cpu_count = layout->cpu_count;
+  new_array->layout = NULL;
+  new_array->source = NULL;
+  new_array->pool = NULL;
+  new_array->system = (stat_system_rates_t){0};
+  new_array->values = (stat_cpu_percentage_t*)(void*)(new_array + 1);
+  return new_array;
 }
 
-stat_cpu_percentage_array_t stat_cpu_percentage_array_create(void) {
-  return stat_cpu_percentage_array_create_l(&global_layout);
+stat_cpu_percentage_array_t stat_cpu_percentage_array_create_v(
+  stat_layout_version_t* layout
+) {
+  stat_cpu_percentage_array_t new_array =
+    stat_cpu_percentage_array_create_l(&(layout->layout));
+  if (new_array != NULL) {
+    new_array->layout = stat_layout_version_acquire(layout);
+  }
+  return new_array;
 }
 
 void stat_cpu_percentage_array_free(
   stat_cpu_percentage_array_t array
 ) {
+  if (array == NULL) {
+    return;
+  }
+  stat_layout_version_release(array->layout);
+  array->layout = NULL;
+  if (array->pool != NULL) {
+    stat_pool_give_back(array->pool, &(array->link));
+    return;
+  }
   free(array);
 }
 
@@ -215,9 +775,12 @@ int stat_cpu_percentage_array_calculate_l(
   stat_cpu_array_t field_array,
   stat_layout_t layout[static 1]
 ) {
-  for (size_t i = 0; i < layout->cpu_count; ++i) {
-    percentage_array[i] = stat_cpu_row_percentage_8(field_array[i]);
-  }
+  stat_kernels_active()->percentage(
+    percentage_array->values,
+    field_array->fields,
+    layout->cpu_count,
+    field_array->stride
+  );
   return (int)layout->cpu_count;
 }
 
@@ -225,9 +788,84 @@ int stat_cpu_percentage_array_calculate(
   stat_cpu_percentage_array_t percentage_array,
   stat_cpu_array_t field_array
 ) {
+  stat_layout_t layout = stat_array_layout(field_array);
   return stat_cpu_percentage_array_calculate_l(
     percentage_array,
     field_array,
-    &global_layout
+    &layout
+  );
+}
+
+size_t stat_cpu_percentage_array_calculate_delta_l(
+  stat_cpu_percentage_array_t percentage_array,
+  stat_cpu_array_t old,
+  stat_cpu_array_t curr,
+  stat_layout_t layout[static 1]
+) {
+  return stat_kernels_active()->fused(
+    percentage_array->values,
+    old->fields,
+    curr->fields,
+    layout->cpu_count,
+    curr->stride
+  );
+}
+
+size_t stat_cpu_percentage_array_calculate_delta(
+  stat_cpu_percentage_array_t percentage_array,
+  stat_cpu_array_t old,
+  stat_cpu_array_t curr
+) {
+  stat_layout_t layout = stat_array_layout(curr);
+  return stat_cpu_percentage_array_calculate_delta_l(
+    percentage_array,
+    old,
+    curr,
+    &layout
+  );
+}
+
+/**
+ * @brief Per-second rate of a counter, following stat_cpu_field_delta.
+ */
+static double stat_counter_rate(
+  uint64_t old,
+  uint64_t curr,
+  double seconds,
+  size_t reset_count[static 1]
+) {
+  return (double)stat_cpu_field_delta(old, curr, reset_count) / seconds;
+}
+
+size_t stat_system_rates_calculate(
+  stat_system_rates_t rates[static 1],
+  stat_cpu_array_t old,
+  stat_cpu_array_t curr
+) {
+  double seconds =
+    (double)(curr->timestamp.tv_sec - old->timestamp.tv_sec) +
+    (double)(curr->timestamp.tv_nsec - old->timestamp.tv_nsec) / 1e9;
+  *rates = (stat_system_rates_t){
+    .procs_running = curr->system.procs_running,
+    .procs_blocked = curr->system.procs_blocked
+  };
+  if (seconds <= 0) {
+    return 0;
+  }
+  size_t reset_count = 0;
+  const stat_system_t* from = &(old->system);
+  const stat_system_t* to = &(curr->system);
+  rates->interrupts =
+    stat_counter_rate(from->interrupts, to->interrupts, seconds, &reset_count);
+  rates->context_switches = stat_counter_rate(
+    from->context_switches,
+    to->context_switches,
+    seconds,
+    &reset_count
   );
+  rates->forks =
+    stat_counter_rate(from->forks, to->forks, seconds, &reset_count);
+  rates->softirqs =
+    stat_counter_rate(from->softirqs, to->softirqs, seconds, &reset_count);
+  return reset_count;
 }
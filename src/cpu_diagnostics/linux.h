@@ -2,8 +2,14 @@
 #define SKAI_CPU_DIAGNOSTICS_LINUX_H
 
 #include <ctype.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
+
+#include "message.h"
+#include "data_structures/mpsc_queue.h"
 
 /**
  * @file Contains functions and data structures for processing the /proc/stat
@@ -24,6 +30,43 @@ typedef struct stat_layout {
   size_t cpu_column_count;    /**< Number of columns with numeric data*/
 } stat_layout_t;
 
+/**
+ * @brief Core number given to the first cpu line, which sums all the cores.
+ */
+enum {
+  STAT_CPU_TOTAL_ID = -1
+};
+
+/**
+ * @brief Immutable snapshot of the /proc/stat layout, shared by all the
+ * samples read while it was current.
+ * 
+ * Cores going offline or online change the number of cpu lines and the core
+ * numbers they carry, each such change produces a new snapshot with a higher
+ * version. Snapshots are reference counted, so samples still in flight keep
+ * the layout they were read with alive. Samples referencing the same snapshot
+ * are guaranteed to be comparable.
+ */
+typedef struct stat_layout_version {
+  atomic_size_t ref_count;      /**<Number of owners, the last one frees it*/
+  unsigned long long version;   /**<Grows by one with each detected change*/
+  stat_layout_t layout;         /**<Dimensions of the samples*/
+  int cpu_ids[];                /**<Core number of each line, with
+                                    STAT_CPU_TOTAL_ID for the first one*/
+} stat_layout_version_t;
+
+/**
+ * @brief Returned by sample parsing when the text doesn't match the expected
+ * layout, i.e. cores went offline or online, and by sampling when memory
+ * for the sample or its layout couldn't be allocated, apart from EOF.
+ */
+enum {
+  STAT_LAYOUT_CHANGED = -2,
+  STAT_OUT_OF_MEMORY = -3
+};
+
+struct stat_source;
+
 /**
  * @brief Constants for human readable access to fields in stat_cpu_row_t.
  * 
@@ -46,13 +89,11 @@ enum cpu_column_id {
  * @brief Variable containing a numeric data from the cpu section of /proc/stat/
  * file.
  * 
- * note: Unsigned long long was considered, as those values are always written
- * as integers, but there existed uncertainty in developers mind regarding
- * how big those numbers can really get, so ultimately decision was made to
- * change it to double, as all the precision from storing it in an integer
- * would be lost anyway in the following calculations.
+ * Kernel exposes those counters as unsigned 64-bit integers, so they're kept
+ * exact through parsing and the delta stage, only the percentage calculation
+ * converts them to floating point.
  */
-typedef double stat_cpu_field_t;
+typedef uint64_t stat_cpu_field_t;
 
 /**
  * @brief Dynamic array representing a row of numeric fields from the cpu
@@ -64,17 +105,108 @@ typedef double stat_cpu_field_t;
 typedef stat_cpu_field_t* stat_cpu_row_t;
 
 /**
- * @brief Dynamic array of individual rows from the cpu section of /proc/stat
+ * @brief Alignment constants for the contiguous sample storage.
+ * 
+ * Rows start at STAT_ROW_ALIGNMENT boundaries, so that each of them can be
+ * loaded with aligned vector instructions, and the field block as a whole
+ * starts at a cache line.
+ */
+enum {
+  STAT_CACHE_LINE_SIZE = 64,
+  STAT_ROW_ALIGNMENT = 32
+};
+
+/**
+ * @brief System-wide counters following the cpu section of /proc/stat file.
+ * 
+ * Counters missing from the file are left at 0.
+ */
+typedef struct stat_system {
+  uint64_t interrupts;        /**<Total of the 'intr' line*/
+  uint64_t context_switches;  /**<'ctxt', since boot*/
+  uint64_t forks;             /**<'processes', created since boot*/
+  uint64_t procs_running;     /**<Runnable tasks at the time of reading*/
+  uint64_t procs_blocked;     /**<Tasks blocked on I/O at the time of reading*/
+  uint64_t softirqs;          /**<Total of the 'softirq' line*/
+} stat_system_t;
+
+/**
+ * @brief Per-second rates of the stat_system_t counters between two samples,
+ * with the task counts of the later one.
+ */
+typedef struct stat_system_rates {
+  double interrupts;          /**<Interrupts per second*/
+  double context_switches;    /**<Context switches per second*/
+  double forks;               /**<Created processes per second*/
+  double softirqs;            /**<Softirqs per second*/
+  uint64_t procs_running;     /**<Runnable tasks*/
+  uint64_t procs_blocked;     /**<Tasks blocked on I/O*/
+} stat_system_rates_t;
+
+/**
+ * @brief Contiguous storage of all rows from the cpu section of /proc/stat
  * file.
  * 
+ * Header and fields live in a single cache-line aligned allocation, rows are
+ * stored one after another, each starting stride fields after the previous
+ * one. Fields between cpu_column_count and stride are padding kept at 0, so
+ * kernels may walk the whole block linearly.
+ */
+typedef struct stat_cpu_block {
+  diagnostics_message_kind_t kind;  /**<Always diagnostics_cpu_sample*/
+  size_t cpu_count;           /**<Number of rows*/
+  size_t cpu_column_count;    /**<Number of meaningful fields in each row*/
+  size_t stride;              /**<Distance in fields between starts of
+                                  consecutive rows*/
+  stat_layout_version_t* layout;  /**<Owned reference to the layout the
+                                      sample was read with, NULL if it was
+                                      created from a plain stat_layout_t*/
+  const struct stat_source* source; /**<Source the sample was read from,
+                                        not owned, NULL if unknown*/
+  struct stat_pool* pool;     /**<Pool the sample goes back to when freed,
+                                  NULL if it came from the heap*/
+  mpsc_node_t link;           /**<Link in the pool's return queue*/
+  struct timespec timestamp;  /**<CLOCK_MONOTONIC time of the read, zeroed
+                                  if the sample wasn't read by a sampler*/
+  stat_system_t system;       /**<Counters read in the same pass as rows*/
+  stat_cpu_field_t* fields;   /**<cpu_count * stride fields, points into the
+                                  same allocation as the header*/
+} stat_cpu_block_t;
+
+/**
+ * @brief Handle to a sample of the cpu section of /proc/stat file.
+ * 
  * Should be handled with associated functions. It's size is based on
  * information from stat_layout_t object used for its creation.
  */
-typedef stat_cpu_row_t* stat_cpu_array_t;
+typedef stat_cpu_block_t* stat_cpu_array_t;
 
 typedef double stat_cpu_percentage_t;
 
-typedef stat_cpu_percentage_t* stat_cpu_percentage_array_t;
+/**
+ * @brief Usage percentages of all rows of a sample, header and values in
+ * a single allocation.
+ */
+typedef struct stat_cpu_percentage_block {
+  diagnostics_message_kind_t kind;  /**<Always diagnostics_cpu_usage*/
+  size_t cpu_count;               /**<Number of values*/
+  stat_layout_version_t* layout;  /**<Owned reference to the layout of the
+                                      sample the values come from, or NULL*/
+  const struct stat_source* source; /**<Source of that sample, not owned,
+                                        NULL if unknown*/
+  struct stat_pool* pool;         /**<Pool the values go back to when freed,
+                                      NULL if they came from the heap*/
+  mpsc_node_t link;               /**<Link in the pool's return queue*/
+  stat_system_rates_t system;     /**<Rates between the two samples*/
+  stat_cpu_percentage_t* values;  /**<One value per row, points into the
+                                      same allocation as the header*/
+} stat_cpu_percentage_block_t;
+
+/**
+ * @brief Handle to usage percentages, should be handled with associated
+ * functions.
+ */
+typedef stat_cpu_percentage_block_t* stat_cpu_percentage_array_t;
 
 
 
@@ -105,65 +237,89 @@ int stat_layout_set_lf(
 );
 
 /**
- * @brief Similar to stat_layout_set_lf, but saves information into layout
- * object owned by implementation.
+ * @brief Creates a layout snapshot from /proc/stat formatted text held in
+ * memory.
  * 
- * @param source File stream pointing to /proc/stat file or with similarly
- * formatted data
- * @return 0 on success, non-0 on approaching the EOF, caller should check
- * the source stream for errors in case of non-0 value
+ * Counts the lines starting with 'cpu' and records the core number of each,
+ * columns are counted in the first line.
+ * 
+ * @param begin First character of the text
+ * @param end One past the last character of the text
+ * @param version Version number given to the snapshot
+ * @return New snapshot with a single reference owned by the caller, NULL on
+ * allocation failure or if the text has no cpu lines.
  */
-int stat_layout_set_f(
-  FILE source[static 1]
+stat_layout_version_t* stat_layout_version_scan(
+  const char* begin,
+  const char* end,
+  unsigned long long version
 );
 
 /**
- * @brief Returns global layout object.
+ * @brief Takes another reference to the snapshot.
  * 
- * @return stat_layout_t object currently stored by library
+ * @param layout 
+ * @return The same snapshot, for convenience
  */
-stat_layout_t stat_layout_get(void);
+stat_layout_version_t* stat_layout_version_acquire(
+  stat_layout_version_t* layout
+);
+
+/**
+ * @brief Drops a reference to the snapshot, freeing it if it was the last one.
+ * 
+ * @param layout Snapshot or NULL, in which case nothing happens
+ */
+void stat_layout_version_release(stat_layout_version_t* layout);
 /**
  * @brief Allocates new stat_cpu_array_t object, based on passed layout.
  * 
- * The used layout object is assumed to be invariable and should be used with
- * each operation on this stat_cpu_array_t that requires it. Trying to pass
- * a different layout or changing its values will result in memory leaks.
+ * Makes exactly one allocation, with the fields zeroed. The used layout object
+ * is assumed to be invariable and should be used with each operation on this
+ * stat_cpu_array_t that requires it.
  * 
  * @param layout Describes the dimensions of newly created array.
- * @return stat_cpu_array_t* 
+ * @return stat_cpu_array_t on success, NULL on allocation failure
  */
 stat_cpu_array_t stat_cpu_array_create_l(stat_layout_t layout[static 1]);
 
 /**
- * @brief Allocates new stat_cpu_array_t object, based on globally stored
- * layout.
+ * @brief Allocates new stat_cpu_array_t object tagged with the provided
+ * layout snapshot, to which it takes a reference.
  * 
- * @return stat_cpu_array_t* 
+ * @param layout Describes the dimensions of newly created array.
+ * @return stat_cpu_array_t on success, NULL on allocation failure
  */
-stat_cpu_array_t stat_cpu_array_create(void);
+stat_cpu_array_t stat_cpu_array_create_v(
+  stat_layout_version_t* layout
+);
 
 /**
- * @brief Frees the memory allocated for stat_cpu_array_t object. Requires
- * layout used for its creation.
+ * @brief Frees the memory allocated for stat_cpu_array_t object and drops its
+ * reference to the layout snapshot, if it has one.
+ * 
+ * Pooled arrays are handed back to their pool instead, which is lock-free
+ * and can be done from any thread.
+ * 
+ * The array carries its own dimensions, so no layout is needed.
  * 
  * @param array stat_cpu_array_t object to be freed.
- * @param layout Same as the one used for the creation of the array.
  */
-void stat_cpu_array_free_l(
-  stat_cpu_array_t array,
-  stat_layout_t layout[static 1]
-);
+void stat_cpu_array_free(stat_cpu_array_t array);
+
+void stat_cpu_array_deleter(void* array_ptr);
 
 /**
- * @brief Frees the memory allocated for stat_cpu_array_t object.
+ * @brief Returns the row with provided index.
  * 
- * @param array stat_cpu_array_t object to be freed that was created using the
- * global layout.
+ * @param array 
+ * @param index Smaller than the cpu_count of the array
+ * @return stat_cpu_row_t pointing into the array's storage
  */
-void stat_cpu_array_free(stat_cpu_array_t array);
-
-void stat_cpu_array_deleter(void* array_ptr);
+stat_cpu_row_t stat_cpu_array_row(
+  stat_cpu_array_t array,
+  size_t index
+);
 
 /**
  * @brief Read /proc/stat data regarding cpu load from the source to the
@@ -189,12 +345,12 @@ int stat_cpu_array_read_fl(
 
 /**
  * @brief Read /proc/stat data regarding cpu load from the source to the
- * provided stat_cpu_array_t using global layout.
+ * provided stat_cpu_array_t using the dimensions it was created with.
  * 
  * Stops reading when 1st read failure occurs, in such case returns described
  * values for diagnostics.
  * 
- * @param array Created with the use of global layout
+ * @param array 
  * @param source File stream pointing to /proc/stat or a file with same
  * formatting
  * @return 0 on completion of all reads(i.e. success), number of successful
@@ -206,14 +362,231 @@ int stat_cpu_array_read_f(
   FILE source[static 1]
 );
 
-void stat_cpu_array_delta_l(
+/**
+ * @brief Parses the cpu section of /proc/stat formatted text held in memory
+ * into the provided stat_cpu_array_t using provided stat_layout_t object.
+ * 
+ * Integer-only scanner meant as a cheaper alternative to the fscanf based
+ * stat_cpu_array_read_fl, the return values follow the same convention.
+ * Lines after the cpu section are handled in the same pass, filling the
+ * system counters of the array.
+ * 
+ * @param array Created with the use of provided layout
+ * @param begin First character of the text
+ * @param end One past the last character of the text
+ * @param layout Used for both bound checks and deducing how much data needs to
+ * be processed
+ * @return 0 on success, 1-based position of the first malformed number in
+ * case of a match failure and EOF if the text ends before all the fields were
+ * read.
+ */
+int stat_cpu_array_parse_l(
+  stat_cpu_array_t array,
+  const char* begin,
+  const char* end,
+  stat_layout_t layout[static 1]
+);
+
+/**
+ * @brief Keeps /proc/stat open between samples together with a reusable read
+ * buffer, so that repeated reads don't go through stdio or the heap.
+ * 
+ * Buffer starts at a page size and grows(in pages) only when the file
+ * doesn't fit in it, so after the first read sampling makes no allocations.
+ * 
+ * Accessing struct fields directly is not recommended.
+ */
+typedef struct stat_sampler {
+  int fd;               /**<Descriptor kept open for the sampler's lifetime*/
+  char* buffer;         /**<Owned buffer the file is read into*/
+  size_t buffer_size;   /**<Capacity of the buffer, multiple of page size*/
+  size_t data_size;     /**<Number of bytes obtained by the last read*/
+  struct timespec timestamp;  /**<CLOCK_MONOTONIC time of the last read*/
+  stat_layout_version_t* layout;  /**<Owned reference to the current layout,
+                                      NULL until the first sample*/
+  struct stat_pool* pool;   /**<Pool samples are taken from, not owned, NULL
+                                to allocate each of them*/
+} stat_sampler_t;
+
+/**
+ * @brief Opens the file under the path and allocates the read buffer.
+ * 
+ * @param sampler Sampler to initialize
+ * @param path Path to /proc/stat or a file with same formatting
+ * @return 0 on success, non-0 value if either opening the file or
+ * the allocation failed, in which case nothing has to be cleaned up.
+ */
+int stat_sampler_open(
+  stat_sampler_t sampler[static 1],
+  const char path[static 1]
+);
+
+/**
+ * @brief Closes the descriptor, frees the buffer and drops the layout owned
+ * by the sampler.
+ * 
+ * @param sampler 
+ */
+void stat_sampler_close(stat_sampler_t sampler[static 1]);
+
+/**
+ * @brief Rereads the whole file from its beginning into the sampler's buffer.
+ * 
+ * Uses pread, so the descriptor never has to be rewound, /proc/stat is
+ * regenerated by the kernel on each read from offset 0.
+ * 
+ * @param sampler 
+ * @return 0 on success, EOF on read or allocation failure.
+ */
+int stat_sampler_refresh(stat_sampler_t sampler[static 1]);
+
+/**
+ * @brief Rereads the file and parses its cpu section into the provided
+ * stat_cpu_array_t using provided stat_layout_t object.
+ * 
+ * @param sampler 
+ * @param array Created with the use of provided layout
+ * @param layout Used for both bound checks and deducing how much data needs to
+ * be processed
+ * @return Same values as stat_cpu_array_parse_l, EOF if rereading failed.
+ */
+int stat_sampler_read_l(
+  stat_sampler_t sampler[static 1],
+  stat_cpu_array_t array,
+  stat_layout_t layout[static 1]
+);
+
+/**
+ * @brief Rereads the file and parses its cpu section into the provided
+ * stat_cpu_array_t using the dimensions it was created with.
+ * 
+ * @param sampler 
+ * @param array 
+ * @return Same values as stat_cpu_array_parse_l, EOF if rereading failed.
+ */
+int stat_sampler_read(
+  stat_sampler_t sampler[static 1],
+  stat_cpu_array_t array
+);
+
+/**
+ * @brief Rereads the file and returns a new sample tagged with the current
+ * layout snapshot.
+ * 
+ * Layout changes are detected while parsing, by checking the core number of
+ * each cpu line and the number of columns and lines against the current
+ * snapshot, so an unchanged file costs nothing extra. Only when they don't
+ * match the layout is scanned again from the already read text and a new
+ * snapshot with a higher version replaces the current one.
+ * 
+ * @param sampler 
+ * @param sample Set to the new sample on success, owned by the caller
+ * @return 0 on success, EOF if rereading failed, STAT_OUT_OF_MEMORY on
+ * allocation failure, STAT_LAYOUT_CHANGED if the cpu lines still don't match
+ * the layout scanned again, e.g. when they have different numbers of
+ * columns, 1-based position of the first malformed number otherwise.
+ */
+int stat_sampler_sample(
+  stat_sampler_t sampler[static 1],
+  stat_cpu_array_t sample[static 1]
+);
+
+/**
+ * @brief One file in /proc/stat format, e.g. the host, a container view or
+ * a recorded capture, with everything needed to sample it.
+ * 
+ * Sources share no state, so any number of them can be sampled concurrently,
+ * each from its own thread. Samples are tagged with the source they come
+ * from, which lets them travel through a pipeline shared by many sources.
+ */
+typedef struct stat_source {
+  size_t id;                /**<Index of the source within its pipeline*/
+  const char* name;         /**<Label used in reports, not owned*/
+  stat_sampler_t sampler;   /**<Owns the descriptor, buffer and layout*/
+} stat_source_t;
+
+/**
+ * @brief Opens the file under the path for sampling.
+ * 
+ * @param source Source to initialize
+ * @param id Index of the source within its pipeline
+ * @param name Label used in reports, has to outlive the source
+ * @param path Path to /proc/stat or a file with same formatting
+ * @return 0 on success, non-0 value if opening failed, in which case nothing
+ * has to be cleaned up.
+ */
+int stat_source_open(
+  stat_source_t source[static 1],
+  size_t id,
+  const char name[static 1],
+  const char path[static 1]
+);
+
+/**
+ * @brief Releases everything owned by the source.
+ * 
+ * @param source 
+ */
+void stat_source_close(stat_source_t source[static 1]);
+
+/**
+ * @brief Same as stat_sampler_sample, additionally tagging the sample with
+ * the source.
+ * 
+ * @param source 
+ * @param sample Set to the new sample on success, owned by the caller
+ * @return Same values as stat_sampler_sample
+ */
+int stat_source_sample(
+  stat_source_t source[static 1],
+  stat_cpu_array_t sample[static 1]
+);
+
+/**
+ * @brief Calculates difference between two readings of the same counter.
+ * 
+ * Difference is taken modulo 2^64, so a counter that wrapped around still
+ * gives the exact number of ticks. A counter that went backwards by less than
+ * half of its range can't have wrapped and counts as reset, giving no ticks,
+ * as iowait is allowed to decrease by a little and a real reset would
+ * otherwise pass the whole count since boot as a single delta.
+ * 
+ * @param old Earlier reading
+ * @param curr Later reading
+ * @param reset_count Incremented by one if the counter went backwards
+ * @return Number of ticks between the readings
+ */
+stat_cpu_field_t stat_cpu_field_delta(
+  stat_cpu_field_t old,
+  stat_cpu_field_t curr,
+  size_t reset_count[static 1]
+);
+
+/**
+ * @brief Calculates difference between all fields of two arrays and saves
+ * results in the third one.
+ * 
+ * Walks the storage of all three arrays linearly, padding included, so all of
+ * them have to share the same stride. Each field follows the rules of
+ * stat_cpu_field_delta.
+ * 
+ * @param old Array with values that will be subtracted
+ * @param curr Array with values to subtract from
+ * @param result Array to which the difference will be saved
+ * @param layout Layout describing dimensions of the provided arrays
+ * @return Number of fields that were found reset
+ */
+size_t stat_cpu_array_delta_l(
   stat_cpu_array_t old,
   stat_cpu_array_t curr,
   stat_cpu_array_t result,
   stat_layout_t layout[static 1]
 );
 
-void stat_cpu_array_delta(
+/**
+ * @brief Same as stat_cpu_array_delta_l, using the dimensions of result.
+ */
+size_t stat_cpu_array_delta(
   stat_cpu_array_t old,
   stat_cpu_array_t curr,
   stat_cpu_array_t result
@@ -230,52 +603,52 @@ void stat_cpu_array_delta(
  * @param curr Row with values to subtract from
  * @param result Row to which the difference will be saved
  * @param layout Layout describing dimensions of the provided rows
+ * @return Number of fields that were found reset
  */
-void stat_cpu_row_delta_l(
+size_t stat_cpu_row_delta_l(
   stat_cpu_row_t old,
   stat_cpu_row_t curr,
   stat_cpu_row_t result,
   stat_layout_t layout[static 1]
 );
 
-/**
- * @brief Calculates difference between all elements of two rows and saves
- * results in a new row, with dimensions according to the global layout
- * 
- * All rows should be have dimensions greater or equal to the ones dictated
- * by the global layout.
- * 
- * @param old Row with values that will be subtracted
- * @param curr Row with values to subtract from
- * @param result Row to which the difference will be saved
- */
-void stat_cpu_row_delta(
-  stat_cpu_row_t old,
-  stat_cpu_row_t curr,
-  stat_cpu_row_t result
-);
-
 /**
  * @brief Calculates CPU usage percentage for the provided row, using 8 fields.
  * 
  * Uses all fields except the last two, as according to conducted research their
  * values are already contained in previous fields, which makes them redundant
- * for this calculation.
+ * for this calculation. Sums are done on integers, conversion to floating point
+ * happens only for the final division.
  * 
  * @param delta stat_cpu_row_t to calculate percentage for, thought of as a
  * delta of rows from two different time points.
  * @return stat_cpu_percentage_t
  */
 stat_cpu_percentage_t stat_cpu_row_percentage_8(
-  stat_cpu_row_t delta
+  const stat_cpu_field_t* delta
 );
 
 stat_cpu_percentage_array_t stat_cpu_percentage_array_create_l(
   stat_layout_t layout[static 1]
 );
 
-stat_cpu_percentage_array_t stat_cpu_percentage_array_create(void);
+/**
+ * @brief Allocates percentages for samples tagged with the provided layout
+ * snapshot, to which it takes a reference.
+ * 
+ * @param layout 
+ * @return stat_cpu_percentage_array_t on success, NULL on allocation failure
+ */
+stat_cpu_percentage_array_t stat_cpu_percentage_array_create_v(
+  stat_layout_version_t* layout
+);
 
+/**
+ * @brief Frees the percentages and drops their reference to the layout
+ * snapshot, pooled ones are handed back to their pool instead.
+ * 
+ * @param array 
+ */
 void stat_cpu_percentage_array_free(
   stat_cpu_percentage_array_t array
 );
@@ -288,9 +661,68 @@ int stat_cpu_percentage_array_calculate_l(
   stat_layout_t layout[static 1]
 );
 
+/**
+ * @brief Same as stat_cpu_percentage_array_calculate_l, using the dimensions
+ * of field_array.
+ */
 int stat_cpu_percentage_array_calculate(
   stat_cpu_percentage_array_t percentage_array,
   stat_cpu_array_t field_array
 );
 
+/**
+ * @brief Calculates CPU usage percentages straight from two samples, in
+ * a single streaming pass that never stores their delta.
+ * 
+ * Gives the same percentages as stat_cpu_array_delta_l followed by
+ * stat_cpu_percentage_array_calculate_l, but only the 8 fields used by
+ * stat_cpu_row_percentage_8 are subtracted, so only those are checked for
+ * resets.
+ * 
+ * @param percentage_array Created with the use of provided layout
+ * @param old Earlier sample
+ * @param curr Later sample, same dimensions as old
+ * @param layout Layout describing dimensions of the provided arrays
+ * @return Number of fields that were found reset
+ */
+size_t stat_cpu_percentage_array_calculate_delta_l(
+  stat_cpu_percentage_array_t percentage_array,
+  stat_cpu_array_t old,
+  stat_cpu_array_t curr,
+  stat_layout_t layout[static 1]
+);
+
+/**
+ * @brief Same as stat_cpu_percentage_array_calculate_delta_l, using the
+ * dimensions of curr.
+ * 
+ * @param percentage_array Created with the same dimensions as the samples
+ * @param old Earlier sample
+ * @param curr Later sample
+ * @return Number of fields that were found reset
+ */
+size_t stat_cpu_percentage_array_calculate_delta(
+  stat_cpu_percentage_array_t percentage_array,
+  stat_cpu_array_t old,
+  stat_cpu_array_t curr
+);
+
+/**
+ * @brief Calculates per-second rates of the system counters between two
+ * samples, using their timestamps.
+ * 
+ * Counters follow the rules of stat_cpu_field_delta, rates are 0 if the
+ * samples weren't taken in order.
+ * 
+ * @param rates Set to the calculated rates
+ * @param old Earlier sample
+ * @param curr Later sample
+ * @return Number of counters that were found reset
+ */
+size_t stat_system_rates_calculate(
+  stat_system_rates_t rates[static 1],
+  stat_cpu_array_t old,
+  stat_cpu_array_t curr
+);
+
 #endif
@@ -0,0 +1,33 @@
+#include "message.h"
+
+#include "cgroup.h"
+#include "linux.h"
+#include "process.h"
+
+diagnostics_message_kind_t diagnostics_message_kind(const void* message) {
+  //every message struct starts with its kind
+  return *(const diagnostics_message_kind_t*)message;
+}
+
+void diagnostics_message_deleter(void* message) {
+  switch (diagnostics_message_kind(message)) {
+    case diagnostics_cpu_sample:
+      stat_cpu_array_free(message);
+      break;
+    case diagnostics_cpu_usage:
+      stat_cpu_percentage_array_free(message);
+      break;
+    case diagnostics_proc_sample:
+      proc_sample_free(message);
+      break;
+    case diagnostics_proc_report:
+      proc_report_free(message);
+      break;
+    case diagnostics_cgroup_sample:
+      cgroup_sample_free(message);
+      break;
+    case diagnostics_cgroup_report:
+      cgroup_report_free(message);
+      break;
+  }
+}
@@ -0,0 +1,40 @@
+#ifndef SKAI_CPU_DIAGNOSTICS_MESSAGE_H
+#define SKAI_CPU_DIAGNOSTICS_MESSAGE_H
+
+/**
+ * @file Tags of the messages passed between pipeline stages, which let
+ * a single queue carry samples and results of different kinds.
+ * 
+ * Every message struct starts with a diagnostics_message_kind_t member, so
+ * the kind can be read through a pointer to the message itself.
+ */
+
+/**
+ * @brief Kinds of messages, each naming the handle type it's carried by.
+ */
+typedef enum diagnostics_message_kind {
+  diagnostics_cpu_sample,     /**<stat_cpu_array_t*/
+  diagnostics_cpu_usage,      /**<stat_cpu_percentage_array_t*/
+  diagnostics_proc_sample,    /**<proc_sample_t*/
+  diagnostics_proc_report,    /**<proc_report_t*/
+  diagnostics_cgroup_sample,  /**<cgroup_sample_t*/
+  diagnostics_cgroup_report   /**<cgroup_report_t*/
+} diagnostics_message_kind_t;
+
+/**
+ * @brief Returns the kind of the message.
+ * 
+ * @param message Any of the handles listed in diagnostics_message_kind_t
+ * @return Kind stored at the start of the message
+ */
+diagnostics_message_kind_t diagnostics_message_kind(const void* message);
+
+/**
+ * @brief Deleter for queues carrying messages of mixed kinds, calls the free
+ * function matching the kind of the message.
+ * 
+ * @param message Any of the handles listed in diagnostics_message_kind_t
+ */
+void diagnostics_message_deleter(void* message);
+
+#endif
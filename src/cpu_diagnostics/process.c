@@ -0,0 +1,592 @@
+//for getdents64
+#define _GNU_SOURCE
+
+#include "process.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @brief Buffer sizes, a stat line is a few hundred characters long and half
+ * of the getdents64 buffer fits about a thousand /proc entries.
+ */
+enum {
+  PROC_STAT_BUFFER_SIZE = 1024,
+  PROC_DIRENT_BUFFER_SIZE = 65536,
+  PROC_PATH_SIZE = 64
+};
+
+/**
+ * @brief Fibonacci hashing, spreads consecutive ids over the whole table.
+ */
+static size_t proc_hash(int32_t tid, size_t capacity) {
+  uint64_t product = (uint64_t)(uint32_t)tid * UINT64_C(0x9E3779B97F4A7C15);
+  return (size_t)(product >> 32) & (capacity - 1);
+}
+
+int proc_table_init(proc_table_t table[static 1], size_t capacity) {
+  size_t rounded = 16;
+  while (rounded < capacity) {
+    rounded *= 2;
+  }
+  table->slots = calloc(rounded, sizeof(proc_entry_t));
+  if (table->slots == NULL) {
+    return -1;
+  }
+  table->capacity = rounded;
+  table->count = 0;
+  return 0;
+}
+
+void proc_table_destroy(proc_table_t table[static 1]) {
+  free(table->slots);
+  table->slots = NULL;
+  table->capacity = 0;
+  table->count = 0;
+}
+
+/**
+ * @brief Returns the slot holding the task or the empty one ending its probe
+ * sequence.
+ */
+static size_t proc_table_probe(
+  const proc_entry_t* slots,
+  size_t capacity,
+  int32_t tid
+) {
+  size_t mask = capacity - 1;
+  size_t slot = proc_hash(tid, capacity);
+  while (slots[slot].tid != 0 && slots[slot].tid != tid) {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+/**
+ * @brief Doubles the capacity, rehashing all the entries.
+ */
+static int proc_table_grow(proc_table_t table[static 1]) {
+  size_t capacity = table->capacity * 2;
+  proc_entry_t* slots = calloc(capacity, sizeof(proc_entry_t));
+  if (slots == NULL) {
+    return -1;
+  }
+  for (size_t i = 0; i < table->capacity; ++i) {
+    if (table->slots[i].tid != 0) {
+      slots[proc_table_probe(slots, capacity, table->slots[i].tid)] =
+        table->slots[i];
+    }
+  }
+  free(table->slots);
+  table->slots = slots;
+  table->capacity = capacity;
+  return 0;
+}
+
+proc_entry_t* proc_table_find(proc_table_t table[static 1], int32_t tid) {
+  size_t slot = proc_table_probe(table->slots, table->capacity, tid);
+  return (table->slots[slot].tid == tid) ? &(table->slots[slot]) : NULL;
+}
+
+proc_entry_t* proc_table_insert(
+  proc_table_t table[static 1],
+  int32_t tid,
+  bool inserted[static 1]
+) {
+  //linear probing degrades quickly past half the capacity
+  if ((table->count + 1) * 2 > table->capacity && proc_table_grow(table)) {
+    return NULL;
+  }
+  size_t slot = proc_table_probe(table->slots, table->capacity, tid);
+  proc_entry_t* entry = &(table->slots[slot]);
+  *inserted = (entry->tid == 0);
+  if (*inserted) {
+    *entry = (proc_entry_t){.tid = tid};
+    table->count += 1;
+  }
+  return entry;
+}
+
+void proc_table_remove_at(proc_table_t table[static 1], size_t slot) {
+  size_t mask = table->capacity - 1;
+  size_t hole = slot;
+  size_t next = (hole + 1) & mask;
+  while (table->slots[next].tid != 0) {
+    size_t home = proc_hash(table->slots[next].tid, table->capacity);
+    //entry can fill the hole only if it doesn't land before its home slot
+    if (((next - home) & mask) >= ((next - hole) & mask)) {
+      table->slots[hole] = table->slots[next];
+      hole = next;
+    }
+    next = (next + 1) & mask;
+  }
+  table->slots[hole] = (proc_entry_t){0};
+  table->count -= 1;
+}
+
+/**
+ * @brief Parses an unsigned number, stopping at the first non-digit.
+ */
+static int proc_scan_number(
+  const char* cursor[static 1],
+  const char* end,
+  uint64_t value[static 1]
+) {
+  const char* iter = *cursor;
+  uint64_t number = 0;
+  while (iter != end && *iter >= '0' && *iter <= '9') {
+    number = number * 10 + (uint64_t)(*iter - '0');
+    ++iter;
+  }
+  if (iter == *cursor) {
+    return -1;
+  }
+  *value = number;
+  *cursor = iter;
+  return 0;
+}
+
+int proc_stat_parse(
+  const char* begin,
+  const char* end,
+  proc_entry_t entry[static 1]
+) {
+  const char* open = memchr(begin, '(', (size_t)(end - begin));
+  const char* close = end;
+  while (close != begin && close[-1] != ')') {
+    --close;
+  }
+  if (open == NULL || close == begin || close - 1 <= open) {
+    return -1;
+  }
+  size_t comm_size = (size_t)(close - 1 - (open + 1));
+  if (comm_size > PROC_COMM_SIZE - 1) {
+    comm_size = PROC_COMM_SIZE - 1;
+  }
+  memcpy(entry->comm, open + 1, comm_size);
+  entry->comm[comm_size] = '\0';
+
+  //fields are numbered from 1, the state after the name is the 3rd one
+  const char* cursor = close;
+  for (int field = 3; field <= 22; ++field) {
+    if (cursor == end || *cursor != ' ') {
+      return -1;
+    }
+    ++cursor;
+    uint64_t* target = NULL;
+    switch (field) {
+      case 14:
+        target = &(entry->utime);
+        break;
+      case 15:
+        target = &(entry->stime);
+        break;
+      case 22:
+        target = &(entry->start_time);
+        break;
+      default:
+        break;
+    }
+    if (target != NULL) {
+      if (proc_scan_number(&cursor, end, target)) {
+        return -1;
+      }
+    } else {
+      while (cursor != end && *cursor != ' ' && *cursor != '\n') {
+        ++cursor;
+      }
+    }
+  }
+  return 0;
+}
+
+int proc_collector_open(
+  proc_collector_t collector[static 1],
+  const char root[static 1],
+  int flags
+) {
+  collector->root_fd = open(root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (collector->root_fd == -1) {
+    return -1;
+  }
+  collector->dirent_buffer = malloc(PROC_DIRENT_BUFFER_SIZE);
+  if (
+    collector->dirent_buffer == NULL ||
+    proc_table_init(&(collector->table), 1024)
+  ) {
+    free(collector->dirent_buffer);
+    close(collector->root_fd);
+    return -1;
+  }
+  collector->dirent_buffer_size = PROC_DIRENT_BUFFER_SIZE;
+  collector->flags = flags;
+  collector->generation = 0;
+  collector->timestamp = (struct timespec){0};
+  collector->scratch = NULL;
+  collector->scratch_size = 0;
+  return 0;
+}
+
+void proc_collector_close(proc_collector_t collector[static 1]) {
+  for (size_t i = 0; i < collector->table.capacity; ++i) {
+    proc_entry_t* entry = &(collector->table.slots[i]);
+    if (entry->tid != 0 && entry->fd != -1) {
+      close(entry->fd);
+    }
+  }
+  proc_table_destroy(&(collector->table));
+  free(collector->dirent_buffer);
+  free(collector->scratch);
+  close(collector->root_fd);
+  collector->root_fd = -1;
+}
+
+size_t proc_collector_task_count(proc_collector_t collector[static 1]) {
+  return collector->table.count;
+}
+
+/**
+ * @brief Writes the path of the task's stat file relative to the root.
+ */
+static void proc_entry_path(
+  proc_collector_t collector[static 1],
+  const proc_entry_t entry[static 1],
+  char path[static PROC_PATH_SIZE]
+) {
+  if (collector->flags & proc_collect_threads) {
+    snprintf(
+      path,
+      PROC_PATH_SIZE,
+      "%d/task/%d/stat",
+      (int)entry->tgid,
+      (int)entry->tid
+    );
+  } else {
+    snprintf(path, PROC_PATH_SIZE, "%d/stat", (int)entry->tid);
+  }
+}
+
+/**
+ * @brief Marks the task as listed in the current tick, recording it first if
+ * it's new.
+ */
+static int proc_collector_touch(
+  proc_collector_t collector[static 1],
+  int32_t tid,
+  int32_t tgid
+) {
+  bool inserted;
+  proc_entry_t* entry = proc_table_insert(&(collector->table), tid, &inserted);
+  if (entry == NULL) {
+    return -1;
+  }
+  entry->generation = collector->generation;
+  if (!inserted) {
+    return 0;
+  }
+  entry->tgid = tgid;
+  entry->fresh = true;
+  char path[PROC_PATH_SIZE];
+  proc_entry_path(collector, entry, path);
+  entry->fd = openat(collector->root_fd, path, O_RDONLY | O_CLOEXEC);
+  if (entry->fd == -1 && errno != EMFILE && errno != ENFILE) {
+    //task exited after being listed, the sweep will drop it
+    entry->generation = collector->generation - 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Parses a directory entry name made of digits only.
+ * 
+ * @return Id or 0 if the name isn't one
+ */
+static int32_t proc_parse_id(const char* name) {
+  int32_t id = 0;
+  for (const char* iter = name; *iter != '\0'; ++iter) {
+    if (*iter < '0' || *iter > '9' || id > INT32_MAX / 10) {
+      return 0;
+    }
+    id = id * 10 + (*iter - '0');
+  }
+  return id;
+}
+
+/**
+ * @brief Lists the directory, touching every task in it.
+ * 
+ * @param dir_fd Root, or a task directory when tgid isn't 0
+ * @param tgid Process owning the task directory, 0 for the root
+ * @param buffer Buffer for getdents64, task directories get its second half
+ */
+static int proc_collector_scan(
+  proc_collector_t collector[static 1],
+  int dir_fd,
+  int32_t tgid,
+  char* buffer,
+  size_t buffer_size
+) {
+  if (lseek(dir_fd, 0, SEEK_SET) == -1) {
+    return EOF;
+  }
+  while (true) {
+    ssize_t read_size = getdents64(dir_fd, buffer, buffer_size / 2);
+    if (read_size < 0) {
+      return EOF;
+    }
+    if (read_size == 0) {
+      return 0;
+    }
+    for (ssize_t offset = 0; offset < read_size;) {
+      struct dirent64* dirent = (struct dirent64*)(void*)(buffer + offset);
+      offset += dirent->d_reclen;
+      int32_t id = proc_parse_id(dirent->d_name);
+      if (id == 0) {
+        continue;
+      }
+      int touch_flag = 0;
+      if (tgid != 0) {
+        touch_flag = proc_collector_touch(collector, id, tgid);
+      } else if (collector->flags & proc_collect_threads) {
+        char path[PROC_PATH_SIZE];
+        snprintf(path, PROC_PATH_SIZE, "%d/task", (int)id);
+        int task_fd = openat(
+          collector->root_fd,
+          path,
+          O_RDONLY | O_DIRECTORY | O_CLOEXEC
+        );
+        if (task_fd == -1) {
+          //process exited after being listed
+          continue;
+        }
+        touch_flag = proc_collector_scan(
+          collector,
+          task_fd,
+          id,
+          buffer + buffer_size / 2,
+          buffer_size / 2
+        );
+        close(task_fd);
+        //a process exiting mid-listing isn't an error of the whole tick
+        if (touch_flag == EOF) {
+          touch_flag = 0;
+        }
+      } else {
+        touch_flag = proc_collector_touch(collector, id, id);
+      }
+      if (touch_flag) {
+        return touch_flag;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Drops the tasks that weren't listed in the current tick.
+ */
+static void proc_collector_sweep(proc_collector_t collector[static 1]) {
+  proc_table_t* table = &(collector->table);
+  for (size_t i = 0; i < table->capacity; ++i) {
+    //removal moves the next entry of the cluster into the same slot
+    while (
+      table->slots[i].tid != 0 &&
+      table->slots[i].generation != collector->generation
+    ) {
+      if (table->slots[i].fd != -1) {
+        close(table->slots[i].fd);
+      }
+      proc_table_remove_at(table, i);
+    }
+  }
+}
+
+/**
+ * @brief Rereads the task's stat file.
+ * 
+ * A descriptor that can't be read anymore belongs to a task that exited, the
+ * file is opened again in case its id already went to a new task.
+ * 
+ * @return 0 on success, non-0 value if the task is gone or the file malformed
+ */
+static int proc_collector_read(
+  proc_collector_t collector[static 1],
+  proc_entry_t entry[static 1],
+  proc_entry_t reading[static 1]
+) {
+  char text[PROC_STAT_BUFFER_SIZE];
+  ssize_t read_size = -1;
+  if (entry->fd != -1) {
+    read_size = pread(entry->fd, text, sizeof(text), 0);
+  }
+  if (read_size <= 0) {
+    if (entry->fd != -1) {
+      close(entry->fd);
+    }
+    char path[PROC_PATH_SIZE];
+    proc_entry_path(collector, entry, path);
+    entry->fd = openat(collector->root_fd, path, O_RDONLY | O_CLOEXEC);
+    if (entry->fd == -1) {
+      return -1;
+    }
+    read_size = pread(entry->fd, text, sizeof(text), 0);
+    if (read_size <= 0) {
+      return -1;
+    }
+  }
+  return proc_stat_parse(text, text + read_size, reading);
+}
+
+/**
+ * @brief Makes sure the scratch buffer can hold a delta of every task.
+ */
+static int proc_collector_reserve(proc_collector_t collector[static 1]) {
+  if (collector->scratch_size >= collector->table.count) {
+    return 0;
+  }
+  size_t scratch_size = collector->table.capacity;
+  proc_delta_t* scratch =
+    realloc(collector->scratch, sizeof(proc_delta_t) * scratch_size);
+  if (scratch == NULL) {
+    return -1;
+  }
+  collector->scratch = scratch;
+  collector->scratch_size = scratch_size;
+  return 0;
+}
+
+int proc_collector_sample(
+  proc_collector_t collector[static 1],
+  proc_sample_t sample[static 1]
+) {
+  collector->generation += 1;
+  int scan_flag = proc_collector_scan(
+    collector,
+    collector->root_fd,
+    0,
+    collector->dirent_buffer,
+    collector->dirent_buffer_size
+  );
+  if (scan_flag) {
+    return scan_flag;
+  }
+  proc_collector_sweep(collector);
+  if (proc_collector_reserve(collector)) {
+    return -1;
+  }
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  double elapsed = 0;
+  if (collector->timestamp.tv_sec != 0 || collector->timestamp.tv_nsec != 0) {
+    elapsed =
+      (double)(now.tv_sec - collector->timestamp.tv_sec) +
+      (double)(now.tv_nsec - collector->timestamp.tv_nsec) / 1e9;
+  }
+  collector->timestamp = now;
+
+  size_t count = 0;
+  proc_table_t* table = &(collector->table);
+  for (size_t i = 0; i < table->capacity; ++i) {
+    proc_entry_t* entry = &(table->slots[i]);
+    proc_entry_t reading;
+    if (entry->tid == 0 || proc_collector_read(collector, entry, &reading)) {
+      continue;
+    }
+    //a different start time means the id was reused by a new task
+    bool comparable =
+      !entry->fresh &&
+      reading.start_time == entry->start_time &&
+      reading.utime >= entry->utime &&
+      reading.stime >= entry->stime;
+    if (comparable && (reading.utime != entry->utime ||
+                       reading.stime != entry->stime)) {
+      proc_delta_t* delta = &(collector->scratch[count++]);
+      delta->tid = entry->tid;
+      delta->tgid = entry->tgid;
+      delta->utime = reading.utime - entry->utime;
+      delta->stime = reading.stime - entry->stime;
+      memcpy(delta->comm, reading.comm, PROC_COMM_SIZE);
+    }
+    entry->fresh = false;
+    entry->start_time = reading.start_time;
+    entry->utime = reading.utime;
+    entry->stime = reading.stime;
+    memcpy(entry->comm, reading.comm, PROC_COMM_SIZE);
+  }
+
+  //entries follow the header, which keeps them aligned
+  proc_sample_t new_sample =
+    malloc(sizeof(proc_sample_block_t) + sizeof(proc_delta_t) * count);
+  if (new_sample == NULL) {
+    return -1;
+  }
+  new_sample->kind = diagnostics_proc_sample;
+  new_sample->count = count;
+  new_sample->task_count = table->count;
+  new_sample->elapsed = elapsed;
+  new_sample->entries = (proc_delta_t*)(void*)(new_sample + 1);
+  memcpy(new_sample->entries, collector->scratch, sizeof(proc_delta_t) * count);
+  *sample = new_sample;
+  return 0;
+}
+
+void proc_sample_free(proc_sample_t sample) {
+  free(sample);
+}
+
+/**
+ * @brief Orders the deltas from the highest total usage.
+ */
+static int proc_delta_compare(const void* lhs, const void* rhs) {
+  const proc_delta_t* left = lhs;
+  const proc_delta_t* right = rhs;
+  uint64_t left_total = left->utime + left->stime;
+  uint64_t right_total = right->utime + right->stime;
+  return (left_total < right_total) - (left_total > right_total);
+}
+
+proc_report_t proc_report_create(proc_sample_t sample, size_t top_count) {
+  size_t count = (sample->count < top_count) ? sample->count : top_count;
+  proc_report_t report =
+    malloc(sizeof(proc_report_block_t) + sizeof(proc_usage_t) * count);
+  if (report == NULL) {
+    return NULL;
+  }
+  report->kind = diagnostics_proc_report;
+  report->count = count;
+  report->task_count = sample->task_count;
+  report->active_count = sample->count;
+  report->entries = (proc_usage_t*)(void*)(report + 1);
+
+  qsort(
+    sample->entries,
+    sample->count,
+    sizeof(proc_delta_t),
+    proc_delta_compare
+  );
+  long ticks_per_second = sysconf(_SC_CLK_TCK);
+  double scale = 0;
+  if (sample->elapsed > 0 && ticks_per_second > 0) {
+    scale = 100.0 / (sample->elapsed * (double)ticks_per_second);
+  }
+  for (size_t i = 0; i < count; ++i) {
+    const proc_delta_t* delta = &(sample->entries[i]);
+    report->entries[i] = (proc_usage_t){
+      .tid = delta->tid,
+      .tgid = delta->tgid,
+      .user = (double)delta->utime * scale,
+      .system = (double)delta->stime * scale
+    };
+    memcpy(report->entries[i].comm, delta->comm, PROC_COMM_SIZE);
+  }
+  return report;
+}
+
+void proc_report_free(proc_report_t report) {
+  free(report);
+}
@@ -0,0 +1,279 @@
+#ifndef SKAI_CPU_DIAGNOSTICS_PROCESS_H
+#define SKAI_CPU_DIAGNOSTICS_PROCESS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "message.h"
+
+/**
+ * @file Per-process and per-thread cpu accounting over /proc/<pid>/stat.
+ * 
+ * Meant to keep up with tens of thousands of tasks at 1Hz, so directories are
+ * listed with getdents64 on descriptors kept open, stat files of known tasks
+ * stay open between ticks and are reread with pread, parsing is done without
+ * stdio and per-task state is kept in an open addressing hash table.
+ */
+
+/**
+ * @brief Length of the command name kept for each task, same as the kernel's
+ * TASK_COMM_LEN.
+ */
+enum {
+  PROC_COMM_SIZE = 16
+};
+
+/**
+ * @brief Flags accepted by proc_collector_open.
+ */
+enum proc_collector_flags {
+  proc_collect_processes = 0,   /**<One entry per process*/
+  proc_collect_threads = 1      /**<One entry per thread, found in
+                                    /proc/<pid>/task*/
+};
+
+/**
+ * @brief State of a single task kept between ticks.
+ * 
+ * Accessing struct fields directly is not recommended.
+ */
+typedef struct proc_entry {
+  int32_t tid;                  /**<Key, 0 marks an empty slot*/
+  int32_t tgid;                 /**<Process the task belongs to*/
+  int fd;                       /**<Cached stat descriptor, -1 if it
+                                    couldn't be opened, the file is opened
+                                    again on the next read then*/
+  unsigned generation;          /**<Tick in which the task was last listed*/
+  uint64_t start_time;          /**<Tells a reused id from the same task*/
+  uint64_t utime;               /**<Last user time reading, in clock ticks*/
+  uint64_t stime;               /**<Last system time reading, in clock ticks*/
+  bool fresh;                   /**<No reading to compare against yet*/
+  char comm[PROC_COMM_SIZE];    /**<Command name, null terminated*/
+} proc_entry_t;
+
+/**
+ * @brief Open addressing hash table of tasks keyed by their id, with linear
+ * probing and backward shift deletion, so it never accumulates tombstones.
+ * 
+ * Accessing struct fields directly is not recommended.
+ */
+typedef struct proc_table {
+  proc_entry_t* slots;  /**<Owned array of capacity slots*/
+  size_t capacity;      /**<Power of 2*/
+  size_t count;         /**<Number of occupied slots*/
+} proc_table_t;
+
+/**
+ * @brief Usage of a single task between two ticks.
+ */
+typedef struct proc_delta {
+  int32_t tid;                  /**<Task id*/
+  int32_t tgid;                 /**<Process the task belongs to*/
+  uint64_t utime;               /**<User time spent, in clock ticks*/
+  uint64_t stime;               /**<System time spent, in clock ticks*/
+  char comm[PROC_COMM_SIZE];    /**<Command name, null terminated*/
+} proc_delta_t;
+
+/**
+ * @brief Message with the tasks that used the cpu between two ticks, header
+ * and entries in a single allocation.
+ */
+typedef struct proc_sample_block {
+  diagnostics_message_kind_t kind;  /**<Always diagnostics_proc_sample*/
+  size_t count;                 /**<Number of entries*/
+  size_t task_count;            /**<Number of tasks seen in the tick*/
+  double elapsed;               /**<Seconds between the two ticks*/
+  proc_delta_t* entries;        /**<Only the tasks with non-zero usage*/
+} proc_sample_block_t;
+
+/**
+ * @brief Handle to the tasks' usage, should be handled with associated
+ * functions.
+ */
+typedef proc_sample_block_t* proc_sample_t;
+
+/**
+ * @brief Usage of a single task as percentage of one core.
+ */
+typedef struct proc_usage {
+  int32_t tid;                  /**<Task id*/
+  int32_t tgid;                 /**<Process the task belongs to*/
+  double user;                  /**<Percentage spent in user mode*/
+  double system;                /**<Percentage spent in kernel mode*/
+  char comm[PROC_COMM_SIZE];    /**<Command name, null terminated*/
+} proc_usage_t;
+
+/**
+ * @brief Message with the tasks using the most cpu, sorted from the top one.
+ */
+typedef struct proc_report_block {
+  diagnostics_message_kind_t kind;  /**<Always diagnostics_proc_report*/
+  size_t count;                 /**<Number of entries*/
+  size_t task_count;            /**<Number of tasks seen in the tick*/
+  size_t active_count;          /**<Number of tasks with non-zero usage*/
+  proc_usage_t* entries;        /**<Sorted by total usage, descending*/
+} proc_report_block_t;
+
+/**
+ * @brief Handle to the report, should be handled with associated functions.
+ */
+typedef proc_report_block_t* proc_report_t;
+
+/**
+ * @brief Collector of per-task usage under a /proc-like directory.
+ * 
+ * Accessing struct fields directly is not recommended.
+ */
+typedef struct proc_collector {
+  int root_fd;                  /**<Descriptor of the /proc directory*/
+  int flags;                    /**<proc_collector_flags*/
+  proc_table_t table;           /**<Known tasks*/
+  char* dirent_buffer;          /**<Owned buffer for getdents64, split
+                                    between the root and task directories*/
+  size_t dirent_buffer_size;    /**<Capacity of the buffer*/
+  proc_delta_t* scratch;        /**<Owned buffer deltas are gathered in*/
+  size_t scratch_size;          /**<Capacity of the scratch buffer*/
+  unsigned generation;          /**<Number of the current tick*/
+  struct timespec timestamp;    /**<CLOCK_MONOTONIC time of the last tick*/
+} proc_collector_t;
+
+/**
+ * @brief Creates an empty table.
+ * 
+ * @param table 
+ * @param capacity Initial capacity, rounded up to a power of 2
+ * @return 0 on success, non-0 value on allocation failure.
+ */
+int proc_table_init(proc_table_t table[static 1], size_t capacity);
+
+/**
+ * @brief Frees the slots, doesn't close any descriptors.
+ * 
+ * @param table 
+ */
+void proc_table_destroy(proc_table_t table[static 1]);
+
+/**
+ * @brief Looks the task up.
+ * 
+ * @param table 
+ * @param tid Positive task id
+ * @return Pointer to the entry or NULL if there's none, invalidated by
+ * insertions and removals.
+ */
+proc_entry_t* proc_table_find(proc_table_t table[static 1], int32_t tid);
+
+/**
+ * @brief Inserts a zeroed entry for the task or returns the existing one.
+ * 
+ * Grows the table once it gets half full.
+ * 
+ * @param table 
+ * @param tid Positive task id
+ * @param inserted Set to whether a new entry was created
+ * @return Pointer to the entry, invalidated by further insertions and
+ * removals, NULL on allocation failure.
+ */
+proc_entry_t* proc_table_insert(
+  proc_table_t table[static 1],
+  int32_t tid,
+  bool inserted[static 1]
+);
+
+/**
+ * @brief Removes the entry in the slot, moving later entries of its cluster
+ * back.
+ * 
+ * Entries can only move into the slot itself or after it, so a caller walking
+ * the slots in order has to recheck the same index after a removal, entries
+ * of a cluster wrapping around the end might then be visited twice.
+ * 
+ * @param table 
+ * @param slot Index of an occupied slot
+ */
+void proc_table_remove_at(proc_table_t table[static 1], size_t slot);
+
+/**
+ * @brief Parses the contents of a /proc/<pid>/stat file.
+ * 
+ * The command name may contain spaces and parentheses, so fields are counted
+ * from the last closing parenthesis.
+ * 
+ * @param begin First character of the text
+ * @param end One past the last character of the text
+ * @param entry Receives comm, utime, stime and start_time
+ * @return 0 on success, non-0 value if the text is malformed.
+ */
+int proc_stat_parse(
+  const char* begin,
+  const char* end,
+  proc_entry_t entry[static 1]
+);
+
+/**
+ * @brief Opens the directory for collecting.
+ * 
+ * @param collector Collector to initialize
+ * @param root Path to /proc or a directory with the same structure
+ * @param flags One of proc_collector_flags
+ * @return 0 on success, non-0 value if either opening the directory or an
+ * allocation failed, in which case nothing has to be cleaned up.
+ */
+int proc_collector_open(
+  proc_collector_t collector[static 1],
+  const char root[static 1],
+  int flags
+);
+
+/**
+ * @brief Closes all the descriptors and frees everything owned by the
+ * collector.
+ * 
+ * @param collector 
+ */
+void proc_collector_close(proc_collector_t collector[static 1]);
+
+/**
+ * @brief Lists the tasks, rereads their stat files and returns their usage
+ * since the previous tick.
+ * 
+ * New tasks are only recorded, so they show up starting with the next tick,
+ * tasks that disappeared are dropped together with their descriptors.
+ * 
+ * @param collector 
+ * @param sample Set to the new sample on success, owned by the caller
+ * @return 0 on success, EOF if the directory couldn't be listed, -1 on
+ * allocation failure.
+ */
+int proc_collector_sample(
+  proc_collector_t collector[static 1],
+  proc_sample_t sample[static 1]
+);
+
+/**
+ * @brief Returns the number of tasks known to the collector.
+ * 
+ * @param collector 
+ * @return size_t
+ */
+size_t proc_collector_task_count(proc_collector_t collector[static 1]);
+
+void proc_sample_free(proc_sample_t sample);
+
+/**
+ * @brief Turns the sample into percentages and keeps the top users.
+ * 
+ * Percentages are relative to a single core, so a task running on several
+ * cores can go over 100.
+ * 
+ * @param sample Its entries get sorted in the process
+ * @param top_count Maximum number of entries in the report
+ * @return New report, NULL on allocation failure.
+ */
+proc_report_t proc_report_create(proc_sample_t sample, size_t top_count);
+
+void proc_report_free(proc_report_t report);
+
+#endif
@@ -0,0 +1,138 @@
+#include "stat_pool.h"
+
+int stat_pool_init(
+  stat_pool_t pool[static 1],
+  diagnostics_message_kind_t kind,
+  size_t capacity
+) {
+  int queue_flag = mpsc_queue_init(&(pool->returned));
+  if (queue_flag) {
+    return queue_flag;
+  }
+  pool->kind = kind;
+  pool->capacity = capacity;
+  pool->created = 0;
+  pool->allocations = 0;
+  return 0;
+}
+
+static stat_cpu_array_t stat_pool_sample_from_link(mpsc_node_t* link) {
+  return (stat_cpu_array_t)(void*)
+    ((char*)link - offsetof(stat_cpu_block_t, link));
+}
+
+static stat_cpu_percentage_array_t stat_pool_usage_from_link(
+  mpsc_node_t* link
+) {
+  return (stat_cpu_percentage_array_t)(void*)
+    ((char*)link - offsetof(stat_cpu_percentage_block_t, link));
+}
+
+/**
+ * @brief Frees the buffer for real, taking it out of the pool.
+ */
+static void stat_pool_discard(
+  stat_pool_t pool[static 1],
+  mpsc_node_t link[static 1]
+) {
+  pool->created -= 1;
+  if (pool->kind == diagnostics_cpu_sample) {
+    stat_cpu_array_t array = stat_pool_sample_from_link(link);
+    array->pool = NULL;
+    stat_cpu_array_free(array);
+  } else {
+    stat_cpu_percentage_array_t array = stat_pool_usage_from_link(link);
+    array->pool = NULL;
+    stat_cpu_percentage_array_free(array);
+  }
+}
+
+void stat_pool_destroy(stat_pool_t pool[static 1]) {
+  mpsc_node_t* link;
+  while ((link = mpsc_queue_pop(&(pool->returned))) != NULL) {
+    stat_pool_discard(pool, link);
+  }
+  mpsc_queue_destroy(&(pool->returned));
+}
+
+stat_cpu_array_t stat_pool_take_sample(
+  stat_pool_t pool[static 1],
+  stat_layout_version_t* layout
+) {
+  if (pool->kind != diagnostics_cpu_sample) {
+    return NULL;
+  }
+  mpsc_node_t* link = mpsc_queue_pop(&(pool->returned));
+  stat_cpu_array_t array =
+    (link != NULL) ? stat_pool_sample_from_link(link) : NULL;
+  if (
+    array != NULL && (
+      array->cpu_count != layout->layout.cpu_count ||
+      array->cpu_column_count != layout->layout.cpu_column_count
+    )
+  ) {
+    //left from before the layout changed, replaced by one that fits
+    stat_pool_discard(pool, link);
+    array = NULL;
+  }
+  if (array == NULL) {
+    array = stat_cpu_array_create_l(&(layout->layout));
+    if (array == NULL) {
+      return NULL;
+    }
+    pool->allocations += 1;
+    if (pool->created < pool->capacity) {
+      array->pool = pool;
+      pool->created += 1;
+    }
+  } else {
+    array->source = NULL;
+    array->timestamp = (struct timespec){0};
+    array->system = (stat_system_t){0};
+  }
+  array->layout = stat_layout_version_acquire(layout);
+  return array;
+}
+
+stat_cpu_percentage_array_t stat_pool_take_usage(
+  stat_pool_t pool[static 1],
+  stat_layout_version_t* layout
+) {
+  if (pool->kind != diagnostics_cpu_usage) {
+    return NULL;
+  }
+  mpsc_node_t* link = mpsc_queue_pop(&(pool->returned));
+  stat_cpu_percentage_array_t array =
+    (link != NULL) ? stat_pool_usage_from_link(link) : NULL;
+  if (array != NULL && array->cpu_count != layout->layout.cpu_count) {
+    stat_pool_discard(pool, link);
+    array = NULL;
+  }
+  if (array == NULL) {
+    array = stat_cpu_percentage_array_create_l(&(layout->layout));
+    if (array == NULL) {
+      return NULL;
+    }
+    pool->allocations += 1;
+    if (pool->created < pool->capacity) {
+      array->pool = pool;
+      pool->created += 1;
+    }
+  } else {
+    array->source = NULL;
+    array->system = (stat_system_rates_t){0};
+  }
+  array->layout = stat_layout_version_acquire(layout);
+  return array;
+}
+
+void stat_pool_give_back(
+  stat_pool_t pool[static 1],
+  mpsc_node_t link[static 1]
+) {
+  mpsc_queue_push(&(pool->returned), link);
+}
+
+size_t stat_pool_allocations(stat_pool_t pool[static 1]) {
+  return pool->allocations;
+}
@@ -0,0 +1,110 @@
+#ifndef SKAI_CPU_DIAGNOSTICS_STAT_POOL_H
+#define SKAI_CPU_DIAGNOSTICS_STAT_POOL_H
+
+#include <stddef.h>
+
+#include "linux.h"
+#include "message.h"
+#include "data_structures/mpsc_queue.h"
+
+/**
+ * @file Recycling of samples and usage percentages between the pipeline
+ * stages.
+ * 
+ * A pool belongs to the single thread that creates the buffers, the stage
+ * consuming them hands them back simply by freeing them, from whichever
+ * thread, through a lock-free queue. Buffers are made as they're needed, up
+ * to the capacity, after which the pipeline runs on recycled ones only.
+ */
+
+/**
+ * @brief Pool of buffers of one kind, either diagnostics_cpu_sample or
+ * diagnostics_cpu_usage.
+ * 
+ * Buffers past the capacity come from the heap and go back to it, so a stalled
+ * consumer can't exhaust the pool.
+ * 
+ * Accessing struct fields directly is not recommended.
+ */
+typedef struct stat_pool {
+  mpsc_queue_t returned;    /**<Buffers handed back, taken by the owner*/
+  diagnostics_message_kind_t kind;  /**<Kind of the pooled buffers*/
+  size_t capacity;          /**<Maximal number of pooled buffers*/
+  size_t created;           /**<Number of pooled buffers in existence*/
+  size_t allocations;       /**<Number of heap allocations made by taking*/
+} stat_pool_t;
+
+/**
+ * @brief Initializes an empty pool.
+ * 
+ * @param pool Pool to initialize
+ * @param kind diagnostics_cpu_sample or diagnostics_cpu_usage
+ * @param capacity Maximal number of pooled buffers, which should cover the
+ * buffers in flight between the owner and the consumers
+ * @return 0 on success, non-0 value on error.
+ */
+int stat_pool_init(
+  stat_pool_t pool[static 1],
+  diagnostics_message_kind_t kind,
+  size_t capacity
+);
+
+/**
+ * @brief Frees the pooled buffers, all of them have to be handed back
+ * beforehand.
+ * 
+ * @param pool 
+ */
+void stat_pool_destroy(stat_pool_t pool[static 1]);
+
+/**
+ * @brief Takes a sample tagged with the layout, recycling a handed back one
+ * if it has the same dimensions, to be called only by the owner.
+ * 
+ * Fields of a recycled sample keep their old values.
+ * 
+ * @param pool Pool of diagnostics_cpu_sample kind
+ * @param layout Snapshot the sample takes a reference to
+ * @return stat_cpu_array_t freed with stat_cpu_array_free, NULL on allocation
+ * failure or if the pool holds the other kind.
+ */
+stat_cpu_array_t stat_pool_take_sample(
+  stat_pool_t pool[static 1],
+  stat_layout_version_t* layout
+);
+
+/**
+ * @brief Takes percentages tagged with the layout, recycling handed back ones
+ * if they have the same number of rows, to be called only by the owner.
+ * 
+ * @param pool Pool of diagnostics_cpu_usage kind
+ * @param layout Snapshot the percentages take a reference to
+ * @return stat_cpu_percentage_array_t freed with
+ * stat_cpu_percentage_array_free, NULL on allocation failure or if the pool
+ * holds the other kind.
+ */
+stat_cpu_percentage_array_t stat_pool_take_usage(
+  stat_pool_t pool[static 1],
+  stat_layout_version_t* layout
+);
+
+/**
+ * @brief Hands a buffer back to its pool without locking, done by the free
+ * functions of the buffers.
+ * 
+ * @param pool 
+ * @param link Link of the buffer
+ */
+void stat_pool_give_back(
+  stat_pool_t pool[static 1],
+  mpsc_node_t link[static 1]
+);
+
+/**
+ * @param pool 
+ * @return Number of heap allocations made by taking so far, which stops
+ * growing once the pipeline runs on recycled buffers.
+ */
+size_t stat_pool_allocations(stat_pool_t pool[static 1]);
+
+#endif
@@ -0,0 +1,275 @@
+#include "broadcast.h"
+
+#include <stdlib.h>
+
+int broadcast_init(
+  broadcast_t broadcast[static 1],
+  size_t capacity,
+  size_t max_subscribers,
+  queue_deleter deleter
+) {
+  size_t rounded = 2;
+  while (rounded < capacity) {
+    rounded *= 2;
+  }
+  broadcast->slots = malloc(sizeof(broadcast_slot_t) * rounded);
+  if (broadcast->slots == NULL) {
+    return -1;
+  }
+  //size of an over-aligned struct is a multiple of its alignment
+  broadcast->subscribers = aligned_alloc(
+    BROADCAST_CACHE_LINE,
+    sizeof(broadcast_subscriber_t) * (max_subscribers ? max_subscribers : 1)
+  );
+  if (broadcast->subscribers == NULL) {
+    free(broadcast->slots);
+    return -1;
+  }
+  int mtx_flag = mtx_init(&(broadcast->lock), mtx_plain);
+  if (mtx_flag != thrd_success) {
+    free(broadcast->subscribers);
+    free(broadcast->slots);
+    return mtx_flag;
+  }
+  int cnd_flag = cnd_init(&(broadcast->wait));
+  if (cnd_flag != thrd_success) {
+    mtx_destroy(&(broadcast->lock));
+    free(broadcast->subscribers);
+    free(broadcast->slots);
+    return cnd_flag;
+  }
+  for (size_t i = 0; i < rounded; ++i) {
+    atomic_init(&(broadcast->slots[i].refs), 0);
+    broadcast->slots[i].message = NULL;
+  }
+  atomic_init(&(broadcast->tail), 0);
+  atomic_init(&(broadcast->waiting), 0);
+  broadcast->mask = rounded - 1;
+  broadcast->subscriber_count = 0;
+  broadcast->max_subscribers = max_subscribers;
+  broadcast->deleter = deleter;
+  return 0;
+}
+
+/**
+ * @brief Drops one reference to the message of the sequence, the last one
+ * hands it to the deleter.
+ */
+static void broadcast_release_sequence(
+  broadcast_t broadcast[static 1],
+  size_t sequence
+) {
+  broadcast_slot_t* slot = &(broadcast->slots[sequence & broadcast->mask]);
+  //read before the release, the publisher may reuse the slot right after it
+  void* message = slot->message;
+  size_t refs =
+    atomic_fetch_sub_explicit(&(slot->refs), 1, memory_order_acq_rel);
+  if (refs == 1 && broadcast->deleter != NULL) {
+    broadcast->deleter(message);
+  }
+}
+
+void broadcast_destroy(broadcast_t broadcast[static 1]) {
+  size_t tail = atomic_load_explicit(&(broadcast->tail), memory_order_acquire);
+  for (size_t i = 0; i < broadcast->subscriber_count; ++i) {
+    broadcast_subscriber_t* subscriber = &(broadcast->subscribers[i]);
+    broadcast_release(subscriber);
+    size_t cursor =
+      atomic_load_explicit(&(subscriber->cursor), memory_order_acquire);
+    for (; cursor != tail; ++cursor) {
+      broadcast_release_sequence(broadcast, cursor);
+    }
+    atomic_store_explicit(&(subscriber->cursor), tail, memory_order_relaxed);
+  }
+  cnd_destroy(&(broadcast->wait));
+  mtx_destroy(&(broadcast->lock));
+  free(broadcast->subscribers);
+  free(broadcast->slots);
+  broadcast->subscribers = NULL;
+  broadcast->slots = NULL;
+  broadcast->subscriber_count = 0;
+}
+
+broadcast_subscriber_t* broadcast_subscribe(
+  broadcast_t broadcast[static 1],
+  broadcast_policy_t policy
+) {
+  if (broadcast->subscriber_count == broadcast->max_subscribers) {
+    return NULL;
+  }
+  broadcast_subscriber_t* subscriber =
+    &(broadcast->subscribers[broadcast->subscriber_count]);
+  atomic_init(
+    &(subscriber->cursor),
+    atomic_load_explicit(&(broadcast->tail), memory_order_relaxed)
+  );
+  atomic_init(&(subscriber->dropped), 0);
+  subscriber->policy = policy;
+  subscriber->holding = false;
+  subscriber->held = 0;
+  subscriber->broadcast = broadcast;
+  broadcast->subscriber_count += 1;
+  return subscriber;
+}
+
+/**
+ * @brief Moves a subscriber falling behind past the sequences that are about
+ * to be overwritten.
+ * 
+ * @param oldest First sequence the subscriber is allowed to be at
+ */
+static void broadcast_skip(
+  broadcast_t broadcast[static 1],
+  broadcast_subscriber_t subscriber[static 1],
+  size_t oldest
+) {
+  size_t cursor =
+    atomic_load_explicit(&(subscriber->cursor), memory_order_relaxed);
+  while (cursor < oldest) {
+    //the subscriber races for the same message, whoever moves the cursor
+    //owns its reference
+    if (
+      atomic_compare_exchange_weak_explicit(
+        &(subscriber->cursor),
+        &cursor,
+        cursor + 1,
+        memory_order_acq_rel,
+        memory_order_relaxed
+      )
+    ) {
+      broadcast_release_sequence(broadcast, cursor);
+      atomic_fetch_add_explicit(
+        &(subscriber->dropped),
+        1,
+        memory_order_relaxed
+      );
+      cursor += 1;
+    }
+  }
+}
+
+int broadcast_publish(broadcast_t broadcast[static 1], void* message) {
+  if (broadcast->subscriber_count == 0) {
+    if (broadcast->deleter != NULL) {
+      broadcast->deleter(message);
+    }
+    return 0;
+  }
+  size_t tail = atomic_load_explicit(&(broadcast->tail), memory_order_relaxed);
+  size_t capacity = broadcast->mask + 1;
+  if (tail >= capacity) {
+    size_t oldest = tail - capacity + 1;
+    //lossless subscribers are checked first, so a declined message doesn't
+    //make the others drop anything
+    for (size_t i = 0; i < broadcast->subscriber_count; ++i) {
+      broadcast_subscriber_t* subscriber = &(broadcast->subscribers[i]);
+      size_t cursor =
+        atomic_load_explicit(&(subscriber->cursor), memory_order_acquire);
+      if (subscriber->policy == broadcast_lossless && cursor < oldest) {
+        return thrd_busy;
+      }
+    }
+    for (size_t i = 0; i < broadcast->subscriber_count; ++i) {
+      broadcast_subscriber_t* subscriber = &(broadcast->subscribers[i]);
+      if (subscriber->policy == broadcast_drop_oldest) {
+        broadcast_skip(broadcast, subscriber, oldest);
+      }
+    }
+  }
+  broadcast_slot_t* slot = &(broadcast->slots[tail & broadcast->mask]);
+  if (atomic_load_explicit(&(slot->refs), memory_order_acquire) != 0) {
+    //a subscriber is still holding the message taken from this slot
+    return thrd_busy;
+  }
+  slot->message = message;
+  atomic_store_explicit(
+    &(slot->refs),
+    broadcast->subscriber_count,
+    memory_order_relaxed
+  );
+  atomic_store_explicit(&(broadcast->tail), tail + 1, memory_order_release);
+  //pairs with the fence in broadcast_take_wait_t, either the subscriber sees
+  //the new tail or the publisher sees it waiting
+  atomic_thread_fence(memory_order_seq_cst);
+  if (atomic_load_explicit(&(broadcast->waiting), memory_order_relaxed)) {
+    mtx_lock(&(broadcast->lock));
+    cnd_broadcast(&(broadcast->wait));
+    mtx_unlock(&(broadcast->lock));
+  }
+  return 0;
+}
+
+const void* broadcast_take(broadcast_subscriber_t subscriber[static 1]) {
+  broadcast_release(subscriber);
+  broadcast_t* broadcast = subscriber->broadcast;
+  size_t cursor =
+    atomic_load_explicit(&(subscriber->cursor), memory_order_relaxed);
+  while (true) {
+    size_t tail =
+      atomic_load_explicit(&(broadcast->tail), memory_order_acquire);
+    if (cursor == tail) {
+      return NULL;
+    }
+    //fails when the publisher skipped the subscriber forward meanwhile
+    if (
+      atomic_compare_exchange_weak_explicit(
+        &(subscriber->cursor),
+        &cursor,
+        cursor + 1,
+        memory_order_acq_rel,
+        memory_order_relaxed
+      )
+    ) {
+      break;
+    }
+  }
+  subscriber->holding = true;
+  subscriber->held = cursor;
+  return broadcast->slots[cursor & broadcast->mask].message;
+}
+
+const void* broadcast_take_wait_t(
+  broadcast_subscriber_t subscriber[static 1],
+  timepoint_t timepoint
+) {
+  const void* message = broadcast_take(subscriber);
+  if (message != NULL) {
+    return message;
+  }
+  broadcast_t* broadcast = subscriber->broadcast;
+  int mtx_flag = mtx_lock(&(broadcast->lock));
+  if (mtx_flag != thrd_success) {
+    return NULL;
+  }
+  atomic_fetch_add_explicit(&(broadcast->waiting), 1, memory_order_relaxed);
+  while (true) {
+    atomic_thread_fence(memory_order_seq_cst);
+    message = broadcast_take(subscriber);
+    if (message != NULL) {
+      break;
+    }
+    //publisher wakes the subscribers only under the lock, so it can't slip
+    //in before the wait starts
+    int cnd_flag =
+      cnd_timedwait(&(broadcast->wait), &(broadcast->lock), &timepoint);
+    if (cnd_flag != thrd_success) {
+      message = broadcast_take(subscriber);
+      break;
+    }
+  }
+  atomic_fetch_sub_explicit(&(broadcast->waiting), 1, memory_order_relaxed);
+  mtx_unlock(&(broadcast->lock));
+  return message;
+}
+
+void broadcast_release(broadcast_subscriber_t subscriber[static 1]) {
+  if (!subscriber->holding) {
+    return;
+  }
+  subscriber->holding = false;
+  broadcast_release_sequence(subscriber->broadcast, subscriber->held);
+}
+
+size_t broadcast_dropped(broadcast_subscriber_t subscriber[static 1]) {
+  return atomic_load_explicit(&(subscriber->dropped), memory_order_relaxed);
+}
@@ -0,0 +1,191 @@
+#ifndef SKAI_DATA_STRUCTURES_BROADCAST_H
+#define SKAI_DATA_STRUCTURES_BROADCAST_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <threads.h>
+
+#include "queue.h"
+#include "utilities/time.h"
+
+/**
+ * @file Fan-out of messages from one publisher thread to several subscriber
+ * threads, each message is published once and shared by all of them.
+ * 
+ * Published messages sit in a ring of slots, every slot counts the
+ * subscribers that still have to release its message, the last one to do so
+ * hands the message to the deleter, e.g. back to its pool. Subscribers only
+ * get pointers to the shared message, which they must not modify, so there's
+ * no copying per subscriber. Each subscriber has its own cursor in the ring
+ * and its own policy for when it falls a whole ring behind the publisher.
+ */
+
+/**
+ * @brief Assumed size of a cache line, cursors of different subscribers are
+ * kept this far apart.
+ */
+enum { BROADCAST_CACHE_LINE = 64 };
+
+/**
+ * @brief Handling of a subscriber that would miss a message because the
+ * publisher got a whole ring ahead of it.
+ */
+typedef enum broadcast_policy {
+  broadcast_lossless,       /**<Publisher is declined until the subscriber
+                                catches up*/
+  broadcast_drop_oldest     /**<Oldest messages the subscriber hasn't taken
+                                yet are skipped*/
+} broadcast_policy_t;
+
+/**
+ * @brief Slot of the ring, reused once every subscriber released its
+ * message.
+ */
+typedef struct broadcast_slot {
+  atomic_size_t refs;   /**<Number of subscribers yet to release the
+                            message*/
+  void* message;        /**<Shared message, written only by the publisher*/
+} broadcast_slot_t;
+
+struct broadcast;
+
+/**
+ * @brief Position of a single subscriber in the ring, used only by the
+ * subscriber thread, apart from the publisher skipping it forward.
+ * 
+ * Accessing struct fields directly is not recommended.
+ */
+typedef struct broadcast_subscriber {
+  _Alignas(BROADCAST_CACHE_LINE) atomic_size_t cursor;  /**<Sequence of the
+                                                            next message to
+                                                            take*/
+  atomic_size_t dropped;        /**<Messages skipped by the publisher*/
+  broadcast_policy_t policy;    /**<Handling of falling behind*/
+  bool holding;                 /**<Whether a taken message is held*/
+  size_t held;                  /**<Sequence of the held message*/
+  struct broadcast* broadcast;  /**<Channel the subscriber belongs to*/
+} broadcast_subscriber_t;
+
+/**
+ * @brief Single-publisher channel delivering every message to all of its
+ * subscribers.
+ * 
+ * Sequences grow without wrapping around the capacity, the slot of
+ * a sequence is the sequence masked by capacity - 1.
+ * 
+ * Accessing struct fields directly is not recommended.
+ */
+typedef struct broadcast {
+  _Alignas(BROADCAST_CACHE_LINE) atomic_size_t tail;  /**<Sequence of the
+                                                          next published
+                                                          message*/
+  broadcast_slot_t* slots;      /**<Owned array of slots*/
+  size_t mask;                  /**<Capacity - 1, capacity being a power
+                                    of 2*/
+  broadcast_subscriber_t* subscribers;  /**<Owned array of subscribers*/
+  size_t subscriber_count;      /**<Number of subscribers*/
+  size_t max_subscribers;       /**<Length of the subscribers array*/
+  queue_deleter deleter;        /**<Called by the last release of a message
+                                    or NULL*/
+  atomic_uint waiting;          /**<Number of subscribers about to sleep or
+                                    sleeping*/
+  mtx_t lock;                   /**<Guards sleeping of the subscribers*/
+  cnd_t wait;                   /**<Subscribers sleep on it while they have
+                                    nothing to take*/
+} broadcast_t;
+
+/**
+ * @brief Initializes the channel with no subscribers.
+ * 
+ * @param broadcast Channel to initialize
+ * @param capacity Minimal number of messages in flight, rounded up to
+ * a power of 2
+ * @param max_subscribers Maximal number of subscribers
+ * @param deleter Called on a message once every subscriber released it or
+ * NULL for non-owning channel
+ * @return 0 on success, non-0 value on error.
+ */
+int broadcast_init(
+  broadcast_t broadcast[static 1],
+  size_t capacity,
+  size_t max_subscribers,
+  queue_deleter deleter
+);
+
+/**
+ * @brief Frees the channel, releasing messages the subscribers still hold or
+ * haven't taken.
+ * 
+ * @param broadcast 
+ */
+void broadcast_destroy(broadcast_t broadcast[static 1]);
+
+/**
+ * @brief Adds a subscriber, which gets every message published from now on,
+ * to be called before the publisher and subscriber threads start.
+ * 
+ * @param broadcast 
+ * @param policy Handling of the subscriber falling behind
+ * @return Subscriber owned by the channel, NULL if there's max_subscribers
+ * of them already.
+ */
+broadcast_subscriber_t* broadcast_subscribe(
+  broadcast_t broadcast[static 1],
+  broadcast_policy_t policy
+);
+
+/**
+ * @brief Publishes the message to all subscribers without blocking, to be
+ * called only by the publisher thread.
+ * 
+ * A message published with no subscribers is deleted right away.
+ * 
+ * @param broadcast 
+ * @param message Pointer to the message, which becomes immutable
+ * @return 0 on success, thrd_busy if a lossless subscriber is a whole ring
+ * behind or a subscriber still holds the message in the slot, in which case
+ * the ownership stays with the caller.
+ */
+int broadcast_publish(broadcast_t broadcast[static 1], void* message);
+
+/**
+ * @brief Takes the next message without blocking, releasing the previously
+ * taken one, to be called only by the subscriber thread.
+ * 
+ * @param subscriber 
+ * @return Pointer to the shared message, valid until it's released, NULL if
+ * there's nothing new.
+ */
+const void* broadcast_take(broadcast_subscriber_t subscriber[static 1]);
+
+/**
+ * @brief Blocks until it can take the next message or until a specific
+ * timepoint, releasing the previously taken one, to be called only by the
+ * subscriber thread.
+ * 
+ * @param subscriber 
+ * @param timepoint Deadline in the same clock as timepoint_now
+ * @return Pointer to the shared message, valid until it's released, NULL if
+ * nothing came before the timeout.
+ */
+const void* broadcast_take_wait_t(
+  broadcast_subscriber_t subscriber[static 1],
+  timepoint_t timepoint
+);
+
+/**
+ * @brief Releases the taken message, if there's one, to be called only by
+ * the subscriber thread.
+ * 
+ * @param subscriber 
+ */
+void broadcast_release(broadcast_subscriber_t subscriber[static 1]);
+
+/**
+ * @param subscriber 
+ * @return Number of messages the subscriber missed by falling behind.
+ */
+size_t broadcast_dropped(broadcast_subscriber_t subscriber[static 1]);
+
+#endif
@@ -0,0 +1,130 @@
+#include "byte_ring.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Length of the header preceding the contents of every frame, which
+ * keeps the contents aligned.
+ */
+enum {
+  BYTE_RING_HEADER = BYTE_RING_ALIGNMENT
+};
+
+/**
+ * @brief Length stored in the header of the space skipped before the end of
+ * the buffer.
+ */
+static const size_t byte_ring_skip_marker = SIZE_MAX;
+
+static size_t byte_ring_frame_length(size_t size) {
+  size_t length = BYTE_RING_HEADER + size + BYTE_RING_ALIGNMENT - 1;
+  return length & ~(size_t)(BYTE_RING_ALIGNMENT - 1);
+}
+
+int byte_ring_init(byte_ring_t ring[static 1], size_t capacity) {
+  size_t rounded = 4 * BYTE_RING_HEADER;
+  while (rounded < capacity) {
+    rounded *= 2;
+  }
+  ring->bytes = aligned_alloc(BYTE_RING_CACHE_LINE, rounded);
+  if (ring->bytes == NULL) {
+    return -1;
+  }
+  atomic_init(&(ring->head), 0);
+  atomic_init(&(ring->tail), 0);
+  ring->tail_cache = 0;
+  ring->head_cache = 0;
+  ring->skipped = 0;
+  ring->mask = rounded - 1;
+  return 0;
+}
+
+void byte_ring_destroy(byte_ring_t ring[static 1]) {
+  free(ring->bytes);
+  ring->bytes = NULL;
+}
+
+size_t byte_ring_max_frame(byte_ring_t ring[static 1]) {
+  //a frame of half the capacity always fits once the ring is empty, no
+  //matter where the skipped space ends
+  return (ring->mask + 1) / 2 - BYTE_RING_HEADER;
+}
+
+void* byte_ring_reserve(byte_ring_t ring[static 1], size_t size) {
+  if (size > byte_ring_max_frame(ring)) {
+    return NULL;
+  }
+  size_t capacity = ring->mask + 1;
+  size_t tail = atomic_load_explicit(&(ring->tail), memory_order_relaxed);
+  size_t offset = tail & ring->mask;
+  size_t to_end = capacity - offset;
+  size_t length = byte_ring_frame_length(size);
+  size_t skipped = (length > to_end) ? to_end : 0;
+  //the head is reloaded only when the cached one says there's no space
+  if (tail + skipped + length - ring->head_cache > capacity) {
+    ring->head_cache =
+      atomic_load_explicit(&(ring->head), memory_order_acquire);
+    if (tail + skipped + length - ring->head_cache > capacity) {
+      return NULL;
+    }
+  }
+  if (skipped != 0) {
+    memcpy(ring->bytes + offset, &byte_ring_skip_marker, sizeof(size_t));
+    offset = 0;
+  }
+  ring->skipped = skipped;
+  return ring->bytes + offset + BYTE_RING_HEADER;
+}
+
+void byte_ring_commit(byte_ring_t ring[static 1], size_t size) {
+  size_t tail = atomic_load_explicit(&(ring->tail), memory_order_relaxed);
+  size_t start = (tail + ring->skipped) & ring->mask;
+  memcpy(ring->bytes + start, &size, sizeof(size_t));
+  atomic_store_explicit(
+    &(ring->tail),
+    tail + ring->skipped + byte_ring_frame_length(size),
+    memory_order_release
+  );
+  ring->skipped = 0;
+}
+
+void* byte_ring_peek(byte_ring_t ring[static 1], size_t size[static 1]) {
+  size_t head = atomic_load_explicit(&(ring->head), memory_order_relaxed);
+  while (true) {
+    if (head == ring->tail_cache) {
+      ring->tail_cache =
+        atomic_load_explicit(&(ring->tail), memory_order_acquire);
+      if (head == ring->tail_cache) {
+        return NULL;
+      }
+    }
+    size_t offset = head & ring->mask;
+    size_t length;
+    memcpy(&length, ring->bytes + offset, sizeof(size_t));
+    if (length != byte_ring_skip_marker) {
+      *size = length;
+      return ring->bytes + offset + BYTE_RING_HEADER;
+    }
+    //space before the end is handed back right away
+    head += ring->mask + 1 - offset;
+    atomic_store_explicit(&(ring->head), head, memory_order_release);
+  }
+}
+
+void byte_ring_consume(byte_ring_t ring[static 1]) {
+  size_t head = atomic_load_explicit(&(ring->head), memory_order_relaxed);
+  size_t length;
+  memcpy(&length, ring->bytes + (head & ring->mask), sizeof(size_t));
+  atomic_store_explicit(
+    &(ring->head),
+    head + byte_ring_frame_length(length),
+    memory_order_release
+  );
+}
+
+bool byte_ring_empty(byte_ring_t ring[static 1]) {
+  size_t size;
+  return byte_ring_peek(ring, &size) == NULL;
+}
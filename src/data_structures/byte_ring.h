@@ -0,0 +1,124 @@
+#ifndef SKAI_DATA_STRUCTURES_BYTE_RING_H
+#define SKAI_DATA_STRUCTURES_BYTE_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @file Fixed capacity ring of variable-length frames of bytes, written by
+ * exactly one producer thread and read by exactly one consumer thread
+ * without locks.
+ * 
+ * The producer reserves a contiguous frame, fills it in place and commits
+ * it, the consumer reads frames in place and consumes them, so nothing gets
+ * copied or allocated on the way. A frame that doesn't fit before the end of
+ * the buffer starts over at its beginning, the space left behind is skipped.
+ */
+
+/**
+ * @brief Granularity of the frames, every frame and its contents start at
+ * a multiple of it.
+ */
+enum {
+  BYTE_RING_ALIGNMENT = _Alignof(max_align_t),
+  BYTE_RING_CACHE_LINE = 64
+};
+
+/**
+ * @brief Single-producer single-consumer ring of frames.
+ * 
+ * Indices grow without wrapping around the capacity, the offset in the
+ * buffer is the index masked by capacity - 1. Every frame starts with
+ * a header holding the length of its contents.
+ * 
+ * Accessing struct fields directly is not recommended.
+ */
+typedef struct byte_ring {
+  _Alignas(BYTE_RING_CACHE_LINE) atomic_size_t head;  /**<Start of the oldest
+                                                          frame, written by
+                                                          the consumer*/
+  size_t tail_cache;        /**<Consumer's last view of the tail*/
+  _Alignas(BYTE_RING_CACHE_LINE) atomic_size_t tail;  /**<End of the newest
+                                                          frame, written by
+                                                          the producer*/
+  size_t head_cache;        /**<Producer's last view of the head*/
+  size_t skipped;           /**<Bytes left behind by the reserved frame*/
+  _Alignas(BYTE_RING_CACHE_LINE) unsigned char* bytes;  /**<Owned buffer*/
+  size_t mask;              /**<Capacity - 1, capacity being a power of 2*/
+} byte_ring_t;
+
+/**
+ * @brief Initializes the ring.
+ * 
+ * @param ring Ring to initialize
+ * @param capacity Minimal number of bytes, rounded up to a power of 2
+ * @return 0 on success, non-0 value on error.
+ */
+int byte_ring_init(byte_ring_t ring[static 1], size_t capacity);
+
+/**
+ * @brief Frees the buffer, frames left in it are plain bytes and need no
+ * cleanup.
+ * 
+ * @param ring 
+ */
+void byte_ring_destroy(byte_ring_t ring[static 1]);
+
+/**
+ * @param ring 
+ * @return Maximal length of the contents of a single frame, half of the
+ * capacity minus the header.
+ */
+size_t byte_ring_max_frame(byte_ring_t ring[static 1]);
+
+/**
+ * @brief Reserves a frame without blocking, to be called only by the
+ * producer thread.
+ * 
+ * The frame becomes visible to the consumer once it's committed, reserving
+ * again without committing discards it.
+ * 
+ * @param ring 
+ * @param size Length of the contents, at most byte_ring_max_frame
+ * @return Pointer to size writable bytes aligned to BYTE_RING_ALIGNMENT,
+ * NULL if the ring doesn't have the space or the frame is too long.
+ */
+void* byte_ring_reserve(byte_ring_t ring[static 1], size_t size);
+
+/**
+ * @brief Publishes the reserved frame, to be called only by the producer
+ * thread.
+ * 
+ * @param ring 
+ * @param size Length of the contents actually written, at most the reserved
+ * one
+ */
+void byte_ring_commit(byte_ring_t ring[static 1], size_t size);
+
+/**
+ * @brief Gets the oldest frame without consuming it, to be called only by
+ * the consumer thread.
+ * 
+ * @param ring 
+ * @param size Set to the length of the contents
+ * @return Pointer to the contents, valid until the frame is consumed, NULL
+ * if the ring is empty.
+ */
+void* byte_ring_peek(byte_ring_t ring[static 1], size_t size[static 1]);
+
+/**
+ * @brief Drops the oldest frame, handing its space back to the producer, to
+ * be called only by the consumer thread after a successful peek.
+ * 
+ * @param ring 
+ */
+void byte_ring_consume(byte_ring_t ring[static 1]);
+
+/**
+ * @param ring 
+ * @return true if the consumer has nothing to peek, false otherwise
+ */
+bool byte_ring_empty(byte_ring_t ring[static 1]);
+
+#endif
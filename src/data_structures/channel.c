@@ -0,0 +1,54 @@
+#include "channel.h"
+
+channel_t channel_from_queue(message_queue_t queue[static 1]) {
+  return (channel_t){.kind = channel_message_queue, .queue = queue};
+}
+
+channel_t channel_from_ring(spsc_ring_t ring[static 1]) {
+  return (channel_t){.kind = channel_spsc_ring, .ring = ring};
+}
+
+int channel_push(channel_t channel[static 1], void* message) {
+  switch (channel->kind) {
+    case channel_spsc_ring:
+      return spsc_ring_try_push(channel->ring, message);
+    case channel_message_queue:
+      break;
+  }
+  return message_queue_push(channel->queue, message);
+}
+
+void* channel_pop_wait_t(channel_t channel[static 1], timepoint_t timepoint) {
+  switch (channel->kind) {
+    case channel_spsc_ring:
+      return spsc_ring_pop_wait_t(channel->ring, timepoint);
+    case channel_message_queue:
+      break;
+  }
+  return message_queue_pop_wait_t(channel->queue, timepoint);
+}
+
+size_t channel_pop_batch_t(
+  channel_t channel[static 1],
+  void* messages[],
+  size_t max,
+  timepoint_t timepoint
+) {
+  if (max == 0) {
+    return 0;
+  }
+  switch (channel->kind) {
+    case channel_spsc_ring:
+      messages[0] = spsc_ring_pop_wait_t(channel->ring, timepoint);
+      if (messages[0] == NULL) {
+        return 0;
+      }
+      if (max == 1) {
+        return 1;
+      }
+      return 1 + spsc_ring_try_pop_batch(channel->ring, messages + 1, max - 1);
+    case channel_message_queue:
+      break;
+  }
+  return message_queue_pop_batch(channel->queue, messages, max, timepoint);
+}
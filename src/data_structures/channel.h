@@ -0,0 +1,89 @@
+#ifndef SKAI_DATA_STRUCTURES_CHANNEL_H
+#define SKAI_DATA_STRUCTURES_CHANNEL_H
+
+#include "message_queue.h"
+#include "spsc_ring.h"
+#include "utilities/time.h"
+
+/**
+ * @file Common interface of the queues pipeline stages pass messages through,
+ * so a stage doesn't need to know whether its hop has a single producer and
+ * can use a lock-free ring, or has to go through the mutex queue.
+ */
+
+/**
+ * @brief Kinds of queues a channel can wrap.
+ */
+typedef enum channel_kind {
+  channel_message_queue,    /**<message_queue_t, any number of producers*/
+  channel_spsc_ring         /**<spsc_ring_t, one producer and one consumer*/
+} channel_kind_t;
+
+/**
+ * @brief Non-owning handle to one of the queues, the queue itself has to
+ * outlive it.
+ */
+typedef struct channel {
+  channel_kind_t kind;
+  union {
+    message_queue_t* queue;
+    spsc_ring_t* ring;
+  };
+} channel_t;
+
+/**
+ * @brief Makes a channel over the mutex queue.
+ * 
+ * @param queue 
+ * @return channel_t 
+ */
+channel_t channel_from_queue(message_queue_t queue[static 1]);
+
+/**
+ * @brief Makes a channel over the ring.
+ * 
+ * @param ring 
+ * @return channel_t 
+ */
+channel_t channel_from_ring(spsc_ring_t ring[static 1]);
+
+/**
+ * @brief Pushes the message, never blocks on a ring.
+ * 
+ * @param channel 
+ * @param message 
+ * @return 0 on success, non-0 value if the queue failed or the ring is full,
+ * in which case the ownership stays with the caller.
+ */
+int channel_push(channel_t channel[static 1], void* message);
+
+/**
+ * @brief Blocks until it can pop a message or until a specific timepoint.
+ * 
+ * @param channel 
+ * @param timepoint 
+ * @return Pointer to the message, NULL if none came before the timeout,
+ * caller takes ownership.
+ */
+void* channel_pop_wait_t(channel_t channel[static 1], timepoint_t timepoint);
+
+/**
+ * @brief Blocks until there's at least one message or until a specific
+ * timepoint, then pops whatever else is already queued, up to max, without
+ * waiting for more.
+ * 
+ * @param channel 
+ * @param messages Buffer for the popped messages, at least max long
+ * @param max Maximal number of popped messages
+ * @param timepoint 
+ * @return Number of popped messages, 0 if none came before the timeout,
+ * caller takes ownership of them.
+ */
+size_t channel_pop_batch_t(
+  channel_t channel[static 1],
+  void* messages[],
+  size_t max,
+  timepoint_t timepoint
+);
+
+#endif
@@ -1,5 +1,14 @@
+//for ppoll
+#define _GNU_SOURCE
+
 #include "message_queue.h"
 
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
 int message_queue_init(
   message_queue_t message_queue[static 1],
   queue_deleter deleter
@@ -13,28 +22,394 @@ int message_queue_init(
     mtx_destroy(&(message_queue->lock));
     return cnd_flag;
   }
+  cnd_flag = cnd_init(&(message_queue->space));
+  if (cnd_flag != thrd_success) {
+    cnd_destroy(&(message_queue->wait));
+    mtx_destroy(&(message_queue->lock));
+    return cnd_flag;
+  }
   queue_init(&(message_queue->queue), deleter);
+  message_queue->capacity = 0;
+  message_queue->policy = message_queue_block;
+  message_queue->dropped = 0;
+  message_queue->strategy = message_queue_wait_condition;
+  message_queue->event_fd = -1;
+  atomic_init(&(message_queue->ready), false);
+  message_queue->spin_limit = 0;
+  atomic_init(&(message_queue->spin_budget), 0);
+#ifdef MESSAGE_QUEUE_STATS
+  message_queue_counters_t* stats = &(message_queue->stats);
+  atomic_init(&(stats->depth), 0);
+  atomic_init(&(stats->max_depth), 0);
+  atomic_init(&(stats->pushes), 0);
+  atomic_init(&(stats->pops), 0);
+  atomic_init(&(stats->contended_locks), 0);
+  atomic_init(&(stats->spurious_wakeups), 0);
+  for (size_t i = 0; i < MESSAGE_QUEUE_STATS_BUCKETS; ++i) {
+    atomic_init(&(stats->wait_histogram[i]), 0);
+  }
+#endif
+  return 0;
+}
+
+int message_queue_init_pooled(
+  message_queue_t message_queue[static 1],
+  queue_deleter deleter,
+  size_t node_count
+) {
+  int init_flag = message_queue_init(message_queue, deleter);
+  if (init_flag) {
+    return init_flag;
+  }
+  int pool_flag =
+    queue_init_pooled(&(message_queue->queue), deleter, node_count);
+  if (pool_flag) {
+    message_queue_destroy(message_queue);
+    return pool_flag;
+  }
   return 0;
 }
 
+int message_queue_init_bounded(
+  message_queue_t message_queue[static 1],
+  queue_deleter deleter,
+  size_t capacity,
+  message_queue_policy_t policy
+) {
+  if (capacity == 0) {
+    return -1;
+  }
+  int init_flag = message_queue_init_pooled(message_queue, deleter, capacity);
+  if (init_flag) {
+    return init_flag;
+  }
+  message_queue->capacity = capacity;
+  message_queue->policy = policy;
+  return 0;
+}
+
+int message_queue_use_eventfd(
+  message_queue_t message_queue[static 1],
+  unsigned spin_limit
+) {
+  int event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (event_fd < 0) {
+    return -1;
+  }
+  message_queue->event_fd = event_fd;
+  message_queue->strategy = message_queue_wait_eventfd;
+  message_queue->spin_limit = spin_limit;
+  atomic_store_explicit(
+    &(message_queue->spin_budget),
+    spin_limit,
+    memory_order_relaxed
+  );
+  if (!queue_empty(&(message_queue->queue))) {
+    uint64_t counter = 1;
+    if (write(event_fd, &counter, sizeof(counter)) < 0) {
+      //can't fail on a fresh eventfd
+    }
+    atomic_store_explicit(&(message_queue->ready), true, memory_order_relaxed);
+  }
+  return 0;
+}
+
+int message_queue_fd(message_queue_t message_queue[static 1]) {
+  return message_queue->event_fd;
+}
+
 void message_queue_destroy(message_queue_t message_queue[static 1]) {
+  if (message_queue->event_fd >= 0) {
+    close(message_queue->event_fd);
+    message_queue->event_fd = -1;
+  }
   queue_destroy(&(message_queue->queue));
+  cnd_destroy(&(message_queue->space));
   cnd_destroy(&(message_queue->wait));
   mtx_destroy(&(message_queue->lock));
 }
 
-int message_queue_push(
+/**
+ * @brief Brings the eventfd in line with the queue after it changed, must be
+ * called with the lock held.
+ * 
+ * Only switches between empty and non-empty touch the eventfd, so it stays
+ * readable exactly while there are messages and busy queues don't pay for
+ * a syscall per message.
+ */
+static void message_queue_publish_locked(
+  message_queue_t message_queue[static 1]
+) {
+  if (message_queue->event_fd < 0) {
+    return;
+  }
+  bool ready = !queue_empty(&(message_queue->queue));
+  if (
+    ready == atomic_load_explicit(&(message_queue->ready), memory_order_relaxed)
+  ) {
+    return;
+  }
+  atomic_store_explicit(&(message_queue->ready), ready, memory_order_release);
+  uint64_t counter = 1;
+  //eventfd neither blocks nor fails here, the counter is only ever 0 or 1
+  if (ready) {
+    if (write(message_queue->event_fd, &counter, sizeof(counter)) < 0) {
+      return;
+    }
+  } else {
+    if (read(message_queue->event_fd, &counter, sizeof(counter)) < 0) {
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Takes the lock, with statistics it first tries without waiting to
+ * find out whether another thread holds it.
+ */
+static int message_queue_lock(message_queue_t message_queue[static 1]) {
+#ifdef MESSAGE_QUEUE_STATS
+  if (mtx_trylock(&(message_queue->lock)) == thrd_success) {
+    return thrd_success;
+  }
+  atomic_fetch_add_explicit(
+    &(message_queue->stats.contended_locks),
+    1,
+    memory_order_relaxed
+  );
+#endif
+  return mtx_lock(&(message_queue->lock));
+}
+
+/**
+ * @brief Records the depth after a change, must be called with the lock held.
+ */
+static void message_queue_stats_depth(message_queue_t message_queue[static 1]) {
+#ifdef MESSAGE_QUEUE_STATS
+  message_queue_counters_t* stats = &(message_queue->stats);
+  size_t depth = queue_size(&(message_queue->queue));
+  atomic_store_explicit(&(stats->depth), depth, memory_order_relaxed);
+  if (depth > atomic_load_explicit(&(stats->max_depth), memory_order_relaxed)) {
+    atomic_store_explicit(&(stats->max_depth), depth, memory_order_relaxed);
+  }
+#else
+  (void)message_queue;
+#endif
+}
+
+/**
+ * @brief Records a push, must be called with the lock held.
+ * 
+ * @param appended Whether the message got a node of its own at the back,
+ * a conflated one takes over the time of the message it replaced
+ */
+static void message_queue_stats_pushed(
   message_queue_t message_queue[static 1],
-  void* message
+  bool appended
+) {
+#ifdef MESSAGE_QUEUE_STATS
+  if (appended) {
+    clock_gettime(CLOCK_MONOTONIC, &(message_queue->queue.back->enqueued));
+  }
+  atomic_fetch_add_explicit(
+    &(message_queue->stats.pushes),
+    1,
+    memory_order_relaxed
+  );
+  message_queue_stats_depth(message_queue);
+#else
+  (void)message_queue;
+  (void)appended;
+#endif
+}
+
+/**
+ * @brief Records the time the message of the node spent queued, right before
+ * it's handed to a consumer.
+ */
+static void message_queue_stats_delivered(
+  message_queue_t message_queue[static 1],
+  queue_node_t node[static 1]
+) {
+#ifdef MESSAGE_QUEUE_STATS
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  timespan_t waited = timespan_dur(node->enqueued, now);
+  unsigned long long waited_us = (waited.tv_sec < 0 || waited.tv_nsec < 0) ?
+    0 :
+    (unsigned long long)waited.tv_sec * 1000000 +
+      (unsigned long long)waited.tv_nsec / 1000;
+  size_t bucket = 0;
+  while (waited_us != 0 && bucket < MESSAGE_QUEUE_STATS_BUCKETS - 1) {
+    waited_us >>= 1;
+    ++bucket;
+  }
+  message_queue_counters_t* stats = &(message_queue->stats);
+  atomic_fetch_add_explicit(
+    &(stats->wait_histogram[bucket]),
+    1,
+    memory_order_relaxed
+  );
+  atomic_fetch_add_explicit(&(stats->pops), 1, memory_order_relaxed);
+#else
+  (void)message_queue;
+  (void)node;
+#endif
+}
+
+/**
+ * @brief Records a wake-up that found nothing to do.
+ */
+static void message_queue_stats_spurious(
+  message_queue_t message_queue[static 1]
+) {
+#ifdef MESSAGE_QUEUE_STATS
+  atomic_fetch_add_explicit(
+    &(message_queue->stats.spurious_wakeups),
+    1,
+    memory_order_relaxed
+  );
+#else
+  (void)message_queue;
+#endif
+}
+
+/**
+ * @brief Pops the front message for a consumer, must be called with the lock
+ * held.
+ */
+static void* message_queue_take(message_queue_t message_queue[static 1]) {
+  queue_t* queue = &(message_queue->queue);
+  if (queue->front == NULL) {
+    return NULL;
+  }
+  message_queue_stats_delivered(message_queue, queue->front);
+  void* message = queue_pop(queue);
+  message_queue_stats_depth(message_queue);
+  return message;
+}
+
+/**
+ * @brief Makes space in the full queue according to its policy, must be
+ * called with the lock held.
+ * 
+ * @param timepoint Deadline of the block policy, NULL to wait indefinitely
+ * @param replaced Set to true if the message already took the place of the
+ * newest one
+ * @return 0 on success, thrd_* code of the failure otherwise.
+ */
+static int message_queue_make_space(
+  message_queue_t message_queue[static 1],
+  void* message,
+  const timepoint_t* timepoint,
+  bool replaced[static 1]
+) {
+  queue_t* queue = &(message_queue->queue);
+  switch (message_queue->policy) {
+    case message_queue_block:
+      //earlier messages of a batch have to reach the consumer before waiting
+      //for it to make space
+      message_queue_publish_locked(message_queue);
+      cnd_signal(&(message_queue->wait));
+      while (queue_size(queue) >= message_queue->capacity) {
+        int cnd_flag = (timepoint != NULL) ?
+          cnd_timedwait(
+            &(message_queue->space),
+            &(message_queue->lock),
+            timepoint
+          ) :
+          cnd_wait(&(message_queue->space), &(message_queue->lock));
+        if (cnd_flag != thrd_success) {
+          message_queue->dropped += 1;
+          return cnd_flag;
+        }
+        if (queue_size(queue) >= message_queue->capacity) {
+          message_queue_stats_spurious(message_queue);
+        }
+      }
+      return 0;
+    case message_queue_drop_newest:
+      message_queue->dropped += 1;
+      return thrd_busy;
+    case message_queue_drop_oldest: {
+      void* oldest = queue_pop(queue);
+      if (queue->deleter != NULL) {
+        queue->deleter(oldest);
+      }
+      message_queue->dropped += 1;
+      return 0;
+    }
+    case message_queue_conflate: {
+      void* newest = queue->back->value;
+      queue->back->value = message;
+      if (queue->deleter != NULL) {
+        queue->deleter(newest);
+      }
+      message_queue->dropped += 1;
+      *replaced = true;
+      return 0;
+    }
+  }
+  return thrd_error;
+}
+
+/**
+ * @brief Pushes a single message, must be called with the lock held.
+ * 
+ * @param timepoint Deadline of the block policy, NULL to wait indefinitely
+ */
+static int message_queue_push_locked(
+  message_queue_t message_queue[static 1],
+  void* message,
+  const timepoint_t* timepoint
 ) {
-  int mtx_flag = mtx_lock(&(message_queue->lock));
+  if (message == NULL) {
+    return -1;
+  }
+  int push_flag = 0;
+  bool replaced = false;
+  if (
+    message_queue->capacity != 0 &&
+    queue_size(&(message_queue->queue)) >= message_queue->capacity
+  ) {
+    push_flag = message_queue_make_space(
+      message_queue,
+      message,
+      timepoint,
+      &replaced
+    );
+  }
+  if (push_flag == 0 && !replaced) {
+    push_flag = queue_push(
+      &(message_queue->queue),
+      message
+    );
+  }
+  if (push_flag == 0) {
+    message_queue_stats_pushed(message_queue, !replaced);
+  }
+  return push_flag;
+}
+
+/**
+ * @brief Common implementation of pushing.
+ * 
+ * @param timepoint Deadline of the block policy, NULL to wait indefinitely
+ */
+static int message_queue_push_until(
+  message_queue_t message_queue[static 1],
+  void* message,
+  const timepoint_t* timepoint
+) {
+  if (message == NULL) {
+    return -1;
+  }
+  int mtx_flag = message_queue_lock(message_queue);
   if (mtx_flag != thrd_success) {
     return mtx_flag;
   }
-  int push_flag = queue_push(
-    &(message_queue->queue),
-    message
-  );
+  int push_flag = message_queue_push_locked(message_queue, message, timepoint);
+  message_queue_publish_locked(message_queue);
   cnd_signal(&(message_queue->wait));
   mtx_unlock(&(message_queue->lock));
   if (push_flag != 0) {
@@ -43,29 +418,221 @@ int message_queue_push(
   return 0;
 }
 
+int message_queue_push(
+  message_queue_t message_queue[static 1],
+  void* message
+) {
+  return message_queue_push_until(message_queue, message, NULL);
+}
+
+int message_queue_push_wait_t(
+  message_queue_t message_queue[static 1],
+  void* message,
+  timepoint_t timepoint
+) {
+  return message_queue_push_until(message_queue, message, &timepoint);
+}
+
+size_t message_queue_push_batch(
+  message_queue_t message_queue[static 1],
+  void* messages[static 1],
+  size_t count
+) {
+  if (message_queue_lock(message_queue) != thrd_success) {
+    return 0;
+  }
+  size_t pushed = 0;
+  while (
+    pushed < count &&
+    message_queue_push_locked(message_queue, messages[pushed], NULL) == 0
+  ) {
+    ++pushed;
+  }
+  if (pushed != 0) {
+    message_queue_publish_locked(message_queue);
+    cnd_signal(&(message_queue->wait));
+  }
+  mtx_unlock(&(message_queue->lock));
+  return pushed;
+}
+
+/**
+ * @brief Pops the element, waking up a producer waiting for space, must be
+ * called with the lock held.
+ */
+static void* message_queue_pop_locked(
+  message_queue_t message_queue[static 1]
+) {
+  void* message = message_queue_take(message_queue);
+  if (message != NULL && message_queue->capacity != 0) {
+    cnd_signal(&(message_queue->space));
+  }
+  if (message != NULL) {
+    message_queue_publish_locked(message_queue);
+  }
+  return message;
+}
+
 void* message_queue_pop(
   message_queue_t message_queue[static 1]
 ) {
-  int mtx_flag = mtx_lock(&(message_queue->lock));
+  int mtx_flag = message_queue_lock(message_queue);
   if (mtx_flag != thrd_success) {
     //TO DO: figure out whether it's possible in circumstances other than
     //complete heap overflow and entire execution being FUBAR and then maybe
     //think of some better solution
     return NULL;
   }
-  void* message = queue_pop(&(message_queue->queue));
+  void* message = message_queue_pop_locked(message_queue);
   mtx_unlock(&(message_queue->lock));
   return message;
 }
 
+/**
+ * @brief Lets the cpu know the thread is busy waiting.
+ */
+static inline void message_queue_cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#else
+  atomic_signal_fence(memory_order_seq_cst);
+#endif
+}
+
+/**
+ * @brief Spins until the queue looks ready or the budget runs out, then
+ * adapts the budget of the next wait to the outcome.
+ * 
+ * @return true if the queue became ready while spinning.
+ */
+static bool message_queue_spin(message_queue_t message_queue[static 1]) {
+  unsigned budget = atomic_load_explicit(
+    &(message_queue->spin_budget),
+    memory_order_relaxed
+  );
+  for (unsigned i = 0; i < budget; ++i) {
+    if (atomic_load_explicit(&(message_queue->ready), memory_order_acquire)) {
+      unsigned limit = message_queue->spin_limit;
+      atomic_store_explicit(
+        &(message_queue->spin_budget),
+        (budget < limit / 2) ? budget * 2 : limit,
+        memory_order_relaxed
+      );
+      return true;
+    }
+    message_queue_cpu_relax();
+  }
+  //spinning didn't pay off, but a single round is kept so it can recover
+  if (budget > 1) {
+    atomic_store_explicit(
+      &(message_queue->spin_budget),
+      budget / 2,
+      memory_order_relaxed
+    );
+  }
+  return false;
+}
+
+/**
+ * @brief Translates the deadline to the monotonic clock.
+ */
+static struct timespec message_queue_monotonic_deadline(timepoint_t timepoint) {
+  timespan_t left = timespan_dur(timepoint_now(), timepoint);
+  if (left.tv_sec < 0 || left.tv_nsec < 0) {
+    left = timespan_s_ns(0, 0);
+  }
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return timepoint_after(now, left);
+}
+
+/**
+ * @brief Waits in the eventfd strategy until the queue looks ready, spinning
+ * first and then parking on the eventfd.
+ * 
+ * @param deadline In the monotonic clock, NULL to wait indefinitely
+ * @return thrd_success once the queue looked ready, which doesn't guarantee
+ * another consumer won't be first, thrd_timedout or thrd_error otherwise.
+ */
+static int message_queue_await(
+  message_queue_t message_queue[static 1],
+  const struct timespec* deadline
+) {
+  if (
+    atomic_load_explicit(&(message_queue->ready), memory_order_acquire) ||
+    message_queue_spin(message_queue)
+  ) {
+    return thrd_success;
+  }
+  struct pollfd poll_fd = {.fd = message_queue->event_fd, .events = POLLIN};
+  while (true) {
+    struct timespec left;
+    if (deadline != NULL) {
+      struct timespec now;
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      left = timespan_dur(now, *deadline);
+      if (left.tv_sec < 0 || left.tv_nsec < 0) {
+        return thrd_timedout;
+      }
+    }
+    int poll_count =
+      ppoll(&poll_fd, 1, (deadline != NULL) ? &left : NULL, NULL);
+    if (poll_count > 0) {
+      return thrd_success;
+    }
+    if (poll_count == 0) {
+      return thrd_timedout;
+    }
+    if (errno != EINTR) {
+      return thrd_error;
+    }
+  }
+}
+
+/**
+ * @brief Popping with waiting of the eventfd strategy.
+ * 
+ * @param timepoint Deadline, NULL to wait indefinitely
+ */
+static void* message_queue_pop_await(
+  message_queue_t message_queue[static 1],
+  const timepoint_t* timepoint
+) {
+  struct timespec deadline;
+  if (timepoint != NULL) {
+    deadline = message_queue_monotonic_deadline(*timepoint);
+  }
+  while (true) {
+    void* message = message_queue_pop(message_queue);
+    if (message != NULL) {
+      return message;
+    }
+    int await_flag = message_queue_await(
+      message_queue,
+      (timepoint != NULL) ? &deadline : NULL
+    );
+    if (await_flag != thrd_success) {
+      return message_queue_pop(message_queue);
+    }
+    message = message_queue_pop(message_queue);
+    if (message != NULL) {
+      return message;
+    }
+    message_queue_stats_spurious(message_queue);
+  }
+}
+
 void* message_queue_pop_wait(
   message_queue_t message_queue[static 1]
 ) {
-  int mtx_flag = mtx_lock(&(message_queue->lock));
+  if (message_queue->strategy == message_queue_wait_eventfd) {
+    return message_queue_pop_await(message_queue, NULL);
+  }
+  int mtx_flag = message_queue_lock(message_queue);
   if (mtx_flag != thrd_success) {
     return NULL;
   }
-  void* message = queue_pop(&(message_queue->queue));
+  void* message = message_queue_pop_locked(message_queue);
   while (message == NULL) {
     //supposedly this function might return thrd_error, but I couldn't
     //find anywhere what has to happen for that + what's the mutex state
@@ -75,7 +642,10 @@ void* message_queue_pop_wait(
       &(message_queue->wait),
       &(message_queue->lock)
     );
-    message = queue_pop(&(message_queue->queue));
+    message = message_queue_pop_locked(message_queue);
+    if (message == NULL) {
+      message_queue_stats_spurious(message_queue);
+    }
   }
   mtx_unlock(&(message_queue->lock));
   return message;  
@@ -85,11 +655,14 @@ void* message_queue_pop_wait_t(
   message_queue_t message_queue[static 1],
   timepoint_t timepoint
 ) {
-  int mtx_flag = mtx_lock(&(message_queue->lock));
+  if (message_queue->strategy == message_queue_wait_eventfd) {
+    return message_queue_pop_await(message_queue, &timepoint);
+  }
+  int mtx_flag = message_queue_lock(message_queue);
   if (mtx_flag != thrd_success) {
     return NULL;
   }
-  void* message = queue_pop(&(message_queue->queue));
+  void* message = message_queue_pop_locked(message_queue);
   while (message == NULL) {
     int cnd_flag = cnd_timedwait(
       &(message_queue->wait),
@@ -102,8 +675,172 @@ void* message_queue_pop_wait_t(
     }
     //in case of spurious wake-up queue_pop will simply return NULL, so
     //there's no need for any additional checks
-    message = queue_pop(&(message_queue->queue));
+    message = message_queue_pop_locked(message_queue);
+    if (message == NULL) {
+      message_queue_stats_spurious(message_queue);
+    }
   }
   mtx_unlock(&(message_queue->lock));
   return message;  
 }
+
+/**
+ * @brief Pops up to max elements, must be called with the lock held.
+ */
+static size_t message_queue_pop_batch_locked(
+  message_queue_t message_queue[static 1],
+  void* messages[static 1],
+  size_t max
+) {
+  queue_t* queue = &(message_queue->queue);
+  size_t count = 0;
+  while (count < max && !queue_empty(queue)) {
+    messages[count] = message_queue_take(message_queue);
+    ++count;
+  }
+  //several slots might have been freed, so every blocked producer may go
+  if (count != 0 && message_queue->capacity != 0) {
+    cnd_broadcast(&(message_queue->space));
+  }
+  if (count != 0) {
+    message_queue_publish_locked(message_queue);
+  }
+  return count;
+}
+
+/**
+ * @brief Batch popping with waiting of the eventfd strategy.
+ */
+static size_t message_queue_pop_batch_await(
+  message_queue_t message_queue[static 1],
+  void* messages[static 1],
+  size_t max,
+  timepoint_t timepoint
+) {
+  struct timespec deadline = message_queue_monotonic_deadline(timepoint);
+  while (true) {
+    if (message_queue_lock(message_queue) != thrd_success) {
+      return 0;
+    }
+    size_t count = message_queue_pop_batch_locked(message_queue, messages, max);
+    mtx_unlock(&(message_queue->lock));
+    if (count != 0) {
+      return count;
+    }
+    if (message_queue_await(message_queue, &deadline) != thrd_success) {
+      return 0;
+    }
+  }
+}
+
+size_t message_queue_pop_batch(
+  message_queue_t message_queue[static 1],
+  void* messages[static 1],
+  size_t max,
+  timepoint_t timepoint
+) {
+  if (message_queue->strategy == message_queue_wait_eventfd) {
+    return message_queue_pop_batch_await(
+      message_queue,
+      messages,
+      max,
+      timepoint
+    );
+  }
+  if (message_queue_lock(message_queue) != thrd_success) {
+    return 0;
+  }
+  while (queue_empty(&(message_queue->queue))) {
+    int cnd_flag = cnd_timedwait(
+      &(message_queue->wait),
+      &(message_queue->lock),
+      &timepoint
+    );
+    if (cnd_flag != thrd_success) {
+      break;
+    }
+    if (queue_empty(&(message_queue->queue))) {
+      message_queue_stats_spurious(message_queue);
+    }
+  }
+  size_t count = message_queue_pop_batch_locked(message_queue, messages, max);
+  mtx_unlock(&(message_queue->lock));
+  return count;
+}
+
+size_t message_queue_drain(
+  message_queue_t message_queue[static 1],
+  queue_t output[static 1]
+) {
+  if (message_queue_lock(message_queue) != thrd_success) {
+    return 0;
+  }
+  size_t count = queue_size(&(message_queue->queue));
+#ifdef MESSAGE_QUEUE_STATS
+  //statistics give up the constant time of draining
+  for (
+    queue_node_t* node = message_queue->queue.front;
+    node != NULL;
+    node = node->next
+  ) {
+    message_queue_stats_delivered(message_queue, node);
+  }
+#endif
+  queue_splice(output, &(message_queue->queue));
+  message_queue_stats_depth(message_queue);
+  if (count != 0 && message_queue->capacity != 0) {
+    cnd_broadcast(&(message_queue->space));
+  }
+  message_queue_publish_locked(message_queue);
+  mtx_unlock(&(message_queue->lock));
+  return count;
+}
+
+size_t message_queue_size(message_queue_t message_queue[static 1]) {
+  if (message_queue_lock(message_queue) != thrd_success) {
+    return 0;
+  }
+  size_t size = queue_size(&(message_queue->queue));
+  mtx_unlock(&(message_queue->lock));
+  return size;
+}
+
+size_t message_queue_dropped(message_queue_t message_queue[static 1]) {
+  if (message_queue_lock(message_queue) != thrd_success) {
+    return 0;
+  }
+  size_t dropped = message_queue->dropped;
+  mtx_unlock(&(message_queue->lock));
+  return dropped;
+}
+
+int message_queue_stats(
+  message_queue_t message_queue[static 1],
+  message_queue_stats_t stats[static 1]
+) {
+#ifdef MESSAGE_QUEUE_STATS
+  message_queue_counters_t* counters = &(message_queue->stats);
+  stats->depth =
+    atomic_load_explicit(&(counters->depth), memory_order_relaxed);
+  stats->max_depth =
+    atomic_load_explicit(&(counters->max_depth), memory_order_relaxed);
+  stats->pushes =
+    atomic_load_explicit(&(counters->pushes), memory_order_relaxed);
+  stats->pops = atomic_load_explicit(&(counters->pops), memory_order_relaxed);
+  stats->contended_locks =
+    atomic_load_explicit(&(counters->contended_locks), memory_order_relaxed);
+  stats->spurious_wakeups =
+    atomic_load_explicit(&(counters->spurious_wakeups), memory_order_relaxed);
+  for (size_t i = 0; i < MESSAGE_QUEUE_STATS_BUCKETS; ++i) {
+    stats->wait_histogram[i] = atomic_load_explicit(
+      &(counters->wait_histogram[i]),
+      memory_order_relaxed
+    );
+  }
+  return 0;
+#else
+  (void)message_queue;
+  *stats = (message_queue_stats_t){0};
+  return -1;
+#endif
+}
@@ -1,6 +1,8 @@
 #ifndef SKAI_DATA_STRUCTURES_MESSAGE_QUEUE_H
 #define SKAI_DATA_STRUCTURES_MESSAGE_QUEUE_H
 
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <threads.h>
 #include <time.h>
 
@@ -13,16 +15,101 @@
  * so one should look into its documentation if more detail is needed.
  */
 
+/**
+ * @brief What a bounded queue does with a message pushed while it's full.
+ */
+typedef enum message_queue_policy {
+  message_queue_block,        /**<Producer waits for space, up to a deadline
+                                  if one was given*/
+  message_queue_drop_newest,  /**<Push is declined with thrd_busy and the
+                                  caller keeps the message*/
+  message_queue_drop_oldest,  /**<Oldest queued message is deleted to make
+                                  space*/
+  message_queue_conflate      /**<Newest queued message is deleted and
+                                  replaced by the pushed one*/
+} message_queue_policy_t;
+
+/**
+ * @brief How consumers wait for messages.
+ */
+typedef enum message_queue_strategy {
+  message_queue_wait_condition, /**<Consumers park on the condition variable
+                                    right away, deadlines are followed in the
+                                    realtime clock*/
+  message_queue_wait_eventfd    /**<Consumers spin for a bounded, adaptive
+                                    number of rounds, then park on an eventfd
+                                    in the monotonic clock, the fd can be
+                                    polled along with other ones*/
+} message_queue_strategy_t;
+
+/**
+ * @brief Number of buckets of the time-in-queue histogram, bucket 0 counts
+ * messages that waited under 1 microsecond, bucket i those that waited
+ * [2^(i-1), 2^i) microseconds and the last one everything longer.
+ */
+enum {
+  MESSAGE_QUEUE_STATS_BUCKETS = 24
+};
+
+/**
+ * @brief Snapshot of the statistics of a queue, collected only when built
+ * with MESSAGE_QUEUE_STATS defined.
+ * 
+ * Fields are read one by one while the queue keeps working, so they might
+ * disagree slightly with each other.
+ */
+typedef struct message_queue_stats {
+  size_t depth;                         /**<Number of queued messages*/
+  size_t max_depth;                     /**<Highest depth seen so far*/
+  unsigned long long pushes;            /**<Messages taken by the queue*/
+  unsigned long long pops;              /**<Messages handed to consumers*/
+  unsigned long long contended_locks;   /**<Lockings that had to wait*/
+  unsigned long long spurious_wakeups;  /**<Wake-ups finding nothing to do*/
+  unsigned long long wait_histogram[MESSAGE_QUEUE_STATS_BUCKETS];
+                                        /**<Time messages spent queued*/
+} message_queue_stats_t;
+
+#ifdef MESSAGE_QUEUE_STATS
+/**
+ * @brief Live counters behind message_queue_stats_t, written under the lock
+ * of the queue and read without it.
+ */
+typedef struct message_queue_counters {
+  atomic_size_t depth;
+  atomic_size_t max_depth;
+  atomic_ullong pushes;
+  atomic_ullong pops;
+  atomic_ullong contended_locks;
+  atomic_ullong spurious_wakeups;
+  atomic_ullong wait_histogram[MESSAGE_QUEUE_STATS_BUCKETS];
+} message_queue_counters_t;
+#endif
+
 /**
  * @brief A wrapper for generic queue adapting it to work as means of
  * communication between threads.
  * 
+ * Capacity of 0 means the queue is unbounded and the policy is never used.
+ * 
  * Accessing struct fields directly is not recommended.
  */
 typedef struct message_queue {
   queue_t queue;    /**<owned queue*/
   mtx_t lock;       /**<lock controlling the access*/
   cnd_t wait;       /**<condition variable for waiting for new messages*/
+  cnd_t space;      /**<condition variable for waiting for free space*/
+  size_t capacity;  /**<maximal number of messages, 0 if unbounded*/
+  message_queue_policy_t policy;  /**<handling of pushes to a full queue*/
+  size_t dropped;   /**<messages dropped or declined due to the capacity*/
+  message_queue_strategy_t strategy;  /**<waiting of the consumers*/
+  int event_fd;     /**<readable while the queue isn't empty, -1 unless the
+                        eventfd strategy is used*/
+  atomic_bool ready;  /**<mirror of the eventfd state for spinning consumers*/
+  unsigned spin_limit;        /**<maximal rounds of spinning*/
+  atomic_uint spin_budget;    /**<rounds of spinning of the next wait*/
+#ifdef MESSAGE_QUEUE_STATS
+  message_queue_counters_t stats; /**<counters of the statistics*/
+#endif
 } message_queue_t;
 
 /**
@@ -38,6 +125,66 @@ int message_queue_init(
   queue_deleter deleter
 );
 
+/**
+ * @brief Initializes message queue reusing its nodes, see queue_init_pooled.
+ * 
+ * @param message_queue Queue to initialize.
+ * @param deleter Clean-up function for queue that owns its element or NULL
+ * otherwise, although non-owning queues for multithreading are undefined.
+ * @param node_count Number of nodes allocated upfront.
+ * @return 0 on success, non-0 value on error.
+ */
+int message_queue_init_pooled(
+  message_queue_t message_queue[static 1],
+  queue_deleter deleter,
+  size_t node_count
+);
+
+/**
+ * @brief Initializes message queue holding at most capacity messages, its
+ * nodes are allocated upfront, so it doesn't touch the heap afterwards.
+ * 
+ * @param message_queue Queue to initialize.
+ * @param deleter Clean-up function for queue that owns its element or NULL
+ * otherwise, messages dropped by the policy are passed to it.
+ * @param capacity Maximal number of messages, at least 1.
+ * @param policy Handling of pushes to the full queue.
+ * @return 0 on success, non-0 value on error.
+ */
+int message_queue_init_bounded(
+  message_queue_t message_queue[static 1],
+  queue_deleter deleter,
+  size_t capacity,
+  message_queue_policy_t policy
+);
+
+/**
+ * @brief Switches the queue to the eventfd strategy, has to be called before
+ * the queue is shared with other threads.
+ * 
+ * The spin budget starts at spin_limit, doubles after each wait that ended
+ * while spinning and halves after each one that had to park.
+ * 
+ * @param message_queue 
+ * @param spin_limit Maximal rounds of spinning before parking, 0 to park
+ * right away
+ * @return 0 on success, -1 if the eventfd couldn't be created, in which case
+ * the queue keeps waiting on its condition variable.
+ */
+int message_queue_use_eventfd(
+  message_queue_t message_queue[static 1],
+  unsigned spin_limit
+);
+
+/**
+ * @brief Gives the descriptor to wait on with poll or epoll, readable while
+ * there are messages, it's owned by the queue and must not be read from.
+ * 
+ * @param message_queue 
+ * @return The eventfd, -1 unless the queue uses the eventfd strategy.
+ */
+int message_queue_fd(message_queue_t message_queue[static 1]);
+
 /**
  * @brief Frees the queue
  * 
@@ -48,15 +195,53 @@ void message_queue_destroy(message_queue_t message_queue[static 1]);
 /**
  * @brief Pushes the message to the queue, might block.
  * 
+ * A full queue with message_queue_block policy blocks until there's space.
+ * 
  * @param message_queue 
  * @param message 
- * @return 0 on success, non-0 otherwise
+ * @return 0 on success, non-0 otherwise, in which case the caller keeps the
+ * ownership, thrd_busy if the message was declined by a full queue.
  */
 int message_queue_push(
   message_queue_t message_queue[static 1],
   void* message
 );
 
+/**
+ * @brief Pushes the message to the queue, a full queue with
+ * message_queue_block policy blocks until there's space or until a specific
+ * timepoint, other policies don't wait.
+ * 
+ * @param message_queue 
+ * @param message 
+ * @param timepoint 
+ * @return 0 on success, non-0 otherwise, in which case the caller keeps the
+ * ownership, thrd_timedout if there was no space before the timeout.
+ */
+int message_queue_push_wait_t(
+  message_queue_t message_queue[static 1],
+  void* message,
+  timepoint_t timepoint
+);
+
+/**
+ * @brief Pushes messages in order under a single lock, waking the consumer
+ * once, or before every wait for space with the block policy, each of them
+ * is handled like in message_queue_push.
+ * 
+ * @param message_queue 
+ * @param messages Messages to push, none of them can be a NULL pointer
+ * @param count Number of messages
+ * @return Number of pushed messages, the queue takes ownership of
+ * messages[0, return) and the caller keeps the rest, which are left after
+ * the first failed push.
+ */
+size_t message_queue_push_batch(
+  message_queue_t message_queue[static 1],
+  void* messages[static 1],
+  size_t count
+);
+
 /**
  * @brief Pops the element from queue, might block.
  * 
@@ -84,6 +269,10 @@ void* message_queue_pop_wait(
  * @brief Blocks until it can pop an element from queue or until a specific
  * timepoint
  * 
+ * With the eventfd strategy the time left until the timepoint is taken once
+ * and the wait follows the monotonic clock, so jumps of the wall clock don't
+ * shorten or stretch it.
+ * 
  * @param message_queue 
  * @param timepoint
  * @return Pointer to element if succeeded, NULL if no elements were available
@@ -94,6 +283,66 @@ void* message_queue_pop_wait_t(
   timepoint_t timepoint
 );
 
+/**
+ * @brief Blocks until there is at least one element or until a specific
+ * timepoint, then pops as many as there are, up to max, under a single lock.
+ * 
+ * @param message_queue 
+ * @param messages Buffer for the popped elements, at least max long
+ * @param max Maximal number of popped elements
+ * @param timepoint 
+ * @return Number of popped elements, 0 if none were available before the
+ * timeout, caller takes ownership of them.
+ */
+size_t message_queue_pop_batch(
+  message_queue_t message_queue[static 1],
+  void* messages[static 1],
+  size_t max,
+  timepoint_t timepoint
+);
+
+/**
+ * @brief Moves every queued element to the back of output in constant time,
+ * without blocking.
+ * 
+ * Nodes move along with the elements, so a pooled or bounded queue has to
+ * allocate new ones once its pool runs out.
+ * 
+ * @param message_queue 
+ * @param output Initialized queue, takes ownership of the elements, should
+ * share the deleter with the message queue
+ * @return Number of moved elements.
+ */
+size_t message_queue_drain(
+  message_queue_t message_queue[static 1],
+  queue_t output[static 1]
+);
+
+/**
+ * @param message_queue 
+ * @return Number of queued messages, taken in constant time.
+ */
+size_t message_queue_size(message_queue_t message_queue[static 1]);
+
+/**
+ * @param message_queue 
+ * @return Number of messages dropped or declined so far because the queue was
+ * full, including blocked pushes that timed out.
+ */
+size_t message_queue_dropped(message_queue_t message_queue[static 1]);
 
+/**
+ * @brief Copies the statistics of the queue without taking its lock, so
+ * monitoring doesn't hold the pipeline up.
+ * 
+ * @param message_queue 
+ * @param stats Snapshot to fill in
+ * @return 0 on success, -1 if the queue was built without MESSAGE_QUEUE_STATS,
+ * in which case the snapshot is zeroed.
+ */
+int message_queue_stats(
+  message_queue_t message_queue[static 1],
+  message_queue_stats_t stats[static 1]
+);
 
 #endif
@@ -0,0 +1,184 @@
+#include "message_value_queue.h"
+
+int message_value_queue_init(
+  message_value_queue_t message_queue[static 1],
+  size_t element_size,
+  size_t capacity
+) {
+  int mtx_flag = mtx_init(&(message_queue->lock), mtx_plain);
+  if (mtx_flag != thrd_success) {
+    return mtx_flag;
+  }
+  int cnd_flag = cnd_init(&(message_queue->wait));
+  if (cnd_flag != thrd_success) {
+    mtx_destroy(&(message_queue->lock));
+    return cnd_flag;
+  }
+  cnd_flag = cnd_init(&(message_queue->space));
+  if (cnd_flag != thrd_success) {
+    cnd_destroy(&(message_queue->wait));
+    mtx_destroy(&(message_queue->lock));
+    return cnd_flag;
+  }
+  //a bounded queue never needs more than its capacity in a single chunk
+  size_t chunk_length =
+    (capacity != 0 && capacity < VALUE_QUEUE_CHUNK_LENGTH) ? capacity : 0;
+  int init_flag =
+    value_queue_init(&(message_queue->queue), element_size, chunk_length);
+  if (init_flag) {
+    cnd_destroy(&(message_queue->space));
+    cnd_destroy(&(message_queue->wait));
+    mtx_destroy(&(message_queue->lock));
+    return init_flag;
+  }
+  message_queue->capacity = capacity;
+  return 0;
+}
+
+void message_value_queue_destroy(
+  message_value_queue_t message_queue[static 1]
+) {
+  value_queue_destroy(&(message_queue->queue));
+  cnd_destroy(&(message_queue->space));
+  cnd_destroy(&(message_queue->wait));
+  mtx_destroy(&(message_queue->lock));
+}
+
+/**
+ * @brief Common implementation of pushing.
+ * 
+ * @param timepoint Deadline of waiting for space, NULL to wait indefinitely
+ */
+static int message_value_queue_push_until(
+  message_value_queue_t message_queue[static 1],
+  const void* message,
+  const timepoint_t* timepoint
+) {
+  int mtx_flag = mtx_lock(&(message_queue->lock));
+  if (mtx_flag != thrd_success) {
+    return mtx_flag;
+  }
+  value_queue_t* queue = &(message_queue->queue);
+  while (
+    message_queue->capacity != 0 &&
+    value_queue_size(queue) >= message_queue->capacity
+  ) {
+    int cnd_flag = (timepoint != NULL) ?
+      cnd_timedwait(
+        &(message_queue->space),
+        &(message_queue->lock),
+        timepoint
+      ) :
+      cnd_wait(&(message_queue->space), &(message_queue->lock));
+    if (cnd_flag != thrd_success) {
+      mtx_unlock(&(message_queue->lock));
+      return cnd_flag;
+    }
+  }
+  int push_flag = value_queue_push(queue, message);
+  cnd_signal(&(message_queue->wait));
+  mtx_unlock(&(message_queue->lock));
+  return push_flag;
+}
+
+int message_value_queue_push(
+  message_value_queue_t message_queue[static 1],
+  const void* message
+) {
+  return message_value_queue_push_until(message_queue, message, NULL);
+}
+
+int message_value_queue_push_wait_t(
+  message_value_queue_t message_queue[static 1],
+  const void* message,
+  timepoint_t timepoint
+) {
+  return message_value_queue_push_until(message_queue, message, &timepoint);
+}
+
+/**
+ * @brief Pops the message, waking up a producer waiting for space, must be
+ * called with the lock held.
+ */
+static int message_value_queue_pop_locked(
+  message_value_queue_t message_queue[static 1],
+  void* message
+) {
+  int pop_flag = value_queue_pop(&(message_queue->queue), message);
+  if (pop_flag == 0 && message_queue->capacity != 0) {
+    cnd_signal(&(message_queue->space));
+  }
+  return pop_flag;
+}
+
+int message_value_queue_pop(
+  message_value_queue_t message_queue[static 1],
+  void* message
+) {
+  int mtx_flag = mtx_lock(&(message_queue->lock));
+  if (mtx_flag != thrd_success) {
+    return mtx_flag;
+  }
+  int pop_flag = message_value_queue_pop_locked(message_queue, message);
+  mtx_unlock(&(message_queue->lock));
+  return pop_flag;
+}
+
+int message_value_queue_pop_wait(
+  message_value_queue_t message_queue[static 1],
+  void* message
+) {
+  int mtx_flag = mtx_lock(&(message_queue->lock));
+  if (mtx_flag != thrd_success) {
+    return mtx_flag;
+  }
+  int pop_flag = message_value_queue_pop_locked(message_queue, message);
+  while (pop_flag != 0) {
+    int cnd_flag = cnd_wait(&(message_queue->wait), &(message_queue->lock));
+    if (cnd_flag != thrd_success) {
+      pop_flag = cnd_flag;
+      break;
+    }
+    pop_flag = message_value_queue_pop_locked(message_queue, message);
+  }
+  mtx_unlock(&(message_queue->lock));
+  return pop_flag;
+}
+
+int message_value_queue_pop_wait_t(
+  message_value_queue_t message_queue[static 1],
+  void* message,
+  timepoint_t timepoint
+) {
+  int mtx_flag = mtx_lock(&(message_queue->lock));
+  if (mtx_flag != thrd_success) {
+    return mtx_flag;
+  }
+  int pop_flag = message_value_queue_pop_locked(message_queue, message);
+  while (pop_flag != 0) {
+    int cnd_flag = cnd_timedwait(
+      &(message_queue->wait),
+      &(message_queue->lock),
+      &timepoint
+    );
+    if (cnd_flag != thrd_success) {
+      pop_flag = cnd_flag;
+      break;
+    }
+    //spurious wake-up leaves the queue empty and the loop goes on
+    pop_flag = message_value_queue_pop_locked(message_queue, message);
+  }
+  mtx_unlock(&(message_queue->lock));
+  return pop_flag;
+}
+
+size_t message_value_queue_size(
+  message_value_queue_t message_queue[static 1]
+) {
+  if (mtx_lock(&(message_queue->lock)) != thrd_success) {
+    return 0;
+  }
+  size_t size = value_queue_size(&(message_queue->queue));
+  mtx_unlock(&(message_queue->lock));
+  return size;
+}
@@ -0,0 +1,132 @@
+#ifndef SKAI_DATA_STRUCTURES_MESSAGE_VALUE_QUEUE_H
+#define SKAI_DATA_STRUCTURES_MESSAGE_VALUE_QUEUE_H
+
+#include <stddef.h>
+#include <threads.h>
+
+#include "value_queue.h"
+#include "utilities/time.h"
+
+/**
+ * @file Expands on value_queue to make it work in multithreading environment,
+ * the same way message_queue does for queue, messages are copied in and out
+ * under the lock instead of being passed as pointers.
+ */
+
+/**
+ * @brief A wrapper for value queue adapting it to work as means of
+ * communication between threads.
+ * 
+ * Capacity of 0 means the queue is unbounded, otherwise pushes to a full
+ * queue wait for space.
+ * 
+ * Accessing struct fields directly is not recommended.
+ */
+typedef struct message_value_queue {
+  value_queue_t queue;  /**<owned queue*/
+  mtx_t lock;           /**<lock controlling the access*/
+  cnd_t wait;           /**<condition variable for waiting for new messages*/
+  cnd_t space;          /**<condition variable for waiting for free space*/
+  size_t capacity;      /**<maximal number of messages, 0 if unbounded*/
+} message_value_queue_t;
+
+/**
+ * @brief Initializes the queue.
+ * 
+ * @param message_queue Queue to initialize.
+ * @param element_size Size of every message in bytes, at least 1.
+ * @param capacity Maximal number of messages, 0 for an unbounded queue.
+ * @return 0 on success, non-0 value on error.
+ */
+int message_value_queue_init(
+  message_value_queue_t message_queue[static 1],
+  size_t element_size,
+  size_t capacity
+);
+
+/**
+ * @brief Frees the queue
+ * 
+ * @param message_queue 
+ */
+void message_value_queue_destroy(
+  message_value_queue_t message_queue[static 1]
+);
+
+/**
+ * @brief Copies the message to the queue, a full queue blocks until there's
+ * space.
+ * 
+ * @param message_queue 
+ * @param message Pointer to element_size bytes
+ * @return 0 on success, non-0 otherwise.
+ */
+int message_value_queue_push(
+  message_value_queue_t message_queue[static 1],
+  const void* message
+);
+
+/**
+ * @brief Copies the message to the queue, a full queue blocks until there's
+ * space or until a specific timepoint.
+ * 
+ * @param message_queue 
+ * @param message Pointer to element_size bytes
+ * @param timepoint 
+ * @return 0 on success, non-0 otherwise, thrd_timedout if there was no space
+ * before the timeout.
+ */
+int message_value_queue_push_wait_t(
+  message_value_queue_t message_queue[static 1],
+  const void* message,
+  timepoint_t timepoint
+);
+
+/**
+ * @brief Pops the message without blocking.
+ * 
+ * @param message_queue 
+ * @param message Pointer to element_size bytes the message is copied to
+ * @return 0 on success, -1 if there were no messages, other non-0 value on
+ * access failure.
+ */
+int message_value_queue_pop(
+  message_value_queue_t message_queue[static 1],
+  void* message
+);
+
+/**
+ * @brief Blocks until it can pop a message from queue
+ * 
+ * @param message_queue 
+ * @param message Pointer to element_size bytes the message is copied to
+ * @return 0 on success, non-0 value on access failure.
+ */
+int message_value_queue_pop_wait(
+  message_value_queue_t message_queue[static 1],
+  void* message
+);
+
+/**
+ * @brief Blocks until it can pop a message from queue or until a specific
+ * timepoint
+ * 
+ * @param message_queue 
+ * @param message Pointer to element_size bytes the message is copied to
+ * @param timepoint 
+ * @return 0 on success, thrd_timedout if no messages were available before
+ * the timeout, other non-0 value on access failure.
+ */
+int message_value_queue_pop_wait_t(
+  message_value_queue_t message_queue[static 1],
+  void* message,
+  timepoint_t timepoint
+);
+
+/**
+ * @param message_queue 
+ * @return Number of queued messages.
+ */
+size_t message_value_queue_size(message_value_queue_t message_queue[static 1]);
+
+#endif
@@ -0,0 +1,117 @@
+#include "mpsc_queue.h"
+
+#include <stddef.h>
+
+int mpsc_queue_init(mpsc_queue_t queue[static 1]) {
+  int mtx_flag = mtx_init(&(queue->lock), mtx_plain);
+  if (mtx_flag != thrd_success) {
+    return mtx_flag;
+  }
+  int cnd_flag = cnd_init(&(queue->wait));
+  if (cnd_flag != thrd_success) {
+    mtx_destroy(&(queue->lock));
+    return cnd_flag;
+  }
+  atomic_init(&(queue->stub.next), NULL);
+  atomic_init(&(queue->head), &(queue->stub));
+  atomic_init(&(queue->waiting), false);
+  queue->tail = &(queue->stub);
+  return 0;
+}
+
+void mpsc_queue_destroy(mpsc_queue_t queue[static 1]) {
+  cnd_destroy(&(queue->wait));
+  mtx_destroy(&(queue->lock));
+}
+
+/**
+ * @brief Links the node in as the newest one.
+ */
+static void mpsc_queue_link(
+  mpsc_queue_t queue[static 1],
+  mpsc_node_t node[static 1]
+) {
+  atomic_store_explicit(&(node->next), NULL, memory_order_relaxed);
+  mpsc_node_t* prev =
+    atomic_exchange_explicit(&(queue->head), node, memory_order_acq_rel);
+  //until this store the consumer can't see the node nor anything after it
+  atomic_store_explicit(&(prev->next), node, memory_order_release);
+}
+
+void mpsc_queue_push(mpsc_queue_t queue[static 1], mpsc_node_t node[static 1]) {
+  mpsc_queue_link(queue, node);
+  //pairs with the fence in mpsc_queue_pop_wait_t, either the consumer sees the
+  //node or the producer sees it waiting
+  atomic_thread_fence(memory_order_seq_cst);
+  if (
+    atomic_load_explicit(&(queue->waiting), memory_order_relaxed) &&
+    atomic_exchange_explicit(&(queue->waiting), false, memory_order_relaxed)
+  ) {
+    mtx_lock(&(queue->lock));
+    cnd_signal(&(queue->wait));
+    mtx_unlock(&(queue->lock));
+  }
+}
+
+mpsc_node_t* mpsc_queue_pop(mpsc_queue_t queue[static 1]) {
+  mpsc_node_t* tail = queue->tail;
+  mpsc_node_t* next = atomic_load_explicit(&(tail->next), memory_order_acquire);
+  if (tail == &(queue->stub)) {
+    if (next == NULL) {
+      return NULL;
+    }
+    queue->tail = next;
+    tail = next;
+    next = atomic_load_explicit(&(next->next), memory_order_acquire);
+  }
+  if (next != NULL) {
+    queue->tail = next;
+    return tail;
+  }
+  mpsc_node_t* head =
+    atomic_load_explicit(&(queue->head), memory_order_acquire);
+  if (tail != head) {
+    //a producer swapped the head but didn't link its node yet
+    return NULL;
+  }
+  //the last element can be taken only once the stub is queued behind it
+  mpsc_queue_link(queue, &(queue->stub));
+  next = atomic_load_explicit(&(tail->next), memory_order_acquire);
+  if (next != NULL) {
+    queue->tail = next;
+    return tail;
+  }
+  return NULL;
+}
+
+mpsc_node_t* mpsc_queue_pop_wait_t(
+  mpsc_queue_t queue[static 1],
+  timepoint_t timepoint
+) {
+  mpsc_node_t* node = mpsc_queue_pop(queue);
+  if (node != NULL) {
+    return node;
+  }
+  int mtx_flag = mtx_lock(&(queue->lock));
+  if (mtx_flag != thrd_success) {
+    return NULL;
+  }
+  while (true) {
+    atomic_store_explicit(&(queue->waiting), true, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    node = mpsc_queue_pop(queue);
+    if (node != NULL) {
+      break;
+    }
+    //producer signals only under the lock, so it can't slip in before the
+    //wait starts
+    int cnd_flag = cnd_timedwait(&(queue->wait), &(queue->lock), &timepoint);
+    if (cnd_flag != thrd_success) {
+      node = mpsc_queue_pop(queue);
+      break;
+    }
+  }
+  atomic_store_explicit(&(queue->waiting), false, memory_order_relaxed);
+  mtx_unlock(&(queue->lock));
+  return node;
+}
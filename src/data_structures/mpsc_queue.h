@@ -0,0 +1,100 @@
+#ifndef SKAI_DATA_STRUCTURES_MPSC_QUEUE_H
+#define SKAI_DATA_STRUCTURES_MPSC_QUEUE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <threads.h>
+
+#include "utilities/time.h"
+
+/**
+ * @file Intrusive queue passing elements from any number of producer threads
+ * to a single consumer thread without locks, after Dmitry Vyukov's intrusive
+ * MPSC node-based queue, with a stub node kept inside the queue itself.
+ * 
+ * Elements embed an mpsc_node_t, so pushing doesn't allocate, and producers
+ * only ever do a single atomic exchange and a store, never waiting on each
+ * other. The mutex and condition variable are there for the consumer to sleep
+ * on, and only the first producer after the consumer fell asleep takes the
+ * mutex to wake it up.
+ */
+
+/**
+ * @brief Link embedded in every element of the queue.
+ */
+typedef struct mpsc_node {
+  _Atomic(struct mpsc_node*) next;  /**<Next element, NULL for the newest*/
+} mpsc_node_t;
+
+/**
+ * @brief Multi-producer single-consumer queue.
+ * 
+ * Producers append at the head, the consumer takes from the tail, a stub node
+ * stands in for the element whenever the queue runs empty.
+ * 
+ * Accessing struct fields directly is not recommended.
+ */
+typedef struct mpsc_queue {
+  _Alignas(64) _Atomic(mpsc_node_t*) head;  /**<Newest node, exchanged by
+                                                the producers*/
+  _Alignas(64) mpsc_node_t* tail;   /**<Oldest node, owned by the consumer*/
+  mpsc_node_t stub;                 /**<Placeholder keeping the list
+                                        non-empty*/
+  atomic_bool waiting;              /**<Consumer is about to sleep or
+                                        sleeping*/
+  mtx_t lock;                       /**<Guards sleeping of the consumer*/
+  cnd_t wait;                       /**<Consumer sleeps on it while the queue
+                                        is empty*/
+} mpsc_queue_t;
+
+/**
+ * @brief Initializes the queue.
+ * 
+ * @param queue Queue to initialize
+ * @return 0 on success, non-0 value on error.
+ */
+int mpsc_queue_init(mpsc_queue_t queue[static 1]);
+
+/**
+ * @brief Frees the resources of the queue, the elements aren't owned by it, so
+ * they have to be popped beforehand.
+ * 
+ * @param queue 
+ */
+void mpsc_queue_destroy(mpsc_queue_t queue[static 1]);
+
+/**
+ * @brief Appends the element, safe to call from any thread.
+ * 
+ * @param queue 
+ * @param node Link embedded in the element, which stays untouched until it's
+ * popped
+ */
+void mpsc_queue_push(mpsc_queue_t queue[static 1], mpsc_node_t node[static 1]);
+
+/**
+ * @brief Pops the oldest element without blocking, to be called only by the
+ * consumer thread.
+ * 
+ * An element whose producer is still in the middle of pushing it isn't
+ * visible yet, the producer wakes up a waiting consumer once it's done.
+ * 
+ * @param queue 
+ * @return Link of the element, NULL if there's none.
+ */
+mpsc_node_t* mpsc_queue_pop(mpsc_queue_t queue[static 1]);
+
+/**
+ * @brief Blocks until it can pop an element from the queue or until
+ * a specific timepoint, to be called only by the consumer thread.
+ * 
+ * @param queue 
+ * @param timepoint Deadline in the same clock as timepoint_now
+ * @return Link of the element, NULL if none came before the timeout.
+ */
+mpsc_node_t* mpsc_queue_pop_wait_t(
+  mpsc_queue_t queue[static 1],
+  timepoint_t timepoint
+);
+
+#endif
@@ -25,6 +25,28 @@ void queue_init(
   queue->front = NULL;
   queue->back = NULL;
   queue->deleter = deleter;
+  queue->size = 0;
+  queue->spare = NULL;
+  queue->pooled = false;
+}
+
+int queue_init_pooled(
+  queue_t queue[static 1],
+  queue_deleter deleter,
+  size_t node_count
+) {
+  queue_init(queue, deleter);
+  queue->pooled = true;
+  for (size_t i = 0; i < node_count; ++i) {
+    queue_node_t* node = malloc(sizeof(queue_node_t));
+    if (node == NULL) {
+      queue_destroy(queue);
+      return -1;
+    }
+    node->next = queue->spare;
+    queue->spare = node;
+  }
+  return 0;
 }
 
 void queue_destroy(queue_t queue[static 1]) {
@@ -44,16 +66,18 @@ void queue_destroy(queue_t queue[static 1]) {
       i = j;
     }
   }
+  while (queue->spare != NULL) {
+    queue_node_t* next = queue->spare->next;
+    queue_node_free(queue->spare);
+    queue->spare = next;
+  }
   queue->front = NULL;
   queue->back = NULL;
+  queue->size = 0;
 }
 
 size_t queue_size(queue_t queue[static 1]) {
-  size_t size = 0;
-  for (queue_node_t* i = queue->front; i != NULL; i = i->next) {
-    size += 1;
-  }
-  return size;
+  return queue->size;
 }
 
 bool queue_empty(queue_t queue[static 1]) {
@@ -65,9 +89,17 @@ bool queue_empty(queue_t queue[static 1]) {
 }
 
 int queue_push(queue_t queue[static 1], void* value) {
-  queue_node_t* new_node = queue_node_new(value);
-  if (new_node == NULL) {
-    return -1;
+  queue_node_t* new_node;
+  if (queue->spare != NULL && value != NULL) {
+    new_node = queue->spare;
+    queue->spare = new_node->next;
+    new_node->value = value;
+    new_node->next = NULL;
+  } else {
+    new_node = queue_node_new(value);
+    if (new_node == NULL) {
+      return -1;
+    }
   }
   if (queue->back == NULL) {
     queue->front = new_node;
@@ -77,6 +109,7 @@ int queue_push(queue_t queue[static 1], void* value) {
     queue->back->next = new_node;
     queue->back = new_node;
   }
+  queue->size += 1;
   return 0;
 }
 
@@ -93,6 +126,31 @@ void* queue_pop(queue_t queue[static 1]) {
     //queue->front->prev = NULL;
   }
   void* value = node->value;
-  queue_node_free(node);
+  queue->size -= 1;
+  if (queue->pooled) {
+    node->next = queue->spare;
+    queue->spare = node;
+  } else {
+    queue_node_free(node);
+  }
   return value;
 }
+
+void queue_splice(
+  queue_t destination[static 1],
+  queue_t source[static 1]
+) {
+  if (source->front == NULL) {
+    return;
+  }
+  if (destination->back == NULL) {
+    destination->front = source->front;
+  } else {
+    destination->back->next = source->front;
+  }
+  destination->back = source->back;
+  destination->size += source->size;
+  source->front = NULL;
+  source->back = NULL;
+  source->size = 0;
+}
@@ -3,6 +3,9 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#ifdef MESSAGE_QUEUE_STATS
+#include <time.h>
+#endif
 
 /**
  * @file Generic queue, storing its values as void pointers. Can be initialized
@@ -20,6 +23,10 @@ typedef struct queue_node {
   void* value;               /**<pointer to value*/
   //struct queue_node* prev;
   struct queue_node* next;   /**<pointer to next node*/
+#ifdef MESSAGE_QUEUE_STATS
+  struct timespec enqueued;  /**<CLOCK_MONOTONIC time the message queue took
+                                 the value, for its statistics*/
+#endif
 } queue_node_t;
 
 /**
@@ -37,11 +44,18 @@ typedef void (*queue_deleter)(void*);
  * front == back == NULL;
  * 
  * Deleter equal to NULL denotes a non-owning queue.
+ * 
+ * Pooled queue keeps popped nodes in a free list instead of freeing them, so
+ * once it has grown to its usual size pushing and popping don't touch the
+ * heap anymore.
  */
 typedef struct queue {
   queue_node_t* front;    /**<Pointer to first node of the queue*/
   queue_node_t* back;     /**<Pointer to last node of the queue*/
   queue_deleter deleter;  /**<Pointer to cleanup function*/
+  size_t size;            /**<Number of elements*/
+  queue_node_t* spare;    /**<Free list of nodes of a pooled queue*/
+  bool pooled;            /**<Whether popped nodes are kept for reuse*/
 } queue_t;
 
 /**
@@ -73,15 +87,35 @@ void queue_init(
   queue_deleter deleter
 );
 
+/**
+ * @brief Initializes queue_t object reusing its nodes.
+ * 
+ * @param queue Queue_t object to be initialized.
+ * @param deleter Cleanup function for use in case of passing ownership of
+ * objects to the queue, or NULL for non-owning queue.
+ * @param node_count Number of nodes allocated upfront, the pool grows past it
+ * if needed.
+ * @return 0 on success, -1 if allocation failed, in which case nothing has to
+ * be cleaned up.
+ */
+int queue_init_pooled(
+  queue_t queue[static 1],
+  queue_deleter deleter,
+  size_t node_count
+);
+
 /**
  * @brief Performs a cleanup on the queue, freeing all its nodes and invoking
- * a cleanup function(if such was provided on init) on all leftover values.
+ * a cleanup function(if such was provided on init) on all leftover values,
+ * along with the pooled nodes.
  * 
  * @param queue Queue to be freed.
  */
 void queue_destroy(queue_t queue[static 1]);
 
 /**
+ * @brief Constant time, the queue counts its elements as they come and go.
+ * 
  * @param queue 
  * @return Number of elements in the queue.
  */
@@ -114,6 +148,20 @@ int queue_push(queue_t queue[static 1], void* value);
  */
 void* queue_pop(queue_t queue[static 1]);
 
+/**
+ * @brief Moves all elements of source to the back of destination in constant
+ * time, nodes go along with them, pooled nodes of source stay in its pool.
+ * 
+ * Both queues should share the deleter, as destination takes the ownership.
+ * 
+ * @param destination 
+ * @param source Left empty
+ */
+void queue_splice(
+  queue_t destination[static 1],
+  queue_t source[static 1]
+);
+
 
 
 
@@ -0,0 +1,141 @@
+#include "spsc_ring.h"
+
+int spsc_ring_init(
+  spsc_ring_t ring[static 1],
+  size_t capacity,
+  queue_deleter deleter
+) {
+  size_t rounded = 2;
+  while (rounded < capacity) {
+    rounded *= 2;
+  }
+  ring->slots = malloc(sizeof(void*) * rounded);
+  if (ring->slots == NULL) {
+    return -1;
+  }
+  int mtx_flag = mtx_init(&(ring->lock), mtx_plain);
+  if (mtx_flag != thrd_success) {
+    free(ring->slots);
+    return mtx_flag;
+  }
+  int cnd_flag = cnd_init(&(ring->wait));
+  if (cnd_flag != thrd_success) {
+    mtx_destroy(&(ring->lock));
+    free(ring->slots);
+    return cnd_flag;
+  }
+  atomic_init(&(ring->head), 0);
+  atomic_init(&(ring->tail), 0);
+  atomic_init(&(ring->waiting), false);
+  ring->tail_cache = 0;
+  ring->head_cache = 0;
+  ring->mask = rounded - 1;
+  ring->deleter = deleter;
+  return 0;
+}
+
+void spsc_ring_destroy(spsc_ring_t ring[static 1]) {
+  if (ring->deleter) {
+    void* value;
+    while ((value = spsc_ring_try_pop(ring)) != NULL) {
+      ring->deleter(value);
+    }
+  }
+  cnd_destroy(&(ring->wait));
+  mtx_destroy(&(ring->lock));
+  free(ring->slots);
+  ring->slots = NULL;
+}
+
+size_t spsc_ring_capacity(spsc_ring_t ring[static 1]) {
+  return ring->mask + 1;
+}
+
+int spsc_ring_try_push(spsc_ring_t ring[static 1], void* value) {
+  size_t tail = atomic_load_explicit(&(ring->tail), memory_order_relaxed);
+  //the head is reloaded only when the cached one says the ring is full
+  if (tail - ring->head_cache > ring->mask) {
+    ring->head_cache =
+      atomic_load_explicit(&(ring->head), memory_order_acquire);
+    if (tail - ring->head_cache > ring->mask) {
+      return -1;
+    }
+  }
+  ring->slots[tail & ring->mask] = value;
+  atomic_store_explicit(&(ring->tail), tail + 1, memory_order_release);
+  //pairs with the fence in spsc_ring_pop_wait_t, either the consumer sees the
+  //new tail or the producer sees it waiting
+  atomic_thread_fence(memory_order_seq_cst);
+  if (atomic_load_explicit(&(ring->waiting), memory_order_relaxed)) {
+    mtx_lock(&(ring->lock));
+    cnd_signal(&(ring->wait));
+    mtx_unlock(&(ring->lock));
+  }
+  return 0;
+}
+
+void* spsc_ring_try_pop(spsc_ring_t ring[static 1]) {
+  size_t head = atomic_load_explicit(&(ring->head), memory_order_relaxed);
+  if (head == ring->tail_cache) {
+    ring->tail_cache =
+      atomic_load_explicit(&(ring->tail), memory_order_acquire);
+    if (head == ring->tail_cache) {
+      return NULL;
+    }
+  }
+  void* value = ring->slots[head & ring->mask];
+  atomic_store_explicit(&(ring->head), head + 1, memory_order_release);
+  return value;
+}
+
+size_t spsc_ring_try_pop_batch(
+  spsc_ring_t ring[static 1],
+  void* values[],
+  size_t max
+) {
+  size_t head = atomic_load_explicit(&(ring->head), memory_order_relaxed);
+  if (ring->tail_cache - head < max) {
+    ring->tail_cache =
+      atomic_load_explicit(&(ring->tail), memory_order_acquire);
+  }
+  size_t count = ring->tail_cache - head;
+  if (count > max) {
+    count = max;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    values[i] = ring->slots[(head + i) & ring->mask];
+  }
+  if (count != 0) {
+    atomic_store_explicit(&(ring->head), head + count, memory_order_release);
+  }
+  return count;
+}
+
+void* spsc_ring_pop_wait_t(spsc_ring_t ring[static 1], timepoint_t timepoint) {
+  void* value = spsc_ring_try_pop(ring);
+  if (value != NULL) {
+    return value;
+  }
+  int mtx_flag = mtx_lock(&(ring->lock));
+  if (mtx_flag != thrd_success) {
+    return NULL;
+  }
+  while (true) {
+    atomic_store_explicit(&(ring->waiting), true, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    value = spsc_ring_try_pop(ring);
+    if (value != NULL) {
+      break;
+    }
+    //producer signals only under the lock, so it can't slip in before the
+    //wait starts
+    int cnd_flag = cnd_timedwait(&(ring->wait), &(ring->lock), &timepoint);
+    if (cnd_flag != thrd_success) {
+      value = spsc_ring_try_pop(ring);
+      break;
+    }
+  }
+  atomic_store_explicit(&(ring->waiting), false, memory_order_relaxed);
+  mtx_unlock(&(ring->lock));
+  return value;
+}
@@ -0,0 +1,129 @@
+#ifndef SKAI_DATA_STRUCTURES_SPSC_RING_H
+#define SKAI_DATA_STRUCTURES_SPSC_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <threads.h>
+
+#include "queue.h"
+#include "utilities/time.h"
+
+/**
+ * @file Fixed capacity ring passing pointers from exactly one producer thread
+ * to exactly one consumer thread without locks.
+ * 
+ * Push and pop only touch the indices through atomics, the mutex and
+ * condition variable are there for the consumer to sleep on when it waits for
+ * an element, the producer takes the mutex only if the consumer is asleep.
+ */
+
+/**
+ * @brief Assumed size of a cache line, indices written by different threads
+ * are kept this far apart.
+ */
+enum { SPSC_RING_CACHE_LINE = 64 };
+
+/**
+ * @brief Single-producer single-consumer ring of pointers.
+ * 
+ * Indices grow without wrapping around the capacity, the slot is the index
+ * masked by capacity - 1, so their difference is the number of elements.
+ * 
+ * Accessing struct fields directly is not recommended.
+ */
+typedef struct spsc_ring {
+  _Alignas(SPSC_RING_CACHE_LINE) atomic_size_t head;  /**<Next slot to pop,
+                                                          written by the
+                                                          consumer*/
+  size_t tail_cache;        /**<Consumer's last view of the tail*/
+  _Alignas(SPSC_RING_CACHE_LINE) atomic_size_t tail;  /**<Next slot to push,
+                                                          written by the
+                                                          producer*/
+  size_t head_cache;        /**<Producer's last view of the head*/
+  _Alignas(SPSC_RING_CACHE_LINE) void** slots;  /**<Owned array of slots*/
+  size_t mask;              /**<Capacity - 1, capacity being a power of 2*/
+  queue_deleter deleter;    /**<Cleanup function for leftovers or NULL*/
+  atomic_bool waiting;      /**<Consumer is about to sleep or sleeping*/
+  mtx_t lock;               /**<Guards sleeping of the consumer*/
+  cnd_t wait;               /**<Consumer sleeps on it while the ring is
+                                empty*/
+} spsc_ring_t;
+
+/**
+ * @brief Initializes the ring.
+ * 
+ * @param ring Ring to initialize
+ * @param capacity Minimal number of elements the ring holds, rounded up to
+ * a power of 2
+ * @param deleter Cleanup function for elements left in the ring when it's
+ * destroyed or NULL for non-owning ring
+ * @return 0 on success, non-0 value on error.
+ */
+int spsc_ring_init(
+  spsc_ring_t ring[static 1],
+  size_t capacity,
+  queue_deleter deleter
+);
+
+/**
+ * @brief Frees the ring, invoking the deleter on leftover elements.
+ * 
+ * @param ring 
+ */
+void spsc_ring_destroy(spsc_ring_t ring[static 1]);
+
+/**
+ * @param ring 
+ * @return Number of elements the ring holds.
+ */
+size_t spsc_ring_capacity(spsc_ring_t ring[static 1]);
+
+/**
+ * @brief Pushes the element without blocking, to be called only by the
+ * producer thread.
+ * 
+ * @param ring 
+ * @param value Pointer to the element, can't be a NULL pointer
+ * @return 0 on success, -1 if the ring is full, in which case the ownership
+ * stays with the caller.
+ */
+int spsc_ring_try_push(spsc_ring_t ring[static 1], void* value);
+
+/**
+ * @brief Pops the element without blocking, to be called only by the consumer
+ * thread.
+ * 
+ * @param ring 
+ * @return Pointer to the element, NULL if the ring is empty, caller takes
+ * ownership.
+ */
+void* spsc_ring_try_pop(spsc_ring_t ring[static 1]);
+
+/**
+ * @brief Pops up to max elements without blocking, publishing the new head
+ * once for all of them, to be called only by the consumer thread.
+ * 
+ * @param ring 
+ * @param values Buffer for the popped elements, at least max long
+ * @param max Maximal number of popped elements
+ * @return Number of popped elements, caller takes ownership of them.
+ */
+size_t spsc_ring_try_pop_batch(
+  spsc_ring_t ring[static 1],
+  void* values[],
+  size_t max
+);
+
+/**
+ * @brief Blocks until it can pop an element from the ring or until
+ * a specific timepoint, to be called only by the consumer thread.
+ * 
+ * @param ring 
+ * @param timepoint Deadline in the same clock as timepoint_now
+ * @return Pointer to element if succeeded, NULL if no elements were available
+ * before the timeout, caller takes ownership.
+ */
+void* spsc_ring_pop_wait_t(spsc_ring_t ring[static 1], timepoint_t timepoint);
+
+#endif
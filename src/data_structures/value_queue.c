@@ -0,0 +1,122 @@
+#include "value_queue.h"
+
+#include <string.h>
+
+static value_queue_chunk_t* value_queue_chunk_new(
+  value_queue_t queue[static 1]
+) {
+  value_queue_chunk_t* chunk = queue->spare;
+  if (chunk != NULL) {
+    queue->spare = NULL;
+  } else {
+    chunk = malloc(
+      sizeof(value_queue_chunk_t) + queue->element_size * queue->chunk_length
+    );
+    if (chunk == NULL) {
+      return NULL;
+    }
+  }
+  chunk->next = NULL;
+  return chunk;
+}
+
+static unsigned char* value_queue_slot(
+  value_queue_t queue[static 1],
+  value_queue_chunk_t* chunk,
+  size_t index
+) {
+  return (unsigned char*)chunk->data + queue->element_size * index;
+}
+
+int value_queue_init(
+  value_queue_t queue[static 1],
+  size_t element_size,
+  size_t chunk_length
+) {
+  if (element_size == 0) {
+    return -1;
+  }
+  queue->element_size = element_size;
+  queue->chunk_length =
+    (chunk_length != 0) ? chunk_length : VALUE_QUEUE_CHUNK_LENGTH;
+  queue->spare = NULL;
+  queue->front = value_queue_chunk_new(queue);
+  if (queue->front == NULL) {
+    return -1;
+  }
+  queue->back = queue->front;
+  queue->head = 0;
+  queue->tail = 0;
+  queue->size = 0;
+  return 0;
+}
+
+void value_queue_destroy(value_queue_t queue[static 1]) {
+  value_queue_chunk_t* chunk = queue->front;
+  while (chunk != NULL) {
+    value_queue_chunk_t* next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+  free(queue->spare);
+  queue->front = NULL;
+  queue->back = NULL;
+  queue->spare = NULL;
+  queue->size = 0;
+}
+
+size_t value_queue_size(value_queue_t queue[static 1]) {
+  return queue->size;
+}
+
+bool value_queue_empty(value_queue_t queue[static 1]) {
+  return queue->size == 0;
+}
+
+int value_queue_push(value_queue_t queue[static 1], const void* element) {
+  if (queue->tail == queue->chunk_length) {
+    value_queue_chunk_t* chunk = value_queue_chunk_new(queue);
+    if (chunk == NULL) {
+      return -1;
+    }
+    queue->back->next = chunk;
+    queue->back = chunk;
+    queue->tail = 0;
+  }
+  memcpy(
+    value_queue_slot(queue, queue->back, queue->tail),
+    element,
+    queue->element_size
+  );
+  queue->tail += 1;
+  queue->size += 1;
+  return 0;
+}
+
+int value_queue_pop(value_queue_t queue[static 1], void* element) {
+  if (queue->size == 0) {
+    return -1;
+  }
+  memcpy(
+    element,
+    value_queue_slot(queue, queue->front, queue->head),
+    queue->element_size
+  );
+  queue->head += 1;
+  queue->size -= 1;
+  if (queue->size == 0) {
+    //last element was in the back chunk, which starts over from its beginning
+    queue->head = 0;
+    queue->tail = 0;
+  } else if (queue->head == queue->chunk_length) {
+    value_queue_chunk_t* emptied = queue->front;
+    queue->front = emptied->next;
+    queue->head = 0;
+    if (queue->spare == NULL) {
+      queue->spare = emptied;
+    } else {
+      free(emptied);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,106 @@
+#ifndef SKAI_DATA_STRUCTURES_VALUE_QUEUE_H
+#define SKAI_DATA_STRUCTURES_VALUE_QUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/**
+ * @file Queue of fixed-size elements stored by value, companion of queue_t for
+ * payloads small enough that boxing each of them on the heap costs more than
+ * copying it.
+ * 
+ * Elements are copied in and out of chunks holding many of them back to back,
+ * so pushing allocates only when a chunk fills up, and an emptied chunk is
+ * kept for reuse, so a queue of steady size doesn't allocate at all.
+ */
+
+/**
+ * @brief Block of consecutive elements, chunks are linked from the oldest to
+ * the newest one.
+ */
+typedef struct value_queue_chunk {
+  struct value_queue_chunk* next;   /**<Newer chunk or NULL*/
+  max_align_t data[];               /**<Storage of chunk_length elements*/
+} value_queue_chunk_t;
+
+/**
+ * @brief Queue of elements of a single size.
+ * 
+ * Front and back are the same chunk while all elements fit in one, there's
+ * always at least one chunk.
+ * 
+ * Accessing struct fields directly is not recommended.
+ */
+typedef struct value_queue {
+  value_queue_chunk_t* front;   /**<Chunk holding the oldest element*/
+  value_queue_chunk_t* back;    /**<Chunk the next element goes to*/
+  value_queue_chunk_t* spare;   /**<Emptied chunk kept for reuse or NULL*/
+  size_t head;                  /**<Index of the oldest element in front*/
+  size_t tail;                  /**<Index of the next free slot in back*/
+  size_t element_size;          /**<Size of a single element in bytes*/
+  size_t chunk_length;          /**<Number of elements in a chunk*/
+  size_t size;                  /**<Number of elements*/
+} value_queue_t;
+
+/**
+ * @brief Default number of elements in a chunk.
+ */
+enum {
+  VALUE_QUEUE_CHUNK_LENGTH = 64
+};
+
+/**
+ * @brief Initializes the queue with its first chunk.
+ * 
+ * @param queue Queue to initialize
+ * @param element_size Size of every element in bytes, at least 1
+ * @param chunk_length Number of elements in a chunk, 0 for
+ * VALUE_QUEUE_CHUNK_LENGTH
+ * @return 0 on success, -1 on allocation failure or zero element size, in
+ * which case nothing has to be cleaned up.
+ */
+int value_queue_init(
+  value_queue_t queue[static 1],
+  size_t element_size,
+  size_t chunk_length
+);
+
+/**
+ * @brief Frees the chunks, elements are plain data and need no cleanup.
+ * 
+ * @param queue 
+ */
+void value_queue_destroy(value_queue_t queue[static 1]);
+
+/**
+ * @param queue 
+ * @return Number of elements in the queue.
+ */
+size_t value_queue_size(value_queue_t queue[static 1]);
+
+/**
+ * @param queue 
+ * @return true if the queue has no elements, false otherwise
+ */
+bool value_queue_empty(value_queue_t queue[static 1]);
+
+/**
+ * @brief Copies the element to the back of the queue.
+ * 
+ * @param queue 
+ * @param element Pointer to element_size bytes
+ * @return 0 on success, -1 if a new chunk couldn't be allocated
+ */
+int value_queue_push(value_queue_t queue[static 1], const void* element);
+
+/**
+ * @brief Copies the oldest element out and removes it from the queue.
+ * 
+ * @param queue 
+ * @param element Pointer to element_size bytes the element is copied to
+ * @return 0 on success, -1 if the queue is empty
+ */
+int value_queue_pop(value_queue_t queue[static 1], void* element);
+
+#endif
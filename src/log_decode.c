@@ -0,0 +1,55 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "logger/log_binary.h"
+
+/**
+ * @brief Renders a binary log written with --binary-log back to the text of
+ * ./log.
+ * 
+ * Usage: log_decode [binary log] [text output]
+ * 
+ * Reads ./log.bin without arguments and writes to stdout without the second
+ * one. Records decoded before an error are kept in the output.
+ * 
+ * @return int 
+ */
+int main(int argc, char* argv[]) {
+  const char* input_path = (argc > 1) ? argv[1] : "./log.bin";
+  FILE* input = fopen(input_path, "rb");
+  if (input == NULL) {
+    fprintf(stderr, "Failed to open %s.\n", input_path);
+    return EXIT_FAILURE;
+  }
+  FILE* output = stdout;
+  if (argc > 2) {
+    output = fopen(argv[2], "w");
+    if (output == NULL) {
+      fprintf(stderr, "Failed to open %s.\n", argv[2]);
+      fclose(input);
+      return EXIT_FAILURE;
+    }
+  }
+  int decode_flag = log_binary_decode(input, output);
+  fclose(input);
+  if (output != stdout) {
+    fclose(output);
+  }
+  if (decode_flag == -1) {
+    fprintf(stderr, "%s isn't a valid binary log of this build.\n", input_path);
+    return EXIT_FAILURE;
+  }
+  if (decode_flag == -3) {
+    fprintf(
+      stderr,
+      "%s is truncated, records up to the cut were decoded.\n",
+      input_path
+    );
+    return EXIT_FAILURE;
+  }
+  if (decode_flag) {
+    fputs("Failed to allocate memory.\n", stderr);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,523 @@
+//for strnlen
+#define _POSIX_C_SOURCE 200809L
+
+#include "log_args.h"
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Longest conversion that gets rendered, with the '*' replaced by the
+ * numbers.
+ */
+enum {
+  LOG_ARGS_SPEC_MAX = 64
+};
+
+/**
+ * @brief Length modifiers of a conversion.
+ */
+typedef enum log_arg_modifier {
+  log_modifier_none,
+  log_modifier_hh,
+  log_modifier_h,
+  log_modifier_l,
+  log_modifier_ll,
+  log_modifier_j,
+  log_modifier_z,
+  log_modifier_t,
+  log_modifier_L
+} log_arg_modifier_t;
+
+static log_arg_modifier_t log_args_modifier(const char* cursor[static 1]) {
+  switch (**cursor) {
+    case 'h':
+      *cursor += 1;
+      if (**cursor == 'h') {
+        *cursor += 1;
+        return log_modifier_hh;
+      }
+      return log_modifier_h;
+    case 'l':
+      *cursor += 1;
+      if (**cursor == 'l') {
+        *cursor += 1;
+        return log_modifier_ll;
+      }
+      return log_modifier_l;
+    case 'j':
+      *cursor += 1;
+      return log_modifier_j;
+    case 'z':
+      *cursor += 1;
+      return log_modifier_z;
+    case 't':
+      *cursor += 1;
+      return log_modifier_t;
+    case 'L':
+      *cursor += 1;
+      return log_modifier_L;
+    default:
+      return log_modifier_none;
+  }
+}
+
+/**
+ * @brief Type read by an integer conversion with the modifier.
+ */
+static log_arg_kind_t log_args_integer_kind(log_arg_modifier_t modifier) {
+  switch (modifier) {
+    case log_modifier_none:
+    case log_modifier_hh:
+    case log_modifier_h:
+      return log_arg_int;
+    case log_modifier_l:
+      return log_arg_long;
+    case log_modifier_ll:
+      return log_arg_llong;
+    case log_modifier_j:
+      return log_arg_intmax;
+    case log_modifier_z:
+      return log_arg_size;
+    case log_modifier_t:
+      return log_arg_ptrdiff;
+    default:
+      return log_arg_invalid;
+  }
+}
+
+static log_arg_kind_t log_args_kind(
+  char conversion,
+  log_arg_modifier_t modifier
+) {
+  switch (conversion) {
+    case '%':
+      return log_arg_none;
+    case 'd':
+    case 'i':
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+      return log_args_integer_kind(modifier);
+    case 'c':
+      return (modifier == log_modifier_none) ? log_arg_int : log_arg_invalid;
+    case 's':
+      return (modifier == log_modifier_none) ?
+        log_arg_string :
+        log_arg_invalid;
+    case 'p':
+      return (modifier == log_modifier_none) ?
+        log_arg_pointer :
+        log_arg_invalid;
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+      if (modifier == log_modifier_none || modifier == log_modifier_l) {
+        return log_arg_double;
+      }
+      return (modifier == log_modifier_L) ? log_arg_ldouble : log_arg_invalid;
+    default:
+      return log_arg_invalid;
+  }
+}
+
+bool log_args_next_spec(
+  const char* format[static 1],
+  log_arg_spec_t spec[static 1]
+) {
+  const char* percent = strchr(*format, '%');
+  if (percent == NULL) {
+    *format += strlen(*format);
+    return false;
+  }
+  const char* cursor = percent + 1;
+  spec->start = percent;
+  spec->star_count = 0;
+  spec->precision_star = false;
+  spec->precision = -1;
+  cursor += strspn(cursor, "-+ #0");
+  if (*cursor == '*') {
+    spec->star_count += 1;
+    cursor += 1;
+  } else {
+    cursor += strspn(cursor, "0123456789");
+  }
+  if (*cursor == '.') {
+    cursor += 1;
+    if (*cursor == '*') {
+      spec->star_count += 1;
+      spec->precision_star = true;
+      cursor += 1;
+    } else {
+      //a lone '.' is a precision of 0
+      spec->precision = 0;
+      for (; *cursor >= '0' && *cursor <= '9'; ++cursor) {
+        int digit = *cursor - '0';
+        spec->precision = (spec->precision > (INT_MAX - digit) / 10) ?
+          INT_MAX :
+          spec->precision * 10 + digit;
+      }
+    }
+  }
+  log_arg_modifier_t modifier = log_args_modifier(&cursor);
+  if (*cursor == '\0') {
+    spec->kind = log_arg_invalid;
+    spec->length = (size_t)(cursor - percent);
+    *format = cursor;
+    return true;
+  }
+  spec->kind = log_args_kind(*cursor, modifier);
+  spec->length = (size_t)(cursor + 1 - percent);
+  *format = cursor + 1;
+  return true;
+}
+
+static size_t log_args_store(
+  unsigned char* buffer,
+  size_t offset,
+  const void* value,
+  size_t size
+) {
+  if (buffer != NULL) {
+    memcpy(buffer + offset, value, size);
+  }
+  return size;
+}
+
+size_t log_args_capture(
+  const char* format,
+  va_list* arguments,
+  unsigned char* buffer
+) {
+  size_t size = 0;
+  log_arg_spec_t spec;
+  while (log_args_next_spec(&format, &spec)) {
+    if (spec.kind == log_arg_invalid) {
+      break;
+    }
+    int precision = spec.precision;
+    for (unsigned i = 0; i < spec.star_count; ++i) {
+      int star = va_arg(*arguments, int);
+      size += log_args_store(buffer, size, &star, sizeof(star));
+      if (spec.precision_star && i + 1 == spec.star_count) {
+        precision = star;
+      }
+    }
+    switch (spec.kind) {
+      case log_arg_int: {
+        int value = va_arg(*arguments, int);
+        size += log_args_store(buffer, size, &value, sizeof(value));
+        break;
+      }
+      case log_arg_long: {
+        long value = va_arg(*arguments, long);
+        size += log_args_store(buffer, size, &value, sizeof(value));
+        break;
+      }
+      case log_arg_llong: {
+        long long value = va_arg(*arguments, long long);
+        size += log_args_store(buffer, size, &value, sizeof(value));
+        break;
+      }
+      case log_arg_intmax: {
+        intmax_t value = va_arg(*arguments, intmax_t);
+        size += log_args_store(buffer, size, &value, sizeof(value));
+        break;
+      }
+      case log_arg_size: {
+        size_t value = va_arg(*arguments, size_t);
+        size += log_args_store(buffer, size, &value, sizeof(value));
+        break;
+      }
+      case log_arg_ptrdiff: {
+        ptrdiff_t value = va_arg(*arguments, ptrdiff_t);
+        size += log_args_store(buffer, size, &value, sizeof(value));
+        break;
+      }
+      case log_arg_double: {
+        double value = va_arg(*arguments, double);
+        size += log_args_store(buffer, size, &value, sizeof(value));
+        break;
+      }
+      case log_arg_ldouble: {
+        long double value = va_arg(*arguments, long double);
+        size += log_args_store(buffer, size, &value, sizeof(value));
+        break;
+      }
+      case log_arg_pointer: {
+        void* value = va_arg(*arguments, void*);
+        size += log_args_store(buffer, size, &value, sizeof(value));
+        break;
+      }
+      case log_arg_string: {
+        const char* value = va_arg(*arguments, const char*);
+        //the way glibc prints it
+        if (value == NULL) {
+          value = "(null)";
+        }
+        //the text may not be terminated within the precision
+        size_t length = (precision < 0) ?
+          strlen(value) :
+          strnlen(value, (size_t)precision);
+        size += log_args_store(buffer, size, value, length);
+        size += log_args_store(buffer, size, "", 1);
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  return size;
+}
+
+/**
+ * @brief Size an argument of the kind is stored with, 0 for strings, whose
+ * size depends on their text.
+ */
+static size_t log_args_kind_size(log_arg_kind_t kind) {
+  switch (kind) {
+    case log_arg_int:
+      return sizeof(int);
+    case log_arg_long:
+      return sizeof(long);
+    case log_arg_llong:
+      return sizeof(long long);
+    case log_arg_intmax:
+      return sizeof(intmax_t);
+    case log_arg_size:
+      return sizeof(size_t);
+    case log_arg_ptrdiff:
+      return sizeof(ptrdiff_t);
+    case log_arg_double:
+      return sizeof(double);
+    case log_arg_ldouble:
+      return sizeof(long double);
+    case log_arg_pointer:
+      return sizeof(void*);
+    default:
+      return 0;
+  }
+}
+
+bool log_args_check(
+  const char* format,
+  const unsigned char* arguments,
+  size_t size
+) {
+  size_t position = 0;
+  log_arg_spec_t spec;
+  while (log_args_next_spec(&format, &spec)) {
+    if (spec.kind == log_arg_invalid) {
+      break;
+    }
+    size_t needed =
+      spec.star_count * sizeof(int) + log_args_kind_size(spec.kind);
+    if (size - position < needed) {
+      return false;
+    }
+    position += needed;
+    if (spec.kind == log_arg_string) {
+      const unsigned char* terminator = (position < size) ?
+        memchr(arguments + position, '\0', size - position) :
+        NULL;
+      if (terminator == NULL) {
+        return false;
+      }
+      position = (size_t)(terminator - arguments) + 1;
+    }
+  }
+  return position == size;
+}
+
+/**
+ * @brief Copies the conversion with the '*' replaced by the captured numbers.
+ * 
+ * @return true on success, false if the conversion is too long.
+ */
+static bool log_args_expand_spec(
+  char expanded[static LOG_ARGS_SPEC_MAX],
+  log_arg_spec_t spec[static 1],
+  const unsigned char* arguments[static 1]
+) {
+  size_t length = 0;
+  for (size_t i = 0; i < spec->length; ++i) {
+    char character = spec->start[i];
+    if (character != '*') {
+      if (length + 1 >= LOG_ARGS_SPEC_MAX) {
+        return false;
+      }
+      expanded[length++] = character;
+      continue;
+    }
+    int star;
+    memcpy(&star, *arguments, sizeof(star));
+    *arguments += sizeof(star);
+    if (star < 0 && length != 0 && expanded[length - 1] == '.') {
+      //negative precision counts as none at all
+      length -= 1;
+      continue;
+    }
+    //negative width comes out as the '-' flag followed by the width
+    int written = snprintf(
+      expanded + length,
+      LOG_ARGS_SPEC_MAX - length,
+      "%d",
+      star
+    );
+    if (written < 0 || length + (size_t)written + 1 >= LOG_ARGS_SPEC_MAX) {
+      return false;
+    }
+    length += (size_t)written;
+  }
+  expanded[length] = '\0';
+  return true;
+}
+
+/**
+ * @brief Appends the text to the output, keeping track of the whole length.
+ */
+static void log_args_append(
+  char* output,
+  size_t size,
+  size_t length[static 1],
+  const char* text,
+  size_t text_length
+) {
+  if (*length + 1 < size) {
+    size_t space = size - *length - 1;
+    memcpy(
+      output + *length,
+      text,
+      (text_length < space) ? text_length : space
+    );
+  }
+  *length += text_length;
+}
+
+/**
+ * @brief Renders a single conversion of the captured argument.
+ * 
+ * @return Length of the rendered text, negative on error.
+ */
+static int log_args_render(
+  char* output,
+  size_t size,
+  const char conversion[static 1],
+  log_arg_kind_t kind,
+  const unsigned char* arguments[static 1]
+) {
+  switch (kind) {
+    case log_arg_none:
+      return snprintf(output, size, "%%");
+    case log_arg_int: {
+      int value;
+      memcpy(&value, *arguments, sizeof(value));
+      *arguments += sizeof(value);
+      return snprintf(output, size, conversion, value);
+    }
+    case log_arg_long: {
+      long value;
+      memcpy(&value, *arguments, sizeof(value));
+      *arguments += sizeof(value);
+      return snprintf(output, size, conversion, value);
+    }
+    case log_arg_llong: {
+      long long value;
+      memcpy(&value, *arguments, sizeof(value));
+      *arguments += sizeof(value);
+      return snprintf(output, size, conversion, value);
+    }
+    case log_arg_intmax: {
+      intmax_t value;
+      memcpy(&value, *arguments, sizeof(value));
+      *arguments += sizeof(value);
+      return snprintf(output, size, conversion, value);
+    }
+    case log_arg_size: {
+      size_t value;
+      memcpy(&value, *arguments, sizeof(value));
+      *arguments += sizeof(value);
+      return snprintf(output, size, conversion, value);
+    }
+    case log_arg_ptrdiff: {
+      ptrdiff_t value;
+      memcpy(&value, *arguments, sizeof(value));
+      *arguments += sizeof(value);
+      return snprintf(output, size, conversion, value);
+    }
+    case log_arg_double: {
+      double value;
+      memcpy(&value, *arguments, sizeof(value));
+      *arguments += sizeof(value);
+      return snprintf(output, size, conversion, value);
+    }
+    case log_arg_ldouble: {
+      long double value;
+      memcpy(&value, *arguments, sizeof(value));
+      *arguments += sizeof(value);
+      return snprintf(output, size, conversion, value);
+    }
+    case log_arg_pointer: {
+      void* value;
+      memcpy(&value, *arguments, sizeof(value));
+      *arguments += sizeof(value);
+      return snprintf(output, size, conversion, value);
+    }
+    case log_arg_string: {
+      //stored in place, so it can be printed straight from the arguments
+      const char* value = (const char*)*arguments;
+      *arguments += strlen(value) + 1;
+      return snprintf(output, size, conversion, value);
+    }
+    default:
+      return -1;
+  }
+}
+
+size_t log_args_format(
+  char* output,
+  size_t size,
+  const char* format,
+  const unsigned char* arguments
+) {
+  size_t length = 0;
+  const char* cursor = format;
+  log_arg_spec_t spec;
+  while (true) {
+    const char* text = cursor;
+    bool found = log_args_next_spec(&cursor, &spec);
+    const char* text_end = found ? spec.start : cursor;
+    log_args_append(output, size, &length, text, (size_t)(text_end - text));
+    if (!found || spec.kind == log_arg_invalid) {
+      break;
+    }
+    char conversion[LOG_ARGS_SPEC_MAX];
+    if (!log_args_expand_spec(conversion, &spec, &arguments)) {
+      break;
+    }
+    bool fits = length < size;
+    int written = log_args_render(
+      fits ? output + length : NULL,
+      fits ? size - length : 0,
+      conversion,
+      spec.kind,
+      &arguments
+    );
+    if (written < 0) {
+      break;
+    }
+    length += (size_t)written;
+  }
+  if (size != 0) {
+    output[(length < size) ? length : size - 1] = '\0';
+  }
+  return length;
+}
@@ -0,0 +1,117 @@
+#ifndef SKAI_LOGGER_LOG_ARGS_H
+#define SKAI_LOGGER_LOG_ARGS_H
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @file Deferred printf formatting, the caller captures only the raw bytes of
+ * the arguments, formatting them by the same format string happens later and
+ * possibly on another thread.
+ * 
+ * Arguments are stored one after another in the order of the conversions,
+ * each as the type the conversion reads, strings are copied up to their
+ * precision and get a terminator. The format string itself isn't copied, it
+ * has to outlive the captured arguments, which string literals do.
+ * 
+ * Conversions %n, %lc and %ls aren't supported, the rendering of a format
+ * using them stops right before.
+ */
+
+/**
+ * @brief Types the arguments are read and stored as.
+ */
+typedef enum log_arg_kind {
+  log_arg_none,       /**<%%, no argument*/
+  log_arg_int,        /**<int, also for char and short, which get promoted*/
+  log_arg_long,       /**<long*/
+  log_arg_llong,      /**<long long*/
+  log_arg_intmax,     /**<intmax_t*/
+  log_arg_size,       /**<size_t*/
+  log_arg_ptrdiff,    /**<ptrdiff_t*/
+  log_arg_double,     /**<double, also for float, which gets promoted*/
+  log_arg_ldouble,    /**<long double*/
+  log_arg_pointer,    /**<void* of %p*/
+  log_arg_string,     /**<null-terminated string of %s*/
+  log_arg_invalid     /**<unsupported or malformed conversion*/
+} log_arg_kind_t;
+
+/**
+ * @brief Single conversion of a format string.
+ */
+typedef struct log_arg_spec {
+  const char* start;        /**<The '%' starting the conversion*/
+  size_t length;            /**<Length up to and including the conversion
+                                character*/
+  unsigned star_count;      /**<Number of int arguments for width and
+                                precision given as '*'*/
+  bool precision_star;      /**<Whether the precision is given as '*', the
+                                last of the int arguments then*/
+  int precision;            /**<Precision given as digits, negative if there
+                                is none or it's given as '*'*/
+  log_arg_kind_t kind;      /**<Type of the converted argument*/
+} log_arg_spec_t;
+
+/**
+ * @brief Finds the next conversion of the format string.
+ * 
+ * @param format Position in the format string, moved past the conversion
+ * @param spec Filled in with the conversion
+ * @return true if there was a conversion, false if the string ended.
+ */
+bool log_args_next_spec(
+  const char* format[static 1],
+  log_arg_spec_t spec[static 1]
+);
+
+/**
+ * @brief Captures the arguments of the format string, consuming them from the
+ * list.
+ * 
+ * @param format printf format string
+ * @param arguments Arguments matching the format
+ * @param buffer Where the arguments get stored or NULL to only measure them
+ * @return Number of bytes the arguments take.
+ */
+size_t log_args_capture(
+  const char* format,
+  va_list* arguments,
+  unsigned char* buffer
+);
+
+/**
+ * @brief Checks that the bytes hold exactly the arguments of the format, so
+ * formatting them stays within the bytes.
+ * 
+ * @param format printf format string
+ * @param arguments Bytes to check, can be NULL if size is 0
+ * @param size Number of the bytes
+ * @return true if every argument fits and strings are terminated within
+ * their bytes, with none left over, false otherwise.
+ */
+bool log_args_check(
+  const char* format,
+  const unsigned char* arguments,
+  size_t size
+);
+
+/**
+ * @brief Formats the captured arguments by the format string they were
+ * captured with, like snprintf.
+ * 
+ * @param output Buffer for the text, can be NULL if size is 0
+ * @param size Size of the output buffer, the text gets cut to fit it with its
+ * terminator
+ * @param format Format string the arguments were captured with
+ * @param arguments Captured arguments
+ * @return Length of the whole text, without the terminator.
+ */
+size_t log_args_format(
+  char* output,
+  size_t size,
+  const char* format,
+  const unsigned char* arguments
+);
+
+#endif
@@ -0,0 +1,664 @@
+#include "log_binary.h"
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log_args.h"
+#include "output_sinks.h"
+
+enum {
+  LOG_BINARY_MAGIC_LENGTH = sizeof(LOG_BINARY_MAGIC) - 1,
+  LOG_BINARY_LAYOUT_LENGTH = 9,
+  LOG_BINARY_BYTE_ORDER = 0x01020304
+};
+
+/**
+ * @brief Sizes of the types the arguments are stored as, a log can be read
+ * only where they're the same.
+ */
+static void log_binary_layout(
+  unsigned char layout[static LOG_BINARY_LAYOUT_LENGTH]
+) {
+  const unsigned char sizes[LOG_BINARY_LAYOUT_LENGTH] = {
+    sizeof(int),
+    sizeof(long),
+    sizeof(long long),
+    sizeof(intmax_t),
+    sizeof(size_t),
+    sizeof(ptrdiff_t),
+    sizeof(double),
+    sizeof(long double),
+    sizeof(void*)
+  };
+  memcpy(layout, sizes, LOG_BINARY_LAYOUT_LENGTH);
+}
+
+/**
+ * @brief Output keeping track of the whole length, bytes past the end of the
+ * buffer are only counted.
+ */
+typedef struct log_binary_writer {
+  unsigned char* buffer;
+  size_t size;
+  size_t length;
+} log_binary_writer_t;
+
+static void log_binary_put(
+  log_binary_writer_t writer[static 1],
+  const void* bytes,
+  size_t count
+) {
+  if (writer->length < writer->size) {
+    size_t space = writer->size - writer->length;
+    memcpy(
+      writer->buffer + writer->length,
+      bytes,
+      (count < space) ? count : space
+    );
+  }
+  writer->length += count;
+}
+
+static void log_binary_put_byte(
+  log_binary_writer_t writer[static 1],
+  unsigned char byte
+) {
+  log_binary_put(writer, &byte, 1);
+}
+
+static size_t log_binary_varint_size(uint64_t value) {
+  size_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    size += 1;
+  }
+  return size;
+}
+
+static void log_binary_put_varint(
+  log_binary_writer_t writer[static 1],
+  uint64_t value
+) {
+  while (value >= 0x80) {
+    log_binary_put_byte(writer, (unsigned char)(value | 0x80));
+    value >>= 7;
+  }
+  log_binary_put_byte(writer, (unsigned char)value);
+}
+
+/**
+ * @brief Maps signed values to unsigned ones, small in magnitude to small.
+ */
+static uint64_t log_binary_zigzag(int64_t value) {
+  return (value < 0) ?
+    ~((uint64_t)value << 1) :
+    (uint64_t)value << 1;
+}
+
+static int64_t log_binary_unzigzag(uint64_t value) {
+  return (value & 1) ?
+    -(int64_t)(value >> 1) - 1 :
+    (int64_t)(value >> 1);
+}
+
+int log_binary_encoder_init(
+  log_binary_encoder_t encoder[static 1],
+  timepoint_t start
+) {
+  encoder->previous = start;
+  encoder->format_capacity = 64;
+  encoder->format_count = 0;
+  encoder->formats =
+    calloc(encoder->format_capacity, sizeof(log_binary_format_t));
+  if (encoder->formats == NULL) {
+    return -1;
+  }
+  encoder->thread_capacity = 16;
+  encoder->thread_count = 0;
+  encoder->threads = malloc(encoder->thread_capacity * sizeof(thrd_t));
+  if (encoder->threads == NULL) {
+    free(encoder->formats);
+    return -1;
+  }
+  return 0;
+}
+
+void log_binary_encoder_destroy(log_binary_encoder_t encoder[static 1]) {
+  free(encoder->formats);
+  free(encoder->threads);
+  encoder->formats = NULL;
+  encoder->threads = NULL;
+}
+
+int log_binary_header(
+  log_binary_encoder_t encoder[static 1],
+  char* buffer,
+  size_t size
+) {
+  log_binary_writer_t writer = {
+    .buffer = (unsigned char*)buffer,
+    .size = size,
+    .length = 0
+  };
+  unsigned char layout[LOG_BINARY_LAYOUT_LENGTH];
+  log_binary_layout(layout);
+  uint32_t byte_order = LOG_BINARY_BYTE_ORDER;
+  log_binary_put(&writer, LOG_BINARY_MAGIC, LOG_BINARY_MAGIC_LENGTH);
+  log_binary_put_byte(&writer, LOG_BINARY_VERSION);
+  log_binary_put(&writer, layout, LOG_BINARY_LAYOUT_LENGTH);
+  log_binary_put(&writer, &byte_order, sizeof(byte_order));
+  log_binary_put_varint(&writer, (uint64_t)encoder->previous.tv_sec);
+  log_binary_put_varint(&writer, (uint64_t)encoder->previous.tv_nsec);
+  return (int)writer.length;
+}
+
+static log_binary_format_t* log_binary_format_slot(
+  log_binary_encoder_t encoder[static 1],
+  const char* format
+) {
+  size_t mask = encoder->format_capacity - 1;
+  //string literals are at least a few bytes apart
+  size_t i = (size_t)((uintptr_t)format >> 3) & mask;
+  while (
+    encoder->formats[i].format != NULL &&
+    encoder->formats[i].format != format
+  ) {
+    i = (i + 1) & mask;
+  }
+  return &(encoder->formats[i]);
+}
+
+/**
+ * @brief Makes room for one more format and thread, so remembering a record
+ * can't fail.
+ * 
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int log_binary_reserve(log_binary_encoder_t encoder[static 1]) {
+  if ((encoder->format_count + 1) * 2 > encoder->format_capacity) {
+    log_binary_encoder_t grown = *encoder;
+    grown.format_capacity *= 2;
+    grown.formats = calloc(grown.format_capacity, sizeof(log_binary_format_t));
+    if (grown.formats == NULL) {
+      return -1;
+    }
+    for (size_t i = 0; i < encoder->format_capacity; ++i) {
+      if (encoder->formats[i].format != NULL) {
+        *log_binary_format_slot(&grown, encoder->formats[i].format) =
+          encoder->formats[i];
+      }
+    }
+    free(encoder->formats);
+    encoder->formats = grown.formats;
+    encoder->format_capacity = grown.format_capacity;
+  }
+  if (encoder->thread_count == encoder->thread_capacity) {
+    thrd_t* threads = realloc(
+      encoder->threads,
+      2 * encoder->thread_capacity * sizeof(thrd_t)
+    );
+    if (threads == NULL) {
+      return -1;
+    }
+    encoder->threads = threads;
+    encoder->thread_capacity *= 2;
+  }
+  return 0;
+}
+
+/**
+ * @return Index of the thread, thread_count if it has none yet.
+ */
+static size_t log_binary_thread_index(
+  log_binary_encoder_t encoder[static 1],
+  thrd_t thread
+) {
+  //searched from the newest, few threads log at all
+  for (size_t i = encoder->thread_count; i > 0; --i) {
+    if (thrd_equal(encoder->threads[i - 1], thread)) {
+      return i - 1;
+    }
+  }
+  return encoder->thread_count;
+}
+
+int log_binary_encode(
+  log_binary_encoder_t encoder[static 1],
+  char* buffer,
+  size_t size,
+  log_record_t record[static 1]
+) {
+  if (log_binary_reserve(encoder)) {
+    return -1;
+  }
+  log_binary_writer_t writer = {
+    .buffer = (unsigned char*)buffer,
+    .size = size,
+    .length = 0
+  };
+  log_binary_format_t* slot = NULL;
+  size_t format_index = 0;
+  if (record->format != NULL) {
+    slot = log_binary_format_slot(encoder, record->format);
+    if (slot->format != NULL) {
+      format_index = slot->index;
+    } else {
+      format_index = encoder->format_count + 1;
+      size_t format_size = strlen(record->format) + 1;
+      log_binary_put_varint(
+        &writer,
+        1 + log_binary_varint_size(format_index) + format_size
+      );
+      log_binary_put_byte(&writer, log_binary_format_entry);
+      log_binary_put_varint(&writer, format_index);
+      log_binary_put(&writer, record->format, format_size);
+    }
+  }
+  size_t thread_index = log_binary_thread_index(encoder, record->thread_id);
+  if (thread_index == encoder->thread_count) {
+    uint64_t thread_id = (uint64_t)record->thread_id;
+    log_binary_put_varint(
+      &writer,
+      1 +
+        log_binary_varint_size(thread_index) +
+        log_binary_varint_size(thread_id)
+    );
+    log_binary_put_byte(&writer, log_binary_thread_entry);
+    log_binary_put_varint(&writer, thread_index);
+    log_binary_put_varint(&writer, thread_id);
+  }
+  //records of different threads can come slightly out of order
+  uint64_t delta_ns = log_binary_zigzag(
+    (int64_t)(record->timestamp.tv_sec - encoder->previous.tv_sec) *
+      NS_PER_SEC +
+    (record->timestamp.tv_nsec - encoder->previous.tv_nsec)
+  );
+  log_binary_put_varint(
+    &writer,
+    1 +
+      log_binary_varint_size(delta_ns) +
+      log_binary_varint_size(thread_index) +
+      1 +
+      log_binary_varint_size(format_index) +
+      record->arguments_size
+  );
+  log_binary_put_byte(&writer, log_binary_record_entry);
+  log_binary_put_varint(&writer, delta_ns);
+  log_binary_put_varint(&writer, thread_index);
+  log_binary_put_byte(&writer, (unsigned char)record->severity);
+  log_binary_put_varint(&writer, format_index);
+  log_binary_put(&writer, record->arguments, record->arguments_size);
+  if (writer.length > INT_MAX) {
+    return -1;
+  }
+  if (writer.length < size) {
+    //written whole, later records can refer to the definitions
+    if (slot != NULL && slot->format == NULL) {
+      slot->format = record->format;
+      slot->index = format_index;
+      encoder->format_count += 1;
+    }
+    if (thread_index == encoder->thread_count) {
+      encoder->threads[encoder->thread_count++] = record->thread_id;
+    }
+    encoder->previous = record->timestamp;
+  }
+  return (int)writer.length;
+}
+
+/**
+ * @brief Input read from a single entry.
+ */
+typedef struct log_binary_reader {
+  const unsigned char* data;
+  size_t size;
+  size_t position;
+} log_binary_reader_t;
+
+static bool log_binary_get_varint(
+  log_binary_reader_t reader[static 1],
+  uint64_t value[static 1]
+) {
+  *value = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7) {
+    if (reader->position == reader->size) {
+      return false;
+    }
+    unsigned char byte = reader->data[reader->position++];
+    *value |= (uint64_t)(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Reads a varint straight from the stream.
+ * 
+ * @return 0 on success, 1 if the stream ended before it, -1 if it ended in
+ * the middle of it.
+ */
+static int log_binary_read_varint(
+  FILE input[static 1],
+  uint64_t value[static 1]
+) {
+  *value = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7) {
+    int byte = getc(input);
+    if (byte == EOF) {
+      return (shift == 0) ? 1 : -1;
+    }
+    *value |= (uint64_t)(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return 0;
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief State of a binary log being read, with buffers reused between
+ * entries.
+ */
+typedef struct log_binary_decoder {
+  timepoint_t time;
+  char** formats;                   /**<Format of index i + 1*/
+  size_t format_count;
+  uint64_t* threads;
+  size_t thread_count;
+  unsigned char* entry;
+  size_t entry_capacity;
+  char* text;
+  size_t text_capacity;
+} log_binary_decoder_t;
+
+static void log_binary_decoder_destroy(
+  log_binary_decoder_t decoder[static 1]
+) {
+  for (size_t i = 0; i < decoder->format_count; ++i) {
+    free(decoder->formats[i]);
+  }
+  free(decoder->formats);
+  free(decoder->threads);
+  free(decoder->entry);
+  free(decoder->text);
+}
+
+/**
+ * @brief Grows the buffer to at least the size.
+ * 
+ * @return The buffer, possibly moved, or NULL on allocation failure.
+ */
+static void* log_binary_grow(
+  void* buffer,
+  size_t capacity[static 1],
+  size_t size
+) {
+  if (size <= *capacity) {
+    return buffer;
+  }
+  void* grown = realloc(buffer, size);
+  if (grown != NULL) {
+    *capacity = size;
+  }
+  return grown;
+}
+
+/**
+ * @return 0 on success, -1 if the header is malformed or of a different
+ * build, -3 if the input ends in the middle of it.
+ */
+static int log_binary_read_header(
+  FILE input[static 1],
+  log_binary_decoder_t decoder[static 1]
+) {
+  unsigned char header[LOG_BINARY_MAGIC_LENGTH + 1 + LOG_BINARY_LAYOUT_LENGTH];
+  unsigned char layout[LOG_BINARY_LAYOUT_LENGTH];
+  uint32_t byte_order;
+  log_binary_layout(layout);
+  size_t read_size = fread(header, 1, sizeof(header), input);
+  //a log cut within its header still starts with as much of the magic
+  size_t magic_length = (read_size < LOG_BINARY_MAGIC_LENGTH) ?
+    read_size :
+    LOG_BINARY_MAGIC_LENGTH;
+  if (memcmp(header, LOG_BINARY_MAGIC, magic_length) != 0) {
+    return -1;
+  }
+  if (
+    read_size != sizeof(header) ||
+    fread(&byte_order, sizeof(byte_order), 1, input) != 1
+  ) {
+    return -3;
+  }
+  if (
+    header[LOG_BINARY_MAGIC_LENGTH] != LOG_BINARY_VERSION ||
+    memcmp(
+      header + LOG_BINARY_MAGIC_LENGTH + 1,
+      layout,
+      LOG_BINARY_LAYOUT_LENGTH
+    ) != 0 ||
+    byte_order != LOG_BINARY_BYTE_ORDER
+  ) {
+    return -1;
+  }
+  uint64_t seconds;
+  uint64_t nanoseconds;
+  if (
+    log_binary_read_varint(input, &seconds) != 0 ||
+    log_binary_read_varint(input, &nanoseconds) != 0
+  ) {
+    return -3;
+  }
+  if (nanoseconds >= NS_PER_SEC) {
+    return -1;
+  }
+  decoder->time = timepoint_s_ns((time_t)seconds, (long)nanoseconds);
+  return 0;
+}
+
+static int log_binary_define_format(
+  log_binary_decoder_t decoder[static 1],
+  log_binary_reader_t reader[static 1]
+) {
+  uint64_t index;
+  if (
+    !log_binary_get_varint(reader, &index) ||
+    index != decoder->format_count + 1 ||
+    reader->position == reader->size ||
+    reader->data[reader->size - 1] != '\0'
+  ) {
+    return -1;
+  }
+  size_t format_size = reader->size - reader->position;
+  char** formats = realloc(
+    decoder->formats,
+    (decoder->format_count + 1) * sizeof(char*)
+  );
+  if (formats == NULL) {
+    return -2;
+  }
+  decoder->formats = formats;
+  char* format = malloc(format_size);
+  if (format == NULL) {
+    return -2;
+  }
+  memcpy(format, reader->data + reader->position, format_size);
+  decoder->formats[decoder->format_count++] = format;
+  return 0;
+}
+
+static int log_binary_define_thread(
+  log_binary_decoder_t decoder[static 1],
+  log_binary_reader_t reader[static 1]
+) {
+  uint64_t index;
+  uint64_t thread_id;
+  if (
+    !log_binary_get_varint(reader, &index) ||
+    index != decoder->thread_count ||
+    !log_binary_get_varint(reader, &thread_id)
+  ) {
+    return -1;
+  }
+  uint64_t* threads = realloc(
+    decoder->threads,
+    (decoder->thread_count + 1) * sizeof(uint64_t)
+  );
+  if (threads == NULL) {
+    return -2;
+  }
+  decoder->threads = threads;
+  decoder->threads[decoder->thread_count++] = thread_id;
+  return 0;
+}
+
+static int log_binary_render_record(
+  log_binary_decoder_t decoder[static 1],
+  log_binary_reader_t reader[static 1],
+  FILE output[static 1]
+) {
+  uint64_t delta;
+  uint64_t thread_index;
+  uint64_t format_index;
+  if (
+    !log_binary_get_varint(reader, &delta) ||
+    !log_binary_get_varint(reader, &thread_index) ||
+    thread_index >= decoder->thread_count ||
+    reader->position == reader->size
+  ) {
+    return -1;
+  }
+  unsigned char severity = reader->data[reader->position++];
+  if (
+    severity > log_fatal ||
+    !log_binary_get_varint(reader, &format_index) ||
+    format_index > decoder->format_count
+  ) {
+    return -1;
+  }
+  int64_t delta_ns = log_binary_unzigzag(delta);
+  timepoint_t time = decoder->time;
+  time.tv_sec += (time_t)(delta_ns / NS_PER_SEC);
+  time.tv_nsec += (long)(delta_ns % NS_PER_SEC);
+  if (time.tv_nsec < 0) {
+    time.tv_sec -= 1;
+    time.tv_nsec += NS_PER_SEC;
+  } else if (time.tv_nsec >= NS_PER_SEC) {
+    time.tv_sec += 1;
+    time.tv_nsec -= NS_PER_SEC;
+  }
+  decoder->time = time;
+
+  const unsigned char* arguments = reader->data + reader->position;
+  size_t arguments_size = reader->size - reader->position;
+  char* message;
+  if (format_index == 0) {
+    if (arguments_size == 0 || arguments[arguments_size - 1] != '\0') {
+      return -1;
+    }
+    message = (char*)arguments;
+  } else {
+    const char* format = decoder->formats[format_index - 1];
+    if (!log_args_check(format, arguments, arguments_size)) {
+      return -1;
+    }
+    size_t length = log_args_format(
+      decoder->text,
+      decoder->text_capacity,
+      format,
+      arguments
+    );
+    if (length >= decoder->text_capacity) {
+      char* text =
+        log_binary_grow(decoder->text, &(decoder->text_capacity), length + 1);
+      if (text == NULL) {
+        return -2;
+      }
+      decoder->text = text;
+      log_args_format(text, length + 1, format, arguments);
+    }
+    message = decoder->text;
+  }
+  log_record_t record = {
+    .thread_id = (thrd_t)decoder->threads[thread_index],
+    .timestamp = time,
+    .severity = (enum log_severity)severity,
+    .message = message
+  };
+  //rendered by the same printer the text sinks use
+  char line[256];
+  int length = output_sink_default_printer(line, sizeof(line), &record);
+  if (length < 0) {
+    return -1;
+  }
+  if ((size_t)length < sizeof(line)) {
+    fputs(line, output);
+    return 0;
+  }
+  char* long_line = malloc((size_t)length + 1);
+  if (long_line == NULL) {
+    return -2;
+  }
+  output_sink_default_printer(long_line, (size_t)length + 1, &record);
+  fputs(long_line, output);
+  free(long_line);
+  return 0;
+}
+
+int log_binary_decode(FILE input[static 1], FILE output[static 1]) {
+  log_binary_decoder_t decoder = {0};
+  int flag = log_binary_read_header(input, &decoder);
+  while (flag == 0) {
+    uint64_t entry_size;
+    int read_flag = log_binary_read_varint(input, &entry_size);
+    if (read_flag == 1) {
+      break;
+    }
+    if (read_flag != 0) {
+      flag = -3;
+      break;
+    }
+    if (entry_size == 0 || entry_size > SIZE_MAX / 2) {
+      flag = -1;
+      break;
+    }
+    unsigned char* entry = log_binary_grow(
+      decoder.entry,
+      &(decoder.entry_capacity),
+      (size_t)entry_size
+    );
+    if (entry == NULL) {
+      flag = -2;
+      break;
+    }
+    decoder.entry = entry;
+    if (fread(decoder.entry, 1, (size_t)entry_size, input) != entry_size) {
+      flag = -3;
+      break;
+    }
+    log_binary_reader_t reader = {
+      .data = decoder.entry,
+      .size = (size_t)entry_size,
+      .position = 1
+    };
+    switch (decoder.entry[0]) {
+      case log_binary_format_entry:
+        flag = log_binary_define_format(&decoder, &reader);
+        break;
+      case log_binary_thread_entry:
+        flag = log_binary_define_thread(&decoder, &reader);
+        break;
+      case log_binary_record_entry:
+        flag = log_binary_render_record(&decoder, &reader, output);
+        break;
+      default:
+        flag = -1;
+        break;
+    }
+  }
+  log_binary_decoder_destroy(&decoder);
+  return flag;
+}
@@ -0,0 +1,126 @@
+#ifndef SKAI_LOGGER_LOG_BINARY_H
+#define SKAI_LOGGER_LOG_BINARY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <threads.h>
+
+#include "log_record.h"
+#include "utilities/time.h"
+
+/**
+ * @file Compact binary log format, records keep the raw arguments captured by
+ * log_printf instead of the formatted text, log_decode renders them back.
+ * 
+ * The file starts with a header, LOG_BINARY_MAGIC followed by the version,
+ * the sizes of the argument types and a 32 bit 0x01020304 in the byte order
+ * of the writer, as arguments are stored as they were in memory, followed by
+ * the start time as two varints of seconds and nanoseconds.
+ * 
+ * Entries follow, each a varint length and that many bytes starting with a
+ * tag. Format strings and threads are given their indices by definition
+ * entries written right before the first record using them, so the table of
+ * strings is built up while reading instead of being known up front.
+ * 
+ * - log_binary_format_entry: varint index, null-terminated format
+ * - log_binary_thread_entry: varint index, varint thread id
+ * - log_binary_record_entry: zigzag varint of nanoseconds since the previous
+ *   record or the start time, varint thread index, severity byte, varint
+ *   format index, the arguments for the rest of the entry
+ * 
+ * Format index 0 stands for plain text, the arguments are then the text with
+ * its terminator. The entries are checked while decoding, the arguments
+ * included, which have to be exactly the ones their format consumes.
+ */
+
+#define LOG_BINARY_MAGIC "CUTLOG"
+
+enum {
+  LOG_BINARY_VERSION = 1
+};
+
+/**
+ * @brief Tags of the entries.
+ */
+enum log_binary_tag {
+  log_binary_format_entry,
+  log_binary_thread_entry,
+  log_binary_record_entry
+};
+
+/**
+ * @brief Format string with its index.
+ */
+typedef struct log_binary_format {
+  const char* format;
+  size_t index;
+} log_binary_format_t;
+
+/**
+ * @brief State of a binary log being written, indices of the format strings
+ * and threads defined so far.
+ */
+typedef struct log_binary_encoder {
+  timepoint_t previous;             /**<Timestamp of the previous record*/
+  log_binary_format_t* formats;     /**<Open addressing table by address*/
+  size_t format_capacity;           /**<Power of 2*/
+  size_t format_count;
+  thrd_t* threads;                  /**<Thread of every index*/
+  size_t thread_capacity;
+  size_t thread_count;
+} log_binary_encoder_t;
+
+/**
+ * @brief Initializes the encoder, records get timed from the start time.
+ * 
+ * @return 0 on success, -1 on allocation failure.
+ */
+int log_binary_encoder_init(
+  log_binary_encoder_t encoder[static 1],
+  timepoint_t start
+);
+
+void log_binary_encoder_destroy(log_binary_encoder_t encoder[static 1]);
+
+/**
+ * @brief Writes the header of the file like snprintf, without the
+ * terminator.
+ * 
+ * @return Length of the header.
+ */
+int log_binary_header(
+  log_binary_encoder_t encoder[static 1],
+  char* buffer,
+  size_t size
+);
+
+/**
+ * @brief Encodes the record along with the definitions it needs.
+ * 
+ * Follows the contract of sink_printer, the encoder remembers the record
+ * only when it fits the buffer with a byte to spare, so a record that
+ * didn't fit can be encoded again.
+ * 
+ * @return Length of the encoded entries, negative on allocation failure.
+ */
+int log_binary_encode(
+  log_binary_encoder_t encoder[static 1],
+  char* buffer,
+  size_t size,
+  log_record_t record[static 1]
+);
+
+/**
+ * @brief Renders the binary log as text in the format of
+ * output_sink_default_printer.
+ * 
+ * @param input Binary log
+ * @param output Where the text goes
+ * @return 0 on success, -1 if the input is malformed or written with
+ * different argument types, -2 on allocation failure, -3 if it ends in the
+ * middle of an entry, as the log of a writer that crashed does.
+ */
+int log_binary_decode(FILE input[static 1], FILE output[static 1]);
+
+#endif
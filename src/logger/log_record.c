@@ -17,6 +17,9 @@ log_record_t* log_record_new(
   new_record->timestamp = timestamp;
   new_record->severity = severity;
   new_record->message = message;
+  new_record->format = NULL;
+  new_record->arguments = (const unsigned char*)message;
+  new_record->arguments_size = strlen(message) + 1;
   return new_record;
 }
 
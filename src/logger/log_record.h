@@ -1,6 +1,7 @@
 #ifndef SKAI_LOGGER_LOG_RECORD_H
 #define SKAI_LOGGER_LOG_RECORD_H
 
+#include <stddef.h>
 #include <threads.h>
 #include <time.h>
 
@@ -16,6 +17,11 @@ typedef struct log_record {
   timepoint_t timestamp;             /**<Time of record's creation*/
   enum log_severity severity;   /**<Severity of described event*/
   char* message;                /**<Attached message, assumed ownership*/
+  const char* format;           /**<Format of the captured arguments, NULL if
+                                    the record is plain text*/
+  const unsigned char* arguments; /**<Arguments captured by log_args_capture
+                                    or the text with its terminator*/
+  size_t arguments_size;        /**<Size of the arguments in bytes*/
 } log_record_t;
 
 /**
@@ -1,42 +1,128 @@
+//for flockfile
+#define _POSIX_C_SOURCE 200809L
+
 #include "logger.h"
 
 #include <string.h>
 #include <threads.h>
 #include <time.h>
 #include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
 
 #include "data_structures/queue.h"
-#include "data_structures/message_queue.h"
+#include "data_structures/byte_ring.h"
+#include "log_args.h"
 #include "output_sinks.h"
-#include "utilities/string.h"
 #include "utilities/time.h"
 
 
+/**
+ * @brief How long records of log_error and above wait for space in a full
+ * ring, before they get written straight to stderr instead.
+ */
+enum {
+  LOG_URGENT_WAIT_MS = 100
+};
+
+/**
+ * @brief Record as it's laid out in a frame of a thread's ring, the payload
+ * follows right after the header.
+ * 
+ * Records of log_printf carry only the format and the raw bytes of its
+ * arguments, they get formatted by the logger thread.
+ */
+typedef struct log_entry {
+  timepoint_t timestamp;
+  thrd_t thread_id;
+  enum log_severity severity;
+  const char* format;           /**<Format of the captured arguments or NULL
+                                    for plain text*/
+  unsigned char payload[];      /**<Null-terminated text or the arguments
+                                    captured by log_args_capture*/
+} log_entry_t;
+
+/**
+ * @brief Ring of a single producing thread, registered with the logger the
+ * first time the thread logs.
+ */
+typedef struct log_thread_ring {
+  byte_ring_t ring;                 /**<Records of the thread*/
+  struct log_thread_ring* next;     /**<Previously registered ring, written
+                                        only before registering and by the
+                                        logger thread*/
+  atomic_bool retired;              /**<Thread ended, the ring is freed once
+                                        it's drained*/
+} log_thread_ring_t;
+
+
 typedef struct log_config {
   time_t start_time;
-  enum log_severity min_severity;
 } log_config_t;
 
 
 typedef struct log_context {
   log_config_t config;
-  message_queue_t message_queue;
+  _Atomic(log_thread_ring_t*) rings;  /**<Newest registered ring*/
+  tss_t ring_key;                   /**<Retires the ring at thread exit*/
+  atomic_size_t dropped;            /**<Records that didn't fit the rings*/
+  size_t reported_dropped;          /**<Drops already reported, owned by the
+                                        logger thread*/
+  atomic_bool waiting;              /**<Logger is about to sleep or
+                                        sleeping*/
+  mtx_t lock;                       /**<Guards sleeping of the logger*/
+  cnd_t wait;                       /**<Logger sleeps on it while the rings
+                                        are empty*/
   output_sink_list_t file_sinks;
+  size_t text_sink_count;           /**<Sinks that need the records as text,
+                                        binary ones don't*/
+  char* text;                       /**<Formatted message of the processed
+                                        record, owned by the logger thread*/
+  size_t text_capacity;
 } log_context_t;
 
 static log_context_t log_context;
 
+atomic_int log_min_severity_level = log_trace;
+
+static _Thread_local log_thread_ring_t* log_local_ring;
+
+
+static void log_thread_ring_retire(void* thread_ring) {
+  log_thread_ring_t* retired = thread_ring;
+  log_local_ring = NULL;
+  atomic_store_explicit(&(retired->retired), true, memory_order_release);
+}
 
 static int log_context_init(log_context_t context[static 1]) {
   context->config.start_time = time(NULL);
-  context->config.min_severity = log_trace;
-  int msq_q_flag = message_queue_init(
-    &(context->message_queue),
-    log_record_deleter
+  atomic_store_explicit(
+    &log_min_severity_level,
+    log_trace,
+    memory_order_relaxed
   );
-  if (msq_q_flag) {
-    return msq_q_flag;
+  int tss_flag = tss_create(&(context->ring_key), log_thread_ring_retire);
+  if (tss_flag != thrd_success) {
+    return tss_flag;
+  }
+  int mtx_flag = mtx_init(&(context->lock), mtx_plain);
+  if (mtx_flag != thrd_success) {
+    tss_delete(context->ring_key);
+    return mtx_flag;
+  }
+  int cnd_flag = cnd_init(&(context->wait));
+  if (cnd_flag != thrd_success) {
+    mtx_destroy(&(context->lock));
+    tss_delete(context->ring_key);
+    return cnd_flag;
   }
+  atomic_init(&(context->rings), NULL);
+  atomic_init(&(context->dropped), 0);
+  context->reported_dropped = 0;
+  atomic_init(&(context->waiting), false);
+  context->text = NULL;
+  context->text_capacity = 0;
+  context->text_sink_count = 0;
   queue_init(
     &(context->file_sinks),
     output_sink_deleter
@@ -45,12 +131,25 @@ static int log_context_init(log_context_t context[static 1]) {
 }
 
 static void log_context_destroy(log_context_t* context) {
-  message_queue_destroy(
-    &(context->message_queue)
-  );
+  //records left in the rings are plain bytes, freeing the rings drops them
+  log_thread_ring_t* thread_ring =
+    atomic_exchange_explicit(&(context->rings), NULL, memory_order_acquire);
+  while (thread_ring != NULL) {
+    log_thread_ring_t* next = thread_ring->next;
+    byte_ring_destroy(&(thread_ring->ring));
+    free(thread_ring);
+    thread_ring = next;
+  }
+  log_local_ring = NULL;
+  tss_delete(context->ring_key);
+  cnd_destroy(&(context->wait));
+  mtx_destroy(&(context->lock));
   queue_destroy(
     &(context->file_sinks)
   );
+  free(context->text);
+  context->text = NULL;
+  context->text_capacity = 0;
 }
 
 
@@ -69,57 +168,281 @@ void log_destroy(void) {
 void log_set_min_severity(
   enum log_severity severity
 ) {
-  log_context.config.min_severity = severity;
+  atomic_store_explicit(
+    &log_min_severity_level,
+    (int)severity,
+    memory_order_relaxed
+  );
+}
+
+void log_module_set_min_severity(
+  log_module_t module[static 1],
+  int severity
+) {
+  atomic_store_explicit(
+    &(module->min_severity),
+    severity,
+    memory_order_relaxed
+  );
 }
 
-void log_add_sink_f(
+int log_add_sink_f(
   FILE output_stream[static 1],
   bool owning,
-  sink_printer printer
+  sink_printer printer,
+  const output_sink_policy_t* policy
 ) {
-  output_sink_t* new_sink = output_sink_new(output_stream, owning, printer);
-  queue_push(&(log_context.file_sinks), new_sink);
+  output_sink_t* new_sink =
+    output_sink_new(output_stream, owning, printer, policy);
+  if (new_sink == NULL) {
+    return -1;
+  }
+  if (queue_push(&(log_context.file_sinks), new_sink)) {
+    output_sink_free(new_sink);
+    return -1;
+  }
+  log_context.text_sink_count += 1;
+  return 0;
 }
 
-static int log_push_record(
-  log_record_t record[static 1]
+int log_add_sink_binary(
+  FILE output_stream[static 1],
+  bool owning,
+  const output_sink_policy_t* policy
 ) {
-  if (log_context.config.min_severity > record->severity) {
+  output_sink_t* new_sink =
+    output_sink_new_binary(output_stream, owning, policy);
+  if (new_sink == NULL) {
     return -1;
   }
-  int post_flag = message_queue_push(
-    &(log_context.message_queue),
-    record
-  );
-  if (post_flag) {
+  if (queue_push(&(log_context.file_sinks), new_sink)) {
+    output_sink_free(new_sink);
     return -1;
   }
   return 0;
 }
 
+size_t log_dropped(void) {
+  return atomic_load_explicit(&(log_context.dropped), memory_order_relaxed);
+}
+
+static void log_count_drop(void) {
+  atomic_fetch_add_explicit(&(log_context.dropped), 1, memory_order_relaxed);
+}
+
+/**
+ * @brief Writes the record to stderr right away, for records of log_error and
+ * above that can't get into the ring.
+ */
+static void log_write_direct(
+  enum log_severity severity,
+  const char* format,
+  va_list arguments
+) {
+  timepoint_t timestamp = timepoint_now();
+  //the record comes out whole even if other threads write to stderr too
+  flockfile(stderr);
+  fprintf(
+    stderr,
+    "(%lld.%.9ld)[%02x](%s): ",
+    (long long int)timestamp.tv_sec,
+    timestamp.tv_nsec,
+    (unsigned int)thrd_current(),
+    log_severity_str(severity)
+  );
+  vfprintf(stderr, format, arguments);
+  fputc('\n', stderr);
+  funlockfile(stderr);
+}
+
+static void log_write_direct_f(
+  enum log_severity severity,
+  const char* format,
+  ...
+) {
+  va_list arguments;
+  va_start(arguments, format);
+  log_write_direct(severity, format, arguments);
+  va_end(arguments);
+}
+
+/**
+ * @brief Gets the ring of the calling thread, creating and registering it on
+ * the first call.
+ * 
+ * @return log_thread_ring_t* or NULL on allocation failure.
+ */
+static log_thread_ring_t* log_thread_ring(void) {
+  if (log_local_ring != NULL) {
+    return log_local_ring;
+  }
+  log_thread_ring_t* thread_ring = malloc(sizeof(log_thread_ring_t));
+  if (thread_ring == NULL) {
+    return NULL;
+  }
+  if (byte_ring_init(&(thread_ring->ring), LOG_THREAD_RING_CAPACITY)) {
+    free(thread_ring);
+    return NULL;
+  }
+  atomic_init(&(thread_ring->retired), false);
+  thread_ring->next =
+    atomic_load_explicit(&(log_context.rings), memory_order_relaxed);
+  while (
+    !atomic_compare_exchange_weak_explicit(
+      &(log_context.rings),
+      &(thread_ring->next),
+      thread_ring,
+      memory_order_release,
+      memory_order_relaxed
+    )
+  ) {}
+  tss_set(log_context.ring_key, thread_ring);
+  log_local_ring = thread_ring;
+  return thread_ring;
+}
+
+/**
+ * @brief Retries the reservation while the logger thread makes space, for at
+ * most LOG_URGENT_WAIT_MS as the logger might not be running at all.
+ */
+static void* log_reserve_wait(byte_ring_t ring[static 1], size_t size) {
+  timepoint_t deadline =
+    timepoint_after(timepoint_now(), timespan_ms(LOG_URGENT_WAIT_MS));
+  void* frame = NULL;
+  while (frame == NULL && timepoint_gt(deadline, timepoint_now())) {
+    thrd_yield();
+    frame = byte_ring_reserve(ring, size);
+  }
+  return frame;
+}
+
+/**
+ * @brief Reserves a record in the ring of the calling thread, records of
+ * log_error and above wait for space in a full ring and are never counted as
+ * dropped, their callers write them straight to stderr instead.
+ * 
+ * @param format Format of the captured arguments or NULL for plain text
+ * @param length Length of the payload, cut down to what fits a single frame
+ * @return log_entry_t* with the header filled in, NULL if the ring is full
+ */
+static log_entry_t* log_reserve(
+  enum log_severity severity,
+  const char* format,
+  size_t length[static 1]
+) {
+  bool urgent = severity >= log_error;
+  log_thread_ring_t* thread_ring = log_thread_ring();
+  if (thread_ring == NULL) {
+    if (!urgent) {
+      log_count_drop();
+    }
+    return NULL;
+  }
+  size_t max_length =
+    byte_ring_max_frame(&(thread_ring->ring)) - sizeof(log_entry_t);
+  if (*length > max_length) {
+    *length = max_length;
+  }
+  log_entry_t* entry = byte_ring_reserve(
+    &(thread_ring->ring),
+    sizeof(log_entry_t) + *length
+  );
+  if (entry == NULL && urgent) {
+    entry = log_reserve_wait(
+      &(thread_ring->ring),
+      sizeof(log_entry_t) + *length
+    );
+  }
+  if (entry == NULL) {
+    if (!urgent) {
+      log_count_drop();
+    }
+    return NULL;
+  }
+  timespec_get(&(entry->timestamp), TIME_UTC);
+  entry->thread_id = thrd_current();
+  entry->severity = severity;
+  entry->format = format;
+  return entry;
+}
+
+/**
+ * @brief Publishes the reserved record, waking the logger up if it sleeps.
+ */
+static void log_commit(size_t length) {
+  byte_ring_commit(&(log_local_ring->ring), sizeof(log_entry_t) + length);
+  //pairs with the fence in log_wait_until, either the logger sees the record
+  //or the producer sees it waiting
+  atomic_thread_fence(memory_order_seq_cst);
+  if (atomic_load_explicit(&(log_context.waiting), memory_order_relaxed)) {
+    mtx_lock(&(log_context.lock));
+    cnd_signal(&(log_context.wait));
+    mtx_unlock(&(log_context.lock));
+  }
+}
+
 
 void log_puts(
   enum log_severity severity,
   const char* message
 ) {
-  struct timespec timestamp;
-  timespec_get(&timestamp, TIME_UTC);
-  log_record_t* new_record = log_record_new_cpy_buf(
-    thrd_current(),
-    timestamp,
-    severity,
-    message
-  );
-  if (new_record == NULL) {
-    //TO DO: error message
+  if (log_enabled(NULL, severity)) {
+    log_emit_puts(severity, message);
+  }
+}
+
+void log_emit_puts(
+  enum log_severity severity,
+  const char* message
+) {
+  size_t length = strlen(message) + 1;
+  log_entry_t* entry = log_reserve(severity, NULL, &length);
+  if (entry == NULL) {
+    if (severity >= log_error) {
+      log_write_direct_f(severity, "%s", message);
+    }
     return;
   }
-  int push_flag = log_push_record(new_record);
-  if (push_flag) {
-    //TODO: error message
-    log_record_free(new_record);
+  //a message too long for the ring gets cut
+  memcpy(entry->payload, message, length - 1);
+  entry->payload[length - 1] = '\0';
+  log_commit(length);
+}
+
+/**
+ * @brief Captures the arguments of the format into the ring of the calling
+ * thread.
+ */
+static void log_emit_vprintf(
+  enum log_severity severity,
+  const char* format,
+  va_list arguments
+) {
+  va_list sizing;
+  va_copy(sizing, arguments);
+  size_t length = log_args_capture(format, &sizing, NULL);
+  va_end(sizing);
+  size_t captured_length = length;
+  log_entry_t* entry = log_reserve(severity, format, &length);
+  if (entry == NULL || length < captured_length) {
+    //arguments can't be cut like text
+    if (severity >= log_error) {
+      va_list writing;
+      va_copy(writing, arguments);
+      log_write_direct(severity, format, writing);
+      va_end(writing);
+    } else if (entry != NULL) {
+      log_count_drop();
+    }
     return;
   }
+  //only the raw arguments are copied, the logger thread formats them, a copy
+  //of the list is taken as a va_list parameter can't be pointed to portably
+  va_list capturing;
+  va_copy(capturing, arguments);
+  log_args_capture(format, &capturing, entry->payload);
+  va_end(capturing);
+  log_commit(length);
 }
 
 void log_printf(
@@ -127,34 +450,237 @@ void log_printf(
   const char* format,
   ...
 ) {
-  timepoint_t timestamp;
-  timespec_get(&timestamp, TIME_UTC);
+  if (!log_enabled(NULL, severity)) {
+    return;
+  }
   va_list arguments;
   va_start(arguments, format);
-  char* message = format_to_new_string_v(format, arguments);
+  log_emit_vprintf(severity, format, arguments);
   va_end(arguments);
-  if (message == NULL) {
-    //TODO: error message
-    return;
+}
+
+void log_emit_printf(
+  enum log_severity severity,
+  const char* format,
+  ...
+) {
+  va_list arguments;
+  va_start(arguments, format);
+  log_emit_vprintf(severity, format, arguments);
+  va_end(arguments);
+}
+
+/**
+ * @brief Formats the captured arguments of the record into the text buffer of
+ * the logger, growing it when needed.
+ * 
+ * @return The formatted message, NULL on allocation failure.
+ */
+static char* log_format_entry(log_entry_t* entry) {
+  size_t length = log_args_format(
+    log_context.text,
+    log_context.text_capacity,
+    entry->format,
+    entry->payload
+  );
+  if (length < log_context.text_capacity) {
+    return log_context.text;
   }
-  log_record_t* new_record = log_record_new(
-    thrd_current(),
-    timestamp,
-    severity,
-    message
+  char* text = realloc(log_context.text, length + 1);
+  if (text == NULL) {
+    return NULL;
+  }
+  log_context.text = text;
+  log_context.text_capacity = length + 1;
+  log_args_format(text, length + 1, entry->format, entry->payload);
+  return text;
+}
+
+/**
+ * @brief Prints the record to every sink, formatting its arguments only if
+ * some sink needs text.
+ * 
+ * @param entry 
+ * @param size Size of the whole frame of the record
+ */
+static void log_process_entry(log_entry_t* entry, size_t size) {
+  char* message = (char*)entry->payload;
+  //binary sinks take the arguments as they are
+  if (entry->format != NULL && log_context.text_sink_count != 0) {
+    message = log_format_entry(entry);
+    if (message == NULL) {
+      log_count_drop();
+      return;
+    }
+  }
+  log_record_t record = {
+    .thread_id = entry->thread_id,
+    .timestamp = entry->timestamp,
+    .severity = entry->severity,
+    .message = message,
+    .format = entry->format,
+    .arguments = entry->payload,
+    .arguments_size = size - sizeof(log_entry_t)
+  };
+  int noprint_count = output_sink_list_print(
+    &(log_context.file_sinks),
+    &record
   );
-  if (new_record == NULL) {
-    //TO DO: error message
-    free(message);
-    return;
+  if (noprint_count) {
+    //TO DO: push a debug message
   }
-  int push_flag = log_push_record(new_record);
-  if (push_flag) {
-    //TODO: error message
-    log_record_free(new_record);
+}
+
+/**
+ * @brief Prints a record with the number of records dropped since the last
+ * report, if there are any.
+ */
+static void log_report_drops(void) {
+  size_t dropped = log_dropped();
+  if (dropped == log_context.reported_dropped) {
     return;
   }
+  char text[128];
+  snprintf(
+    text,
+    sizeof(text),
+    "<Logger> Dropped %zu records, %zu in total.",
+    dropped - log_context.reported_dropped,
+    dropped
+  );
+  log_context.reported_dropped = dropped;
+  log_record_t record = {
+    .thread_id = thrd_current(),
+    .timestamp = timepoint_now(),
+    .severity = log_warning,
+    .message = text,
+    .format = NULL,
+    .arguments = (unsigned char*)text,
+    .arguments_size = strlen(text) + 1
+  };
+  output_sink_list_print(&(log_context.file_sinks), &record);
+}
+
+/**
+ * @brief Unlinks and frees the rings of ended threads once they're drained.
+ */
+static void log_reap_rings(void) {
+  log_thread_ring_t* previous = NULL;
+  log_thread_ring_t* thread_ring =
+    atomic_load_explicit(&(log_context.rings), memory_order_acquire);
+  while (thread_ring != NULL) {
+    log_thread_ring_t* next = thread_ring->next;
+    if (
+      !atomic_load_explicit(&(thread_ring->retired), memory_order_acquire) ||
+      !byte_ring_empty(&(thread_ring->ring))
+    ) {
+      previous = thread_ring;
+      thread_ring = next;
+      continue;
+    }
+    log_thread_ring_t* expected = thread_ring;
+    if (
+      previous == NULL &&
+      !atomic_compare_exchange_strong_explicit(
+        &(log_context.rings),
+        &expected,
+        next,
+        memory_order_acquire,
+        memory_order_acquire
+      )
+    ) {
+      //new rings got registered in front of it
+      previous = expected;
+      while (previous->next != thread_ring) {
+        previous = previous->next;
+      }
+    }
+    if (previous != NULL) {
+      previous->next = next;
+    }
+    byte_ring_destroy(&(thread_ring->ring));
+    free(thread_ring);
+    thread_ring = next;
+  }
+}
 
+/**
+ * @brief Prints every record available in the rings, merged by their
+ * timestamps.
+ * 
+ * @return Number of printed records.
+ */
+static size_t log_process_available(void) {
+  size_t count = 0;
+  log_thread_ring_t* rings =
+    atomic_load_explicit(&(log_context.rings), memory_order_acquire);
+  while (true) {
+    log_thread_ring_t* oldest_ring = NULL;
+    log_entry_t* oldest = NULL;
+    size_t oldest_size = 0;
+    for (
+      log_thread_ring_t* thread_ring = rings;
+      thread_ring != NULL;
+      thread_ring = thread_ring->next
+    ) {
+      size_t size;
+      log_entry_t* entry = byte_ring_peek(&(thread_ring->ring), &size);
+      if (
+        entry != NULL &&
+        (oldest == NULL || timepoint_gt(oldest->timestamp, entry->timestamp))
+      ) {
+        oldest_ring = thread_ring;
+        oldest = entry;
+        oldest_size = size;
+      }
+    }
+    if (oldest == NULL) {
+      break;
+    }
+    log_process_entry(oldest, oldest_size);
+    byte_ring_consume(&(oldest_ring->ring));
+    count += 1;
+  }
+  log_report_drops();
+  //records of the batch sit in the sink buffers until one of them is due
+  output_sink_list_flush_due(&(log_context.file_sinks), timepoint_now());
+  log_reap_rings();
+  return count;
+}
+
+/**
+ * @brief Sleeps until a producer commits a record, until a specific
+ * timepoint or until a sink buffer is due to be written.
+ */
+static void log_wait_until(timepoint_t deadline) {
+  timepoint_t flush_time;
+  if (
+    output_sink_list_next_flush(&(log_context.file_sinks), &flush_time) &&
+    timepoint_gt(deadline, flush_time)
+  ) {
+    deadline = flush_time;
+  }
+  if (mtx_lock(&(log_context.lock)) != thrd_success) {
+    return;
+  }
+  atomic_store_explicit(&(log_context.waiting), true, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  bool empty = true;
+  for (
+    log_thread_ring_t* thread_ring =
+      atomic_load_explicit(&(log_context.rings), memory_order_acquire);
+    thread_ring != NULL && empty;
+    thread_ring = thread_ring->next
+  ) {
+    empty = byte_ring_empty(&(thread_ring->ring));
+  }
+  //producers signal only under the lock, so they can't slip in before the
+  //wait starts
+  if (empty) {
+    cnd_timedwait(&(log_context.wait), &(log_context.lock), &deadline);
+  }
+  atomic_store_explicit(&(log_context.waiting), false, memory_order_relaxed);
+  mtx_unlock(&(log_context.lock));
 }
 
 void log_process_some_dur(timespan_t duration) {
@@ -163,37 +689,15 @@ void log_process_some_dur(timespan_t duration) {
   while (
     timepoint_gt(deadline, timepoint_now())
   ) {
-    log_record_t* record = message_queue_pop_wait_t(
-      &(log_context.message_queue),
-      deadline
-    );
-    if (record == NULL) {
-      continue;
-    }
-    int noprint_count = output_sink_list_print(
-      &(log_context.file_sinks),
-      record
-    );
-    if (noprint_count) {
-      //TO DO: push a debug message
+    //whatever got recorded by the time of wake-up is handled in one batch,
+    //without checking the clock between records
+    if (log_process_available() == 0) {
+      log_wait_until(deadline);
     }
-    log_record_free(record);
   }
 }
 
 void log_process_all() {
-  while(true) {
-    log_record_t* record = message_queue_pop(&(log_context.message_queue));
-    if (record == NULL) {
-      break;
-    }
-    int noprint_count = output_sink_list_print(
-      &(log_context.file_sinks),
-      record
-    );
-    if (noprint_count) {
-      //TO DO: push a debug message
-    }
-    log_record_free(record);
-  }
+  log_process_available();
+  output_sink_list_flush(&(log_context.file_sinks));
 }
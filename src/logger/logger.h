@@ -2,11 +2,122 @@
 #define SKAI_LOGGER_H
 
 #include <stdio.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 
 #include "severity.h"
 #include "output_sinks.h"
 
+/**
+ * @file Logging front end, each thread writes its records into a ring of its
+ * own, created the first time it logs, so logging never takes a shared lock
+ * or allocates. The logger thread merges the rings by timestamp into the
+ * sinks, records that find the ring of their thread full are dropped and the
+ * logger thread reports how many with a record of its own. Records of
+ * log_error and above are never dropped, they wait for space for a while and
+ * then get written straight to stderr.
+ * 
+ * Records below the minimal severity are filtered out before anything gets
+ * copied or formatted. The LOG_PUTS and LOG_PRINTF macros check it inline
+ * along with the level of their module, and calls below
+ * LOG_COMPILED_MIN_SEVERITY get compiled out, arguments included.
+ */
+
+/**
+ * @brief Lowest severity compiled in, set by the LOG_MIN_SEVERITY cmake
+ * variable.
+ */
+#ifndef LOG_COMPILED_MIN_SEVERITY
+#define LOG_COMPILED_MIN_SEVERITY log_trace
+#endif
+
+/**
+ * @brief Size in bytes of the ring of every logging thread.
+ */
+enum {
+  LOG_THREAD_RING_CAPACITY = 64 * 1024
+};
+
+/**
+ * @brief Minimal severity of a module that follows the global one.
+ */
+enum {
+  log_module_inherit = -1
+};
+
+/**
+ * @brief Part of the program with a minimal severity of its own, e.g. a
+ * thread frame.
+ */
+typedef struct log_module {
+  const char* name;
+  atomic_int min_severity;      /**<Overrides the global minimal severity
+                                    unless log_module_inherit*/
+} log_module_t;
+
+#define LOG_MODULE_INIT(module_name) { \
+  .name = (module_name), \
+  .min_severity = log_module_inherit \
+}
+
+/**
+ * @brief Global minimal severity, read by the inline checks, to be set with
+ * log_set_min_severity.
+ */
+extern atomic_int log_min_severity_level;
+
+/**
+ * @brief Checks whether a record of the severity would be logged.
+ * 
+ * @param module Module of the record or NULL for the global severity only
+ * @param severity Severity of the record
+ * @return true if the record passes the compiled and runtime minimums.
+ */
+static inline bool log_enabled(
+  log_module_t* module,
+  enum log_severity severity
+) {
+  if (severity < LOG_COMPILED_MIN_SEVERITY) {
+    return false;
+  }
+  int min_severity = (module != NULL) ?
+    atomic_load_explicit(&(module->min_severity), memory_order_relaxed) :
+    log_module_inherit;
+  if (min_severity == log_module_inherit) {
+    min_severity =
+      atomic_load_explicit(&log_min_severity_level, memory_order_relaxed);
+  }
+  return (int)severity >= min_severity;
+}
+
+/**
+ * @brief Logs the message if its module lets it through, compiled out below
+ * LOG_COMPILED_MIN_SEVERITY.
+ * 
+ * The compiled minimum is compared in the macro itself rather than only in
+ * log_enabled, so that the call is dropped even without inlining.
+ */
+#define LOG_PUTS(module, severity, message) do { \
+  if ( \
+    (severity) >= LOG_COMPILED_MIN_SEVERITY && \
+    log_enabled((module), (severity)) \
+  ) { \
+    log_emit_puts((severity), (message)); \
+  } \
+} while (0)
+
+/**
+ * @brief Logs the printf-formatted message if its module lets it through,
+ * the arguments aren't evaluated otherwise.
+ */
+#define LOG_PRINTF(module, severity, ...) do { \
+  if ( \
+    (severity) >= LOG_COMPILED_MIN_SEVERITY && \
+    log_enabled((module), (severity)) \
+  ) { \
+    log_emit_printf((severity), __VA_ARGS__); \
+  } \
+} while (0)
 
 /**
  * @brief Initializes logger, should be called at the very beginning of the
@@ -29,7 +140,7 @@ void log_destroy(void);
  * @brief Sets minimum severity used by the logger for filtering
  * 
  * Logger will deny creation of new records with severity lesser than provided
- * here
+ * here, unless their module has a severity of its own.
  * 
  * @param severity 
  */
@@ -37,16 +148,51 @@ void log_set_min_severity(
   enum log_severity severity
 );
 
+/**
+ * @brief Sets minimum severity of the module, overriding the global one.
+ * 
+ * @param module 
+ * @param severity Minimal severity or log_module_inherit to follow the global
+ * one again
+ */
+void log_module_set_min_severity(
+  log_module_t module[static 1],
+  int severity
+);
+
 /**
  * @brief Adds file sink.
  * 
  * @param output_stream 
  * @param owning 
+ * @param printer Formats the records or NULL for the default format
+ * @param policy When the sink writes out its buffer, NULL for
+ * output_sink_default_policy
+ * @return 0 on success, -1 on allocation failure.
+ */
+int log_add_sink_f(
+  FILE output_stream[static 1],
+  bool owning,
+  sink_printer printer,
+  const output_sink_policy_t* policy
+);
+
+/**
+ * @brief Adds sink writing a binary log, decoded back to text by log_decode.
+ * 
+ * Records are written without formatting their arguments, which are then
+ * formatted only for the text sinks, if there are any.
+ * 
+ * @param output_stream 
+ * @param owning 
+ * @param policy When the sink writes out its buffer, NULL for
+ * output_sink_default_policy
+ * @return 0 on success, -1 on allocation failure.
  */
-void log_add_sink_f(
+int log_add_sink_binary(
   FILE output_stream[static 1],
   bool owning,
-  sink_printer printer
+  const output_sink_policy_t* policy
 );
 
 void log_puts(
@@ -55,15 +201,62 @@ void log_puts(
 );
 
 
+/**
+ * @brief Logs the message without checking the severity, for the LOG_PUTS
+ * macro which checks it inline.
+ */
+void log_emit_puts(
+  enum log_severity severity,
+  const char* message
+);
+
+/**
+ * @brief Logs a printf-formatted message, the caller only copies the format
+ * pointer and the raw arguments, the text is formatted by the logger thread.
+ * 
+ * The format has to outlive the record, which string literals do, strings
+ * passed for %s are copied. Conversions %n, %lc and %ls aren't supported.
+ * 
+ * @param severity Severity of the message
+ * @param format printf format string
+ */
 void log_printf(
   enum log_severity severity,
   const char* format,
   ...
 );
 
+/**
+ * @brief Logs a printf-formatted message without checking the severity, for
+ * the LOG_PRINTF macro which checks it inline.
+ */
+void log_emit_printf(
+  enum log_severity severity,
+  const char* format,
+  ...
+);
+
 
+/**
+ * @return Number of records dropped so far because the ring of their thread
+ * was full or couldn't be created, records of log_error and above aren't
+ * ever dropped.
+ */
+size_t log_dropped(void);
+
+/**
+ * @brief Prints records to the sinks for the duration, sleeping while there
+ * are none, to be called only by the logger thread.
+ * 
+ * @param duration 
+ */
 void log_process_some_dur(timespan_t duration);
 
+/**
+ * @brief Prints all records available at the moment without waiting and
+ * writes out the buffers of the sinks, to be called only by the logger thread
+ * or once it's gone.
+ */
 void log_process_all(void);
 
 
@@ -1,13 +1,44 @@
+//for fileno, writev and errno values of write
+#define _POSIX_C_SOURCE 200809L
+
 #include "output_sinks.h"
 
+#include <errno.h>
+#include <sys/uio.h>
+
+const output_sink_policy_t output_sink_default_policy = {
+  .buffer_size = 64 * 1024,
+  .interval = {.tv_sec = 1, .tv_nsec = 0},
+  .flush_severity = log_error
+};
+
 output_sink_t* output_sink_new(
   FILE stream[static 1],
   bool owning,
-  sink_printer printer
+  sink_printer printer,
+  const output_sink_policy_t* policy
 ) {
   output_sink_t* new_sink = malloc(sizeof(output_sink_t));
+  if (new_sink == NULL) {
+    return NULL;
+  }
+  new_sink->policy = (policy != NULL) ? *policy : output_sink_default_policy;
+  if (new_sink->policy.buffer_size == 0) {
+    new_sink->policy.buffer_size = 1;
+  }
+  new_sink->buffer = malloc(new_sink->policy.buffer_size);
+  if (new_sink->buffer == NULL) {
+    free(new_sink);
+    return NULL;
+  }
+  //records go around stdio from now on
+  fflush(stream);
   new_sink->stream = stream;
+  new_sink->descriptor = fileno(stream);
   new_sink->owning = owning;
+  new_sink->length = 0;
+  new_sink->write_count = 0;
+  new_sink->encoder = NULL;
   if (printer) {
     new_sink->printer = printer;
   } else {
@@ -16,10 +47,51 @@ output_sink_t* output_sink_new(
   return new_sink;
 }
 
+output_sink_t* output_sink_new_binary(
+  FILE stream[static 1],
+  bool owning,
+  const output_sink_policy_t* policy
+) {
+  log_binary_encoder_t* encoder = malloc(sizeof(log_binary_encoder_t));
+  if (encoder == NULL) {
+    return NULL;
+  }
+  if (log_binary_encoder_init(encoder, timepoint_now())) {
+    free(encoder);
+    return NULL;
+  }
+  output_sink_policy_t binary_policy =
+    (policy != NULL) ? *policy : output_sink_default_policy;
+  //the header goes in the buffer, written along with the first records
+  size_t header_length = (size_t)log_binary_header(encoder, NULL, 0);
+  if (binary_policy.buffer_size <= header_length) {
+    binary_policy.buffer_size = header_length + 1;
+  }
+  output_sink_t* new_sink =
+    output_sink_new(stream, owning, NULL, &binary_policy);
+  if (new_sink == NULL) {
+    log_binary_encoder_destroy(encoder);
+    free(encoder);
+    return NULL;
+  }
+  new_sink->encoder = encoder;
+  new_sink->length =
+    (size_t)log_binary_header(encoder, new_sink->buffer, header_length + 1);
+  new_sink->flush_time =
+    timepoint_after(timepoint_now(), new_sink->policy.interval);
+  return new_sink;
+}
+
 void output_sink_free(output_sink_t* output_sink) {
+  output_sink_flush(output_sink);
   if (output_sink->owning) {
     fclose(output_sink->stream);
   }
+  if (output_sink->encoder != NULL) {
+    log_binary_encoder_destroy(output_sink->encoder);
+    free(output_sink->encoder);
+  }
+  free(output_sink->buffer);
   free(output_sink);
 }
 
@@ -28,11 +100,13 @@ void output_sink_deleter(void* output_sink) {
 }
 
 int output_sink_default_printer(
-  FILE stream[static 1],
+  char* buffer,
+  size_t size,
   log_record_t record[static 1]
 ) {
-  return fprintf(
-    stream,
+  return snprintf(
+    buffer,
+    size,
     "(%lld.%.9ld)[%02x](%s): %s\n",
     (long long int)record->timestamp.tv_sec,
     record->timestamp.tv_nsec,
@@ -42,6 +116,120 @@ int output_sink_default_printer(
   );
 }
 
+/**
+ * @brief Formats the record with the printer or the encoder of the sink.
+ */
+static int output_sink_format(
+  output_sink_t sink[static 1],
+  char* buffer,
+  size_t size,
+  log_record_t record[static 1]
+) {
+  if (sink->encoder != NULL) {
+    return log_binary_encode(sink->encoder, buffer, size, record);
+  }
+  return sink->printer(buffer, size, record);
+}
+
+/**
+ * @brief Writes every part, retrying after interrupts and partial writes.
+ * 
+ * @return 0 on success, -1 on failure.
+ */
+static int output_sink_write(
+  output_sink_t sink[static 1],
+  struct iovec parts[],
+  int part_count
+) {
+  while (part_count > 0) {
+    ssize_t written = writev(sink->descriptor, parts, part_count);
+    sink->write_count += 1;
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    size_t left = (size_t)written;
+    while (part_count > 0 && left >= parts[0].iov_len) {
+      left -= parts[0].iov_len;
+      parts += 1;
+      part_count -= 1;
+    }
+    if (part_count > 0) {
+      parts[0].iov_base = (char*)parts[0].iov_base + left;
+      parts[0].iov_len -= left;
+    }
+  }
+  return 0;
+}
+
+int output_sink_flush(output_sink_t sink[static 1]) {
+  if (sink->length == 0) {
+    return 0;
+  }
+  struct iovec part = {.iov_base = sink->buffer, .iov_len = sink->length};
+  sink->length = 0;
+  return output_sink_write(sink, &part, 1);
+}
+
+/**
+ * @brief Writes the buffer along with a record too long to fit it in a
+ * single call.
+ * 
+ * @return 0 on success, -1 on failure.
+ */
+static int output_sink_print_oversized(
+  output_sink_t sink[static 1],
+  log_record_t record[static 1],
+  size_t length
+) {
+  char* text = malloc(length + 1);
+  if (text == NULL) {
+    return -1;
+  }
+  output_sink_format(sink, text, length + 1, record);
+  struct iovec parts[] = {
+    {.iov_base = sink->buffer, .iov_len = sink->length},
+    {.iov_base = text, .iov_len = length}
+  };
+  sink->length = 0;
+  int write_flag = output_sink_write(sink, parts, 2);
+  free(text);
+  return write_flag;
+}
+
+int output_sink_print(
+  output_sink_t sink[static 1],
+  log_record_t record[static 1]
+) {
+  size_t space = sink->policy.buffer_size - sink->length;
+  int formatted =
+    output_sink_format(sink, sink->buffer + sink->length, space, record);
+  if (formatted < 0) {
+    return -1;
+  }
+  size_t length = (size_t)formatted;
+  //the printer needs space for a terminator as well
+  if (length >= space) {
+    if (length >= sink->policy.buffer_size) {
+      return output_sink_print_oversized(sink, record, length);
+    }
+    if (output_sink_flush(sink)) {
+      return -1;
+    }
+    output_sink_format(sink, sink->buffer, sink->policy.buffer_size, record);
+  }
+  if (sink->length == 0 && length != 0) {
+    sink->flush_time = timepoint_after(timepoint_now(), sink->policy.interval);
+  }
+  sink->length += length;
+  if (record->severity >= sink->policy.flush_severity) {
+    return output_sink_flush(sink);
+  }
+  return 0;
+}
+
 int output_sink_list_print(
   output_sink_list_t sink_list[static 1],
   log_record_t record[static 1]
@@ -50,10 +238,56 @@ int output_sink_list_print(
   int unprinted_count = 0;
   while (iter != NULL) {
     output_sink_t* sink = iter->value;
-    if (sink->printer(sink->stream, record) < 0) {
+    if (output_sink_print(sink, record)) {
       unprinted_count += 1;
     }
     iter = iter->next;
   }
   return unprinted_count;
 }
+
+int output_sink_list_flush_due(
+  output_sink_list_t sink_list[static 1],
+  timepoint_t now
+) {
+  int failed_count = 0;
+  for (queue_node_t* iter = sink_list->front; iter != NULL; iter = iter->next) {
+    output_sink_t* sink = iter->value;
+    if (
+      sink->length != 0 &&
+      !timepoint_gt(sink->flush_time, now) &&
+      output_sink_flush(sink)
+    ) {
+      failed_count += 1;
+    }
+  }
+  return failed_count;
+}
+
+int output_sink_list_flush(output_sink_list_t sink_list[static 1]) {
+  int failed_count = 0;
+  for (queue_node_t* iter = sink_list->front; iter != NULL; iter = iter->next) {
+    if (output_sink_flush(iter->value)) {
+      failed_count += 1;
+    }
+  }
+  return failed_count;
+}
+
+bool output_sink_list_next_flush(
+  output_sink_list_t sink_list[static 1],
+  timepoint_t flush_time[static 1]
+) {
+  bool pending = false;
+  for (queue_node_t* iter = sink_list->front; iter != NULL; iter = iter->next) {
+    output_sink_t* sink = iter->value;
+    if (
+      sink->length != 0 &&
+      (!pending || timepoint_gt(*flush_time, sink->flush_time))
+    ) {
+      *flush_time = sink->flush_time;
+      pending = true;
+    }
+  }
+  return pending;
+}
@@ -6,38 +6,169 @@
 #include <stdlib.h>
 
 #include "data_structures/queue.h"
+#include "utilities/time.h"
 
+#include "log_binary.h"
 #include "log_record.h"
 
-typedef int (*sink_printer)(FILE[static 1], log_record_t[static 1]);
+/**
+ * @file Sinks gather formatted records in a buffer of their own and write it
+ * to the file descriptor of their stream with a single call, bypassing the
+ * buffering of stdio.
+ * 
+ * A sink writes its buffer when the next record doesn't fit it, when the
+ * oldest buffered record waited for the interval of its policy, and right
+ * after buffering a record of the flush severity or above.
+ * 
+ * Binary sinks write the records in the format of log_binary.h instead of
+ * text, without formatting the arguments.
+ */
+
+/**
+ * @brief Formats the record into the buffer like snprintf.
+ * 
+ * @return Length of the whole text without the terminator, even if it didn't
+ * fit, negative on error.
+ */
+typedef int (*sink_printer)(char*, size_t, log_record_t[static 1]);
+
+/**
+ * @brief When a sink writes out its buffer.
+ */
+typedef struct output_sink_policy {
+  size_t buffer_size;               /**<Records are gathered until the next
+                                        one doesn't fit*/
+  timespan_t interval;              /**<Longest time a record waits in the
+                                        buffer*/
+  enum log_severity flush_severity; /**<Records of it and above get written
+                                        right away*/
+} output_sink_policy_t;
+
+/**
+ * @brief 64KiB buffer written at least once a second and at every error.
+ */
+extern const output_sink_policy_t output_sink_default_policy;
 
 typedef struct output_sink {
   FILE* stream;
+  int descriptor;                   /**<Descriptor of the stream*/
   bool owning;
   sink_printer printer;
+  log_binary_encoder_t* encoder;    /**<Encodes the records of a binary sink
+                                        instead of the printer*/
+  output_sink_policy_t policy;
+  char* buffer;
+  size_t length;                    /**<Bytes waiting in the buffer*/
+  timepoint_t flush_time;           /**<When the buffer is due to be written,
+                                        valid only if length isn't 0*/
+  size_t write_count;               /**<Write calls made so far*/
 } output_sink_t;
 
 typedef queue_t output_sink_list_t;
 
+/**
+ * @brief Returns newly allocated sink.
+ * 
+ * @param stream Stream written to, whatever it has buffered gets flushed
+ * @param owning Whether the stream gets closed along with the sink
+ * @param printer Formats the records or NULL for the default one
+ * @param policy When the sink writes out its buffer, NULL for the default one
+ * @return output_sink_t* on success or NULL in case of allocation failure.
+ */
 output_sink_t* output_sink_new(
   FILE stream[static 1],
   bool owning,
-  sink_printer printer
+  sink_printer printer,
+  const output_sink_policy_t* policy
+);
+
+/**
+ * @brief Returns newly allocated sink writing a binary log, starting with its
+ * header.
+ * 
+ * @param stream Stream written to, whatever it has buffered gets flushed
+ * @param owning Whether the stream gets closed along with the sink
+ * @param policy When the sink writes out its buffer, NULL for the default one
+ * @return output_sink_t* on success or NULL in case of allocation failure.
+ */
+output_sink_t* output_sink_new_binary(
+  FILE stream[static 1],
+  bool owning,
+  const output_sink_policy_t* policy
 );
 
+/**
+ * @brief Writes what's buffered and frees the sink, closing its stream if
+ * it's owned.
+ */
 void output_sink_free(output_sink_t* output_sink);
 
 void output_sink_deleter(void* output_sink);
 
 int output_sink_default_printer(
-  FILE stream[static 1],
+  char* buffer,
+  size_t size,
   log_record_t record[static 1]
 );
 
+/**
+ * @brief Writes out the buffer of the sink.
+ * 
+ * @return 0 on success, -1 if the write failed and the buffer was dropped.
+ */
+int output_sink_flush(output_sink_t sink[static 1]);
+
+/**
+ * @brief Formats the record into the buffer of the sink, writing it out as
+ * its policy says.
+ * 
+ * @return 0 on success, -1 if the record couldn't be formatted or written.
+ */
+int output_sink_print(
+  output_sink_t sink[static 1],
+  log_record_t record[static 1]
+);
+
+/**
+ * @brief Prints the record to every sink of the list.
+ * 
+ * @return Number of sinks the record failed to get to.
+ */
 int output_sink_list_print(
   output_sink_list_t sink_list[static 1],
   log_record_t record[static 1]
 );
 
+/**
+ * @brief Writes out the buffers due by the timepoint.
+ * 
+ * @param sink_list 
+ * @param now Current time
+ * @return Number of sinks that failed to write.
+ */
+int output_sink_list_flush_due(
+  output_sink_list_t sink_list[static 1],
+  timepoint_t now
+);
+
+/**
+ * @brief Writes out the buffers of every sink.
+ * 
+ * @return Number of sinks that failed to write.
+ */
+int output_sink_list_flush(output_sink_list_t sink_list[static 1]);
+
+/**
+ * @brief Finds the earliest time a buffer of the list is due.
+ * 
+ * @param sink_list 
+ * @param flush_time Set to the earliest due time if there is any
+ * @return true if some sink has buffered records, false otherwise.
+ */
+bool output_sink_list_next_flush(
+  output_sink_list_t sink_list[static 1],
+  timepoint_t flush_time[static 1]
+);
+
 
 #endif
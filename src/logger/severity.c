@@ -1,5 +1,7 @@
 #include "severity.h"
 
+#include <string.h>
+
 const char* log_severity_str(
   enum log_severity severity
 ) {
@@ -13,3 +15,16 @@ const char* log_severity_str(
   };
   return severity_strs[severity];
 }
+
+int log_severity_parse(
+  const char* name,
+  enum log_severity severity[static 1]
+) {
+  for (int i = log_trace; i <= log_fatal; ++i) {
+    if (strcmp(name, log_severity_str((enum log_severity)i)) == 0) {
+      *severity = (enum log_severity)i;
+      return 0;
+    }
+  }
+  return -1;
+}
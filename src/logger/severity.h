@@ -17,4 +17,16 @@ const char* log_severity_str(
   enum log_severity severity
 );
 
+/**
+ * @brief Finds the severity by its name as returned by log_severity_str.
+ * 
+ * @param name 
+ * @param severity Set to the found severity
+ * @return 0 on success, -1 if no severity has the name.
+ */
+int log_severity_parse(
+  const char* name,
+  enum log_severity severity[static 1]
+);
+
 #endif
@@ -2,32 +2,101 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdatomic.h>
+#include <string.h>
 #include <threads.h>
 
 #include "utilities/time.h"
 #include "cpu_diagnostics/linux.h"
+#include "cpu_diagnostics/cgroup.h"
+#include "cpu_diagnostics/kernels.h"
+#include "cpu_diagnostics/process.h"
+#include "cpu_diagnostics/stat_pool.h"
 #include "logger/logger.h"
+#include "data_structures/broadcast.h"
+#include "data_structures/channel.h"
 #include "data_structures/message_queue.h"
+#include "data_structures/spsc_ring.h"
 
 #include "threads/execution_frame.h"
 #include "threads/thread_context.h"
 #include "threads/frames/reader.h"
 #include "threads/frames/analyzer.h"
+#include "threads/frames/cgroup_reader.h"
 #include "threads/frames/printer.h"
+#include "threads/frames/process_reader.h"
 #include "threads/frames/logger.h"
 
 static atomic_bool execution_flag;
 
+static log_module_t main_log_module = LOG_MODULE_INIT("main");
+
 
 static void signal_handler(int signum) {
   (void)signum;
   atomic_store(&execution_flag, false);
 }
 
+/**
+ * @brief Applies a --log-level=[MODULE:]SEVERITY option, without a module the
+ * global minimal severity gets set.
+ * 
+ * @return 0 on success, -1 if the module or the severity is unknown.
+ */
+static int set_log_level(const char* option) {
+  log_module_t* modules[] = {
+    &main_log_module,
+    reader_frame.log_module,
+    process_reader_frame.log_module,
+    cgroup_reader_frame.log_module,
+    analyzer_frame.log_module,
+    printer_frame.log_module,
+    logger_frame.log_module
+  };
+  const char* separator = strchr(option, ':');
+  enum log_severity severity;
+  if (log_severity_parse(separator ? separator + 1 : option, &severity)) {
+    return -1;
+  }
+  if (separator == NULL) {
+    log_set_min_severity(severity);
+    return 0;
+  }
+  size_t name_length = (size_t)(separator - option);
+  for (size_t i = 0; i < sizeof(modules) / sizeof(modules[0]); ++i) {
+    if (
+      strlen(modules[i]->name) == name_length &&
+      strncmp(modules[i]->name, option, name_length) == 0
+    ) {
+      log_module_set_min_severity(modules[i], (int)severity);
+      return 0;
+    }
+  }
+  return -1;
+}
+
 /**
  * @brief Prints percentages of processor usage in the last second every second,
  * also logs information about its behaviour into ./log file.
  * 
+ * Every argument is a path to a file in /proc/stat format, e.g. a container's
+ * view of it, each sampled by its own reader thread into a shared pipeline.
+ * Without such arguments only /proc/stat of the host is sampled.
+ * 
+ * With --processes or --threads, tasks using the most cpu are reported as
+ * well, per process or per thread respectively.
+ * 
+ * With --cgroups, cgroups of the v2 hierarchy mounted at /sys/fs/cgroup using
+ * the most cpu are reported along with their throttling, --cgroups=PATH reads
+ * the hierarchy mounted at PATH instead.
+ * 
+ * With --binary-log the log is written to ./log.bin in a compact binary
+ * format instead, log_decode renders it back to the text of ./log.
+ * 
+ * With --log-level=SEVERITY records below the severity aren't logged, with
+ * --log-level=MODULE:SEVERITY the same applies to a single module, e.g.
+ * --log-level=info --log-level=analyzer:trace. Modules are main, reader,
+ * process_reader, cgroup_reader, analyzer, printer and logger.
+ * 
  * Can be stopped with sigterm and sigint(ctrl+c in terminal), which will then
  * shutdown the application after a little over a second as it will print all
  * the statistics into ./log. Will also stop in case of any of the threads
@@ -35,74 +104,283 @@ static void signal_handler(int signum) {
  * 
  * @return int 
  */
-int main(void) {
+int main(int argc, char* argv[]) {
   
   log_init();
-  FILE* log_file = fopen("./log", "w");
-  log_add_sink_f(log_file, true, NULL);
-  //log_add_sink_f(stderr, false, NULL);
-
   log_set_min_severity(log_trace);
 
-  FILE* stat = fopen("/proc/stat", "r");
-  stat_layout_set_f(stat);
-  fclose(stat);
+  char** paths = calloc((size_t)argc + 1, sizeof(char*));
+  if (paths == NULL) {
+    log_destroy();
+    exit(EXIT_FAILURE);
+  }
+  size_t source_count = 0;
+  bool collect_tasks = false;
+  int collect_flags = proc_collect_processes;
+  const char* cgroup_root = NULL;
+  bool binary_log = false;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--processes") == 0) {
+      collect_tasks = true;
+    } else if (strcmp(argv[i], "--threads") == 0) {
+      collect_tasks = true;
+      collect_flags = proc_collect_threads;
+    } else if (strcmp(argv[i], "--cgroups") == 0) {
+      cgroup_root = "/sys/fs/cgroup";
+    } else if (strncmp(argv[i], "--cgroups=", 10) == 0) {
+      cgroup_root = argv[i] + 10;
+    } else if (strcmp(argv[i], "--binary-log") == 0) {
+      binary_log = true;
+    } else if (strncmp(argv[i], "--log-level=", 12) == 0) {
+      if (set_log_level(argv[i] + 12)) {
+        fprintf(stderr, "Invalid log level %s.\n", argv[i] + 12);
+        free(paths);
+        log_destroy();
+        exit(EXIT_FAILURE);
+      }
+    } else {
+      paths[source_count++] = argv[i];
+    }
+  }
+  if (source_count == 0) {
+    paths[source_count++] = "/proc/stat";
+  }
+  //sinks come after the options, records before them are kept in the rings
+  FILE* log_file = binary_log ? fopen("./log.bin", "wb") : fopen("./log", "w");
+  if (log_file == NULL) {
+    fputs("Failed to open the log file.\n", stderr);
+  } else if (binary_log) {
+    log_add_sink_binary(log_file, true, NULL);
+  } else {
+    log_add_sink_f(log_file, true, NULL, NULL);
+  }
+  //log_add_sink_f(stderr, false, NULL, NULL);
+  //readers come first, followed by analyzer, printer and logger
+  size_t reader_count =
+    source_count + (collect_tasks ? 1 : 0) + (cgroup_root != NULL ? 1 : 0);
+  size_t thread_count = reader_count + 3;
+
+  stat_source_t* sources = calloc(source_count, sizeof(stat_source_t));
+  reader_context_t* reader_domains =
+    calloc(source_count, sizeof(reader_context_t));
+  thread_context_t* contexts = calloc(thread_count, sizeof(thread_context_t));
+  atomic_bool* watchdog_flag = calloc(thread_count, sizeof(atomic_bool));
+  thrd_t* worker = calloc(thread_count, sizeof(thrd_t));
+  if (
+    sources == NULL || reader_domains == NULL || contexts == NULL ||
+    watchdog_flag == NULL || worker == NULL
+  ) {
+    LOG_PUTS(
+      &main_log_module,
+      log_fatal,
+      "<Main> Failed to allocate thread state."
+    );
+    log_destroy();
+    exit(EXIT_FAILURE);
+  }
+  for (size_t i = 0; i < source_count; ++i) {
+    if (stat_source_open(&(sources[i]), i, paths[i], paths[i])) {
+      LOG_PRINTF(
+        &main_log_module,
+        log_fatal,
+        "<Main> Failed to open %s.",
+        paths[i]
+      );
+      fprintf(stderr, "Failed to open %s.\n", paths[i]);
+      while (i-- > 0) {
+        stat_source_close(&(sources[i]));
+      }
+      log_destroy();
+      exit(EXIT_FAILURE);
+    }
+  }
+  proc_collector_t collector;
+  if (
+    collect_tasks && proc_collector_open(&collector, "/proc", collect_flags)
+  ) {
+    LOG_PUTS(&main_log_module, log_fatal, "<Main> Failed to open /proc.");
+    fputs("Failed to open /proc.\n", stderr);
+    for (size_t i = 0; i < source_count; ++i) {
+      stat_source_close(&(sources[i]));
+    }
+    log_destroy();
+    exit(EXIT_FAILURE);
+  }
+  cgroup_collector_t cgroup_collector;
+  if (
+    cgroup_root != NULL &&
+    cgroup_collector_open(&cgroup_collector, cgroup_root)
+  ) {
+    LOG_PRINTF(
+      &main_log_module,
+      log_fatal,
+      "<Main> Failed to open %s.",
+      cgroup_root
+    );
+    fprintf(stderr, "Failed to open %s.\n", cgroup_root);
+    for (size_t i = 0; i < source_count; ++i) {
+      stat_source_close(&(sources[i]));
+    }
+    if (collect_tasks) {
+      proc_collector_close(&collector);
+    }
+    log_destroy();
+    exit(EXIT_FAILURE);
+  }
+
+  LOG_PRINTF(
+    &main_log_module,
+    log_info,
+    "<Main> Using %s kernels for cpu statistics.",
+    stat_kernels_active()->name
+  );
 
+  //hops with a single producer go through lock-free rings, several readers
+  //need the mutex queue
+  enum { pipeline_ring_capacity = 64 };
   message_queue_t unprocessed_data_queue;
-  message_queue_init(&unprocessed_data_queue, stat_cpu_array_deleter);
-  message_queue_t processed_data_queue;
-  message_queue_init(&processed_data_queue, stat_cpu_percentage_array_deleter);
+  spsc_ring_t unprocessed_data_ring;
+  channel_t unprocessed_data;
+  int unprocessed_flag;
+  if (reader_count == 1) {
+    unprocessed_flag = spsc_ring_init(
+      &unprocessed_data_ring,
+      pipeline_ring_capacity,
+      diagnostics_message_deleter
+    );
+    unprocessed_data = channel_from_ring(&unprocessed_data_ring);
+  } else {
+    //a stalled analyzer loses the oldest samples instead of piling them up
+    unprocessed_flag = message_queue_init_bounded(
+      &unprocessed_data_queue,
+      diagnostics_message_deleter,
+      pipeline_ring_capacity,
+      message_queue_drop_oldest
+    );
+    unprocessed_data = channel_from_queue(&unprocessed_data_queue);
+  }
+  //results are published once and shared by every consumer, the printer is
+  //the only one so far
+  enum { pipeline_max_subscribers = 4 };
+  broadcast_t processed_data;
+  int processed_flag = broadcast_init(
+    &processed_data,
+    pipeline_ring_capacity,
+    pipeline_max_subscribers,
+    diagnostics_message_deleter
+  );
+  broadcast_subscriber_t* printer_subscription = (processed_flag == 0) ?
+    broadcast_subscribe(&processed_data, broadcast_lossless) :
+    NULL;
+  //readers recycle their samples and the analyzer its percentages, a pool
+  //covers a full hop plus the buffers held at both of its ends
+  enum { pipeline_pool_capacity = pipeline_ring_capacity + 4 };
+  stat_pool_t* sample_pools = calloc(source_count, sizeof(stat_pool_t));
+  stat_pool_t usage_pool;
+  int pool_flag = (sample_pools == NULL) || stat_pool_init(
+    &usage_pool,
+    diagnostics_cpu_usage,
+    pipeline_pool_capacity
+  );
+  for (size_t i = 0; pool_flag == 0 && i < source_count; ++i) {
+    pool_flag = stat_pool_init(
+      &(sample_pools[i]),
+      diagnostics_cpu_sample,
+      pipeline_pool_capacity
+    );
+    sources[i].sampler.pool = &(sample_pools[i]);
+  }
+  if (
+    unprocessed_flag || processed_flag || printer_subscription == NULL ||
+    pool_flag
+  ) {
+    LOG_PUTS(
+      &main_log_module,
+      log_fatal,
+      "<Main> Failed to create the pipeline buffers."
+    );
+    log_destroy();
+    exit(EXIT_FAILURE);
+  }
 
   atomic_init(&execution_flag, true);
   signal(SIGINT, signal_handler);
   signal(SIGTERM, signal_handler);
 
-  atomic_bool watchdog_flag[4];
-
-  reader_context_t reader_domain = {
-    .output = &unprocessed_data_queue
-  };
   analyzer_context_t analyzer_domain = {
-    .input = &unprocessed_data_queue,
-    .output = &processed_data_queue
+    .input = &unprocessed_data,
+    .output = &processed_data,
+    .source_count = source_count,
+    .proc_top_count = 10,
+    .cgroup_top_count = 10,
+    .usage_pool = &usage_pool
   };
   printer_context_t printer_domain = {
-    .input = &processed_data_queue
+    .input = printer_subscription,
+    .source_count = source_count
   };
 
-  thread_context_t contexts[4] = {
-    [0] = {
+  for (size_t i = 0; i < source_count; ++i) {
+    reader_domains[i] = (reader_context_t){
+      .source = &(sources[i]),
+      .output = &unprocessed_data
+    };
+    contexts[i] = (thread_context_t){
       .frame = reader_frame,
       .interval = timespan_s_ns(1, 0),
       .name = "Reader",
       .stack_size = 0,
-      .domain = &reader_domain,
-    },
-    [1] = {
-      .frame = analyzer_frame,
-      .interval = timespan_s_ns(1, 0),
-      .name = "Analyzer",
-      .stack_size = 0,
-      .domain = &analyzer_domain
-    },
-    [2] = {
-      .frame = printer_frame,
+      .domain = &(reader_domains[i])
+    };
+  }
+  process_reader_context_t process_reader_domain = {
+    .collector = &collector,
+    .output = &unprocessed_data
+  };
+  if (collect_tasks) {
+    contexts[source_count] = (thread_context_t){
+      .frame = process_reader_frame,
       .interval = timespan_s_ns(1, 0),
-      .name = "Printer",
+      .name = "Process reader",
       .stack_size = 0,
-      .domain = &printer_domain
-    },
-    [3] = {
-      .frame = logger_frame,
+      .domain = &process_reader_domain
+    };
+  }
+  cgroup_reader_context_t cgroup_reader_domain = {
+    .collector = &cgroup_collector,
+    .output = &unprocessed_data
+  };
+  if (cgroup_root != NULL) {
+    contexts[reader_count - 1] = (thread_context_t){
+      .frame = cgroup_reader_frame,
       .interval = timespan_s_ns(1, 0),
-      .name = "Logger",
+      .name = "Cgroup reader",
       .stack_size = 0,
-    }
+      .domain = &cgroup_reader_domain
+    };
+  }
+  contexts[reader_count] = (thread_context_t){
+    .frame = analyzer_frame,
+    .interval = timespan_s_ns(1, 0),
+    .name = "Analyzer",
+    .stack_size = 0,
+    .domain = &analyzer_domain
+  };
+  contexts[reader_count + 1] = (thread_context_t){
+    .frame = printer_frame,
+    .interval = timespan_s_ns(1, 0),
+    .name = "Printer",
+    .stack_size = 0,
+    .domain = &printer_domain
+  };
+  contexts[reader_count + 2] = (thread_context_t){
+    .frame = logger_frame,
+    .interval = timespan_s_ns(1, 0),
+    .name = "Logger",
+    .stack_size = 0,
   };
 
-  thrd_t worker[4];
-
-  for (size_t i = 0; i < 4; ++i) {
+  for (size_t i = 0; i < thread_count; ++i) {
     contexts[i].should_continue = &execution_flag;
     contexts[i].watchdog = &(watchdog_flag[i]);
     thrd_create(&(worker[i]), execution_frame, &(contexts[i]));
@@ -117,13 +395,14 @@ int main(void) {
     timepoint_t loop_end = timepoint_after(loop_start, interval);
     execution_frame_sleep_until(loop_end);
 
-    for (flag_id = 0; flag_id < 4; ++flag_id) {
+    for (flag_id = 0; flag_id < thread_count; ++flag_id) {
       if (!atomic_exchange(&(watchdog_flag)[flag_id], false)) {
         break;
       }
     }
-    if (flag_id != 4) {
-      log_printf(
+    if (flag_id != thread_count) {
+      LOG_PRINTF(
+        &main_log_module,
         log_fatal,
         "<Watchdog> Thread %zu failed to report back, terminating.",
         flag_id
@@ -132,12 +411,59 @@ int main(void) {
     } 
   }
   
-  for (size_t i = 0; i < 4; ++i) {
+  for (size_t i = 0; i < thread_count; ++i) {
     thrd_join(worker[i], NULL);
   }
 
-  message_queue_destroy(&(unprocessed_data_queue));
-  message_queue_destroy(&(processed_data_queue));
+  if (reader_count == 1) {
+    spsc_ring_destroy(&unprocessed_data_ring);
+  } else {
+    message_queue_stats_t stats;
+    //zero unless the project is built with MESSAGE_QUEUE_STATS
+    if (message_queue_stats(&unprocessed_data_queue, &stats) == 0) {
+      LOG_PRINTF(
+        &main_log_module,
+        log_info,
+        "<Main> Unprocessed queue: %llu pushes, %llu pops, max depth %zu, "
+        "%llu contended locks, %llu spurious wake-ups.",
+        stats.pushes,
+        stats.pops,
+        stats.max_depth,
+        stats.contended_locks,
+        stats.spurious_wakeups
+      );
+      //logger thread is gone already
+      log_process_all();
+    }
+    message_queue_destroy(&unprocessed_data_queue);
+  }
+  LOG_PRINTF(
+    &main_log_module,
+    log_info,
+    "<Main> %zu log records dropped in total.",
+    log_dropped()
+  );
+  log_process_all();
+  broadcast_destroy(&processed_data);
+  //every buffer is back in its pool once the queues are gone
+  stat_pool_destroy(&usage_pool);
+  for (size_t i = 0; i < source_count; ++i) {
+    stat_pool_destroy(&(sample_pools[i]));
+    stat_source_close(&(sources[i]));
+  }
+  if (collect_tasks) {
+    proc_collector_close(&collector);
+  }
+  if (cgroup_root != NULL) {
+    cgroup_collector_close(&cgroup_collector);
+  }
+  free(paths);
+  free(sources);
+  free(sample_pools);
+  free(reader_domains);
+  free(contexts);
+  free(watchdog_flag);
+  free(worker);
   log_destroy();
   exit(EXIT_SUCCESS);
 }
@@ -0,0 +1,196 @@
+//for mkdtemp
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cpu_diagnostics/cgroup.h"
+
+#include "fixture_tree.h"
+
+/**
+ * @file Tests of the per-cgroup collector
+ * 
+ * The collector is pointed at a temporary directory laid out like a cgroup v2
+ * hierarchy, whose cpu.stat files are rewritten between scans.
+ */
+
+static void write_stat(
+  const char* path,
+  unsigned long long user_usec,
+  unsigned long long system_usec,
+  unsigned long long nr_throttled,
+  unsigned long long throttled_usec
+) {
+  FILE* file = fixture_open(path);
+  fprintf(
+    file,
+    "usage_usec %llu\nuser_usec %llu\nsystem_usec %llu\nnr_periods 40\n"
+    "nr_throttled %llu\nthrottled_usec %llu\nnr_bursts 0\nburst_usec 0\n",
+    user_usec + system_usec,
+    user_usec,
+    system_usec,
+    nr_throttled,
+    throttled_usec
+  );
+  fclose(file);
+}
+
+static const cgroup_delta_t* find_delta(
+  cgroup_sample_t sample,
+  const char* path
+) {
+  for (size_t i = 0; i < sample->count; ++i) {
+    if (strcmp(sample->entries[i].path, path) == 0) {
+      return &(sample->entries[i]);
+    }
+  }
+  return NULL;
+}
+
+static void test_parse(void) {
+  static const char text[] =
+    "usage_usec 900\nuser_usec 600\nsystem_usec 300\nnr_periods 7\n"
+    "nr_throttled 2\nthrottled_usec 150";
+  cgroup_counters_t counters;
+  cgroup_stat_parse(text, text + strlen(text), &counters);
+  assert(
+    (counters.usage_usec == 900) && (counters.user_usec == 600) &&
+    (counters.system_usec == 300) && (counters.nr_throttled == 2) &&
+    (counters.throttled_usec == 150) &&
+    "Counters are read by their names, unknown lines are skipped."
+  );
+  static const char root_text[] = "usage_usec 5\nuser_usec 3\nsystem_usec 2\n";
+  cgroup_stat_parse(root_text, root_text + strlen(root_text), &counters);
+  assert(
+    (counters.usage_usec == 5) && (counters.nr_throttled == 0) &&
+    "Counters missing from the file are zeroed."
+  );
+}
+
+static void test_collector(void) {
+  write_stat("cpu.stat", 1000, 1000, 0, 0);
+  fixture_make_dir("a");
+  write_stat("a/cpu.stat", 500, 500, 0, 0);
+  fixture_make_dir("a/b");
+  write_stat("a/b/cpu.stat", 100, 100, 0, 0);
+  //a cgroup without the cpu controller enabled
+  fixture_make_dir("c");
+
+  cgroup_collector_t collector;
+  assert(
+    (cgroup_collector_open(&collector, fixture_root) == 0) &&
+    "Collector opens the fixture."
+  );
+  cgroup_sample_t sample = NULL;
+  assert(
+    (cgroup_collector_sample(&collector, &sample) == 0) &&
+    (sample->count == 0) && (sample->cgroup_count == 4) &&
+    (collector.walk_count == 1) &&
+    "First scan only records the cgroups."
+  );
+  cgroup_sample_free(sample);
+
+  write_stat("a/b/cpu.stat", 400, 150, 3, 2000);
+  assert(
+    (cgroup_collector_sample(&collector, &sample) == 0) &&
+    (sample->count == 1) && (collector.walk_count == 1) &&
+    "Rewritten cpu.stat files don't make the hierarchy walked again."
+  );
+  const cgroup_delta_t* delta = find_delta(sample, "a/b");
+  assert(
+    (delta != NULL) && (delta->counters.usage_usec == 350) &&
+    (delta->counters.user_usec == 300) &&
+    (delta->counters.system_usec == 50) &&
+    (delta->counters.nr_throttled == 3) &&
+    (delta->counters.throttled_usec == 2000) &&
+    "Deltas are taken against the previous scan."
+  );
+  cgroup_sample_free(sample);
+
+  fixture_make_dir("a/d");
+  write_stat("a/d/cpu.stat", 0, 0, 0, 0);
+  fixture_remove("c");
+  write_stat("a/b/cpu.stat", 500, 150, 3, 2000);
+  assert(
+    (cgroup_collector_sample(&collector, &sample) == 0) &&
+    (collector.walk_count == 2) && (sample->cgroup_count == 4) &&
+    (sample->count == 1) && (find_delta(sample, "a/b") != NULL) &&
+    "Created and removed cgroups trigger a walk keeping the others' state."
+  );
+  cgroup_sample_free(sample);
+
+  //recreated under the same path, with counters starting over
+  fixture_make_dir("a/next");
+  write_stat("a/next/cpu.stat", 10, 10, 0, 0);
+  fixture_remove("a/b/cpu.stat");
+  fixture_remove("a/b");
+  fixture_rename("a/next", "a/b");
+  write_stat("a/d/cpu.stat", 20000, 10000, 0, 0);
+  assert(
+    (cgroup_collector_sample(&collector, &sample) == 0) &&
+    (collector.walk_count == 3) && (sample->count == 1) &&
+    (find_delta(sample, "a/d") != NULL) &&
+    "Recreated cgroup starts over, new one is compared from now on."
+  );
+  cgroup_sample_free(sample);
+
+  write_stat("cpu.stat", 2000, 1500, 0, 0);
+  write_stat("a/b/cpu.stat", 30, 10, 1, 100);
+  write_stat("a/d/cpu.stat", 40000, 20000, 0, 0);
+  assert(
+    (cgroup_collector_sample(&collector, &sample) == 0) &&
+    (sample->count == 3) && (find_delta(sample, "a/b") != NULL) &&
+    (find_delta(sample, "a/b")->counters.usage_usec == 20) &&
+    "Recreated cgroup is compared against its own counters."
+  );
+  sample->elapsed = 1;
+  cgroup_report_t report = cgroup_report_create(sample, 2);
+  assert(
+    (report != NULL) && (report->count == 2) && (report->active_count == 3) &&
+    (report->throttled_count == 1) && (report->cgroup_count == 4) &&
+    (strcmp(report->entries[0].path, "a/d") == 0) &&
+    (strcmp(report->entries[1].path, "") == 0) &&
+    "Report is sorted by usage and cut to the requested size."
+  );
+  assert(
+    (report->entries[0].usage > 2.99) && (report->entries[0].usage < 3.01) &&
+    (report->entries[0].user > 1.99) && (report->entries[0].user < 2.01) &&
+    "Usage is a percentage of a single core."
+  );
+  cgroup_report_free(report);
+  cgroup_sample_free(sample);
+  cgroup_collector_close(&collector);
+
+  fixture_remove("a/d/cpu.stat");
+  fixture_remove("a/d");
+  fixture_remove("a/b/cpu.stat");
+  fixture_remove("a/b");
+  fixture_remove("a/cpu.stat");
+  fixture_remove("a");
+  fixture_remove("cpu.stat");
+}
+
+static void test_missing_root(void) {
+  cgroup_collector_t collector;
+  assert(
+    (cgroup_collector_open(&collector, "/nonexistent/cgroup") == 0) &&
+    "Root is only walked on the first scan."
+  );
+  cgroup_sample_t sample = NULL;
+  assert(
+    (cgroup_collector_sample(&collector, &sample) == EOF) &&
+    "Missing root fails the scan."
+  );
+  cgroup_collector_close(&collector);
+}
+
+int main(void) {
+  fixture_create();
+  test_parse();
+  test_collector();
+  test_missing_root();
+  fixture_destroy();
+  return 0;
+}
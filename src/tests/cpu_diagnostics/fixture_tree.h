@@ -0,0 +1,69 @@
+#ifndef SKAI_TESTS_CPU_DIAGNOSTICS_FIXTURE_TREE_H
+#define SKAI_TESTS_CPU_DIAGNOSTICS_FIXTURE_TREE_H
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @file Temporary directory the collector tests lay out like /proc or
+ * a cgroup v2 hierarchy, paths are given relative to its root.
+ * 
+ * Tests including it have to define _POSIX_C_SOURCE 200809L for mkdtemp.
+ */
+
+enum {
+  FIXTURE_PATH_SIZE = 256
+};
+
+static char fixture_root[] = "/tmp/collector_test_XXXXXX";
+
+static inline void fixture_create(void) {
+  assert((mkdtemp(fixture_root) != NULL) && "Fixture root can be created.");
+}
+
+static inline void fixture_destroy(void) {
+  rmdir(fixture_root);
+}
+
+static inline void fixture_path(
+  char full_path[static FIXTURE_PATH_SIZE],
+  const char* path
+) {
+  snprintf(full_path, FIXTURE_PATH_SIZE, "%s/%s", fixture_root, path);
+}
+
+/**
+ * @brief Opens the file for writing, truncating it.
+ */
+static inline FILE* fixture_open(const char* path) {
+  char full_path[FIXTURE_PATH_SIZE];
+  fixture_path(full_path, path);
+  FILE* file = fopen(full_path, "w");
+  assert((file != NULL) && "Fixture file can be written.");
+  return file;
+}
+
+static inline void fixture_make_dir(const char* path) {
+  char full_path[FIXTURE_PATH_SIZE];
+  fixture_path(full_path, path);
+  assert((mkdir(full_path, 0700) == 0) && "Fixture directory can be made.");
+}
+
+static inline void fixture_remove(const char* path) {
+  char full_path[FIXTURE_PATH_SIZE];
+  fixture_path(full_path, path);
+  assert((remove(full_path) == 0) && "Fixture path can be removed.");
+}
+
+static inline void fixture_rename(const char* from, const char* to) {
+  char full_from[FIXTURE_PATH_SIZE];
+  char full_to[FIXTURE_PATH_SIZE];
+  fixture_path(full_from, from);
+  fixture_path(full_to, to);
+  assert((rename(full_from, full_to) == 0) && "Fixture can be renamed.");
+}
+
+#endif
@@ -0,0 +1,153 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cpu_diagnostics/linux.h"
+#include "cpu_diagnostics/kernels.h"
+
+/**
+ * @file Checks every kernel available on the machine against the scalar
+ * reference, stat_cpu_field_delta and stat_cpu_row_percentage_8, with the
+ * fused kernels checked against both applied one after another.
+ * 
+ * Data mixes regular increments with wrapped and reset counters, iowait
+ * going slightly backwards, idle rows and deltas too large for the vectorized
+ * conversion to double, on row and field counts that don't divide evenly into
+ * vector widths.
+ */
+
+enum {
+  column_count = 10,
+  stride = 12,
+  max_rows = 131
+};
+
+static uint64_t random_state = 0x2545F4914F6CDD1DULL;
+
+static uint64_t next_random(void) {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 7;
+  random_state ^= random_state << 17;
+  return random_state;
+}
+
+static void fill_samples(
+  stat_cpu_field_t old[static 1],
+  stat_cpu_field_t curr[static 1],
+  size_t row_count
+) {
+  for (size_t i = 0; i < row_count; ++i) {
+    uint64_t kind = next_random() % 9;
+    for (size_t j = 0; j < stride; ++j) {
+      size_t k = i * stride + j;
+      if (j >= column_count) {
+        old[k] = 0;
+        curr[k] = 0;
+        continue;
+      }
+      old[k] = next_random() % 100000000;
+      curr[k] = old[k] + next_random() % 1000;
+      if (kind == 1) {
+        //idle row, nothing changed
+        curr[k] = old[k];
+      } else if (kind == 2 && j == idle_col) {
+        old[k] = UINT64_MAX - next_random() % 500;
+      } else if (kind == 3 && j == user_proc_col) {
+        curr[k] = next_random() % 50;
+      } else if (kind == 4 && j == system_proc_col) {
+        //jump too big for the fast conversion
+        curr[k] = (1ULL << 53) + next_random() % 1000;
+      } else if (kind == 5 && j == iowait_col) {
+        curr[k] = old[k] - next_random() % 10;
+      }
+    }
+  }
+}
+
+int main(void) {
+  static stat_cpu_field_t old[max_rows * stride];
+  static stat_cpu_field_t curr[max_rows * stride];
+  static stat_cpu_field_t expected_delta[max_rows * stride];
+  static stat_cpu_field_t delta[max_rows * stride];
+  static stat_cpu_percentage_t expected_percentage[max_rows];
+  static stat_cpu_percentage_t percentage[max_rows];
+
+  assert(
+    (stat_kernels_get(stat_kernel_portable) != NULL) &&
+    "Portable kernels are always available."
+  );
+  assert(
+    (stat_kernels_active() != NULL) &&
+    "Some kernels are always selected."
+  );
+
+  for (size_t row_count = 0; row_count <= max_rows; ++row_count) {
+    fill_samples(old, curr, row_count);
+    size_t field_count = row_count * stride;
+    size_t expected_resets = 0;
+    //fused kernels only look at the fields used by the percentage
+    size_t expected_fused_resets = 0;
+    for (size_t k = 0; k < field_count; ++k) {
+      size_t field_resets = 0;
+      expected_delta[k] = stat_cpu_field_delta(
+        old[k],
+        curr[k],
+        &field_resets
+      );
+      expected_resets += field_resets;
+      expected_fused_resets += (k % stride < 8) ? field_resets : 0;
+    }
+    for (size_t i = 0; i < row_count; ++i) {
+      expected_percentage[i] = stat_cpu_row_percentage_8(
+        expected_delta + i * stride
+      );
+    }
+
+    for (int isa = 0; isa < stat_kernel_isa_count; ++isa) {
+      const stat_kernels_t* kernels =
+        stat_kernels_get((enum stat_kernel_isa)isa);
+      if (kernels == NULL) {
+        continue;
+      }
+      size_t resets = kernels->delta(old, curr, delta, field_count);
+      assert(
+        (resets == expected_resets) &&
+        "Kernel counts the same resets as the reference."
+      );
+      for (size_t k = 0; k < field_count; ++k) {
+        assert(
+          (delta[k] == expected_delta[k]) &&
+          "Kernel delta matches the reference exactly."
+        );
+      }
+      kernels->percentage(percentage, expected_delta, row_count, stride);
+      for (size_t i = 0; i < row_count; ++i) {
+        assert(
+          (percentage[i] == expected_percentage[i]) &&
+          "Kernel percentage matches the reference exactly."
+        );
+      }
+      resets = kernels->fused(percentage, old, curr, row_count, stride);
+      assert(
+        (resets == expected_fused_resets) &&
+        "Fused kernel counts resets among the first 8 fields."
+      );
+      for (size_t i = 0; i < row_count; ++i) {
+        assert(
+          (percentage[i] == expected_percentage[i]) &&
+          "Fused kernel matches the two-pass reference exactly."
+        );
+      }
+    }
+  }
+
+  for (int isa = 0; isa < stat_kernel_isa_count; ++isa) {
+    const stat_kernels_t* kernels =
+      stat_kernels_get((enum stat_kernel_isa)isa);
+    if (kernels != NULL) {
+      printf("Checked %s kernels.\n", kernels->name);
+    }
+  }
+  return 0;
+}
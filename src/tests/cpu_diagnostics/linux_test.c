@@ -0,0 +1,354 @@
+//for fmemopen, mkstemp and ftruncate
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cpu_diagnostics/linux.h"
+
+/**
+ * @file Tests of /proc/stat parsing
+ * 
+ * Both the fscanf based reader and the integer scanner are run on the same
+ * text and are expected to agree. Hotplug is simulated by rewriting a
+ * temporary file between samples.
+ */
+
+static char sample_stat[] =
+  "cpu  2855 0 939 153614 127 0 1 763 0 0\n"
+  "cpu0 1400 0 500 76000 60 0 1 400 0 0\n"
+  "cpu1 1455 0 439 77614 67 0 0 363 0 0\n"
+  "intr 66325 0 0 0 0\n"
+  "ctxt 102030\n"
+  "btime 1700000000\n"
+  "processes 4321\n"
+  "procs_running 3\n"
+  "procs_blocked 1\n"
+  "softirq 9000 0 4000 0 5000\n";
+
+//cpu1 went offline and cpu2 came online
+static const char hotplug_stat[] =
+  "cpu  2955 0 999 153714 127 0 1 763 0 0\n"
+  "cpu0 1500 0 560 76100 60 0 1 400 0 0\n"
+  "cpu2 10 0 5 400 0 0 0 0 0 0\n"
+  "intr 66400 0 0 0 0\n";
+
+static void rewrite_file(int fd, const char* text) {
+  size_t size = strlen(text);
+  assert(
+    (ftruncate(fd, 0) == 0) && (pwrite(fd, text, size, 0) == (ssize_t)size) &&
+    "Fixture file can be rewritten."
+  );
+}
+
+static void test_hotplug(void) {
+  char path[] = "/tmp/linux_test_stat_XXXXXX";
+  int fd = mkstemp(path);
+  assert((fd != -1) && "Fixture file can be created.");
+  rewrite_file(fd, sample_stat);
+
+  stat_sampler_t sampler;
+  assert(
+    (stat_sampler_open(&sampler, path) == 0) && "Sampler opens the fixture."
+  );
+  stat_cpu_array_t first = NULL;
+  stat_cpu_array_t second = NULL;
+  stat_cpu_array_t third = NULL;
+  assert(
+    (stat_sampler_sample(&sampler, &first) == 0) &&
+    (first->layout != NULL) && (first->layout->version == 1) &&
+    (first->layout->layout.cpu_count == 3) &&
+    (first->layout->cpu_ids[0] == STAT_CPU_TOTAL_ID) &&
+    (first->layout->cpu_ids[2] == 1) &&
+    "First sample scans the layout."
+  );
+  assert(
+    (stat_sampler_sample(&sampler, &second) == 0) &&
+    (second->layout == first->layout) &&
+    "Unchanged file keeps the same layout snapshot."
+  );
+
+  rewrite_file(fd, hotplug_stat);
+  assert(
+    (stat_sampler_sample(&sampler, &third) == 0) &&
+    (third->layout != first->layout) && (third->layout->version == 2) &&
+    (third->layout->cpu_ids[1] == 0) && (third->layout->cpu_ids[2] == 2) &&
+    (stat_cpu_array_row(third, 2)[idle_col] == 400) &&
+    "Different set of cores gives a new snapshot with a higher version."
+  );
+  assert(
+    (first->layout->version == 1) && (first->layout->cpu_ids[2] == 1) &&
+    "Samples in flight keep the layout they were read with."
+  );
+  stat_cpu_array_free(first);
+  stat_cpu_array_free(second);
+  stat_cpu_array_free(third);
+
+  rewrite_file(fd, sample_stat);
+  assert(
+    (stat_sampler_sample(&sampler, &first) == 0) &&
+    (first->layout->version == 3) && (first->layout->cpu_ids[2] == 1) &&
+    "Coming back to the old set of cores is a change as well."
+  );
+  stat_cpu_array_free(first);
+
+  stat_sampler_close(&sampler);
+  close(fd);
+  unlink(path);
+}
+
+static void test_uneven_columns(void) {
+  char path[] = "/tmp/linux_test_uneven_XXXXXX";
+  int fd = mkstemp(path);
+  assert((fd != -1) && "Fixture file can be created.");
+  rewrite_file(
+    fd,
+    "cpu  1 2 3 4 5 6 7 8 9 10\n"
+    "cpu0 1 2 3 4 5 6 7 8 9 10 11\n"
+    "intr 0\n"
+  );
+
+  stat_sampler_t sampler;
+  assert(
+    (stat_sampler_open(&sampler, path) == 0) && "Sampler opens the fixture."
+  );
+  stat_cpu_array_t sample = NULL;
+  assert(
+    (stat_sampler_sample(&sampler, &sample) == STAT_LAYOUT_CHANGED) &&
+    (sample == NULL) &&
+    "Lines with different numbers of columns fail after a single rescan."
+  );
+
+  rewrite_file(fd, "intr 0\n");
+  assert(
+    (stat_sampler_sample(&sampler, &sample) == 1) && (sample == NULL) &&
+    "Text without cpu lines is malformed, not out of memory."
+  );
+
+  rewrite_file(fd, sample_stat);
+  assert(
+    (stat_sampler_sample(&sampler, &sample) == 0) &&
+    (sample->layout->layout.cpu_count == 3) &&
+    "Sampler recovers once the lines agree again."
+  );
+  stat_cpu_array_free(sample);
+
+  stat_sampler_close(&sampler);
+  close(fd);
+  unlink(path);
+}
+
+static void test_sources(void) {
+  char host_path[] = "/tmp/linux_test_host_XXXXXX";
+  char guest_path[] = "/tmp/linux_test_guest_XXXXXX";
+  int host_fd = mkstemp(host_path);
+  int guest_fd = mkstemp(guest_path);
+  assert((host_fd != -1) && (guest_fd != -1) && "Fixtures can be created.");
+  rewrite_file(host_fd, sample_stat);
+  rewrite_file(guest_fd, hotplug_stat);
+
+  stat_source_t host;
+  stat_source_t guest;
+  assert(
+    (stat_source_open(&host, 0, "host", host_path) == 0) &&
+    (stat_source_open(&guest, 1, "guest", guest_path) == 0) &&
+    "Sources open their fixtures."
+  );
+  stat_cpu_array_t host_sample = NULL;
+  stat_cpu_array_t guest_sample = NULL;
+  assert(
+    (stat_source_sample(&host, &host_sample) == 0) &&
+    (stat_source_sample(&guest, &guest_sample) == 0) &&
+    "Both sources can be sampled."
+  );
+  assert(
+    (host_sample->source == &host) && (guest_sample->source == &guest) &&
+    "Samples are tagged with their source."
+  );
+  assert(
+    (host_sample->layout != guest_sample->layout) &&
+    (host_sample->layout->cpu_ids[2] == 1) &&
+    (guest_sample->layout->cpu_ids[2] == 2) &&
+    (host_sample->layout->version == 1) &&
+    (guest_sample->layout->version == 1) &&
+    "Each source keeps its own layout."
+  );
+  stat_cpu_array_free(host_sample);
+  stat_cpu_array_free(guest_sample);
+
+  stat_source_close(&host);
+  stat_source_close(&guest);
+  close(host_fd);
+  close(guest_fd);
+  unlink(host_path);
+  unlink(guest_path);
+}
+
+int main(void) {
+  FILE* source = fmemopen(sample_stat, strlen(sample_stat), "r");
+  stat_layout_t layout;
+  assert(
+    (stat_layout_set_lf(&layout, source) == 0) &&
+    "Layout is found before the intr line."
+  );
+  fclose(source);
+  assert(
+    (layout.cpu_count == 3) && (layout.cpu_column_count == 10) &&
+    "Three cpu lines with ten columns each."
+  );
+
+  stat_cpu_array_t scanned = stat_cpu_array_create_l(&layout);
+  stat_cpu_array_t parsed = stat_cpu_array_create_l(&layout);
+
+  source = fmemopen(sample_stat, strlen(sample_stat), "r");
+  assert(
+    (stat_cpu_array_read_fl(scanned, source, &layout) == 0) &&
+    "fscanf reader succeeds on well formed text."
+  );
+  fclose(source);
+
+  const char* end = sample_stat + strlen(sample_stat);
+  assert(
+    (stat_cpu_array_parse_l(parsed, sample_stat, end, &layout) == 0) &&
+    "Scanner succeeds on well formed text."
+  );
+  for (size_t i = 0; i < layout.cpu_count; ++i) {
+    stat_cpu_row_t scanned_row = stat_cpu_array_row(scanned, i);
+    stat_cpu_row_t parsed_row = stat_cpu_array_row(parsed, i);
+    for (size_t j = 0; j < layout.cpu_column_count; ++j) {
+      assert(
+        (scanned_row[j] == parsed_row[j]) &&
+        "Scanner agrees with fscanf on every field."
+      );
+    }
+  }
+  assert(
+    (stat_cpu_array_row(parsed, 2)[idle_col] == 77614) &&
+    "Fields land in their columns."
+  );
+  assert(
+    (parsed->system.interrupts == 66325) &&
+    (parsed->system.context_switches == 102030) &&
+    (parsed->system.forks == 4321) &&
+    (parsed->system.procs_running == 3) &&
+    (parsed->system.procs_blocked == 1) &&
+    (parsed->system.softirqs == 9000) &&
+    "System counters are parsed in the same pass as cpu rows."
+  );
+
+  stat_cpu_array_t later = stat_cpu_array_create_l(&layout);
+  later->system = parsed->system;
+  later->system.context_switches += 3000;
+  later->system.interrupts += 500;
+  later->system.procs_running = 7;
+  parsed->timestamp = (struct timespec){.tv_sec = 10, .tv_nsec = 500000000};
+  later->timestamp = (struct timespec){.tv_sec = 12, .tv_nsec = 500000000};
+  stat_system_rates_t rates;
+  assert(
+    (stat_system_rates_calculate(&rates, parsed, later) == 0) &&
+    (rates.context_switches == 1500.0) && (rates.interrupts == 250.0) &&
+    (rates.forks == 0.0) && (rates.procs_running == 7) &&
+    "Counters are turned into per-second rates over the sample interval."
+  );
+  assert(
+    (stat_system_rates_calculate(&rates, later, parsed) == 0) &&
+    (rates.context_switches == 0.0) &&
+    "Samples out of order give no rates."
+  );
+  stat_cpu_array_free(later);
+
+  assert(
+    (parsed->stride >= layout.cpu_column_count) &&
+    ((parsed->stride * sizeof(stat_cpu_field_t)) % STAT_ROW_ALIGNMENT == 0) &&
+    ((size_t)parsed->fields % STAT_CACHE_LINE_SIZE == 0) &&
+    "Rows are padded to the row alignment inside a cache-line aligned block."
+  );
+  for (size_t i = 0; i < layout.cpu_count; ++i) {
+    for (size_t j = layout.cpu_column_count; j < parsed->stride; ++j) {
+      assert(
+        (stat_cpu_array_row(parsed, i)[j] == 0) &&
+        "Padding fields stay zeroed after parsing."
+      );
+    }
+  }
+
+  const char* truncated_end = strstr(sample_stat, "cpu1") + 10;
+  assert(
+    (stat_cpu_array_parse_l(parsed, sample_stat, truncated_end, &layout) ==
+      EOF) &&
+    "Text ending before the last field is reported as EOF."
+  );
+
+  static const char malformed[] = "cpu  1 2 x 4 5 6 7 8 9 10\n";
+  assert(
+    (stat_cpu_array_parse_l(
+      parsed,
+      malformed,
+      malformed + strlen(malformed),
+      &layout
+    ) == 3) &&
+    "Malformed field is reported by its 1-based position."
+  );
+
+  size_t reset_count = 0;
+  assert(
+    (stat_cpu_field_delta(100, 250, &reset_count) == 150) &&
+    (reset_count == 0) &&
+    "Regular delta is exact."
+  );
+  assert(
+    (stat_cpu_field_delta(UINT64_MAX - 9, 20, &reset_count) == 30) &&
+    (reset_count == 0) &&
+    "Wrapped counter still gives the exact number of ticks."
+  );
+  assert(
+    (stat_cpu_field_delta(5000, 40, &reset_count) == 0) &&
+    (reset_count == 1) &&
+    "Counter going backwards is a reset without any ticks."
+  );
+  assert(
+    (stat_cpu_field_delta(127, 126, &reset_count) == 0) &&
+    (reset_count == 2) &&
+    "Iowait stepping back by a tick doesn't count the ticks since boot."
+  );
+
+  //second sample where one counter of cpu1 was reset and iowait went back
+  stat_cpu_row_t prev_row = stat_cpu_array_row(scanned, 2);
+  stat_cpu_row_t curr_row = stat_cpu_array_row(parsed, 2);
+  for (size_t j = 0; j < layout.cpu_column_count; ++j) {
+    curr_row[j] = prev_row[j] + j;
+  }
+  curr_row[user_proc_col] = 7;
+  curr_row[iowait_col] = prev_row[iowait_col] - 1;
+  stat_cpu_array_t delta = stat_cpu_array_create_l(&layout);
+  memcpy(
+    stat_cpu_array_row(parsed, 0),
+    stat_cpu_array_row(scanned, 0),
+    sizeof(stat_cpu_field_t) * parsed->stride * 2
+  );
+  assert(
+    (stat_cpu_array_delta_l(scanned, parsed, delta, &layout) == 2) &&
+    "Array delta counts the reset fields."
+  );
+  stat_cpu_row_t delta_row = stat_cpu_array_row(delta, 2);
+  assert(
+    (delta_row[user_proc_col] == 0) && (delta_row[iowait_col] == 0) &&
+    (delta_row[steal_col] == steal_col) &&
+    "Fields going backwards give no ticks, the others are plain differences."
+  );
+  assert(
+    (stat_cpu_array_row(delta, 1)[idle_col] == 0) &&
+    "Unchanged rows give zero deltas."
+  );
+  stat_cpu_array_free(delta);
+
+  stat_cpu_array_free(scanned);
+  stat_cpu_array_free(parsed);
+
+  test_hotplug();
+  test_uneven_columns();
+  test_sources();
+  return 0;
+}
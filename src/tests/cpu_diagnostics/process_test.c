@@ -0,0 +1,284 @@
+//for mkdtemp and truncate
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cpu_diagnostics/process.h"
+
+#include "fixture_tree.h"
+
+/**
+ * @file Tests of the per-task collector
+ * 
+ * The collector is pointed at a temporary directory laid out like /proc,
+ * whose stat files are rewritten between ticks.
+ */
+
+static void write_stat(
+  const char* path,
+  int tid,
+  const char* comm,
+  unsigned long long utime,
+  unsigned long long stime,
+  unsigned long long start_time
+) {
+  FILE* file = fixture_open(path);
+  fprintf(
+    file,
+    "%d (%s) S 1 %d %d 0 -1 4194560 120 0 0 0 %llu %llu 0 0 20 0 1 0 %llu "
+    "1000 100 18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 0 17 0 0 0 0 0 0\n",
+    tid,
+    comm,
+    tid,
+    tid,
+    utime,
+    stime,
+    start_time
+  );
+  fclose(file);
+}
+
+static const proc_delta_t* find_delta(proc_sample_t sample, int tid) {
+  for (size_t i = 0; i < sample->count; ++i) {
+    if (sample->entries[i].tid == tid) {
+      return &(sample->entries[i]);
+    }
+  }
+  return NULL;
+}
+
+static void test_table(void) {
+  proc_table_t table;
+  assert((proc_table_init(&table, 4) == 0) && "Table can be created.");
+  enum { id_count = 5000 };
+  for (int32_t tid = 1; tid <= id_count; ++tid) {
+    bool inserted = false;
+    proc_entry_t* entry = proc_table_insert(&table, tid, &inserted);
+    assert((entry != NULL) && inserted && "New ids are inserted.");
+    entry->utime = (uint64_t)tid;
+  }
+  assert(
+    (table.count == id_count) && (table.count * 2 <= table.capacity) &&
+    "Table grows to stay at most half full."
+  );
+  for (size_t i = 0; i < table.capacity; ++i) {
+    while (table.slots[i].tid != 0 && table.slots[i].tid % 2 == 1) {
+      proc_table_remove_at(&table, i);
+    }
+  }
+  assert((table.count == id_count / 2) && "Odd ids were removed.");
+  for (int32_t tid = 1; tid <= id_count; ++tid) {
+    proc_entry_t* entry = proc_table_find(&table, tid);
+    if (tid % 2 == 1) {
+      assert((entry == NULL) && "Removed ids can't be found.");
+    } else {
+      assert(
+        (entry != NULL) && (entry->utime == (uint64_t)tid) &&
+        "Remaining ids are still reachable after the clusters shifted."
+      );
+    }
+  }
+  proc_table_destroy(&table);
+}
+
+static void test_parse(void) {
+  static const char text[] =
+    "42 (a) (b) c) R 1 42 42 0 -1 0 0 0 0 0 700 300 0 0 20 0 1 0 9000 0\n";
+  proc_entry_t entry = {0};
+  assert(
+    (proc_stat_parse(text, text + strlen(text), &entry) == 0) &&
+    (entry.utime == 700) && (entry.stime == 300) &&
+    (entry.start_time == 9000) && (strcmp(entry.comm, "a) (b) c") == 0) &&
+    "Fields are counted from the last closing parenthesis."
+  );
+  static const char truncated[] = "42 (a) R 1 42 42 0 -1 0 0 0 0 0 700";
+  assert(
+    (proc_stat_parse(truncated, truncated + strlen(truncated), &entry) != 0) &&
+    "Truncated text is rejected."
+  );
+}
+
+static void test_processes(void) {
+  fixture_make_dir("100");
+  fixture_make_dir("200");
+  fixture_make_dir("self");
+  write_stat("100/stat", 100, "worker", 10, 5, 1000);
+  write_stat("200/stat", 200, "idle one", 3, 3, 2000);
+
+  proc_collector_t collector;
+  assert(
+    (
+      proc_collector_open(&collector, fixture_root, proc_collect_processes) == 0
+    ) &&
+    "Collector opens the fixture."
+  );
+  proc_sample_t sample = NULL;
+  assert(
+    (proc_collector_sample(&collector, &sample) == 0) &&
+    (sample->count == 0) && (sample->task_count == 2) &&
+    "First tick only records the tasks."
+  );
+  proc_sample_free(sample);
+
+  write_stat("100/stat", 100, "worker", 60, 25, 1000);
+  assert(
+    (proc_collector_sample(&collector, &sample) == 0) &&
+    (sample->count == 1) &&
+    "Only tasks that used the cpu are reported."
+  );
+  const proc_delta_t* delta = find_delta(sample, 100);
+  assert(
+    (delta != NULL) && (delta->utime == 50) && (delta->stime == 20) &&
+    (strcmp(delta->comm, "worker") == 0) &&
+    "Deltas are taken against the previous tick."
+  );
+  proc_report_t report = proc_report_create(sample, 5);
+  assert(
+    (report != NULL) && (report->count == 1) && (report->task_count == 2) &&
+    (report->entries[0].tid == 100) &&
+    "Report keeps the active tasks."
+  );
+  proc_report_free(report);
+  proc_sample_free(sample);
+
+  fixture_remove("200/stat");
+  fixture_remove("200");
+  fixture_make_dir("300");
+  write_stat("300/stat", 300, "new", 80, 0, 3000);
+  //id reused by a task with less cpu time than the previous owner
+  write_stat("100/stat", 100, "reused", 1, 1, 5000);
+  assert(
+    (proc_collector_sample(&collector, &sample) == 0) &&
+    (sample->count == 0) && (sample->task_count == 2) &&
+    (proc_collector_task_count(&collector) == 2) &&
+    "Exited tasks are dropped, new and reused ones start over."
+  );
+  proc_sample_free(sample);
+
+  write_stat("300/stat", 300, "new", 90, 0, 3000);
+  write_stat("100/stat", 100, "reused", 4, 1, 5000);
+  assert(
+    (proc_collector_sample(&collector, &sample) == 0) &&
+    (sample->count == 2) &&
+    (find_delta(sample, 300)->utime == 10) &&
+    (find_delta(sample, 100)->utime == 3) &&
+    "Tasks added in the previous tick are compared from now on."
+  );
+  report = proc_report_create(sample, 1);
+  assert(
+    (report->count == 1) && (report->active_count == 2) &&
+    (report->entries[0].tid == 300) &&
+    "Report is sorted and cut to the requested size."
+  );
+  proc_report_free(report);
+  proc_sample_free(sample);
+  proc_collector_close(&collector);
+
+  fixture_remove("100/stat");
+  fixture_remove("100");
+  fixture_remove("300/stat");
+  fixture_remove("300");
+  fixture_remove("self");
+}
+
+static void test_reused_after_exit(void) {
+  fixture_make_dir("700");
+  write_stat("700/stat", 700, "old", 10, 10, 100);
+  proc_collector_t collector;
+  assert(
+    (
+      proc_collector_open(&collector, fixture_root, proc_collect_processes) == 0
+    ) &&
+    "Collector opens the fixture."
+  );
+  proc_sample_t sample = NULL;
+  assert(
+    (proc_collector_sample(&collector, &sample) == 0) &&
+    "First tick records the task."
+  );
+  proc_sample_free(sample);
+
+  //descriptor kept from the exited task reads nothing, while the task that
+  //got its id has a different file under the same path
+  char full_path[FIXTURE_PATH_SIZE];
+  fixture_path(full_path, "700/stat");
+  assert((truncate(full_path, 0) == 0) && "Fixture file can be emptied.");
+  fixture_remove("700/stat");
+  write_stat("700/stat", 700, "new", 1, 1, 900);
+  assert(
+    (proc_collector_sample(&collector, &sample) == 0) &&
+    (sample->count == 0) && (proc_collector_task_count(&collector) == 1) &&
+    "Failed read reopens the file and starts the new task over."
+  );
+  proc_sample_free(sample);
+
+  write_stat("700/stat", 700, "new", 5, 1, 900);
+  assert(
+    (proc_collector_sample(&collector, &sample) == 0) &&
+    (sample->count == 1) && (find_delta(sample, 700)->utime == 4) &&
+    (strcmp(find_delta(sample, 700)->comm, "new") == 0) &&
+    "New task is read through the reopened file from then on."
+  );
+  proc_sample_free(sample);
+  proc_collector_close(&collector);
+
+  fixture_remove("700/stat");
+  fixture_remove("700");
+}
+
+static void test_threads(void) {
+  fixture_make_dir("500");
+  fixture_make_dir("500/task");
+  fixture_make_dir("500/task/500");
+  fixture_make_dir("500/task/501");
+  write_stat("500/stat", 500, "server", 30, 30, 100);
+  write_stat("500/task/500/stat", 500, "server", 10, 10, 100);
+  write_stat("500/task/501/stat", 501, "server-io", 20, 20, 110);
+
+  proc_collector_t collector;
+  assert(
+    (
+      proc_collector_open(&collector, fixture_root, proc_collect_threads) == 0
+    ) &&
+    "Collector opens the fixture."
+  );
+  proc_sample_t sample = NULL;
+  assert(
+    (proc_collector_sample(&collector, &sample) == 0) &&
+    (sample->task_count == 2) &&
+    "Threads are listed from the task directory."
+  );
+  proc_sample_free(sample);
+
+  write_stat("500/task/501/stat", 501, "server-io", 20, 27, 110);
+  assert(
+    (proc_collector_sample(&collector, &sample) == 0) &&
+    (sample->count == 1) && (sample->entries[0].tid == 501) &&
+    (sample->entries[0].tgid == 500) && (sample->entries[0].stime == 7) &&
+    "Thread deltas carry the owning process."
+  );
+  proc_sample_free(sample);
+  proc_collector_close(&collector);
+
+  fixture_remove("500/task/501/stat");
+  fixture_remove("500/task/501");
+  fixture_remove("500/task/500/stat");
+  fixture_remove("500/task/500");
+  fixture_remove("500/task");
+  fixture_remove("500/stat");
+  fixture_remove("500");
+}
+
+int main(void) {
+  fixture_create();
+  test_table();
+  test_parse();
+  test_processes();
+  test_reused_after_exit();
+  test_threads();
+  fixture_destroy();
+  return 0;
+}
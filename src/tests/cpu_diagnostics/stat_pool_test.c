@@ -0,0 +1,132 @@
+#include <assert.h>
+#include <string.h>
+#include <threads.h>
+
+#include "cpu_diagnostics/linux.h"
+#include "cpu_diagnostics/stat_pool.h"
+
+/**
+ * @file Tests of recycling samples and percentages through a pool
+ */
+
+static const char two_cores[] =
+  "cpu  2855 0 939 153614 127 0 1 763 0 0\n"
+  "cpu0 1400 0 500 76000 60 0 1 400 0 0\n"
+  "cpu1 1455 0 439 77614 67 0 0 363 0 0\n"
+  "intr 66325 0 0 0 0\n";
+
+static const char one_core[] =
+  "cpu  2855 0 939 153614 127 0 1 763 0 0\n"
+  "cpu0 1400 0 500 76000 60 0 1 400 0 0\n"
+  "intr 66325 0 0 0 0\n";
+
+static stat_layout_version_t* scan(const char* text, unsigned long long id) {
+  stat_layout_version_t* layout =
+    stat_layout_version_scan(text, text + strlen(text), id);
+  assert((layout != NULL) && "Layout is scanned from the text.");
+  return layout;
+}
+
+static int free_sample(void* sample) {
+  stat_cpu_array_free(sample);
+  return 0;
+}
+
+static void test_samples(void) {
+  stat_layout_version_t* layout = scan(two_cores, 1);
+  stat_pool_t pool;
+  assert(
+    (stat_pool_init(&pool, diagnostics_cpu_sample, 2) == 0) &&
+    "Pool can be created."
+  );
+  assert(
+    (stat_pool_take_usage(&pool, layout) == NULL) &&
+    "Pool of samples doesn't give out percentages."
+  );
+  stat_cpu_array_t first = stat_pool_take_sample(&pool, layout);
+  stat_cpu_array_t second = stat_pool_take_sample(&pool, layout);
+  stat_cpu_array_t third = stat_pool_take_sample(&pool, layout);
+  assert(
+    (first != NULL) && (second != NULL) && (third != NULL) &&
+    (first->layout == layout) && (first->cpu_count == 3) &&
+    "Pool gives out samples of the layout."
+  );
+  assert(
+    (first->pool == &pool) && (second->pool == &pool) &&
+    (third->pool == NULL) &&
+    "Samples past the capacity come from the heap."
+  );
+  first->timestamp.tv_sec = 1;
+  stat_cpu_array_free(first);
+  //handing back from another thread takes the lock-free path
+  thrd_t thread;
+  assert(
+    (thrd_create(&thread, free_sample, second) == thrd_success) &&
+    "Consumer thread starts."
+  );
+  thrd_join(thread, NULL);
+  stat_cpu_array_free(third);
+  assert(
+    (stat_pool_allocations(&pool) == 3) && "Every sample was allocated once."
+  );
+
+  for (int round = 0; round < 10; ++round) {
+    stat_cpu_array_t a = stat_pool_take_sample(&pool, layout);
+    stat_cpu_array_t b = stat_pool_take_sample(&pool, layout);
+    assert(
+      (a->timestamp.tv_sec == 0) && (b->timestamp.tv_sec == 0) &&
+      "Recycled samples come with a clean header."
+    );
+    stat_cpu_array_free(b);
+    stat_cpu_array_free(a);
+  }
+  assert(
+    (stat_pool_allocations(&pool) == 3) &&
+    "Steady state runs on recycled samples."
+  );
+
+  stat_layout_version_t* smaller = scan(one_core, 2);
+  stat_cpu_array_t resized = stat_pool_take_sample(&pool, smaller);
+  assert(
+    (resized->cpu_count == 2) && (resized->pool == &pool) &&
+    (stat_pool_allocations(&pool) == 4) &&
+    "Sample of an outdated layout is replaced by one that fits."
+  );
+  stat_cpu_array_free(resized);
+  stat_layout_version_release(smaller);
+  stat_pool_destroy(&pool);
+  stat_layout_version_release(layout);
+}
+
+static void test_usage(void) {
+  stat_layout_version_t* layout = scan(two_cores, 1);
+  stat_pool_t pool;
+  assert(
+    (stat_pool_init(&pool, diagnostics_cpu_usage, 1) == 0) &&
+    "Pool can be created."
+  );
+  assert(
+    (stat_pool_take_sample(&pool, layout) == NULL) &&
+    "Pool of percentages doesn't give out samples."
+  );
+  for (int round = 0; round < 5; ++round) {
+    stat_cpu_percentage_array_t usage = stat_pool_take_usage(&pool, layout);
+    assert(
+      (usage != NULL) && (usage->cpu_count == 3) &&
+      (usage->layout == layout) && (usage->pool == &pool) &&
+      "Pool gives out percentages of the layout."
+    );
+    stat_cpu_percentage_array_free(usage);
+  }
+  assert(
+    (stat_pool_allocations(&pool) == 1) && "Percentages are recycled."
+  );
+  stat_pool_destroy(&pool);
+  stat_layout_version_release(layout);
+}
+
+int main(void) {
+  test_samples();
+  test_usage();
+  return 0;
+}
@@ -0,0 +1,224 @@
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#include "data_structures/broadcast.h"
+#include "utilities/time.h"
+
+/**
+ * @file Tests of the single-publisher fan-out channel
+ */
+
+enum { transfer_count = 100000 };
+
+static int deleter_invocation_count;
+
+static void sample_deleter(void* value) {
+  free(value);
+  deleter_invocation_count += 1;
+}
+
+static atomic_int released_count;
+
+static void counting_deleter(void* value) {
+  (void)value;
+  atomic_fetch_add(&released_count, 1);
+}
+
+static int* new_element(int value) {
+  //assuming here malloc won't return NULL
+  int* element = malloc(sizeof(int));
+  *element = value;
+  return element;
+}
+
+static void test_shared(void) {
+  broadcast_t broadcast;
+  assert(
+    (broadcast_init(&broadcast, 4, 2, sample_deleter) == 0) &&
+    "Broadcast can be created."
+  );
+  deleter_invocation_count = 0;
+  int* lonely = new_element(0);
+  assert(
+    (broadcast_publish(&broadcast, lonely) == 0) &&
+    "Message can be published without subscribers."
+  );
+  assert(
+    (deleter_invocation_count == 1) &&
+    "Message nobody subscribed to is deleted right away."
+  );
+
+  broadcast_subscriber_t* first =
+    broadcast_subscribe(&broadcast, broadcast_lossless);
+  broadcast_subscriber_t* second =
+    broadcast_subscribe(&broadcast, broadcast_lossless);
+  assert((first != NULL && second != NULL) && "Subscribers are added.");
+  assert(
+    (broadcast_subscribe(&broadcast, broadcast_lossless) == NULL) &&
+    "Subscribers are limited."
+  );
+  assert((broadcast_take(first) == NULL) && "New subscriber has nothing.");
+
+  int* element = new_element(1);
+  broadcast_publish(&broadcast, element);
+  assert(
+    (broadcast_take(first) == element && broadcast_take(second) == element) &&
+    "Every subscriber gets the same message."
+  );
+  broadcast_release(first);
+  assert(
+    (deleter_invocation_count == 1) &&
+    "Message is kept while a subscriber holds it."
+  );
+  broadcast_release(second);
+  assert(
+    (deleter_invocation_count == 2) &&
+    "Last release deletes the message."
+  );
+  broadcast_release(second);
+  assert(
+    (deleter_invocation_count == 2) &&
+    "Release without a held message does nothing."
+  );
+
+  for (int i = 0; i < 4; ++i) {
+    assert(
+      (broadcast_publish(&broadcast, new_element(i)) == 0) &&
+      "Broadcast accepts messages up to its capacity."
+    );
+  }
+  int* declined = new_element(4);
+  assert(
+    (broadcast_publish(&broadcast, declined) == thrd_busy) &&
+    "Lossless subscriber a whole ring behind declines the message."
+  );
+  free(declined);
+  const int* taken = broadcast_take(first);
+  assert((taken != NULL && *taken == 0) && "Messages come in order.");
+  broadcast_release(first);
+  const int* kept = broadcast_take(second);
+  assert((kept != NULL && *kept == 0) && "Both subscribers get the oldest.");
+  declined = new_element(4);
+  assert(
+    (broadcast_publish(&broadcast, declined) == thrd_busy) &&
+    "Slot held by a subscriber isn't reused."
+  );
+  broadcast_release(second);
+  assert(
+    (broadcast_publish(&broadcast, declined) == 0) &&
+    "Released slot is reused."
+  );
+  //both subscribers still have 4 messages to take
+  broadcast_destroy(&broadcast);
+  assert(
+    (deleter_invocation_count == 7) &&
+    "Destroy deletes messages that weren't taken."
+  );
+}
+
+static void test_drop_oldest(void) {
+  broadcast_t broadcast;
+  broadcast_init(&broadcast, 4, 2, sample_deleter);
+  broadcast_subscriber_t* fast =
+    broadcast_subscribe(&broadcast, broadcast_lossless);
+  broadcast_subscriber_t* slow =
+    broadcast_subscribe(&broadcast, broadcast_drop_oldest);
+  deleter_invocation_count = 0;
+  for (int i = 0; i < 10; ++i) {
+    assert(
+      (broadcast_publish(&broadcast, new_element(i)) == 0) &&
+      "Keeping up lossless subscriber doesn't decline messages."
+    );
+    const int* taken = broadcast_take(fast);
+    assert((taken != NULL && *taken == i) && "Fast subscriber gets all.");
+    broadcast_release(fast);
+  }
+  assert(
+    (broadcast_dropped(slow) == 6 && broadcast_dropped(fast) == 0) &&
+    "Only the subscriber falling behind drops messages."
+  );
+  assert(
+    (deleter_invocation_count == 6) &&
+    "Skipped messages are released on behalf of the subscriber."
+  );
+  for (int i = 6; i < 10; ++i) {
+    const int* taken = broadcast_take(slow);
+    assert(
+      (taken != NULL && *taken == i) &&
+      "Slow subscriber continues with the newest messages."
+    );
+  }
+  assert((broadcast_take(slow) == NULL) && "Slow subscriber caught up.");
+  assert(
+    (deleter_invocation_count == 10) &&
+    "Taking the next message releases the previous one."
+  );
+  broadcast_destroy(&broadcast);
+}
+
+typedef struct transfer {
+  broadcast_subscriber_t* subscriber;
+  int valid;
+} transfer_t;
+
+static int subscriber_thread(void* argument) {
+  transfer_t* transfer = argument;
+  transfer->valid = 1;
+  for (uintptr_t i = 1; i <= transfer_count; ++i) {
+    timepoint_t deadline =
+      timepoint_after(timepoint_now(), timespan_s_ns(5, 0));
+    const void* message = broadcast_take_wait_t(transfer->subscriber, deadline);
+    if ((uintptr_t)message != i) {
+      transfer->valid = 0;
+      break;
+    }
+  }
+  broadcast_release(transfer->subscriber);
+  return 0;
+}
+
+static void test_threads(void) {
+  broadcast_t broadcast;
+  broadcast_init(&broadcast, 16, 3, counting_deleter);
+  atomic_init(&released_count, 0);
+  transfer_t transfers[3];
+  thrd_t threads[3];
+  for (size_t i = 0; i < 3; ++i) {
+    transfers[i].subscriber =
+      broadcast_subscribe(&broadcast, broadcast_lossless);
+  }
+  for (size_t i = 0; i < 3; ++i) {
+    assert(
+      (thrd_create(&(threads[i]), subscriber_thread, &(transfers[i])) ==
+        thrd_success) &&
+      "Subscriber thread starts."
+    );
+  }
+  for (uintptr_t i = 1; i <= transfer_count; ++i) {
+    while (broadcast_publish(&broadcast, (void*)i)) {
+      thrd_yield();
+    }
+  }
+  for (size_t i = 0; i < 3; ++i) {
+    thrd_join(threads[i], NULL);
+    assert(
+      transfers[i].valid &&
+      "Every subscriber gets all messages in order."
+    );
+  }
+  assert(
+    (atomic_load(&released_count) == transfer_count) &&
+    "Every message is released exactly once."
+  );
+  broadcast_destroy(&broadcast);
+}
+
+int main(void) {
+  test_shared();
+  test_drop_oldest();
+  test_threads();
+  return 0;
+}
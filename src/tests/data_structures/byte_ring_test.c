@@ -0,0 +1,139 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <threads.h>
+
+#include "data_structures/byte_ring.h"
+
+/**
+ * @file Tests of the single-producer single-consumer ring of frames
+ */
+
+enum { transfer_count = 200000 };
+
+static void push_frame(byte_ring_t ring[static 1], size_t size, int value) {
+  unsigned char* frame = byte_ring_reserve(ring, size);
+  assert((frame != NULL) && "Ring has space for the frame.");
+  memset(frame, value, size);
+  byte_ring_commit(ring, size);
+}
+
+static void pop_frame(byte_ring_t ring[static 1], size_t size, int value) {
+  size_t peeked_size = 0;
+  unsigned char* frame = byte_ring_peek(ring, &peeked_size);
+  assert((frame != NULL) && "Ring has a frame to peek.");
+  assert((peeked_size == size) && "Frame keeps its committed length.");
+  for (size_t i = 0; i < size; ++i) {
+    assert((frame[i] == value) && "Frame keeps its contents.");
+  }
+  byte_ring_consume(ring);
+}
+
+static void test_single_thread(void) {
+  byte_ring_t ring;
+  assert((byte_ring_init(&ring, 1000) == 0) && "Ring can be created.");
+  assert(
+    (byte_ring_max_frame(&ring) + BYTE_RING_ALIGNMENT == 512) &&
+    "Capacity is rounded up to a power of 2, frames take half of it."
+  );
+  assert(byte_ring_empty(&ring) && "New ring is empty.");
+  assert(
+    (byte_ring_reserve(&ring, byte_ring_max_frame(&ring) + 1) == NULL) &&
+    "Frame over the maximal length is declined."
+  );
+
+  //frames of odd lengths drift across the end of the buffer
+  for (int round = 0; round < 50; ++round) {
+    size_t size = 37 + (size_t)round * 5;
+    push_frame(&ring, size, round);
+    push_frame(&ring, 100, round + 1);
+    pop_frame(&ring, size, round);
+    pop_frame(&ring, 100, round + 1);
+  }
+  assert(byte_ring_empty(&ring) && "Emptied ring is empty.");
+
+  size_t pushed = 0;
+  unsigned char* frame;
+  while ((frame = byte_ring_reserve(&ring, 100)) != NULL) {
+    memset(frame, 0, 100);
+    byte_ring_commit(&ring, 100);
+    pushed += 1;
+  }
+  assert((pushed > 0 && pushed < 1024 / 100) && "Full ring declines frames.");
+  size_t size;
+  assert(
+    (byte_ring_peek(&ring, &size) != NULL && size == 100) &&
+    "Frames of the full ring are intact."
+  );
+  byte_ring_consume(&ring);
+  push_frame(&ring, 10, 7);
+  for (size_t i = 1; i < pushed; ++i) {
+    pop_frame(&ring, 100, 0);
+  }
+  pop_frame(&ring, 10, 7);
+
+  unsigned char* reserved = byte_ring_reserve(&ring, 64);
+  assert((reserved != NULL) && "Consumed frames make space.");
+  assert(
+    ((uintptr_t)reserved % BYTE_RING_ALIGNMENT == 0) &&
+    "Frames are aligned."
+  );
+  byte_ring_commit(&ring, 5);
+  assert(
+    (byte_ring_peek(&ring, &size) != NULL && size == 5) &&
+    "Committed length can be shorter than the reserved one."
+  );
+  byte_ring_consume(&ring);
+  assert(byte_ring_empty(&ring) && "Emptied ring is empty.");
+  byte_ring_destroy(&ring);
+}
+
+static int producer(void* argument) {
+  byte_ring_t* ring = argument;
+  for (uint32_t i = 0; i < transfer_count; ++i) {
+    size_t size = sizeof(uint32_t) * (1 + i % 7);
+    uint32_t* frame;
+    while ((frame = byte_ring_reserve(ring, size)) == NULL) {
+      thrd_yield();
+    }
+    for (size_t j = 0; j < size / sizeof(uint32_t); ++j) {
+      frame[j] = i;
+    }
+    byte_ring_commit(ring, size);
+  }
+  return 0;
+}
+
+static void test_threads(void) {
+  byte_ring_t ring;
+  byte_ring_init(&ring, 4096);
+  thrd_t thread;
+  assert(
+    (thrd_create(&thread, producer, &ring) == thrd_success) &&
+    "Producer thread starts."
+  );
+  bool valid = true;
+  for (uint32_t i = 0; i < transfer_count; ++i) {
+    size_t size;
+    uint32_t* frame;
+    while ((frame = byte_ring_peek(&ring, &size)) == NULL) {
+      thrd_yield();
+    }
+    valid = valid && size == sizeof(uint32_t) * (1 + i % 7);
+    for (size_t j = 0; valid && j < size / sizeof(uint32_t); ++j) {
+      valid = frame[j] == i;
+    }
+    byte_ring_consume(&ring);
+  }
+  thrd_join(thread, NULL);
+  assert(valid && "Frames cross threads intact and in order.");
+  assert(byte_ring_empty(&ring) && "Every frame was consumed.");
+  byte_ring_destroy(&ring);
+}
+
+int main(void) {
+  test_single_thread();
+  test_threads();
+  return 0;
+}
@@ -0,0 +1,166 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#include "data_structures/message_queue.h"
+#include "utilities/time.h"
+
+/**
+ * @file Tests of the statistics of the thread-safe queue, built with
+ * MESSAGE_QUEUE_STATS regardless of the rest of the project.
+ */
+
+static int* new_element(int value) {
+  //assuming here malloc won't return NULL
+  int* element = malloc(sizeof(int));
+  *element = value;
+  return element;
+}
+
+static unsigned long long histogram_total(
+  message_queue_stats_t stats[static 1]
+) {
+  unsigned long long total = 0;
+  for (size_t i = 0; i < MESSAGE_QUEUE_STATS_BUCKETS; ++i) {
+    total += stats->wait_histogram[i];
+  }
+  return total;
+}
+
+static int contended_push(void* argument) {
+  message_queue_push(argument, new_element(1));
+  return 0;
+}
+
+static int delayed_signal(void* argument) {
+  message_queue_t* queue = argument;
+  thrd_sleep(&(struct timespec){.tv_nsec = 20 * NS_PER_MS}, NULL);
+  mtx_lock(&(queue->lock));
+  cnd_signal(&(queue->wait));
+  mtx_unlock(&(queue->lock));
+  return 0;
+}
+
+static void test_counts(void) {
+  message_queue_t queue;
+  message_queue_init(&queue, free);
+  message_queue_stats_t stats;
+  assert(
+    (message_queue_stats(&queue, &stats) == 0) &&
+    "Statistics are available."
+  );
+  assert(
+    (stats.pushes == 0 && stats.pops == 0 && stats.max_depth == 0) &&
+    "Fresh queue has no statistics."
+  );
+
+  for (int i = 0; i < 3; ++i) {
+    message_queue_push(&queue, new_element(i));
+  }
+  thrd_sleep(&(struct timespec){.tv_nsec = 5 * NS_PER_MS}, NULL);
+  free(message_queue_pop(&queue));
+  message_queue_stats(&queue, &stats);
+  assert(
+    (stats.pushes == 3 && stats.pops == 1) &&
+    "Pushes and pops are counted."
+  );
+  assert(
+    (stats.depth == 2 && stats.max_depth == 3) &&
+    "Depth follows the queue and its maximum is kept."
+  );
+  unsigned long long long_waits = 0;
+  //bucket 12 starts at 2048 microseconds
+  for (size_t i = 12; i < MESSAGE_QUEUE_STATS_BUCKETS; ++i) {
+    long_waits += stats.wait_histogram[i];
+  }
+  assert(
+    (long_waits == 1) &&
+    "Time in queue of the popped message is recorded."
+  );
+
+  queue_t drained;
+  queue_init(&drained, free);
+  message_queue_drain(&queue, &drained);
+  queue_destroy(&drained);
+  message_queue_stats(&queue, &stats);
+  assert(
+    (stats.pops == 3 && stats.depth == 0 && stats.max_depth == 3) &&
+    "Drained messages count as popped."
+  );
+  assert(
+    (histogram_total(&stats) == stats.pops) &&
+    "Every popped message lands in the histogram."
+  );
+  message_queue_destroy(&queue);
+}
+
+static void test_policies(void) {
+  message_queue_t queue;
+  message_queue_init_bounded(&queue, free, 2, message_queue_drop_oldest);
+  for (int i = 0; i < 4; ++i) {
+    message_queue_push(&queue, new_element(i));
+  }
+  message_queue_stats_t stats;
+  message_queue_stats(&queue, &stats);
+  assert(
+    (stats.pushes == 4 && stats.pops == 0 && stats.depth == 2) &&
+    "Messages dropped for space aren't counted as popped."
+  );
+  message_queue_destroy(&queue);
+
+  message_queue_init_bounded(&queue, free, 1, message_queue_conflate);
+  message_queue_push(&queue, new_element(0));
+  message_queue_push(&queue, new_element(1));
+  message_queue_stats(&queue, &stats);
+  assert(
+    (stats.pushes == 2 && stats.depth == 1 && stats.max_depth == 1) &&
+    "Conflated push is counted without growing the queue."
+  );
+  message_queue_destroy(&queue);
+}
+
+static void test_contention(void) {
+  message_queue_t queue;
+  message_queue_init(&queue, free);
+  mtx_lock(&(queue.lock));
+  thrd_t producer;
+  assert(
+    (thrd_create(&producer, contended_push, &queue) == thrd_success) &&
+    "Producer thread starts."
+  );
+  thrd_sleep(&(struct timespec){.tv_nsec = 20 * NS_PER_MS}, NULL);
+  mtx_unlock(&(queue.lock));
+  thrd_join(producer, NULL);
+  message_queue_stats_t stats;
+  message_queue_stats(&queue, &stats);
+  assert(
+    (stats.contended_locks == 1 && stats.pushes == 1) &&
+    "Push waiting for the held lock is counted as contended."
+  );
+
+  free(message_queue_pop(&queue));
+  assert(
+    (thrd_create(&producer, delayed_signal, &queue) == thrd_success) &&
+    "Signalling thread starts."
+  );
+  timepoint_t deadline =
+    timepoint_after(timepoint_now(), timespan_s_ns(0, 200 * NS_PER_MS));
+  assert(
+    (message_queue_pop_wait_t(&queue, deadline) == NULL) &&
+    "Nothing is popped from the empty queue."
+  );
+  thrd_join(producer, NULL);
+  message_queue_stats(&queue, &stats);
+  assert(
+    (stats.spurious_wakeups == 1) &&
+    "Wake-up without a message is counted as spurious."
+  );
+  message_queue_destroy(&queue);
+}
+
+int main(void) {
+  test_counts();
+  test_policies();
+  test_contention();
+  return 0;
+}
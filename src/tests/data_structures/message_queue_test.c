@@ -0,0 +1,413 @@
+//for poll
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#include "data_structures/message_queue.h"
+#include "utilities/time.h"
+
+/**
+ * @file Tests of the thread-safe queue, focused on the bounded mode and its
+ * overflow policies.
+ */
+
+static int deleter_invocation_count;
+
+static void sample_deleter(void* value) {
+  free(value);
+  deleter_invocation_count += 1;
+}
+
+static int* new_element(int value) {
+  //assuming here malloc won't return NULL
+  int* element = malloc(sizeof(int));
+  *element = value;
+  return element;
+}
+
+static int pop_value(message_queue_t queue[static 1]) {
+  int* element = message_queue_pop(queue);
+  assert((element != NULL) && "Queue has an element to pop.");
+  int value = *element;
+  free(element);
+  return value;
+}
+
+static void fill(message_queue_t queue[static 1], int count) {
+  for (int i = 0; i < count; ++i) {
+    assert(
+      (message_queue_push(queue, new_element(i)) == 0) &&
+      "Queue accepts elements up to its capacity."
+    );
+  }
+}
+
+static int delayed_pop(void* argument) {
+  thrd_sleep(&(struct timespec){.tv_nsec = 20 * NS_PER_MS}, NULL);
+  free(message_queue_pop(argument));
+  return 0;
+}
+
+static int delayed_push(void* argument) {
+  thrd_sleep(&(struct timespec){.tv_nsec = 20 * NS_PER_MS}, NULL);
+  message_queue_push(argument, new_element(7));
+  return 0;
+}
+
+static int parked_pop(void* argument) {
+  timepoint_t deadline = timepoint_after(timepoint_now(), timespan_s_ns(5, 0));
+  int popped_count = 0;
+  for (int i = 0; i < 5; ++i) {
+    int* element = message_queue_pop_wait_t(argument, deadline);
+    if (element == NULL || *element != i) {
+      free(element);
+      break;
+    }
+    free(element);
+    popped_count += 1;
+  }
+  return popped_count;
+}
+
+static bool readable(message_queue_t queue[static 1]) {
+  struct pollfd poll_fd = {.fd = message_queue_fd(queue), .events = POLLIN};
+  return poll(&poll_fd, 1, 0) == 1;
+}
+
+static void test_unbounded(void) {
+  message_queue_t queue;
+  assert(
+    (message_queue_init(&queue, sample_deleter) == 0) &&
+    "Unbounded queue is initialized."
+  );
+  fill(&queue, 100);
+  assert(
+    (message_queue_size(&queue) == 100) &&
+    (message_queue_dropped(&queue) == 0) &&
+    "Unbounded queue takes everything."
+  );
+  assert((pop_value(&queue) == 0) && "Elements come out in order.");
+  deleter_invocation_count = 0;
+  message_queue_destroy(&queue);
+  assert(
+    (deleter_invocation_count == 99) &&
+    "Deleter is invoked on the leftovers."
+  );
+}
+
+static void test_drop_newest(void) {
+  message_queue_t queue;
+  assert(
+    (message_queue_init_bounded(
+      &queue,
+      sample_deleter,
+      3,
+      message_queue_drop_newest
+    ) == 0) &&
+    "Bounded queue is initialized."
+  );
+  fill(&queue, 3);
+  int* declined = new_element(3);
+  assert(
+    (message_queue_push(&queue, declined) == thrd_busy) &&
+    (message_queue_size(&queue) == 3) &&
+    (message_queue_dropped(&queue) == 1) &&
+    "Full queue declines the newest element."
+  );
+  free(declined);
+  assert((pop_value(&queue) == 0) && "Queued elements are untouched.");
+  message_queue_destroy(&queue);
+}
+
+static void test_drop_oldest(void) {
+  message_queue_t queue;
+  assert(
+    (message_queue_init_bounded(
+      &queue,
+      sample_deleter,
+      3,
+      message_queue_drop_oldest
+    ) == 0) &&
+    "Bounded queue is initialized."
+  );
+  fill(&queue, 3);
+  deleter_invocation_count = 0;
+  assert(
+    (message_queue_push(&queue, new_element(3)) == 0) &&
+    (message_queue_push(&queue, new_element(4)) == 0) &&
+    (deleter_invocation_count == 2) &&
+    (message_queue_size(&queue) == 3) &&
+    (message_queue_dropped(&queue) == 2) &&
+    "Full queue deletes the oldest elements to make space."
+  );
+  assert(
+    (pop_value(&queue) == 2) && (pop_value(&queue) == 3) &&
+    (pop_value(&queue) == 4) &&
+    "Remaining elements keep their order."
+  );
+  message_queue_destroy(&queue);
+}
+
+static void test_conflate(void) {
+  message_queue_t queue;
+  assert(
+    (message_queue_init_bounded(
+      &queue,
+      sample_deleter,
+      2,
+      message_queue_conflate
+    ) == 0) &&
+    "Bounded queue is initialized."
+  );
+  fill(&queue, 2);
+  deleter_invocation_count = 0;
+  for (int i = 10; i < 15; ++i) {
+    assert(
+      (message_queue_push(&queue, new_element(i)) == 0) &&
+      "Full conflating queue accepts the element."
+    );
+  }
+  assert(
+    (deleter_invocation_count == 5) && (message_queue_size(&queue) == 2) &&
+    (message_queue_dropped(&queue) == 5) &&
+    "Conflated elements are deleted."
+  );
+  assert(
+    (pop_value(&queue) == 0) && (pop_value(&queue) == 14) &&
+    "Newest queued element is replaced by the latest one."
+  );
+  message_queue_destroy(&queue);
+}
+
+static void test_block(void) {
+  message_queue_t queue;
+  assert(
+    (message_queue_init_bounded(
+      &queue,
+      sample_deleter,
+      2,
+      message_queue_block
+    ) == 0) &&
+    "Bounded queue is initialized."
+  );
+  fill(&queue, 2);
+  int* element = new_element(2);
+  timepoint_t deadline = timepoint_after(timepoint_now(), timespan_ms(10));
+  assert(
+    (message_queue_push_wait_t(&queue, element, deadline) == thrd_timedout) &&
+    (message_queue_size(&queue) == 2) &&
+    (message_queue_dropped(&queue) == 1) &&
+    "Blocked push times out when nothing is popped."
+  );
+  thrd_t consumer;
+  assert(
+    (thrd_create(&consumer, delayed_pop, &queue) == thrd_success) &&
+    "Consumer thread starts."
+  );
+  deadline = timepoint_after(timepoint_now(), timespan_s_ns(5, 0));
+  assert(
+    (message_queue_push_wait_t(&queue, element, deadline) == 0) &&
+    "Blocked push goes through once there's space."
+  );
+  thrd_join(consumer, NULL);
+  assert(
+    (pop_value(&queue) == 1) && (pop_value(&queue) == 2) &&
+    "Blocked element lands at the back."
+  );
+  message_queue_destroy(&queue);
+}
+
+static void test_batch(void) {
+  message_queue_t queue;
+  assert(
+    (message_queue_init_bounded(
+      &queue,
+      sample_deleter,
+      4,
+      message_queue_drop_newest
+    ) == 0) &&
+    "Bounded queue is initialized."
+  );
+  void* elements[6];
+  for (int i = 0; i < 6; ++i) {
+    elements[i] = new_element(i);
+  }
+  assert(
+    (message_queue_push_batch(&queue, elements, 6) == 4) &&
+    "Batch push stops at the capacity."
+  );
+  free(elements[4]);
+  free(elements[5]);
+  void* popped[8];
+  assert(
+    (message_queue_pop_batch(&queue, popped, 3, timepoint_now()) == 3) &&
+    "Batch pop takes up to the maximum."
+  );
+  bool in_order = true;
+  for (int i = 0; i < 3; ++i) {
+    in_order = in_order && (*(int*)popped[i] == i);
+    free(popped[i]);
+  }
+  assert(in_order && "Batch pop keeps the order.");
+  assert(
+    (message_queue_pop_batch(&queue, popped, 8, timepoint_now()) == 1) &&
+    (*(int*)popped[0] == 3) &&
+    "Batch pop takes only what is queued."
+  );
+  free(popped[0]);
+  timepoint_t start = timepoint_now();
+  assert(
+    (message_queue_pop_batch(
+      &queue,
+      popped,
+      8,
+      timepoint_after(start, timespan_ms(20))
+    ) == 0) &&
+    "Batch pop on an empty queue times out."
+  );
+  assert(
+    timepoint_gt(timepoint_now(), timepoint_after(start, timespan_ms(19))) &&
+    "Timed out batch pop lasts until the deadline."
+  );
+
+  fill(&queue, 4);
+  queue_t output;
+  queue_init(&output, sample_deleter);
+  assert(
+    (message_queue_drain(&queue, &output) == 4) &&
+    (message_queue_size(&queue) == 0) &&
+    (queue_size(&output) == 4) &&
+    "Drain moves every element out."
+  );
+  assert(
+    (*(int*)output.front->value == 0) && (*(int*)output.back->value == 3) &&
+    "Drained elements keep the order."
+  );
+  fill(&queue, 4);
+  assert(
+    (message_queue_drain(&queue, &output) == 4) &&
+    (queue_size(&output) == 8) &&
+    "Drain appends to the output."
+  );
+  deleter_invocation_count = 0;
+  queue_destroy(&output);
+  message_queue_destroy(&queue);
+  assert(
+    (deleter_invocation_count == 8) &&
+    "Output owns the drained elements."
+  );
+}
+
+static void test_blocking_batch(bool eventfd) {
+  message_queue_t queue;
+  assert(
+    (message_queue_init_bounded(
+      &queue,
+      sample_deleter,
+      2,
+      message_queue_block
+    ) == 0) &&
+    (!eventfd || message_queue_use_eventfd(&queue, 1000) == 0) &&
+    "Bounded queue is initialized."
+  );
+  thrd_t consumer;
+  assert(
+    (thrd_create(&consumer, parked_pop, &queue) == thrd_success) &&
+    "Consumer thread starts."
+  );
+  //gives the consumer time to park on the empty queue
+  thrd_sleep(&(struct timespec){.tv_nsec = 20 * NS_PER_MS}, NULL);
+  void* elements[5];
+  for (int i = 0; i < 5; ++i) {
+    elements[i] = new_element(i);
+  }
+  assert(
+    (message_queue_push_batch(&queue, elements, 5) == 5) &&
+    "Batch larger than the capacity waits for the consumer."
+  );
+  int popped_count = 0;
+  thrd_join(consumer, &popped_count);
+  assert(
+    (popped_count == 5) &&
+    "Parked consumer gets the whole batch in order."
+  );
+  message_queue_destroy(&queue);
+}
+
+static void test_eventfd(void) {
+  message_queue_t queue;
+  assert(
+    (message_queue_init(&queue, sample_deleter) == 0) &&
+    (message_queue_fd(&queue) == -1) &&
+    "Queue waits on the condition variable by default."
+  );
+  assert(
+    (message_queue_use_eventfd(&queue, 1000) == 0) &&
+    (message_queue_fd(&queue) >= 0) &&
+    "Queue switches to the eventfd."
+  );
+  assert(!readable(&queue) && "Empty queue's fd isn't readable.");
+  fill(&queue, 2);
+  assert(readable(&queue) && "Queue with messages has a readable fd.");
+  free(message_queue_pop(&queue));
+  assert(readable(&queue) && "Fd stays readable while messages are left.");
+  free(message_queue_pop(&queue));
+  assert(!readable(&queue) && "Emptied queue's fd isn't readable.");
+
+  timepoint_t start = timepoint_now();
+  assert(
+    (message_queue_pop_wait_t(&queue, timepoint_after(start, timespan_ms(20)))
+      == NULL) &&
+    "Waiting on an empty queue times out."
+  );
+  assert(
+    timepoint_gt(timepoint_now(), timepoint_after(start, timespan_ms(19))) &&
+    "Timed out wait lasts until the deadline."
+  );
+
+  thrd_t producer;
+  assert(
+    (thrd_create(&producer, delayed_push, &queue) == thrd_success) &&
+    "Producer thread starts."
+  );
+  timepoint_t deadline =
+    timepoint_after(timepoint_now(), timespan_s_ns(5, 0));
+  int* element = message_queue_pop_wait_t(&queue, deadline);
+  assert(
+    (element != NULL) && (*element == 7) &&
+    "Parked consumer is woken up by the push."
+  );
+  free(element);
+  thrd_join(producer, NULL);
+
+  assert(
+    (thrd_create(&producer, delayed_push, &queue) == thrd_success) &&
+    "Producer thread starts."
+  );
+  void* popped[4];
+  assert(
+    (message_queue_pop_batch(&queue, popped, 4, deadline) == 1) &&
+    "Parked batch pop is woken up by the push."
+  );
+  free(popped[0]);
+  thrd_join(producer, NULL);
+  assert(!readable(&queue) && "Fd is cleared by the batch pop.");
+  message_queue_destroy(&queue);
+}
+
+int main(void) {
+  test_unbounded();
+  test_drop_newest();
+  test_drop_oldest();
+  test_conflate();
+  test_block();
+  test_batch();
+  test_blocking_batch(false);
+  test_blocking_batch(true);
+  test_eventfd();
+  return 0;
+}
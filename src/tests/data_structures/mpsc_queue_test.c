@@ -0,0 +1,112 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#include "data_structures/mpsc_queue.h"
+#include "utilities/time.h"
+
+/**
+ * @file Tests of the intrusive multi-producer single-consumer queue
+ */
+
+enum { producer_count = 4, element_count = 50000 };
+
+typedef struct element {
+  mpsc_node_t link;
+  int producer;
+  int sequence;
+} element_t;
+
+typedef struct producer_argument {
+  mpsc_queue_t* queue;
+  int id;
+} producer_argument_t;
+
+static element_t elements[producer_count][element_count];
+
+static element_t* element_from_link(mpsc_node_t* link) {
+  return (element_t*)(void*)((char*)link - offsetof(element_t, link));
+}
+
+static int producer(void* argument) {
+  producer_argument_t* producer = argument;
+  for (int i = 0; i < element_count; ++i) {
+    element_t* element = &(elements[producer->id][i]);
+    element->producer = producer->id;
+    element->sequence = i;
+    mpsc_queue_push(producer->queue, &(element->link));
+  }
+  return 0;
+}
+
+static void test_single_thread(void) {
+  mpsc_queue_t queue;
+  assert((mpsc_queue_init(&queue) == 0) && "Queue can be created.");
+  assert((mpsc_queue_pop(&queue) == NULL) && "New queue is empty.");
+  //a few rounds so the stub gets requeued behind the last element
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 5; ++i) {
+      mpsc_queue_push(&queue, &(elements[0][i].link));
+    }
+    for (int i = 0; i < 5; ++i) {
+      assert(
+        (mpsc_queue_pop(&queue) == &(elements[0][i].link)) &&
+        "Queue pops elements in the same order as they were pushed."
+      );
+    }
+    assert((mpsc_queue_pop(&queue) == NULL) && "Emptied queue is empty.");
+  }
+  timepoint_t start = timepoint_now();
+  assert(
+    (mpsc_queue_pop_wait_t(&queue, timepoint_after(start, timespan_ms(20)))
+      == NULL) &&
+    "Waiting on an empty queue times out."
+  );
+  assert(
+    timepoint_gt(timepoint_now(), timepoint_after(start, timespan_ms(19))) &&
+    "Timed out wait lasts until the deadline."
+  );
+  mpsc_queue_destroy(&queue);
+}
+
+static void test_producers(void) {
+  mpsc_queue_t queue;
+  assert((mpsc_queue_init(&queue) == 0) && "Queue can be created.");
+  thrd_t threads[producer_count];
+  producer_argument_t arguments[producer_count];
+  for (int i = 0; i < producer_count; ++i) {
+    arguments[i] = (producer_argument_t){.queue = &queue, .id = i};
+    assert(
+      (thrd_create(&(threads[i]), producer, &(arguments[i])) == thrd_success) &&
+      "Producer thread starts."
+    );
+  }
+  int next_sequence[producer_count] = {0};
+  bool in_order = true;
+  for (int i = 0; i < producer_count * element_count; ++i) {
+    timepoint_t deadline =
+      timepoint_after(timepoint_now(), timespan_s_ns(5, 0));
+    mpsc_node_t* link = mpsc_queue_pop_wait_t(&queue, deadline);
+    assert((link != NULL) && "Every pushed element arrives.");
+    element_t* element = element_from_link(link);
+    in_order = in_order &&
+      (element->sequence == next_sequence[element->producer]);
+    next_sequence[element->producer] += 1;
+  }
+  for (int i = 0; i < producer_count; ++i) {
+    thrd_join(threads[i], NULL);
+  }
+  assert(
+    in_order && "Elements of each producer arrive in the order of pushing."
+  );
+  assert((mpsc_queue_pop(&queue) == NULL) && "Nothing is left behind.");
+  mpsc_queue_destroy(&queue);
+}
+
+int main(void) {
+  test_single_thread();
+  test_producers();
+  return 0;
+}
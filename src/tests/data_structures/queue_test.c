@@ -107,5 +107,62 @@ int main(void) {
     "There were 10 elements and deleter was invoked for all of them."
   );
 
+  //pooled queue behaves the same, only keeps its nodes around
+  assert(
+    (queue_init_pooled(&sample_queue, NULL, 4) == 0) &&
+    "Pooled queue is initialized."
+  );
+  assert(queue_empty(&sample_queue) && "Pooled queue is initialized empty.");
+  for (size_t i = 0; i < 10; ++i) {
+    assert(
+      (queue_push(&sample_queue, &(elements[i])) == 0) &&
+      "Pooled queue grows past its initial node count."
+    );
+  }
+  for (size_t i = 0; i < 10; ++i) {
+    assert(
+      (queue_pop(&sample_queue) == &(elements[i])) &&
+      "Pooled queue pops elements in the same order as they were pushed."
+    );
+  }
+  assert(
+    (queue_pop(&sample_queue) == NULL) &&
+    "Emptied pooled queue returns NULL on pop."
+  );
+  queue_push(&sample_queue, &(elements[0]));
+  queue_node_t* reused_node = sample_queue.back;
+  queue_pop(&sample_queue);
+  assert(
+    (sample_queue.spare == reused_node) &&
+    "Popped node goes back to the pool."
+  );
+  queue_push(&sample_queue, &(elements[1]));
+  assert(
+    (sample_queue.back == reused_node) &&
+    "Pushing takes the node from the pool."
+  );
+  assert(
+    (queue_push(&sample_queue, NULL) == -1) &&
+    "Pooled queue declines pushing a null pointer and returns -1"
+  );
+  queue_destroy(&sample_queue);
+
+  assert(
+    (queue_init_pooled(&sample_queue, sample_deleter, 16) == 0) &&
+    "Owning pooled queue is initialized."
+  );
+  for (size_t i = 0; i < 10; ++i) {
+    int *dynamic_element = malloc(sizeof(int));
+    *dynamic_element = elements[i];
+    queue_push(&sample_queue, dynamic_element);
+  }
+  free(queue_pop(&sample_queue));
+  deleter_invocation_count = 0;
+  queue_destroy(&sample_queue);
+  assert(
+    (deleter_invocation_count == 9) &&
+    "Destroying a pooled queue invokes deleter on leftover elements."
+  );
+
   return 0;
 }
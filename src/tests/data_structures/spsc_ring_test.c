@@ -0,0 +1,144 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#include "data_structures/spsc_ring.h"
+#include "utilities/time.h"
+
+/**
+ * @file Tests of the single-producer single-consumer ring
+ */
+
+enum { transfer_count = 200000 };
+
+static int deleter_invocation_count;
+
+static void sample_deleter(void* value) {
+  free(value);
+  deleter_invocation_count += 1;
+}
+
+static int producer(void* argument) {
+  spsc_ring_t* ring = argument;
+  for (uintptr_t i = 1; i <= transfer_count; ++i) {
+    while (spsc_ring_try_push(ring, (void*)i)) {
+      thrd_yield();
+    }
+  }
+  return 0;
+}
+
+static void test_single_thread(void) {
+  spsc_ring_t ring;
+  assert((spsc_ring_init(&ring, 5, NULL) == 0) && "Ring can be created.");
+  assert(
+    (spsc_ring_capacity(&ring) == 8) &&
+    "Capacity is rounded up to a power of 2."
+  );
+  assert((spsc_ring_try_pop(&ring) == NULL) && "New ring is empty.");
+  int elements[8] = {0};
+  //a few rounds so the indices wrap around the slots
+  for (int round = 0; round < 5; ++round) {
+    for (size_t i = 0; i < 8; ++i) {
+      assert(
+        (spsc_ring_try_push(&ring, &(elements[i])) == 0) &&
+        "Ring accepts elements up to its capacity."
+      );
+    }
+    assert(
+      (spsc_ring_try_push(&ring, &(elements[0])) == -1) &&
+      "Full ring declines the element."
+    );
+    for (size_t i = 0; i < 8; ++i) {
+      assert(
+        (spsc_ring_try_pop(&ring) == &(elements[i])) &&
+        "Ring pops elements in the same order as they were pushed."
+      );
+    }
+    assert((spsc_ring_try_pop(&ring) == NULL) && "Emptied ring is empty.");
+  }
+  timepoint_t start = timepoint_now();
+  assert(
+    (spsc_ring_pop_wait_t(&ring, timepoint_after(start, timespan_ms(20)))
+      == NULL) &&
+    "Waiting on an empty ring times out."
+  );
+  assert(
+    timepoint_gt(timepoint_now(), timepoint_after(start, timespan_ms(19))) &&
+    "Timed out wait lasts until the deadline."
+  );
+  spsc_ring_destroy(&ring);
+
+  assert(
+    (spsc_ring_init(&ring, 16, sample_deleter) == 0) &&
+    "Owning ring can be created."
+  );
+  for (size_t i = 0; i < 10; ++i) {
+    //assuming here malloc won't return NULL
+    spsc_ring_try_push(&ring, malloc(sizeof(int)));
+  }
+  deleter_invocation_count = 0;
+  spsc_ring_destroy(&ring);
+  assert(
+    (deleter_invocation_count == 10) &&
+    "Deleter is invoked on every leftover element."
+  );
+}
+
+static void test_pop_batch(void) {
+  spsc_ring_t ring;
+  assert((spsc_ring_init(&ring, 8, NULL) == 0) && "Ring can be created.");
+  int elements[8] = {0};
+  void* popped[8];
+  //a few rounds so the batch crosses the end of the slots
+  for (int round = 0; round < 3; ++round) {
+    for (size_t i = 0; i < 5; ++i) {
+      spsc_ring_try_push(&ring, &(elements[i]));
+    }
+    assert(
+      (spsc_ring_try_pop_batch(&ring, popped, 3) == 3) &&
+      (spsc_ring_try_pop_batch(&ring, popped + 3, 5) == 2) &&
+      "Batch pop takes up to the maximum and only what is queued."
+    );
+    bool in_order = true;
+    for (size_t i = 0; i < 5; ++i) {
+      in_order = in_order && (popped[i] == &(elements[i]));
+    }
+    assert(in_order && "Batch pop keeps the order.");
+    assert(
+      (spsc_ring_try_pop_batch(&ring, popped, 8) == 0) &&
+      "Batch pop on an empty ring takes nothing."
+    );
+  }
+  spsc_ring_destroy(&ring);
+}
+
+static void test_two_threads(void) {
+  spsc_ring_t ring;
+  assert((spsc_ring_init(&ring, 64, NULL) == 0) && "Ring can be created.");
+  thrd_t thread;
+  assert(
+    (thrd_create(&thread, producer, &ring) == thrd_success) &&
+    "Producer thread starts."
+  );
+  bool in_order = true;
+  for (uintptr_t i = 1; i <= transfer_count; ++i) {
+    timepoint_t deadline =
+      timepoint_after(timepoint_now(), timespan_s_ns(5, 0));
+    void* value = spsc_ring_pop_wait_t(&ring, deadline);
+    in_order = in_order && (value == (void*)i);
+  }
+  thrd_join(thread, NULL);
+  assert(in_order && "Every element arrives once and in order.");
+  assert((spsc_ring_try_pop(&ring) == NULL) && "Nothing is left behind.");
+  spsc_ring_destroy(&ring);
+}
+
+int main(void) {
+  test_single_thread();
+  test_pop_batch();
+  test_two_threads();
+  return 0;
+}
@@ -0,0 +1,148 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <threads.h>
+
+#include "data_structures/message_value_queue.h"
+#include "data_structures/value_queue.h"
+#include "utilities/time.h"
+
+/**
+ * @file Tests of the by-value queue and its thread-safe wrapper
+ */
+
+enum { transfer_count = 100000 };
+
+typedef struct payload {
+  uint64_t sequence;
+  uint32_t counters[3];
+} payload_t;
+
+static int producer(void* argument) {
+  message_value_queue_t* queue = argument;
+  for (uint64_t i = 0; i < transfer_count; ++i) {
+    payload_t payload = {.sequence = i, .counters = {1, 2, (uint32_t)i}};
+    message_value_queue_push(queue, &payload);
+  }
+  return 0;
+}
+
+static void test_value_queue(void) {
+  value_queue_t queue;
+  assert(
+    (value_queue_init(&queue, 0, 4) == -1) &&
+    "Elements can't be empty."
+  );
+  assert(
+    (value_queue_init(&queue, sizeof(payload_t), 4) == 0) &&
+    "Queue can be created."
+  );
+  payload_t payload;
+  assert((value_queue_pop(&queue, &payload) == -1) && "New queue is empty.");
+  //a few rounds crossing several chunks
+  for (int round = 0; round < 3; ++round) {
+    for (uint64_t i = 0; i < 11; ++i) {
+      payload_t in = {.sequence = i, .counters = {(uint32_t)round, 0, 7}};
+      assert(
+        (value_queue_push(&queue, &in) == 0) && "Queue takes the element."
+      );
+    }
+    assert((value_queue_size(&queue) == 11) && "Queue counts its elements.");
+    bool in_order = true;
+    for (uint64_t i = 0; i < 11; ++i) {
+      assert(
+        (value_queue_pop(&queue, &payload) == 0) && "Queue gives the element."
+      );
+      in_order = in_order && (payload.sequence == i) &&
+        (payload.counters[0] == (uint32_t)round) && (payload.counters[2] == 7);
+    }
+    assert(in_order && "Elements come out whole and in order.");
+    assert(value_queue_empty(&queue) && "Emptied queue is empty.");
+  }
+  //interleaved, so the front chunk gets emptied while the back one fills
+  uint64_t next_in = 0;
+  uint64_t next_out = 0;
+  bool in_order = true;
+  for (int i = 0; i < 100; ++i) {
+    payload_t in = {.sequence = next_in++};
+    value_queue_push(&queue, &in);
+    in.sequence = next_in++;
+    value_queue_push(&queue, &in);
+    value_queue_pop(&queue, &payload);
+    in_order = in_order && (payload.sequence == next_out++);
+  }
+  assert(
+    in_order && (value_queue_size(&queue) == 100) &&
+    "Interleaved pushes and pops keep the order."
+  );
+  value_queue_destroy(&queue);
+}
+
+static void test_message_value_queue(void) {
+  message_value_queue_t queue;
+  assert(
+    (message_value_queue_init(&queue, sizeof(payload_t), 2) == 0) &&
+    "Bounded queue can be created."
+  );
+  payload_t payload = {.sequence = 1};
+  message_value_queue_push(&queue, &payload);
+  message_value_queue_push(&queue, &payload);
+  timepoint_t start = timepoint_now();
+  assert(
+    (message_value_queue_push_wait_t(
+      &queue,
+      &payload,
+      timepoint_after(start, timespan_ms(20))
+    ) == thrd_timedout) &&
+    "Push to a full queue times out."
+  );
+  assert(
+    (message_value_queue_size(&queue) == 2) &&
+    "Timed out push leaves the queue as it was."
+  );
+  assert(
+    (message_value_queue_pop(&queue, &payload) == 0) &&
+    (message_value_queue_pop(&queue, &payload) == 0) &&
+    (message_value_queue_pop(&queue, &payload) == -1) &&
+    "Non-blocking pop reports an empty queue."
+  );
+  start = timepoint_now();
+  assert(
+    (message_value_queue_pop_wait_t(
+      &queue,
+      &payload,
+      timepoint_after(start, timespan_ms(20))
+    ) == thrd_timedout) &&
+    "Waiting on an empty queue times out."
+  );
+  assert(
+    timepoint_gt(timepoint_now(), timepoint_after(start, timespan_ms(19))) &&
+    "Timed out wait lasts until the deadline."
+  );
+
+  thrd_t thread;
+  assert(
+    (thrd_create(&thread, producer, &queue) == thrd_success) &&
+    "Producer thread starts."
+  );
+  bool in_order = true;
+  for (uint64_t i = 0; i < transfer_count; ++i) {
+    timepoint_t deadline =
+      timepoint_after(timepoint_now(), timespan_s_ns(5, 0));
+    assert(
+      (message_value_queue_pop_wait_t(&queue, &payload, deadline) == 0) &&
+      "Every pushed message arrives."
+    );
+    in_order = in_order && (payload.sequence == i) &&
+      (payload.counters[2] == (uint32_t)i);
+  }
+  thrd_join(thread, NULL);
+  assert(in_order && "Messages arrive whole and in order.");
+  message_value_queue_destroy(&queue);
+}
+
+int main(void) {
+  test_value_queue();
+  test_message_value_queue();
+  return 0;
+}
@@ -0,0 +1,102 @@
+#include <assert.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logger/log_args.h"
+
+/**
+ * @file Tests of the deferred formatting against snprintf
+ */
+
+/**
+ * @brief Captures the arguments, formats them and compares the text with the
+ * one of vsnprintf.
+ */
+static void check_format(const char* format, ...) {
+  va_list arguments;
+  va_start(arguments, format);
+  va_list measuring;
+  va_copy(measuring, arguments);
+  va_list expecting;
+  va_copy(expecting, arguments);
+  size_t size = log_args_capture(format, &measuring, NULL);
+  va_end(measuring);
+  unsigned char* captured = malloc(size ? size : 1);
+  assert((captured != NULL) && "Buffer for the arguments is allocated.");
+  assert(
+    (log_args_capture(format, &arguments, captured) == size) &&
+    "Capture takes the measured number of bytes."
+  );
+  va_end(arguments);
+  assert(
+    log_args_check(format, captured, size) &&
+    (size == 0 || !log_args_check(format, captured, size - 1)) &&
+    "Captured bytes are exactly the arguments of the format."
+  );
+
+  char expected[256];
+  int expected_length =
+    vsnprintf(expected, sizeof(expected), format, expecting);
+  va_end(expecting);
+  char text[256];
+  size_t length = log_args_format(text, sizeof(text), format, captured);
+  assert(
+    (length == (size_t)expected_length && strcmp(text, expected) == 0) &&
+    "Deferred formatting matches snprintf."
+  );
+
+  char short_text[8];
+  length = log_args_format(short_text, sizeof(short_text), format, captured);
+  assert(
+    (length == (size_t)expected_length) &&
+    "Cut text reports its whole length."
+  );
+  assert(
+    (strncmp(short_text, expected, sizeof(short_text) - 1) == 0 &&
+      strlen(short_text) < sizeof(short_text)) &&
+    "Cut text is a terminated prefix."
+  );
+  assert(
+    (log_args_format(NULL, 0, format, captured) == length) &&
+    "Text can be measured without a buffer."
+  );
+  free(captured);
+}
+
+static int captured_marker;
+
+int main(void) {
+  check_format("Plain text without conversions.");
+  check_format("%i %ld %lli %llu %llx %zu", -1, -2L, -3LL, 4ULL, 255ULL,
+    (size_t)6);
+  check_format("<Reader> Process %i: %s, %s", 42, "name", (char*)NULL);
+  check_format("%5.2f|%-8e|%g|%Lf %%", 3.14159, 2.5, 1e-7, 1.5L);
+  check_format("[%*d] [%-*.*s] [%.*f]", 6, 7, -6, 2, "text", -1, 0.5);
+  check_format("%c%hhd%hd%jd%td%p", 'x', 300, 70000, (intmax_t)9,
+    (ptrdiff_t)-10, (void*)&captured_marker);
+  check_format("%08.3x and %#o", 0xabcu, 8u);
+  char unterminated[3] = {'a', 'b', 'c'};
+  check_format("%.*s", 3, unterminated);
+  check_format("[%.2s] [%5.s] [%.*s]", unterminated, unterminated, -1, "all");
+
+  unsigned char captured[8];
+  char text[64];
+  assert(
+    (log_args_format(text, sizeof(text), "Cut %n here", captured) == 4 &&
+      strcmp(text, "Cut ") == 0) &&
+    "Rendering stops before an unsupported conversion."
+  );
+  memset(captured, 'a', sizeof(captured));
+  assert(
+    !log_args_check("%s", captured, sizeof(captured)) &&
+    "String without a terminator within the bytes is rejected."
+  );
+  assert(
+    !log_args_check("%i", captured, sizeof(int) * 2) &&
+    "Bytes left over after the arguments are rejected."
+  );
+  return 0;
+}
@@ -0,0 +1,313 @@
+#include <assert.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+
+#include "logger/log_args.h"
+#include "logger/log_binary.h"
+#include "logger/output_sinks.h"
+
+/**
+ * @file Tests of the binary log, records written by a binary sink have to
+ * decode to the text the default printer makes of them
+ */
+
+enum { record_count = 2000 };
+
+static unsigned char arguments[256];
+
+/**
+ * @brief Prints the record to the binary sink and its text to the expected
+ * output.
+ */
+static void print(
+  output_sink_t sink[static 1],
+  FILE expected[static 1],
+  log_record_t record[static 1],
+  const char* format,
+  ...
+) {
+  char message[256];
+  va_list list;
+  va_start(list, format);
+  va_list capturing;
+  va_copy(capturing, list);
+  vsnprintf(message, sizeof(message), format, list);
+  va_end(list);
+  record->format = format;
+  record->arguments = arguments;
+  record->arguments_size = log_args_capture(format, &capturing, arguments);
+  va_end(capturing);
+  assert(
+    (output_sink_print(sink, record) == 0) &&
+    "Record gets encoded."
+  );
+  record->message = message;
+  char line[512];
+  output_sink_default_printer(line, sizeof(line), record);
+  fputs(line, expected);
+}
+
+static int other_thread(void* argument) {
+  *(thrd_t*)argument = thrd_current();
+  return 0;
+}
+
+static void test_round_trip(void) {
+  FILE* binary = tmpfile();
+  FILE* expected = tmpfile();
+  FILE* decoded = tmpfile();
+  assert(
+    (binary != NULL && expected != NULL && decoded != NULL) &&
+    "Temporary files open."
+  );
+  output_sink_policy_t policy = output_sink_default_policy;
+  //small buffer makes records cross the writes
+  policy.buffer_size = 128;
+  output_sink_t* sink = output_sink_new_binary(binary, false, &policy);
+  assert((sink != NULL) && "Binary sink is created.");
+
+  thrd_t threads[2] = {thrd_current()};
+  thrd_t thread;
+  thrd_create(&thread, other_thread, &(threads[1]));
+  thrd_join(thread, NULL);
+
+  timepoint_t time = timepoint_now();
+  for (int i = 0; i < record_count; ++i) {
+    log_record_t record = {
+      .thread_id = threads[i % 2],
+      .timestamp = time,
+      .severity = (enum log_severity)(i % (log_fatal + 1))
+    };
+    switch (i % 4) {
+      case 0:
+        print(sink, expected, &record, "<Test> Record %i of %zu.", i,
+          (size_t)record_count);
+        break;
+      case 1:
+        print(sink, expected, &record, "<Test> %s %llx %5.2f %%", "hex",
+          0xabcULL * (unsigned long long)i, i / 7.0);
+        break;
+      case 2: {
+        char text[64];
+        snprintf(text, sizeof(text), "<Test> Plain text %i.", i);
+        record.message = text;
+        record.arguments = (const unsigned char*)text;
+        record.arguments_size = strlen(text) + 1;
+        assert(
+          (output_sink_print(sink, &record) == 0) &&
+          "Plain text gets encoded."
+        );
+        char line[512];
+        output_sink_default_printer(line, sizeof(line), &record);
+        fputs(line, expected);
+        break;
+      }
+      default:
+        print(sink, expected, &record, "<Test> Long %s.",
+          "argument longer than the buffer of the sink, which makes it go "
+          "out in a write of its own along with what was buffered");
+        break;
+    }
+    //records from different threads come slightly out of order
+    time = timepoint_after(
+      time,
+      timespan_s_ns(i % 3 == 0 ? 1 : 0, (i % 5 == 0) ? 0 : 999999999 - i)
+    );
+    if (i % 7 == 0) {
+      time.tv_nsec = (time.tv_nsec >= 1000) ? time.tv_nsec - 1000 : 0;
+    }
+  }
+  output_sink_free(sink);
+
+  rewind(binary);
+  assert(
+    (log_binary_decode(binary, decoded) == 0) &&
+    "Binary log decodes."
+  );
+  rewind(expected);
+  rewind(decoded);
+  char expected_line[512];
+  char decoded_line[512];
+  size_t lines = 0;
+  while (fgets(expected_line, sizeof(expected_line), expected) != NULL) {
+    assert(
+      (fgets(decoded_line, sizeof(decoded_line), decoded) != NULL &&
+        strcmp(expected_line, decoded_line) == 0) &&
+      "Decoded text matches the text of the default printer."
+    );
+    lines += 1;
+  }
+  assert(
+    (lines == record_count &&
+      fgets(decoded_line, sizeof(decoded_line), decoded) == NULL) &&
+    "Every record is decoded once."
+  );
+
+  fseek(binary, 0, SEEK_END);
+  long binary_size = ftell(binary);
+  fseek(expected, 0, SEEK_END);
+  assert(
+    (binary_size < ftell(expected)) &&
+    "Binary log is smaller than the text."
+  );
+  fclose(binary);
+  fclose(expected);
+  fclose(decoded);
+}
+
+static void test_retry(void) {
+  log_binary_encoder_t encoder;
+  assert(
+    (log_binary_encoder_init(&encoder, timepoint_now()) == 0) &&
+    "Encoder initializes."
+  );
+  char text[] = "Text.";
+  log_record_t record = {
+    .thread_id = thrd_current(),
+    .timestamp = timepoint_now(),
+    .severity = log_info,
+    .message = text,
+    .arguments = (const unsigned char*)text,
+    .arguments_size = sizeof(text)
+  };
+  char buffer[64];
+  int length = log_binary_encode(&encoder, buffer, 4, &record);
+  assert(
+    (log_binary_encode(&encoder, buffer, sizeof(buffer), &record) == length) &&
+    "Record that didn't fit encodes again the same."
+  );
+  assert(
+    (log_binary_encode(&encoder, buffer, sizeof(buffer), &record) < length) &&
+    "Thread is defined only once."
+  );
+  log_binary_encoder_destroy(&encoder);
+}
+
+/**
+ * @brief Writes a log of the records, as encoded without any checks.
+ * 
+ * @return Length of the log.
+ */
+static long write_log(
+  FILE binary[static 1],
+  log_record_t records[],
+  size_t count
+) {
+  log_binary_encoder_t encoder;
+  assert(
+    (log_binary_encoder_init(&encoder, timepoint_now()) == 0) &&
+    "Encoder initializes."
+  );
+  static char buffer[8192];
+  int length = log_binary_header(&encoder, buffer, sizeof(buffer));
+  fwrite(buffer, 1, (size_t)length, binary);
+  for (size_t i = 0; i < count; ++i) {
+    length = log_binary_encode(&encoder, buffer, sizeof(buffer), &records[i]);
+    assert(
+      (length > 0 && (size_t)length < sizeof(buffer)) &&
+      "Record gets encoded."
+    );
+    fwrite(buffer, 1, (size_t)length, binary);
+  }
+  log_binary_encoder_destroy(&encoder);
+  long size = ftell(binary);
+  rewind(binary);
+  return size;
+}
+
+static void test_malformed(void) {
+  FILE* input = tmpfile();
+  FILE* output = tmpfile();
+  fputs("Not a binary log.", input);
+  rewind(input);
+  assert(
+    (log_binary_decode(input, output) == -1) &&
+    "Text isn't decoded."
+  );
+  fclose(input);
+
+  static unsigned char unterminated[5000];
+  memset(unterminated, 'a', sizeof(unterminated));
+  log_record_t record = {
+    .thread_id = thrd_current(),
+    .timestamp = timepoint_now(),
+    .severity = log_info,
+    .format = "<Test> %s.",
+    .arguments = unterminated,
+    .arguments_size = sizeof(unterminated)
+  };
+  input = tmpfile();
+  write_log(input, &record, 1);
+  assert(
+    (log_binary_decode(input, output) == -1) &&
+    "Arguments that don't fit their format aren't decoded."
+  );
+  fclose(input);
+  fclose(output);
+}
+
+static void test_truncated(void) {
+  char text[] = "Text.";
+  log_record_t records[3];
+  for (size_t i = 0; i < 3; ++i) {
+    records[i] = (log_record_t){
+      .thread_id = thrd_current(),
+      .timestamp = timepoint_now(),
+      .severity = log_info,
+      .message = text,
+      .arguments = (const unsigned char*)text,
+      .arguments_size = sizeof(text)
+    };
+  }
+  FILE* complete = tmpfile();
+  long size = write_log(complete, records, 3);
+  char* bytes = malloc((size_t)size);
+  assert(
+    (bytes != NULL &&
+      fread(bytes, 1, (size_t)size, complete) == (size_t)size) &&
+    "Log is read back."
+  );
+  fclose(complete);
+
+  FILE* input = tmpfile();
+  FILE* output = tmpfile();
+  //cut in the middle of the last record
+  fwrite(bytes, 1, (size_t)size - 3, input);
+  rewind(input);
+  assert(
+    (log_binary_decode(input, output) == -3) &&
+    "Log ending within an entry is reported as truncated."
+  );
+  rewind(output);
+  char line[512];
+  size_t lines = 0;
+  while (fgets(line, sizeof(line), output) != NULL) {
+    lines += 1;
+  }
+  assert((lines == 2) && "Records before the cut are decoded.");
+  fclose(input);
+  fclose(output);
+
+  input = tmpfile();
+  output = tmpfile();
+  fwrite(bytes, 1, 4, input);
+  rewind(input);
+  assert(
+    (log_binary_decode(input, output) == -3) &&
+    "Log ending within the header is reported as truncated."
+  );
+  fclose(input);
+  fclose(output);
+  free(bytes);
+}
+
+int main(void) {
+  test_round_trip();
+  test_retry();
+  test_malformed();
+  test_truncated();
+  return 0;
+}
@@ -0,0 +1,105 @@
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <threads.h>
+
+#include "logger/logger.h"
+
+/**
+ * @file Tests of records that find the ring of their thread full
+ *
+ * Nothing drains the ring unless a test starts a thread for it, so the ring
+ * fills up with a burst of records.
+ */
+
+static atomic_bool draining;
+
+static int drain(void* context) {
+  (void)context;
+  while (atomic_load(&draining)) {
+    log_process_some_dur(timespan_ms(1));
+  }
+  return 0;
+}
+
+static size_t count_lines(FILE stream[static 1], const char* text) {
+  char line[256];
+  size_t count = 0;
+  rewind(stream);
+  while (fgets(line, sizeof(line), stream) != NULL) {
+    if (strstr(line, text) != NULL) {
+      count += 1;
+    }
+  }
+  return count;
+}
+
+/**
+ * @return Number of records that got into the ring.
+ */
+static size_t fill_ring(void) {
+  size_t dropped = log_dropped();
+  size_t records = 0;
+  while (log_dropped() == dropped) {
+    log_puts(log_info, "<Test> Filling the ring up.");
+    records += 1;
+  }
+  return records - 1;
+}
+
+int main(void) {
+  assert((log_init() == 0) && "Logger initializes.");
+  FILE* stream = tmpfile();
+  assert((stream != NULL) && "Temporary file opens.");
+  assert(
+    (log_add_sink_f(stream, false, NULL, NULL) == 0) &&
+    "Sink is added."
+  );
+
+  size_t records = fill_ring();
+  log_puts(log_error, "<Test> Urgent record without a logger.");
+  assert(
+    (log_dropped() == 1) &&
+    "Record of log_error isn't dropped."
+  );
+  log_process_all();
+  assert(
+    (count_lines(stream, "Filling the ring up.") == records) &&
+    "Records that fit the ring are printed."
+  );
+  assert(
+    (count_lines(stream, "Urgent record") == 0) &&
+    "Urgent record is written to stderr instead of the full ring."
+  );
+  assert(
+    (count_lines(stream, "Dropped 1 records, 1 in total.") == 1) &&
+    "Logger reports the drop."
+  );
+
+  fill_ring();
+  atomic_init(&draining, true);
+  thrd_t drainer;
+  assert(
+    (thrd_create(&drainer, drain, NULL) == thrd_success) &&
+    "Draining thread starts."
+  );
+  log_printf(log_fatal, "<Test> Waiting record %i.", 7);
+  atomic_store(&draining, false);
+  thrd_join(drainer, NULL);
+  log_process_all();
+  assert(
+    (count_lines(stream, "Waiting record 7.") == 1) &&
+    "Urgent record waits for space in the ring."
+  );
+  assert(
+    (log_dropped() == 2 &&
+      count_lines(stream, "Dropped 1 records, 2 in total.") == 1) &&
+    "Every drop gets reported once."
+  );
+
+  log_destroy();
+  fclose(stream);
+  return 0;
+}
@@ -0,0 +1,70 @@
+#include <assert.h>
+#include <stdbool.h>
+
+#include "logger/logger.h"
+
+/**
+ * @file Tests of the global and per module severity filtering
+ * 
+ * Builds can compile out the lowest severities with LOG_MIN_SEVERITY, so
+ * records expected to pass are checked against what the build compiled in.
+ */
+
+static log_module_t test_module = LOG_MODULE_INIT("test");
+
+static bool compiled_in(enum log_severity severity) {
+  return severity >= LOG_COMPILED_MIN_SEVERITY;
+}
+
+int main(void) {
+  assert((log_init() == 0) && "Logger initializes.");
+  assert(
+    (log_enabled(&test_module, log_trace) == compiled_in(log_trace)) &&
+    "Everything compiled in is logged by default."
+  );
+
+  log_set_min_severity(log_info);
+  assert(
+    (!log_enabled(NULL, log_debug) &&
+      log_enabled(NULL, log_info) == compiled_in(log_info)) &&
+    "Global severity filters records."
+  );
+  assert(
+    (!log_enabled(&test_module, log_debug) &&
+      log_enabled(&test_module, log_error) == compiled_in(log_error)) &&
+    "Module follows the global severity by default."
+  );
+
+  log_module_set_min_severity(&test_module, log_trace);
+  assert(
+    (log_enabled(&test_module, log_trace) == compiled_in(log_trace) &&
+      !log_enabled(NULL, log_trace)) &&
+    "Module severity overrides the global one."
+  );
+  for (int severity = log_trace; severity < log_fatal; ++severity) {
+    assert(
+      (compiled_in(severity) || !log_enabled(&test_module, severity)) &&
+      "Severities compiled out stay filtered."
+    );
+  }
+  log_module_set_min_severity(&test_module, log_fatal);
+  assert(
+    !log_enabled(&test_module, log_error) &&
+    "Module severity can be stricter than the global one."
+  );
+
+  int evaluated = 0;
+  LOG_PRINTF(&test_module, log_info, "Value %i.", ++evaluated);
+  assert((evaluated == 0) && "Filtered call doesn't evaluate arguments.");
+  LOG_PRINTF(&test_module, log_fatal, "Value %i.", ++evaluated);
+  assert((evaluated == 1) && "Passing call evaluates arguments.");
+
+  log_module_set_min_severity(&test_module, log_module_inherit);
+  assert(
+    (!log_enabled(&test_module, log_debug) &&
+      log_enabled(&test_module, log_info) == compiled_in(log_info)) &&
+    "Module can follow the global severity again."
+  );
+  log_destroy();
+  return 0;
+}
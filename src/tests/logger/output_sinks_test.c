@@ -0,0 +1,129 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <threads.h>
+
+#include "logger/output_sinks.h"
+
+/**
+ * @file Tests of the buffering and flush policy of the sinks
+ */
+
+static long file_size(FILE stream[static 1]) {
+  fseek(stream, 0, SEEK_END);
+  return ftell(stream);
+}
+
+static void print(
+  output_sink_t sink[static 1],
+  enum log_severity severity,
+  char* message
+) {
+  log_record_t record = {
+    .thread_id = thrd_current(),
+    .timestamp = timepoint_now(),
+    .severity = severity,
+    .message = message
+  };
+  assert((output_sink_print(sink, &record) == 0) && "Record gets printed.");
+}
+
+static void test_policy(void) {
+  FILE* stream = tmpfile();
+  assert((stream != NULL) && "Temporary file opens.");
+  output_sink_policy_t policy = {
+    .buffer_size = 256,
+    .interval = timespan_s_ns(3600, 0),
+    .flush_severity = log_error
+  };
+  output_sink_t* sink = output_sink_new(stream, false, NULL, &policy);
+  assert((sink != NULL) && "Sink is created.");
+
+  print(sink, log_info, "First.");
+  print(sink, log_warning, "Second.");
+  assert(
+    (sink->write_count == 0 && file_size(stream) == 0) &&
+    "Records below the flush severity are buffered."
+  );
+  print(sink, log_error, "Third.");
+  assert(
+    (sink->write_count == 1 && file_size(stream) > 0 && sink->length == 0) &&
+    "Record of the flush severity writes the buffer out."
+  );
+
+  size_t records = 0;
+  while (sink->write_count == 1) {
+    print(sink, log_info, "Filling the buffer up.");
+    records += 1;
+  }
+  assert(
+    (records > 1 && sink->length != 0) &&
+    "Buffer is written once the next record doesn't fit it."
+  );
+
+  timepoint_t flush_time;
+  queue_t sinks;
+  queue_init(&sinks, NULL);
+  assert(
+    !output_sink_list_next_flush(&sinks, &flush_time) &&
+    "Empty list has nothing to write."
+  );
+  queue_push(&sinks, sink);
+  assert(
+    output_sink_list_next_flush(&sinks, &flush_time) &&
+    "Buffered records are due."
+  );
+  assert(
+    (output_sink_list_flush_due(&sinks, timepoint_now()) == 0 &&
+      sink->length != 0) &&
+    "Buffer isn't written before the interval passes."
+  );
+  output_sink_list_flush_due(&sinks, flush_time);
+  assert((sink->length == 0) && "Buffer is written once it's due.");
+
+  char long_message[1000];
+  memset(long_message, 'x', sizeof(long_message) - 1);
+  long_message[sizeof(long_message) - 1] = '\0';
+  long size_before = file_size(stream);
+  size_t writes_before = sink->write_count;
+  print(sink, log_info, "Short.");
+  print(sink, log_info, long_message);
+  assert(
+    (sink->write_count == writes_before + 1 && sink->length == 0) &&
+    "Record over the buffer size is written along with the buffer."
+  );
+  assert(
+    (file_size(stream) > size_before + (long)sizeof(long_message)) &&
+    "Every byte of the long record is written."
+  );
+  queue_destroy(&sinks);
+  output_sink_free(sink);
+  fclose(stream);
+}
+
+static void test_burst(void) {
+  FILE* stream = tmpfile();
+  output_sink_t* sink = output_sink_new(stream, true, NULL, NULL);
+  for (int i = 0; i < 10000; ++i) {
+    print(sink, log_trace, "<Test> Record of a logging burst.");
+  }
+  output_sink_flush(sink);
+  assert(
+    (sink->write_count < 100) &&
+    "Burst is written in a few calls."
+  );
+  char line[128];
+  rewind(stream);
+  size_t lines = 0;
+  while (fgets(line, sizeof(line), stream) != NULL) {
+    lines += 1;
+  }
+  assert((lines == 10000) && "Every record of the burst is written.");
+  output_sink_free(sink);
+}
+
+int main(void) {
+  test_policy();
+  test_burst();
+  return 0;
+}
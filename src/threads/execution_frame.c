@@ -10,7 +10,8 @@ int execution_frame(void* context) {
   ctx->stack_data = stack_data;
   ctx->loop.count = 0;
 #ifndef EXEC_FRAME_NO_LOG
-  log_printf(
+  LOG_PRINTF(
+    ctx->frame.log_module,
     log_trace,
     "<%s> Thread starts.",
     ctx->name
@@ -30,7 +31,8 @@ int execution_frame(void* context) {
     ctx->loop.count += 1;
 #ifndef EXEC_FRAME_NO_LOG
     timespan_t total_dur = timespan_dur(ctx->loop.start, timepoint_now());    
-    log_printf(
+    LOG_PRINTF(
+      ctx->frame.log_module,
       log_debug,
       "<%s> Iteration #%llx finished in %llisec %llinsec.",
       ctx->name,
@@ -39,7 +41,8 @@ int execution_frame(void* context) {
       (long long int)total_dur.tv_nsec
     );
     if (timepoint_gt(ctx->interval, total_dur)) {
-      log_printf(
+      LOG_PRINTF(
+        ctx->frame.log_module,
         log_warning,
         "<%s> Loop finished too fast.",
         ctx->name
@@ -48,7 +51,8 @@ int execution_frame(void* context) {
 #endif
   }
 #ifndef EXEC_FRAME_NO_LOG 
-  log_printf(
+  LOG_PRINTF(
+    ctx->frame.log_module,
     log_trace,
     "<%s> Thread ends after %llu iterations.",
     ctx->name,
@@ -1,66 +1,239 @@
 #include "analyzer.h"
 
 #include "logger/logger.h"
+#include "cpu_diagnostics/cgroup.h"
+#include "cpu_diagnostics/process.h"
+
+static log_module_t analyzer_log_module = LOG_MODULE_INIT("analyzer");
 
 frame_func_t analyzer_frame = {
   .init = analyzer_init,
   .loop = analyzer_loop,
-  .cleanup = analyzer_cleanup
+  .cleanup = analyzer_cleanup,
+  .log_module = &analyzer_log_module
 };
 
 
 int analyzer_init(void* context) {
   thread_context_t* ctx = context;
   analyzer_context_t* domain = ctx->domain;
-  domain->stack.prev = NULL;
-  domain->stack.curr = NULL;
-  domain->stack.delta = stat_cpu_array_create();
-  if (domain->stack.delta == NULL) {
+  domain->stack.prev = calloc(domain->source_count, sizeof(stat_cpu_array_t));
+  if (domain->stack.prev == NULL) {
+    LOG_PUTS(
+      &analyzer_log_module,
+      log_fatal,
+      "<Analyzer> Failed to allocate per source state."
+    );
     return -1;
   }
+  domain->stack.curr = NULL;
   return 0;
 }
 
 
+/**
+ * @brief Calculates percentages between two samples of the same source and
+ * layout, then passes them on.
+ */
+static void analyzer_process(
+  analyzer_context_t domain[static 1],
+  stat_cpu_array_t prev,
+  stat_cpu_array_t curr
+) {
+  LOG_PUTS(
+    &analyzer_log_module,
+    log_trace,
+    "<Analyzer> Input fetched, processing."
+  );
+  stat_cpu_percentage_array_t result = (domain->usage_pool != NULL) ?
+    stat_pool_take_usage(domain->usage_pool, curr->layout) :
+    stat_cpu_percentage_array_create_v(curr->layout);
+  if (result == NULL) {
+    //TO DO: Out of memory
+    return;
+  }
+  result->source = curr->source;
+  LOG_PUTS(&analyzer_log_module, log_trace, "<Analyzer> Calculating results.");
+  size_t reset_count = stat_cpu_percentage_array_calculate_delta_l(
+    result,
+    prev,
+    curr,
+    &(curr->layout->layout)
+  );
+  reset_count += stat_system_rates_calculate(&(result->system), prev, curr);
+  if (reset_count) {
+    LOG_PRINTF(
+      &analyzer_log_module,
+      log_warning,
+      "<Analyzer> %zu counters of %s were reset since the previous sample.",
+      reset_count,
+      curr->source->name
+    );
+  }
+  int push_flag = broadcast_publish(domain->output, result);
+  if (push_flag) {
+    stat_cpu_percentage_array_free(result);
+    LOG_PRINTF(
+      &analyzer_log_module,
+      log_error,
+      "<Analyzer> Failed to publish results, return code: %i.",
+      push_flag
+    );
+  } else {
+    LOG_PUTS(&analyzer_log_module, log_trace, "<Analyzer> Published results.");
+  }
+}
+
+
+/**
+ * @brief Turns usage of tasks into a report of the top ones and passes it on.
+ */
+static void analyzer_process_tasks(
+  analyzer_context_t domain[static 1],
+  proc_sample_t sample
+) {
+  proc_report_t report = proc_report_create(sample, domain->proc_top_count);
+  proc_sample_free(sample);
+  if (report == NULL) {
+    LOG_PUTS(
+      &analyzer_log_module,
+      log_error,
+      "<Analyzer> Failed to allocate task report, sample dropped."
+    );
+    return;
+  }
+  int push_flag = broadcast_publish(domain->output, report);
+  if (push_flag) {
+    proc_report_free(report);
+    LOG_PRINTF(
+      &analyzer_log_module,
+      log_error,
+      "<Analyzer> Failed to publish task report, return code: %i.",
+      push_flag
+    );
+  } else {
+    LOG_PUTS(
+      &analyzer_log_module,
+      log_trace,
+      "<Analyzer> Published task report."
+    );
+  }
+}
+
+
+/**
+ * @brief Turns usage of cgroups into a report of the top ones and passes it
+ * on.
+ */
+static void analyzer_process_cgroups(
+  analyzer_context_t domain[static 1],
+  cgroup_sample_t sample
+) {
+  cgroup_report_t report =
+    cgroup_report_create(sample, domain->cgroup_top_count);
+  cgroup_sample_free(sample);
+  if (report == NULL) {
+    LOG_PUTS(
+      &analyzer_log_module,
+      log_error,
+      "<Analyzer> Failed to allocate cgroup report, sample dropped."
+    );
+    return;
+  }
+  int push_flag = broadcast_publish(domain->output, report);
+  if (push_flag) {
+    cgroup_report_free(report);
+    LOG_PRINTF(
+      &analyzer_log_module,
+      log_error,
+      "<Analyzer> Failed to publish cgroup report, return code: %i.",
+      push_flag
+    );
+  } else {
+    LOG_PUTS(
+      &analyzer_log_module,
+      log_trace,
+      "<Analyzer> Published cgroup report."
+    );
+  }
+}
+
+
+/**
+ * @brief Routes a single message to its processing by kind.
+ */
+static void analyzer_dispatch(
+  analyzer_context_t domain[static 1],
+  void* message
+) {
+  if (diagnostics_message_kind(message) == diagnostics_proc_sample) {
+    analyzer_process_tasks(domain, message);
+    return;
+  }
+  if (diagnostics_message_kind(message) == diagnostics_cgroup_sample) {
+    analyzer_process_cgroups(domain, message);
+    return;
+  }
+  if (diagnostics_message_kind(message) != diagnostics_cpu_sample) {
+    LOG_PUTS(
+      &analyzer_log_module,
+      log_error,
+      "<Analyzer> Dropped message of unexpected kind."
+    );
+    diagnostics_message_deleter(message);
+    return;
+  }
+  domain->stack.curr = message;
+  const stat_source_t* source = domain->stack.curr->source;
+  if (source == NULL || source->id >= domain->source_count) {
+    LOG_PUTS(
+      &analyzer_log_module,
+      log_error,
+      "<Analyzer> Dropped sample of an unknown source."
+    );
+    stat_cpu_array_free(domain->stack.curr);
+    return;
+  }
+  stat_cpu_array_t* prev = &(domain->stack.prev[source->id]);
+  if (*prev != NULL && (*prev)->layout != domain->stack.curr->layout) {
+    //rows of the two samples describe different cores, can't compare them
+    LOG_PRINTF(
+      &analyzer_log_module,
+      log_info,
+      "<Analyzer> Layout of %s changed to version %llu, resynchronizing.",
+      source->name,
+      domain->stack.curr->layout->version
+    );
+  } else if (*prev != NULL) {
+    analyzer_process(domain, *prev, domain->stack.curr);
+  }
+  stat_cpu_array_free(*prev);
+  *prev = domain->stack.curr;
+}
+
+
 int analyzer_loop(void* context) {
   thread_context_t* ctx = context;
   analyzer_context_t* domain = ctx->domain;
+  void* batch[ANALYZER_BATCH_SIZE];
   while (timepoint_gt(ctx->loop.end, timepoint_now())) {
-    log_puts(log_trace, "<Analyzer> Attempting to fetch input.");
-    domain->stack.curr = message_queue_pop_wait_t(domain->input, ctx->loop.end);
-    if (domain->stack.curr == NULL) {
-      log_puts(log_trace, "<Analyzer> Fetch timed out.");
-    } else if (domain->stack.prev != NULL) {
-      log_puts(log_trace, "<Analyzer> Input fetched, processing.");
-      stat_cpu_percentage_array_t result =
-        stat_cpu_percentage_array_create();
-      if (result == NULL) {
-        //TO DO: Out of memory
-        stat_cpu_array_free(domain->stack.prev);
-      } else {
-        log_puts(log_trace, "<Analyzer> Calculating results.");
-        stat_cpu_array_delta(
-          domain->stack.prev,
-          domain->stack.curr,
-          domain->stack.delta
-        );
-        stat_cpu_percentage_array_calculate(result, domain->stack.delta);
-        stat_cpu_array_free(domain->stack.prev);
-        int push_flag = message_queue_push(domain->output, result);
-        if (push_flag) {
-          stat_cpu_percentage_array_free(result);
-          log_printf(
-            log_error,
-            "<Analyzer> Failed to push results, return code: %i.",
-            push_flag
-          );
-        } else {
-          log_puts(log_trace, "<Analyzer> Pushed message to queue.");
-        }
-      }
-      domain->stack.prev = domain->stack.curr;
-    } else {
-      domain->stack.prev = domain->stack.curr;
+    LOG_PUTS(
+      &analyzer_log_module,
+      log_trace,
+      "<Analyzer> Attempting to fetch input."
+    );
+    size_t count = channel_pop_batch_t(
+      domain->input,
+      batch,
+      ANALYZER_BATCH_SIZE,
+      ctx->loop.end
+    );
+    if (count == 0) {
+      LOG_PUTS(&analyzer_log_module, log_trace, "<Analyzer> Fetch timed out.");
+      continue;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      analyzer_dispatch(domain, batch[i]);
     }
   }
   return 0;
@@ -70,9 +243,9 @@ int analyzer_loop(void* context) {
 int analyzer_cleanup(void* context) {
   thread_context_t* ctx = context;
   analyzer_context_t* domain = ctx->domain;
-  if (domain->stack.prev != NULL) {
-    stat_cpu_array_free(domain->stack.prev);
+  for (size_t i = 0; i < domain->source_count; ++i) {
+    stat_cpu_array_free(domain->stack.prev[i]);
   }
-  stat_cpu_array_free(domain->stack.delta);
+  free(domain->stack.prev);
   return 0;
 }
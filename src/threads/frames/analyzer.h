@@ -2,20 +2,33 @@
 #define SKAI_THREADS_FRAMES_ANALYZER_H
 
 #include "threads/thread_context.h"
-#include "data_structures/message_queue.h"
+#include "data_structures/broadcast.h"
+#include "data_structures/channel.h"
 #include "cpu_diagnostics/linux.h"
+#include "cpu_diagnostics/stat_pool.h"
 
 extern frame_func_t analyzer_frame;
 
+/**
+ * @brief Maximal number of messages taken off the input at once.
+ */
+enum {
+  ANALYZER_BATCH_SIZE = 16
+};
+
 typedef struct analyzer_stack {
-  stat_cpu_array_t prev;
+  stat_cpu_array_t* prev;   /**<Previous sample of each source*/
   stat_cpu_array_t curr;
-  stat_cpu_array_t delta;
 } analyzer_stack_t;
 
 typedef struct analyzer_context {
-  message_queue_t* input;
-  message_queue_t* output;
+  channel_t* input;
+  broadcast_t* output;      /**<Shared by every consumer of the results*/
+  size_t source_count;
+  size_t proc_top_count;    /**<Number of tasks kept in task reports*/
+  size_t cgroup_top_count;  /**<Number of cgroups kept in cgroup reports*/
+  stat_pool_t* usage_pool;  /**<Pool of the percentages, owned by the
+                                analyzer thread, NULL to allocate them*/
   analyzer_stack_t stack;
 } analyzer_context_t;
 
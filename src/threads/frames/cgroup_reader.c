@@ -0,0 +1,68 @@
+#include "cgroup_reader.h"
+
+#include "threads/execution_frame.h"
+#include "logger/logger.h"
+
+
+static log_module_t cgroup_reader_log_module = LOG_MODULE_INIT("cgroup_reader");
+
+frame_func_t cgroup_reader_frame = {
+  .init = cgroup_reader_init,
+  .loop = cgroup_reader_loop,
+  .cleanup = cgroup_reader_cleanup,
+  .log_module = &cgroup_reader_log_module
+};
+
+
+int cgroup_reader_init(void* context) {
+  (void)context;
+  return 0;
+}
+
+
+int cgroup_reader_loop(void* context) {
+  thread_context_t* ctx = context;
+  cgroup_reader_context_t* domain = ctx->domain;
+  cgroup_sample_t sample = NULL;
+  int read_flag = cgroup_collector_sample(domain->collector, &sample);
+  if (read_flag) {
+    LOG_PRINTF(
+      &cgroup_reader_log_module,
+      log_error,
+      "<Cgroup reader> Collecting failed, return code: %i.",
+      read_flag
+    );
+  } else {
+    LOG_PRINTF(
+      &cgroup_reader_log_module,
+      log_debug,
+      "<Cgroup reader> %zu of %zu cgroups used the cpu.",
+      sample->count,
+      sample->cgroup_count
+    );
+    int push_flag = channel_push(domain->output, sample);
+    if (push_flag) {
+      cgroup_sample_free(sample);
+      LOG_PRINTF(
+        &cgroup_reader_log_module,
+        log_error,
+        "<Cgroup reader> Failed to push results, return code: %i.",
+        push_flag
+      );
+    } else {
+      LOG_PUTS(
+        &cgroup_reader_log_module,
+        log_trace,
+        "<Cgroup reader> Pushed message to queue."
+      );
+    }
+  }
+  execution_frame_sleep_until(ctx->loop.end);
+  return 0;
+}
+
+
+int cgroup_reader_cleanup(void* context) {
+  (void)context;
+  return 0;
+}
@@ -0,0 +1,21 @@
+#ifndef SKAI_THREADS_FRAMES_CGROUP_READER_H
+#define SKAI_THREADS_FRAMES_CGROUP_READER_H
+
+#include "threads/thread_context.h"
+#include "data_structures/channel.h"
+#include "cpu_diagnostics/cgroup.h"
+
+extern frame_func_t cgroup_reader_frame;
+
+typedef struct cgroup_reader_context {
+  cgroup_collector_t* collector;
+  channel_t* output;
+} cgroup_reader_context_t;
+
+int cgroup_reader_init(void* context);
+
+int cgroup_reader_loop(void* context);
+
+int cgroup_reader_cleanup(void* context);
+
+#endif
@@ -3,10 +3,13 @@
 #include "threads/execution_frame.h"
 #include "logger/logger.h"
 
+static log_module_t logger_log_module = LOG_MODULE_INIT("logger");
+
 frame_func_t logger_frame = {
   .init = logger_init,
   .loop = logger_loop,
-  .cleanup = logger_cleanup
+  .cleanup = logger_cleanup,
+  .log_module = &logger_log_module
 };
 
 
@@ -2,49 +2,183 @@
 
 #include "threads/execution_frame.h"
 #include "logger/logger.h"
+#include "cpu_diagnostics/cgroup.h"
 #include "cpu_diagnostics/linux.h"
+#include "cpu_diagnostics/process.h"
+
+static log_module_t printer_log_module = LOG_MODULE_INIT("printer");
 
 frame_func_t printer_frame = {
   .init = printer_init,
   .loop = printer_loop,
-  .cleanup = printer_cleanup
+  .cleanup = printer_cleanup,
+  .log_module = &printer_log_module
 };
 
 
 int printer_init(void* context) {
   thread_context_t* ctx = context;
   printer_context_t* domain = ctx->domain;
-  domain->stack.cpu_count = stat_layout_get().cpu_count;
+  domain->stack.layout_versions = calloc(
+    domain->source_count,
+    sizeof(unsigned long long)
+  );
+  if (domain->stack.layout_versions == NULL) {
+    LOG_PUTS(
+      &printer_log_module,
+      log_fatal,
+      "<Printer> Failed to allocate per source state."
+    );
+    return -1;
+  }
   return 0;
 }
 
 
+/**
+ * @brief Prints a single report, noting when the source's cores changed.
+ */
+static void printer_report(
+  printer_context_t domain[static 1],
+  const stat_cpu_percentage_block_t* result
+) {
+  const stat_source_t* source = result->source;
+  stat_layout_version_t* layout = result->layout;
+  if (
+    source != NULL && source->id < domain->source_count && layout != NULL
+  ) {
+    unsigned long long* last_version =
+      &(domain->stack.layout_versions[source->id]);
+    if (*last_version != 0 && *last_version != layout->version) {
+      printf(
+        "\nCpu layout of %s changed, now reporting %zu cores.\n",
+        source->name,
+        result->cpu_count - 1
+      );
+    }
+    *last_version = layout->version;
+  }
+  printf("\nUsage report of %s:\n", source != NULL ? source->name : "?");
+  for (size_t i = 1; i < result->cpu_count; ++i) {
+    //core numbers have gaps when some of them are offline
+    int core = (layout != NULL) ? layout->cpu_ids[i] : (int)(i - 1);
+    printf("CPU_core[%d]_usage = %f%%\n", core, result->values[i]);
+  }
+  printf("CPU_total = %f%%\n", result->values[0]);
+  const stat_system_rates_t* system = &(result->system);
+  printf(
+    "Context_switches = %.1f/s, interrupts = %.1f/s, softirqs = %.1f/s\n",
+    system->context_switches,
+    system->interrupts,
+    system->softirqs
+  );
+  printf(
+    "Forks = %.1f/s, tasks running = %llu, blocked = %llu\n",
+    system->forks,
+    (unsigned long long)system->procs_running,
+    (unsigned long long)system->procs_blocked
+  );
+}
+
+
+/**
+ * @brief Prints the tasks using the most cpu.
+ */
+static void printer_report_tasks(const proc_report_block_t* report) {
+  printf(
+    "\nTop tasks, %zu of %zu used the cpu:\n",
+    report->active_count,
+    report->task_count
+  );
+  for (size_t i = 0; i < report->count; ++i) {
+    const proc_usage_t* usage = &(report->entries[i]);
+    printf(
+      "%7d %7d %-16s user = %6.2f%% system = %6.2f%%\n",
+      (int)usage->tid,
+      (int)usage->tgid,
+      usage->comm,
+      usage->user,
+      usage->system
+    );
+  }
+}
+
+
+/**
+ * @brief Prints the cgroups using the most cpu and how much they were
+ * throttled.
+ */
+static void printer_report_cgroups(const cgroup_report_block_t* report) {
+  printf(
+    "\nTop cgroups, %zu of %zu used the cpu, %zu were throttled:\n",
+    report->active_count,
+    report->cgroup_count,
+    report->throttled_count
+  );
+  for (size_t i = 0; i < report->count; ++i) {
+    const cgroup_usage_t* usage = &(report->entries[i]);
+    printf(
+      "/%s\n  usage = %6.2f%% user = %6.2f%% system = %6.2f%% "
+      "throttled = %6.2f%%(%llu periods)\n",
+      usage->path,
+      usage->usage,
+      usage->user,
+      usage->system,
+      usage->throttled,
+      (unsigned long long)usage->nr_throttled
+    );
+  }
+}
+
+
 int printer_loop(void* context) {
   thread_context_t* ctx = context;
   printer_context_t* domain = ctx->domain;
-  log_puts(log_trace, "<Printer> Attempting to fetch message.");
-  stat_cpu_percentage_array_t result = message_queue_pop_wait_t(
-    domain->input,
-    ctx->loop.end
-  );
-  if (result == NULL) {
-    //means there's no need for sleep
-    log_puts(log_trace, "<Printer> Fetch timed out.");
-  } else {
-    log_puts(log_trace, "<Printer> Message fetched, printing.");
-    puts("\nUsage report:");
-    for (size_t i = 1; i < domain->stack.cpu_count; ++i) {
-      printf("CPU_core[%zu]_usage = %f%%\n", i - 1, result[i]);
+  //every source delivers a report per interval, so keep printing until its end
+  while (timepoint_gt(ctx->loop.end, timepoint_now())) {
+    LOG_PUTS(
+      &printer_log_module,
+      log_trace,
+      "<Printer> Attempting to fetch message."
+    );
+    //shared with the other subscribers, so it's only read
+    const void* message = broadcast_take_wait_t(domain->input, ctx->loop.end);
+    if (message == NULL) {
+      LOG_PUTS(&printer_log_module, log_trace, "<Printer> Fetch timed out.");
+      continue;
+    }
+    LOG_PUTS(
+      &printer_log_module,
+      log_trace,
+      "<Printer> Message fetched, printing."
+    );
+    switch (diagnostics_message_kind(message)) {
+      case diagnostics_cpu_usage:
+        printer_report(domain, message);
+        break;
+      case diagnostics_proc_report:
+        printer_report_tasks(message);
+        break;
+      case diagnostics_cgroup_report:
+        printer_report_cgroups(message);
+        break;
+      default:
+        LOG_PUTS(
+          &printer_log_module,
+          log_error,
+          "<Printer> Dropped message of unexpected kind."
+        );
+        break;
     }
-    printf("CPU_total = %f%%\n", result[0]);
-    stat_cpu_percentage_array_free(result);
-    execution_frame_sleep_until(ctx->loop.end);
+    broadcast_release(domain->input);
   }
   return 0;
 }
 
 
 int printer_cleanup(void* context) {
-  (void)context;
+  thread_context_t* ctx = context;
+  printer_context_t* domain = ctx->domain;
+  free(domain->stack.layout_versions);
   return 0;
-}
\ No newline at end of file
+}
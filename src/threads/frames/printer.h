@@ -2,16 +2,17 @@
 #define SKAI_THREADS_FRAMES_PRINTER_H
 
 #include "threads/thread_context.h"
-#include "data_structures/message_queue.h"
+#include "data_structures/broadcast.h"
 
 extern frame_func_t printer_frame;
 
 typedef struct printer_stack {
-  size_t cpu_count;
+  unsigned long long* layout_versions;  /**<Last layout of each source*/
 } printer_stack_t;
 
 typedef struct printer_context {
-  message_queue_t* input;
+  broadcast_subscriber_t* input;  /**<Subscription to the results*/
+  size_t source_count;
   printer_stack_t stack;
 } printer_context_t;
 
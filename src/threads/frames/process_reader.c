@@ -0,0 +1,69 @@
+#include "process_reader.h"
+
+#include "threads/execution_frame.h"
+#include "logger/logger.h"
+
+
+static log_module_t process_reader_log_module =
+  LOG_MODULE_INIT("process_reader");
+
+frame_func_t process_reader_frame = {
+  .init = process_reader_init,
+  .loop = process_reader_loop,
+  .cleanup = process_reader_cleanup,
+  .log_module = &process_reader_log_module
+};
+
+
+int process_reader_init(void* context) {
+  (void)context;
+  return 0;
+}
+
+
+int process_reader_loop(void* context) {
+  thread_context_t* ctx = context;
+  process_reader_context_t* domain = ctx->domain;
+  proc_sample_t sample = NULL;
+  int read_flag = proc_collector_sample(domain->collector, &sample);
+  if (read_flag) {
+    LOG_PRINTF(
+      &process_reader_log_module,
+      log_error,
+      "<Process reader> Collecting failed, return code: %i.",
+      read_flag
+    );
+  } else {
+    LOG_PRINTF(
+      &process_reader_log_module,
+      log_debug,
+      "<Process reader> %zu of %zu tasks used the cpu.",
+      sample->count,
+      sample->task_count
+    );
+    int push_flag = channel_push(domain->output, sample);
+    if (push_flag) {
+      proc_sample_free(sample);
+      LOG_PRINTF(
+        &process_reader_log_module,
+        log_error,
+        "<Process reader> Failed to push results, return code: %i.",
+        push_flag
+      );
+    } else {
+      LOG_PUTS(
+        &process_reader_log_module,
+        log_trace,
+        "<Process reader> Pushed message to queue."
+      );
+    }
+  }
+  execution_frame_sleep_until(ctx->loop.end);
+  return 0;
+}
+
+
+int process_reader_cleanup(void* context) {
+  (void)context;
+  return 0;
+}
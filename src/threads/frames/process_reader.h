@@ -0,0 +1,21 @@
+#ifndef SKAI_THREADS_FRAMES_PROCESS_READER_H
+#define SKAI_THREADS_FRAMES_PROCESS_READER_H
+
+#include "threads/thread_context.h"
+#include "data_structures/channel.h"
+#include "cpu_diagnostics/process.h"
+
+extern frame_func_t process_reader_frame;
+
+typedef struct process_reader_context {
+  proc_collector_t* collector;
+  channel_t* output;
+} process_reader_context_t;
+
+int process_reader_init(void* context);
+
+int process_reader_loop(void* context);
+
+int process_reader_cleanup(void* context);
+
+#endif
@@ -1,21 +1,24 @@
 #include "reader.h"
 
-#include <stdio.h>
-
 #include "threads/execution_frame.h"
 #include "logger/logger.h"
 #include "cpu_diagnostics/linux.h"
 
 
+static log_module_t reader_log_module = LOG_MODULE_INIT("reader");
+
 frame_func_t reader_frame = {
   .init = reader_init,
   .loop = reader_loop,
-  .cleanup = reader_cleanup
+  .cleanup = reader_cleanup,
+  .log_module = &reader_log_module
 };
 
 
 int reader_init(void* context) {
-  (void)context;
+  thread_context_t* ctx = context;
+  reader_context_t* domain = ctx->domain;
+  domain->stack.layout_version = 0;
   return 0;
 }
 
@@ -23,36 +26,47 @@ int reader_init(void* context) {
 int reader_loop(void* context) {
   thread_context_t* ctx = context;
   reader_context_t* domain = ctx->domain;
-  int read_flag = 0;
   int push_flag = 0;
-  FILE* proc_stat = fopen("/proc/stat", "r");
-  if (proc_stat == NULL) {
-    log_puts(log_fatal, "<Reader> Failed to open /proc/stat.");
-    return -1;
-  }
-  stat_cpu_array_t data = stat_cpu_array_create();
-  if (data != NULL) {
-    read_flag = stat_cpu_array_read_f(data, proc_stat);
-    fclose(proc_stat);
-  } else {
-      //TO DO: out of memory condition
-    fclose(proc_stat);
-    return 0;
-  }
+  stat_cpu_array_t data = NULL;
+  int read_flag = stat_source_sample(domain->source, &data);
   if (read_flag == 0) {
-    push_flag = message_queue_push(domain->output, data);
-    log_puts(log_trace, "<Reader> Pushed message to queue.");
+    if (data->layout->version != domain->stack.layout_version) {
+      LOG_PRINTF(
+        &reader_log_module,
+        log_info,
+        "<Reader> Layout %llu of %s has %zu cpu lines.",
+        data->layout->version,
+        domain->source->name,
+        data->layout->layout.cpu_count
+      );
+      domain->stack.layout_version = data->layout->version;
+    }
+    push_flag = channel_push(domain->output, data);
+    LOG_PUTS(
+      &reader_log_module,
+      log_trace,
+      "<Reader> Pushed message to queue."
+    );
+  } else if (read_flag == STAT_OUT_OF_MEMORY) {
+    LOG_PRINTF(
+      &reader_log_module,
+      log_error,
+      "<Reader> Out of memory while sampling %s.",
+      domain->source->name
+    );
   } else {
-    stat_cpu_array_free(data);
-    log_printf(
+    LOG_PRINTF(
+      &reader_log_module,
       log_error,
-      "<Reader> Read from /stat/cpu failed, return code: %i.",
+      "<Reader> Read from %s failed, return code: %i.",
+      domain->source->name,
       read_flag
     );
   }
   if (push_flag) {
     stat_cpu_array_free(data);
-    log_printf(
+    LOG_PRINTF(
+      &reader_log_module,
       log_error, 
       "<Reader> Failed to push results, return code: %i.",
       push_flag
@@ -2,12 +2,19 @@
 #define SKAI_THREADS_FRAMES_READER_H
 
 #include "threads/thread_context.h"
-#include "data_structures/message_queue.h"
+#include "data_structures/channel.h"
+#include "cpu_diagnostics/linux.h"
 
 extern frame_func_t reader_frame;
 
+typedef struct reader_stack {
+  unsigned long long layout_version;
+} reader_stack_t;
+
 typedef struct reader_context {
-  message_queue_t* output;
+  stat_source_t* source;
+  channel_t* output;
+  reader_stack_t stack;
 } reader_context_t;
 
 int reader_init(void* context);
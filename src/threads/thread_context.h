@@ -3,6 +3,7 @@
 
 #include <stdatomic.h>
 
+#include "logger/logger.h"
 #include "utilities/time.h"
 
 typedef int (*init_func)(void*);
@@ -13,6 +14,7 @@ typedef struct frame_func {
   init_func init;
   loop_func loop;
   cleanup_func cleanup;
+  log_module_t* log_module;     /**<Minimal severity of the frame's records*/
 } frame_func_t;
 
 typedef struct loop_context {
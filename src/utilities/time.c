@@ -107,6 +107,14 @@ timespan_t timespan_dur_abs(
   ));
 }
 
+double timespan_elapsed_ns(
+  timepoint_t start,
+  timepoint_t end
+) {
+  timespan_t span = timespan_dur(start, end);
+  return (double)span.tv_sec * NS_PER_SEC + (double)span.tv_nsec;
+}
+
 timespan_t timespan_time_left(
   timepoint_t start,
   timepoint_t planned_end,
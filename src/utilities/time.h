@@ -190,6 +190,19 @@ timespan_t timespan_dur_abs(
   timepoint_t end
 );
 
+/**
+ * @brief Calculates duration from start to end in nanoseconds, as a double
+ * so that measurements can be averaged without overflow.
+ * 
+ * @param start tv_nsec in [0..NS_PER_SEC-1] and both fields non-negative
+ * @param end tv_nsec in [0..NS_PER_SEC-1] and both fields non-negative
+ * @return Nanoseconds between the timepoints, negative if start > end
+ */
+double timespan_elapsed_ns(
+  timepoint_t start,
+  timepoint_t end
+);
+
 /**
  * @brief Calculates leftover time based on the point of start, planned point
  * of end and duration that passed between the two.